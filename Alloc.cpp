@@ -0,0 +1,387 @@
+/// \file Alloc.cpp
+
+/// \brief Code for allocation tracking.
+///
+/// When compiled with `TRACK_ALLOC` defined (`make TRACK_ALLOC=1`), every
+/// heap allocation is counted. With glibc, `malloc` and friends are replaced
+/// by wrappers around `__libc_malloc` and friends, which catches allocations
+/// made by the C library (such as `stdio` buffers) as well as those made by
+/// the global `operator new`, which calls `malloc`. The old `__malloc_hook`
+/// mechanism was removed in glibc 2.34, so this is the only way to do it.
+/// Elsewhere, the global `operator new` and `operator delete` are replaced
+/// instead, storing the size of each block in front of it. Without
+/// `TRACK_ALLOC` nothing is replaced and all counts are zero.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Alloc.h"
+#include "Illusion.h"
+#include "Perf.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+//////////////////////////////////////////////////////////////////////////
+// Allocation hooks.
+
+#pragma region hooks
+
+#ifdef TRACK_ALLOC
+
+static std::atomic<size_t> g_nCount(0); ///< Number of allocations.
+static std::atomic<size_t> g_nFrees(0); ///< Number of frees.
+static std::atomic<size_t> g_nBytes(0); ///< Number of bytes allocated.
+static std::atomic<size_t> g_nLive(0); ///< Number of bytes live.
+static std::atomic<size_t> g_nPeak(0); ///< High-water mark for live bytes.
+
+/// \brief Count an allocation.
+///
+/// \param n Size of block in bytes.
+
+static void Allocated(size_t n){
+  g_nCount++;
+  g_nBytes += n;
+  const size_t live = g_nLive += n; //live bytes after allocation
+  size_t peak = g_nPeak.load(); //high-water mark
+
+  while(live > peak && !g_nPeak.compare_exchange_weak(peak, live));
+} //Allocated
+
+/// \brief Count a free.
+///
+/// \param n Size of block in bytes.
+
+static void Freed(size_t n){
+  g_nFrees++;
+  g_nLive -= n;
+} //Freed
+
+#ifdef __GLIBC__
+
+#include <malloc.h>
+
+extern "C"{
+  void* __libc_malloc(size_t n);
+  void* __libc_calloc(size_t n, size_t size);
+  void* __libc_realloc(void* p, size_t n);
+  void* __libc_memalign(size_t align, size_t n);
+  void __libc_free(void* p);
+
+  void* malloc(size_t n){
+    void* p = __libc_malloc(n); //new block
+    if(p != nullptr)Allocated(malloc_usable_size(p));
+    return p;
+  } //malloc
+
+  void* calloc(size_t n, size_t size){
+    void* p = __libc_calloc(n, size); //new block
+    if(p != nullptr)Allocated(malloc_usable_size(p));
+    return p;
+  } //calloc
+
+  void* realloc(void* p, size_t n){
+    const size_t old = p? malloc_usable_size(p): 0; //size of old block
+    void* q = __libc_realloc(p, n); //new block
+
+    if(q != nullptr){
+      if(p != nullptr)Freed(old);
+      Allocated(malloc_usable_size(q));
+    } //if
+
+    else if(p != nullptr && n == 0)Freed(old); //realloc(p, 0) frees p
+
+    return q;
+  } //realloc
+
+  void* memalign(size_t align, size_t n){
+    void* p = __libc_memalign(align, n); //new block
+    if(p != nullptr)Allocated(malloc_usable_size(p));
+    return p;
+  } //memalign
+
+  void* aligned_alloc(size_t align, size_t n){
+    return memalign(align, n);
+  } //aligned_alloc
+
+  int posix_memalign(void** p, size_t align, size_t n){
+    if(align < sizeof(void*) || (align & (align - 1)) != 0)return EINVAL;
+    *p = memalign(align, n);
+    return *p == nullptr? ENOMEM: 0;
+  } //posix_memalign
+
+  void free(void* p){
+    if(p != nullptr)Freed(malloc_usable_size(p));
+    __libc_free(p);
+  } //free
+} //extern "C"
+
+#else //not glibc
+
+static const size_t HEADER = alignof(std::max_align_t); ///< Header size.
+
+/// \param n Number of bytes.
+/// \return Pointer to new block.
+
+void* operator new(size_t n){
+  char* p = (char*)malloc(n + HEADER); //block with header
+  if(p == nullptr)throw std::bad_alloc();
+
+  *(size_t*)p = n;
+  Allocated(n);
+  return p + HEADER;
+} //operator new
+
+/// \param n Number of bytes.
+/// \return Pointer to new block.
+
+void* operator new[](size_t n){
+  return operator new(n);
+} //operator new[]
+
+/// \param p Pointer to block, or `nullptr`.
+
+void operator delete(void* p) noexcept{
+  if(p != nullptr){
+    char* q = (char*)p - HEADER; //block with header
+    Freed(*(size_t*)q);
+    free(q);
+  } //if
+} //operator delete
+
+/// \param p Pointer to block, or `nullptr`.
+
+void operator delete[](void* p) noexcept{
+  operator delete(p);
+} //operator delete[]
+
+#endif //__GLIBC__
+
+#endif //TRACK_ALLOC
+
+/// \return true if allocations are being counted.
+
+bool AllocTracking(){
+#ifdef TRACK_ALLOC
+  return true;
+#else
+  return false;
+#endif
+} //AllocTracking
+
+/// \return Counts since the program started, with `peak` the high-water
+///   mark for live bytes since the last CAllocScope was constructed.
+
+AllocStats AllocTotals(){
+  AllocStats stats; //result
+
+#ifdef TRACK_ALLOC
+  stats.count = g_nCount;
+  stats.frees = g_nFrees;
+  stats.bytes = g_nBytes;
+  stats.peak = g_nPeak;
+#endif
+
+  return stats;
+} //AllocTotals
+
+#pragma endregion hooks
+
+//////////////////////////////////////////////////////////////////////////
+// CAllocScope.
+
+#pragma region CAllocScope
+
+/// Record the totals so far and reset the high-water mark for live bytes.
+
+CAllocScope::CAllocScope(){
+#ifdef TRACK_ALLOC
+  m_nLive = g_nLive;
+  g_nPeak = m_nLive;
+#endif
+
+  m_cStart = AllocTotals();
+} //constructor
+
+/// \return Counts since construction.
+
+AllocStats CAllocScope::Stop() const{
+  AllocStats stats = AllocTotals(); //totals now
+  stats.count -= m_cStart.count;
+  stats.frees -= m_cStart.frees;
+  stats.bytes -= m_cStart.bytes;
+  stats.peak = stats.peak > m_nLive? stats.peak - m_nLive: 0;
+  return stats;
+} //Stop
+
+#pragma endregion CAllocScope
+
+//////////////////////////////////////////////////////////////////////////
+// Allocation report.
+
+#pragma region bench
+
+/// \brief Report allocations per phase and per job.
+///
+/// The parameters are optionally `-reps n` (default 100) followed by a job
+/// as described in ParseJob() or a job file as described in LoadJobs();
+/// without either, the illusions `output1.svg` and `output2.svg` are used.
+/// For each job, the phases timed by BenchPhasesCommand() are each run
+/// once to warm up and then `n` times, and the allocations, frees, and
+/// bytes allocated per repetition and the peak live bytes are reported.
+/// The phases are describe (Describe()), geometry (PlaceElements()),
+/// format (FormatElements() to a count-only output), I/O (OpenSVG(),
+/// writing the formatted bytes, and CloseSVG()), and end to end (all of
+/// these to a file). The geometry and format phases are the hot loops,
+/// which should not allocate at all once warmed up.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 if the hot loops don't allocate, 1 if they do, or for failure.
+
+int BenchAllocCommand(size_t argc, const char* const argv[]){
+  size_t reps = 100; //number of repetitions
+  std::vector<Job> jobs; //jobs to measure
+  bool ok = true; //parameters are valid
+
+  if(argc >= 2 && !strcmp(argv[0], "-reps")){
+    reps = (size_t)strtoul(argv[1], nullptr, 10);
+    argc -= 2; argv += 2;
+    ok = reps > 0;
+  } //if
+
+  if(ok && argc == 1)
+    ok = LoadJobs(argv[0], jobs) && !jobs.empty();
+
+  else if(ok && argc > 1){
+    jobs.push_back(Job());
+    ok = ParseJob(jobs[0], argc, argv);
+  } //else if
+
+  if(!ok){
+    printf("Expected [-reps n] [job | jobfile]\n");
+    return 1;
+  } //if
+
+  if(!AllocTracking()){
+    printf("Allocation tracking is off, rebuild with make TRACK_ALLOC=1\n");
+    return 1;
+  } //if
+
+  if(jobs.empty())BenchJobs(jobs);
+
+  const std::string fname = TempName("bench-alloc"); //I/O phase file
+  const AllocStats start = AllocTotals(); //totals before the jobs
+  size_t hot = 0; //number of hot loop allocations
+
+  for(const Job& job: jobs){
+    Illusion illusion; //illusion descriptor
+    Describe(illusion, job);
+    const size_t n = ElementCount(illusion); //number of elements
+    std::vector<Placed> placed(n); //placed elements
+    PlaceElements(illusion, placed);
+
+    std::string body; //formatted style and elements
+    COutput bodyoutput(body); //output stream for body
+    FormatElements(bodyoutput, illusion, placed);
+    bodyoutput.Close();
+
+    printf("%s: %zu elements, %zu reps\n", job.fname.c_str(), n, reps);
+    printf("  %-10s %10s %10s %12s %12s\n", "phase", "allocs/rep",
+      "frees/rep", "bytes/rep", "peak bytes");
+
+    const char* phase[] = {"describe", "geometry", "format", "I/O",
+      "end-to-end"}; //phase names
+
+    for(size_t k=0; k<5; k++){
+      CAllocScope scope; //allocation counts for this phase
+
+      for(size_t rep=0; rep<=reps; rep++){
+        if(rep == 1)scope = CAllocScope(); //first rep is the warm up
+
+        switch(k){
+          case 0:{
+            Illusion fresh; //illusion descriptor
+            Describe(fresh, job);
+          } break;
+
+          case 1: PlaceElements(illusion, placed); break;
+
+          case 2:{
+            COutput count; //count-only output
+            FormatElements(count, illusion, placed);
+          } break;
+
+          case 3:{
+            COutput file; //output file
+
+            if(OpenSVG(file, fname, job.w, job.w)){
+              file.Write(body.data(), body.size());
+              CloseSVG(file);
+            } //if
+          } break;
+
+          case 4:{
+            Illusion fresh; //illusion descriptor
+            Describe(fresh, job);
+            COutput file; //output file
+
+            if(OpenSVG(file, fname, job.w, job.w)){
+              DrawIllusion(file, fresh);
+              CloseSVG(file);
+            } //if
+          } break;
+        } //switch
+      } //for
+
+      const AllocStats stats = scope.Stop(); //counts for this phase
+      if(k == 1 || k == 2)hot += stats.count;
+
+      printf("  %-10s %10.2f %10.2f %12.1f %12zu\n", phase[k],
+        (double)stats.count/reps, (double)stats.frees/reps,
+        (double)stats.bytes/reps, stats.peak);
+    } //for
+  } //for
+
+  remove((fname + ".svg").c_str());
+
+  const AllocStats total = AllocTotals(); //totals after the jobs
+  printf("Run: %zu allocations, %zu frees, %zu bytes, of which the jobs made "
+    "%zu allocations of %zu bytes\n", total.count, total.frees, total.bytes,
+    total.count - start.count, total.bytes - start.bytes);
+
+  if(hot > 0){
+    printf("The hot loops made %zu allocations after warming up\n", hot);
+    return 1;
+  } //if
+
+  printf("The hot loops made no allocations after warming up\n");
+  return 0;
+} //BenchAllocCommand
+
+#pragma endregion bench
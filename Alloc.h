@@ -0,0 +1,66 @@
+/// \file Alloc.h
+
+/// \brief Interface for allocation tracking.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Alloc_h__
+#define __Alloc_h__
+
+#include <stddef.h>
+
+/// \brief Allocation counts.
+///
+/// Counts of heap allocations and frees over some interval, with the bytes
+/// allocated measured as the usable size of each block, which is what is
+/// actually taken from the heap.
+
+struct AllocStats{
+  size_t count = 0; ///< Number of allocations.
+  size_t frees = 0; ///< Number of frees.
+  size_t bytes = 0; ///< Number of bytes allocated.
+  size_t peak = 0; ///< Peak live bytes above those live at the start.
+}; //AllocStats
+
+/// \brief Allocation scope.
+///
+/// Counts the allocations made by all threads between construction and
+/// Stop(). Peak live bytes are tracked by a single global high-water mark
+/// that the constructor resets, so scopes should not overlap.
+
+class CAllocScope{
+  private:
+    AllocStats m_cStart; ///< Totals at construction.
+    size_t m_nLive = 0; ///< Live bytes at construction.
+
+  public:
+    CAllocScope(); ///< Constructor.
+    AllocStats Stop() const; ///< Counts since construction.
+}; //CAllocScope
+
+bool AllocTracking();
+AllocStats AllocTotals();
+
+int BenchAllocCommand(size_t argc, const char* const argv[]);
+
+#endif //__Alloc_h__
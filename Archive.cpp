@@ -0,0 +1,501 @@
+/// \file Archive.cpp
+
+/// \brief Code for tar archive output.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Archive.h"
+#include "Budget.h"
+#include "Illusion.h"
+#include "Timer.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// Tar headers.
+
+#pragma region headers
+
+static const size_t BLOCK = 512; ///< Tar block size in bytes.
+
+/// \brief Make a tar header.
+///
+/// Fill in a POSIX ustar header for a regular file. Names of more than 100
+/// characters are split at a slash into a prefix of at most 155 characters
+/// and a name of at most 100.
+///
+/// \param h [out] Header block of BLOCK bytes.
+/// \param name File name within the archive.
+/// \param size File size in bytes.
+/// \param mtime Modification time in seconds since the epoch.
+/// \return false if the name is too long or the file too large.
+
+static bool TarHeader(char* h, const std::string& name, size_t size,
+  unsigned long long mtime)
+{
+  memset(h, 0, BLOCK);
+  size_t split = 0; //length of prefix
+
+  if(name.empty() || (unsigned long long)size >= 077777777777ULL)
+    return false;
+
+  if(name.size() > 100){ //split at the last slash that fits the prefix
+    split = name.rfind('/', 155);
+
+    if(split == std::string::npos || split == 0 ||
+      name.size() - split - 1 > 100)
+        return false;
+
+    memcpy(h + 345, name.data(), split);
+    memcpy(h, name.data() + split + 1, name.size() - split - 1);
+  } //if
+
+  else memcpy(h, name.data(), name.size());
+
+  snprintf(h + 100, 8, "%07o", 0644); //mode
+  snprintf(h + 108, 8, "%07o", 0); //uid
+  snprintf(h + 116, 8, "%07o", 0); //gid
+  snprintf(h + 124, 12, "%011llo", (unsigned long long)size);
+  snprintf(h + 136, 12, "%011llo", mtime);
+  h[156] = '0'; //regular file
+  memcpy(h + 257, "ustar", 6);
+  memcpy(h + 263, "00", 2);
+
+  unsigned sum = 8*' '; //checksum, counting its own field as spaces
+
+  for(size_t i=0; i<BLOCK; i++)
+    if(i < 148 || i >= 156)sum += (unsigned char)h[i];
+
+  snprintf(h + 148, 8, "%06o", sum);
+  h[155] = ' ';
+
+  return true;
+} //TarHeader
+
+/// \brief Read a tar header.
+///
+/// \param h Header block of BLOCK bytes.
+/// \param name [out] File name within the archive.
+/// \param size [out] File size in bytes.
+/// \return false if this is an empty block marking the end of the archive.
+
+static bool ReadTarHeader(const char* h, std::string& name, size_t& size){
+  if(h[0] == 0)return false;
+
+  const std::string prefix(h + 345, strnlen(h + 345, 155)); //name prefix
+  name = std::string(h, strnlen(h, 100));
+  if(!prefix.empty())name = prefix + "/" + name;
+
+  const std::string octal(h + 124, 12); //size in octal
+  size = (size_t)strtoull(octal.c_str(), nullptr, 8);
+
+  return true;
+} //ReadTarHeader
+
+/// \brief Name of an output within an archive.
+///
+/// Tar archives hold relative names, so leading slashes are removed.
+///
+/// \param fname File name.
+/// \return Name within the archive.
+
+std::string ArchiveName(const std::string& fname){
+  const size_t i = fname.find_first_not_of('/'); //first character kept
+  return i == std::string::npos? "": fname.substr(i);
+} //ArchiveName
+
+#pragma endregion headers
+
+//////////////////////////////////////////////////////////////////////////
+// Tar writer.
+
+#pragma region writer
+
+/// Close the archive if it is still open, discarding it.
+
+CTarWriter::~CTarWriter(){
+  if(!m_strTemp.empty()){
+    m_bError = true;
+    Close();
+  } //if
+} //destructor
+
+/// Open an archive, and its index if required, by way of temporary files.
+/// \param fname Archive file name.
+/// \param index True to write an index to `fname.idx`.
+/// \return true if the files were opened.
+
+bool CTarWriter::Open(const std::string& fname, bool index){
+  m_strName = fname;
+  m_strTemp = TempName(fname);
+  m_strIndexTemp = TempName(fname + ".idx");
+  m_bIndex = index;
+  m_nTime = (unsigned long long)time(nullptr);
+  m_nEntries = 0;
+  m_bError = false;
+
+  if(!m_cOutput.Open(m_strTemp, true)){
+    m_strTemp.clear();
+    return false;
+  } //if
+
+  if(index && !m_cIndex.Open(m_strIndexTemp, false)){
+    m_bIndex = false;
+    m_bError = true;
+    Close();
+    return false;
+  } //if
+
+  return true;
+} //Open
+
+/// Append an entry to the archive, and a line to the index if there is one.
+/// \param name File name within the archive.
+/// \param data File contents.
+/// \param digest [out] Digest of the file contents.
+/// \param sha256 True to put the SHA-256 of the file contents in the digest.
+/// \return true if the entry was added.
+
+bool CTarWriter::Add(const std::string& name, const std::string& data,
+  Digest& digest, bool sha256)
+{
+  char h[BLOCK]; //header block
+
+  if(!TarHeader(h, name, data.size(), m_nTime)){
+    m_bError = true;
+    return false;
+  } //if
+
+  CXXHash64 hash; //hash of contents
+  hash.Update(data.data(), data.size());
+  digest.size = data.size();
+  digest.hash = hash.Digest();
+
+  if(sha256){
+    CSha256 sha; //SHA-256 of contents
+    sha.Update(data.data(), data.size());
+    digest.sha256 = sha.Digest();
+  } //if
+
+  m_cOutput.Write(h, BLOCK);
+  const size_t offset = m_cOutput.Size(); //offset of contents
+  m_cOutput.Write(data.data(), data.size());
+
+  const size_t pad = (BLOCK - data.size()%BLOCK)%BLOCK; //padding
+  memset(h, 0, pad);
+  m_cOutput.Write(h, pad);
+
+  if(m_bIndex)
+    m_cIndex.Printf("%s %zu %zu %s\n", HexHash(digest.hash).c_str(), offset,
+      digest.size, name.c_str());
+
+  m_nEntries++;
+  return !m_cOutput.Error();
+} //Add
+
+/// End the archive with two empty blocks and rename it and its index into
+/// place, or remove them if anything went wrong.
+/// \return true if the archive was written.
+
+bool CTarWriter::Close(){
+  if(m_strTemp.empty())return false;
+
+  char h[2*BLOCK] = {0}; //end of archive marker
+  m_cOutput.Write(h, sizeof(h));
+  m_cOutput.Close();
+
+  bool ok = !m_bError && !m_cOutput.Error(); //archive written
+  ok = MoveIntoPlace(m_strTemp, m_strName, ok);
+  m_strTemp.clear();
+
+  if(m_bIndex){
+    m_cIndex.Close();
+    ok = MoveIntoPlace(m_strIndexTemp, m_strName + ".idx",
+      ok && !m_cIndex.Error());
+  } //if
+
+  return ok;
+} //Close
+
+/// \return Number of entries added.
+
+size_t CTarWriter::Entries() const{
+  return m_nEntries;
+} //Entries
+
+/// \return Number of bytes written to the archive so far.
+
+size_t CTarWriter::Size() const{
+  return m_cOutput.Size();
+} //Size
+
+#pragma endregion writer
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Seek in a file.
+///
+/// \param file File pointer.
+/// \param offset Offset from the start of the file, which may be more than
+/// 2 GB.
+/// \return true if the seek succeeded.
+
+static bool Seek(FILE* file, size_t offset){
+#ifdef _MSC_VER //Visual Studio
+  return _fseeki64(file, (__int64)offset, SEEK_SET) == 0;
+#else
+  return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+} //Seek
+
+/// \brief Find an entry in an archive index.
+///
+/// \param fname Archive file name.
+/// \param name Name of entry.
+/// \param offset [out] Offset of entry contents.
+/// \param digest [out] Digest of entry contents.
+/// \return true if the entry is in the index.
+
+static bool FindInIndex(const std::string& fname, const std::string& name,
+  size_t& offset, Digest& digest)
+{
+  FILE* input = fopen((fname + ".idx").c_str(), "rt"); //index file
+  if(input == nullptr)return false;
+
+  char line[1024]; //line of index
+  bool found = false; //entry found
+
+  while(!found && fgets(line, sizeof(line), input) != nullptr){
+    unsigned long long hash = 0; //hash of entry
+    int n = 0; //number of characters before name
+
+    if(sscanf(line, "%llx %zu %zu %n", &hash, &offset, &digest.size, &n) >= 3
+      && n > 0)
+    {
+      std::string s(line + n); //name of entry
+      while(!s.empty() && (s.back() == '\n' || s.back() == '\r'))s.pop_back();
+      digest.hash = hash;
+      found = s == name;
+    } //if
+  } //while
+
+  fclose(input);
+  return found;
+} //FindInIndex
+
+/// \brief Find an entry in an archive by reading its headers.
+///
+/// \param input Archive file.
+/// \param name Name of entry.
+/// \param offset [out] Offset of entry contents.
+/// \param size [out] Size of entry contents.
+/// \return true if the entry is in the archive.
+
+static bool FindInArchive(FILE* input, const std::string& name,
+  size_t& offset, size_t& size)
+{
+  char h[BLOCK]; //header block
+  std::string s; //name of entry
+  size_t pos = 0; //offset of header
+
+  while(Seek(input, pos) && fread(h, 1, BLOCK, input) == BLOCK &&
+    ReadTarHeader(h, s, size))
+  {
+    if(s == name){
+      offset = pos + BLOCK;
+      return true;
+    } //if
+
+    pos += BLOCK + (size + BLOCK - 1)/BLOCK*BLOCK;
+  } //while
+
+  return false;
+} //FindInArchive
+
+/// \brief Extract one file from a tar archive.
+///
+/// The parameters are a tar archive written by CTarWriter and the name of
+/// one of its entries, which is written to `stdout`. If the archive has an
+/// index, the entry is found with a single seek and its hash is checked,
+/// otherwise the headers are read from the start of the archive until it
+/// is found. Errors are reported on `stderr`.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int ExtractCommand(size_t argc, const char* const argv[]){
+  if(argc != 2){
+    printf("Expected archive and file name\n");
+    return 1;
+  } //if
+
+  const std::string fname = argv[0]; //archive file name
+  const std::string name = ArchiveName(argv[1]); //name of entry
+  FILE* input = fopen(fname.c_str(), "rb"); //archive file
+
+  if(input == nullptr){
+    fprintf(stderr, "Cannot open %s\n", fname.c_str());
+    return 1;
+  } //if
+
+  size_t offset = 0; //offset of entry contents
+  Digest digest; //digest of entry contents
+  const bool indexed = FindInIndex(fname, name, offset, digest); //in index
+
+  if(!indexed && !FindInArchive(input, name, offset, digest.size)){
+    fprintf(stderr, "Cannot find %s in %s\n", name.c_str(), fname.c_str());
+    fclose(input);
+    return 1;
+  } //if
+
+  CXXHash64 hash; //hash of entry contents
+  std::vector<char> buffer(65536); //copy buffer
+  size_t left = digest.size; //bytes left to copy
+  bool ok = Seek(input, offset); //no errors so far
+
+  while(ok && left > 0){
+    const size_t n = fread(buffer.data(), 1,
+      std::min(left, buffer.size()), input); //bytes read
+
+    hash.Update(buffer.data(), n);
+    ok = n > 0 && fwrite(buffer.data(), 1, n, stdout) == n;
+    left -= n;
+  } //while
+
+  fclose(input);
+
+  if(ok && indexed && hash.Digest() != digest.hash){
+    fprintf(stderr, "%s does not match the index\n", name.c_str());
+    ok = false;
+  } //if
+
+  if(!ok)fprintf(stderr, "Cannot extract %s\n", name.c_str());
+  return ok? 0: 1;
+} //ExtractCommand
+
+/// \brief Benchmark archive output.
+///
+/// The parameters are a directory, optionally followed by `-jobs n` for the
+/// number of small jobs (default 2000) and `-threads t` for the number of
+/// drawing threads (default one per core). The jobs are rendered to one
+/// SVG file each in the directory as by `batch -threads t`, and then into
+/// a tar archive with an index in the same directory, and the number of
+/// jobs per second is reported for each. Each is run three times and the
+/// fastest is reported. Pointing the directory at different file systems
+/// (for example ext4 and tmpfs) shows how much of the cost of one file per
+/// job is file system metadata.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchArchiveCommand(size_t argc, const char* const argv[]){
+  size_t n = 2000; //number of jobs
+  size_t threads = 0; //number of threads
+  bool ok = argc > 0; //no errors so far
+
+  for(size_t i=1; ok && i<argc; i++){ //options
+    if(!strcmp(argv[i], "-jobs") && i + 1 < argc)
+      ok = (n = (size_t)strtoul(argv[++i], nullptr, 10)) > 0;
+    else if(!strcmp(argv[i], "-threads") && i + 1 < argc)
+      ok = (threads = (size_t)strtoul(argv[++i], nullptr, 10)) > 0;
+    else ok = false;
+  } //for
+
+  if(!ok){
+    printf("Expected directory [-jobs n] [-threads t]\n");
+    return 1;
+  } //if
+
+  const std::string dir = argv[0]; //output directory
+  const std::string tarname = dir + "/bench.tar"; //archive file name
+  std::vector<Job> jobs(n); //job descriptors
+  std::vector<Piece> plan(n); //one piece per job
+  std::vector<size_t> order(n); //jobs in order
+
+  for(size_t i=0; i<n; i++){
+    Job& job = jobs[i]; //job descriptor
+    job.kind = 1 + i%2;
+    job.fname = dir + "/bench" + std::to_string(i);
+    job.w = 800;
+    job.n = job.kind == 1? 4: 3;
+    job.p[0] = job.kind == 1? 100.0f: 300.0f;
+    job.p[1] = job.kind == 1? 72.0f: 12.0f;
+    job.p[2] = job.kind == 1? 24.0f: 6.0f;
+    job.dark = "black"; job.light = "white"; job.bgclr = "gray";
+
+    plan[i].job = order[i] = i;
+  } //for
+
+  CCostModel model; //cost model
+  model.Calibrate(&jobs);
+  CThreadPool pool(threads); //drawing threads
+  const auto none = [](size_t, const Digest&){}; //nothing to do when done
+
+  double tFiles = 1e9, tTar = 1e9; //fastest times
+  size_t failed = 0; //number of jobs that failed
+  size_t bytes = 0; //archive size
+
+  for(size_t rep=0; rep<3; rep++){
+    CTimer timer; //stopwatch
+    failed += RunPlan(jobs, plan, pool, none);
+    tFiles = std::min(tFiles, timer.Elapsed());
+
+    timer.Start();
+    CMemoryBudget budget(SIZE_MAX); //no memory limit
+    CWriteQueue queue(4*pool.Size()); //writer queue
+    CTarWriter tar; //archive
+    std::vector<JobMemory> memory; //memory used by each job
+
+    if(!tar.Open(tarname, true)){
+      printf("Cannot write %s\n", tarname.c_str());
+      return 1;
+    } //if
+
+    failed += RunBudget(jobs, order, model, pool, budget, queue, none, memory,
+      &tar);
+    bytes = tar.Size();
+    if(!tar.Close())failed++;
+    tTar = std::min(tTar, timer.Elapsed());
+  } //for
+
+  printf("%zu jobs on %zu threads in %s\n", n, pool.Size(), dir.c_str());
+  printf("  one file per job  %8.3f s %10.1f jobs/s\n", tFiles, n/tFiles);
+  printf("  tar with index    %8.3f s %10.1f jobs/s, %0.1f MB archive\n",
+    tTar, n/tTar, bytes/1048576.0);
+
+  if(failed > 0)printf("%zu jobs failed\n", failed);
+  return failed > 0? 1: 0;
+} //BenchArchiveCommand
+
+#pragma endregion commands
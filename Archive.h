@@ -0,0 +1,81 @@
+/// \file Archive.h
+
+/// \brief Interface for tar archive output.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Archive_h__
+#define __Archive_h__
+
+#include <string>
+
+#include "Output.h"
+
+/// \brief Tar archive writer.
+///
+/// Writes SVG files into a single POSIX ustar archive instead of one file
+/// each, which saves a create, a rename, and a handful of metadata
+/// operations per output. Each entry is a 512-byte header followed by the
+/// file contents padded to a multiple of 512 bytes, and the archive ends
+/// with two empty blocks, so it can be unpacked with `tar -xf`. The archive
+/// is written to a temporary file and renamed into place by Close().
+///
+/// Optionally, a sidecar index named after the archive with `.idx`
+/// appended records one line per entry with its hash in hex, the offset
+/// of its contents in the archive, its size in bytes, and its name, for
+/// example
+///
+///     9b0c2d1f6a4e3c88 512 15506 output1.svg
+///
+/// so that any entry can be read with a single seek (see ExtractCommand()).
+
+class CTarWriter{
+  private:
+    std::string m_strName; ///< Archive file name.
+    std::string m_strTemp; ///< Temporary file name.
+    std::string m_strIndexTemp; ///< Temporary index file name.
+    COutput m_cOutput; ///< Archive output stream.
+    COutput m_cIndex; ///< Index output stream.
+    bool m_bIndex = false; ///< Writing an index.
+    unsigned long long m_nTime = 0; ///< Modification time of entries.
+    size_t m_nEntries = 0; ///< Number of entries written.
+    bool m_bError = false; ///< True if an entry could not be added.
+
+  public:
+    ~CTarWriter(); ///< Destructor.
+
+    bool Open(const std::string& fname, bool index=false); ///< Open.
+    bool Add(const std::string& name, const std::string& data,
+      Digest& digest, bool sha256=false); ///< Add an entry.
+    bool Close(); ///< Finish and rename into place.
+
+    size_t Entries() const; ///< Number of entries.
+    size_t Size() const; ///< Number of bytes written.
+}; //CTarWriter
+
+std::string ArchiveName(const std::string& fname);
+
+int ExtractCommand(size_t argc, const char* const argv[]);
+int BenchArchiveCommand(size_t argc, const char* const argv[]);
+
+#endif //__Archive_h__
@@ -0,0 +1,321 @@
+/// \file Batch.cpp
+
+/// \brief Code for batch rendering.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Archive.h"
+#include "Batch.h"
+#include "Budget.h"
+#include "Cost.h"
+#include "Journal.h"
+#include "Timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <mutex>
+
+/// \brief Parse a shard.
+///
+/// \param shard [out] Shard.
+/// \param s String of the form `k/n` where `k < n`.
+/// \return true if the string describes a valid shard.
+
+bool ParseShard(Shard& shard, const char* s){
+  char* end = nullptr; //end of number parsed
+  shard.k = (size_t)strtoul(s, &end, 10);
+  if(end == s || *end != '/')return false;
+
+  s = end + 1;
+  shard.n = (size_t)strtoul(s, &end, 10);
+
+  return end != s && *end == 0 && shard.k < shard.n;
+} //ParseShard
+
+/// \brief Shard membership.
+///
+/// \param shard Shard.
+/// \param i Job index.
+/// \return true if job `i` is in the shard.
+
+bool InShard(const Shard& shard, size_t i){
+  return i%shard.n == shard.k;
+} //InShard
+
+/// \brief Render a batch of jobs.
+///
+/// The parameters are a job file as described in LoadJobs(), optionally
+/// followed by `-shard k/n` to render only shard `k` of `n`, and
+/// `-journal <file>` to record each finished output in a journal (see
+/// CJournal). When a batch is restarted with the same journal, outputs that
+/// are in the journal and still match their recorded size and hash are
+/// skipped, and only the rest are rendered. With `-quick` only the size is
+/// checked, and with `-sync` each journal line is flushed to disk.
+///
+/// The jobs are rendered by `-threads n` threads (default 1) in the order
+/// in which they appear in the job file. With `-lpt` they are rendered
+/// longest first according to a calibrated cost model (see CCostModel), and
+/// with `-split` jobs that are predicted to take longer than their share of
+/// the total are split across threads (see PlanBatch()). The number of jobs
+/// per second is reported at the end, along with the predicted makespan.
+///
+/// With `-budget m` each job is drawn to memory and written by a single
+/// writer thread, and jobs are started only when their predicted footprint
+/// fits in a budget of `m` megabytes (see RunBudget()). At most `-queue k`
+/// drawn jobs (default 4) wait for the writer before the drawing threads
+/// are held back. The footprint and resident set size of each job are
+/// reported, along with the peak resident set size of the whole batch.
+///
+/// With `-tar file` the SVG is written into a single tar archive instead of
+/// one file per job, in the same way as with `-budget` (which defaults to
+/// no limit), and `-index` also writes an index of the archive (see
+/// CTarWriter). An archive can't be journaled.
+///
+/// With `-manifest file` the size and XXH64 hash of each output are written
+/// to a manifest, one line per job in job file order, and with `-sha256`
+/// its SHA-256 hash too (otherwise "-"). The hashes are computed as the
+/// bytes are written, so the outputs are never read back. Jobs skipped
+/// because they are in the journal are listed with their journaled hash.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BatchCommand(size_t argc, const char* const argv[]){
+  std::vector<Job> jobs; //job descriptors
+  Shard shard; //shard to be rendered
+  std::string journalfile; //journal file name
+  bool quick = false; //check sizes only
+  bool sync = false; //flush journal to disk
+  size_t threads = 1; //number of threads
+  bool lpt = false; //longest jobs first
+  bool split = false; //split oversized jobs
+  size_t budget = 0; //memory budget in megabytes, 0 for none
+  size_t depth = 4; //writer queue depth
+  std::string tarname; //archive file name
+  bool index = false; //write an archive index
+  std::string manifestfile; //manifest file name
+  bool sha256 = false; //compute SHA-256 hashes
+  bool ok = argc > 0; //no errors so far
+
+  for(size_t i=1; ok && i<argc; i++){ //options
+    if(!strcmp(argv[i], "-shard") && i + 1 < argc)
+      ok = ParseShard(shard, argv[++i]);
+    else if(!strcmp(argv[i], "-journal") && i + 1 < argc)
+      journalfile = argv[++i];
+    else if(!strcmp(argv[i], "-threads") && i + 1 < argc)
+      ok = (threads = (size_t)strtoul(argv[++i], nullptr, 10)) > 0;
+    else if(!strcmp(argv[i], "-budget") && i + 1 < argc)
+      ok = (budget = (size_t)strtoul(argv[++i], nullptr, 10)) > 0;
+    else if(!strcmp(argv[i], "-queue") && i + 1 < argc)
+      ok = (depth = (size_t)strtoul(argv[++i], nullptr, 10)) > 0;
+    else if(!strcmp(argv[i], "-tar") && i + 1 < argc)
+      tarname = argv[++i];
+    else if(!strcmp(argv[i], "-manifest") && i + 1 < argc)
+      manifestfile = argv[++i];
+    else if(!strcmp(argv[i], "-index"))index = true;
+    else if(!strcmp(argv[i], "-sha256"))sha256 = true;
+    else if(!strcmp(argv[i], "-quick"))quick = true;
+    else if(!strcmp(argv[i], "-sync"))sync = true;
+    else if(!strcmp(argv[i], "-lpt"))lpt = true;
+    else if(!strcmp(argv[i], "-split"))split = true;
+    else ok = false;
+  } //for
+
+  const bool archived = !tarname.empty(); //writing an archive
+
+  if(!ok || (split && (budget > 0 || archived)) ||
+    (archived && !journalfile.empty()) || (index && !archived) ||
+    (sha256 && manifestfile.empty()))
+  {
+    printf("Expected job file [-shard k/n] [-journal file [-quick] [-sync]] ");
+    printf("[-threads n] [-lpt] [-split | -budget m [-queue k]] ");
+    printf("[-tar file [-index]] [-manifest file [-sha256]]\n");
+    return 1;
+  } //if
+
+  if(!LoadJobs(argv[0], jobs)){
+    printf("Cannot load jobs from %s\n", argv[0]);
+    return 1;
+  } //if
+
+  CTimer timer; //stopwatch
+  CJournal journal; //journal of finished outputs
+  const bool journaled = !journalfile.empty(); //using a journal
+
+  if(journaled){
+    const size_t n = journal.Load(journalfile); //number of files in journal
+
+    if(!journal.Open(journalfile, sync)){
+      printf("Cannot write journal %s\n", journalfile.c_str());
+      return 1;
+    } //if
+
+    printf("Journal %s has %zu outputs\n", journalfile.c_str(), n);
+  } //if
+
+  std::vector<size_t> todo; //indices of jobs to be rendered
+  size_t skipped = 0; //number of jobs already done
+  std::vector<Digest> digests(jobs.size()); //digest of each output
+  std::vector<bool> written(jobs.size(), false); //output has a digest
+  std::vector<char> valid(jobs.size(), 0); //output matches the journal
+
+  if(journaled){ //verify journaled outputs, hashing them on every thread
+    CThreadPool verifier(threads); //verifying threads
+
+    for(size_t i=0; i<jobs.size(); i++){
+      const std::string fname = jobs[i].fname + ".svg"; //output file name
+
+      if(InShard(shard, i) && journal.Find(fname, digests[i]))
+        verifier.Enqueue([&, i, fname](){
+          valid[i] = Verify(fname, digests[i], quick);
+        });
+    } //for
+
+    verifier.Wait();
+  } //if
+
+  for(size_t i=0; i<jobs.size(); i++)
+    if(InShard(shard, i)){
+      if(valid[i]){
+        written[i] = true;
+        skipped++;
+      } //if
+
+      else todo.push_back(i);
+    } //if
+
+  CCostModel model; //cost model
+  if(lpt || split || budget > 0 || archived)model.Calibrate(&jobs);
+
+  std::vector<Piece> plan; //pieces of work
+  std::vector<double> predicted; //predicted time of each piece
+  PlanBatch(jobs, todo, model, threads, lpt, split, plan);
+
+  for(const Piece& piece: plan)
+    predicted.push_back(piece.seconds);
+
+  std::mutex mutex; //guards the journal and digests
+  bool journalok = true; //journal written ok
+  CThreadPool pool(threads); //rendering threads
+
+  const auto append = [&](size_t i, const Digest& digest){
+    std::lock_guard<std::mutex> lock(mutex);
+    digests[i] = digest;
+    written[i] = true;
+
+    if(journaled && !journal.Append(jobs[i].fname + ".svg", digest))
+      journalok = false;
+  }; //append to journal and record digest
+
+  size_t failed = 0; //number of jobs that failed
+
+  if(budget == 0 && !archived)
+    failed = RunPlan(jobs, plan, pool, append, nullptr, sha256);
+
+  else{
+    std::vector<size_t> order; //jobs in the order admitted
+    std::vector<JobMemory> memory; //memory used by each job
+    CMemoryBudget membudget(budget > 0? budget << 20: SIZE_MAX); //budget
+    CWriteQueue queue(depth); //writer queue
+    CTarWriter tar; //archive
+
+    for(const Piece& piece: plan)
+      order.push_back(piece.job);
+
+    if(archived && !tar.Open(tarname, index)){
+      printf("Cannot write %s\n", tarname.c_str());
+      return 1;
+    } //if
+
+    failed = RunBudget(jobs, order, model, pool, membudget, queue, append,
+      memory, archived? &tar: nullptr, sha256);
+
+    if(archived && !tar.Close()){
+      printf("Cannot write %s\n", tarname.c_str());
+      failed = order.size();
+    } //if
+
+    if(budget > 0){
+      printf("  %-24s %12s %12s %15s\n", "job", "estimate MB", "SVG MB",
+        "process RSS MB");
+
+      for(size_t k=0; k<order.size(); k++)
+        printf("  %-24s %12.2f %12.2f %15.2f\n", jobs[order[k]].fname.c_str(),
+          memory[k].estimate/1048576.0, memory[k].size/1048576.0,
+          memory[k].processRss/1048576.0);
+
+      printf("Budget %zu MB, peak promised %0.2f MB, %zu admission waits, ",
+        budget, membudget.Peak()/1048576.0, membudget.Waits());
+      printf("%zu writer queue waits\n", queue.Waits());
+      printf("Peak RSS %0.2f MB\n", PeakResidentBytes()/1048576.0);
+    } //if
+
+    if(archived)
+      printf("Wrote %zu files to %s\n", tar.Entries(), tarname.c_str());
+  } //else
+
+  bool manifestok = true; //manifest written ok
+
+  if(!manifestfile.empty()){
+    const std::string temp = TempName(manifestfile); //temporary file name
+    COutput manifest; //manifest file
+    manifestok = manifest.Open(temp);
+
+    for(size_t i=0; manifestok && i<jobs.size(); i++)
+      if(written[i]){
+        const std::string fname = jobs[i].fname + ".svg"; //output file name
+        const Digest& d = digests[i]; //digest of output
+
+        manifest.Printf("%s %zu %s %s\n", HexHash(d.hash).c_str(), d.size,
+          d.sha256.empty()? "-": d.sha256.c_str(),
+          archived? ArchiveName(fname).c_str(): fname.c_str());
+      } //if
+
+    manifest.Close();
+    manifestok = MoveIntoPlace(temp, manifestfile,
+      manifestok && !manifest.Error());
+
+    if(!manifestok)
+      printf("Cannot write manifest %s\n", manifestfile.c_str());
+  } //if
+
+  const size_t done = todo.size() - failed; //number of jobs rendered
+  const double t = timer.Elapsed(); //elapsed time
+
+  printf("Rendered %zu jobs (shard %zu/%zu) in %0.3f s, %0.1f jobs/s\n",
+    done, shard.k, shard.n, t, t > 0? done/t: 0);
+
+  if(lpt || split)
+    printf("Predicted makespan %0.3f s on %zu threads\n",
+      Makespan(predicted, threads), threads);
+
+  if(journaled)
+    printf("Skipped %zu jobs already in the journal\n", skipped);
+
+  if(!journalok)
+    printf("Cannot write journal %s\n", journalfile.c_str());
+
+  return failed || !journalok || !manifestok? 1: 0;
+} //BatchCommand
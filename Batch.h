@@ -0,0 +1,49 @@
+/// \file Batch.h
+
+/// \brief Interface for batch rendering.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Batch_h__
+#define __Batch_h__
+
+#include "Illusion.h"
+
+/// \brief Shard.
+///
+/// A deterministic subset of the jobs in a job file. Shard `k` of `n`
+/// consists of the jobs whose zero-based line index is congruent to `k`
+/// modulo `n`, so the shards of a job file can be rendered independently on
+/// different machines without any communication.
+
+struct Shard{
+  size_t k = 0; ///< Shard index.
+  size_t n = 1; ///< Number of shards.
+}; //Shard
+
+bool ParseShard(Shard& shard, const char* s);
+bool InShard(const Shard& shard, size_t i);
+
+int BatchCommand(size_t argc, const char* const argv[]);
+
+#endif //__Batch_h__
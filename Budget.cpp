@@ -0,0 +1,325 @@
+/// \file Budget.cpp
+
+/// \brief Code for memory-budgeted batches.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Archive.h"
+#include "Budget.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <thread>
+
+#ifndef _MSC_VER
+  #include <sys/resource.h>
+  #include <unistd.h>
+#endif
+
+#ifdef __GLIBC__
+  #include <malloc.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Memory budget.
+
+#pragma region budget
+
+/// \param bytes Budget in bytes.
+
+CMemoryBudget::CMemoryBudget(size_t bytes): m_nBudget(bytes){
+} //constructor
+
+/// Wait until the bytes fit in the budget, or nothing else is in progress,
+/// and then promise them.
+/// \param bytes Number of bytes.
+
+void CMemoryBudget::Acquire(size_t bytes){
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  if(m_nUsed > 0 && m_nUsed + bytes > m_nBudget){
+    m_nWaits++;
+
+    m_cvFree.wait(lock, [&]{
+      return m_nUsed == 0 || m_nUsed + bytes <= m_nBudget;
+    });
+  } //if
+
+  m_nUsed += bytes;
+  m_nPeak = std::max(m_nPeak, m_nUsed);
+} //Acquire
+
+/// Give back bytes promised by Acquire().
+/// \param bytes Number of bytes.
+
+void CMemoryBudget::Release(size_t bytes){
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_nUsed -= bytes;
+  m_cvFree.notify_all();
+} //Release
+
+/// \return Largest number of bytes promised at once.
+
+size_t CMemoryBudget::Peak(){
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nPeak;
+} //Peak
+
+/// \return Number of times that Acquire() had to wait.
+
+size_t CMemoryBudget::Waits(){
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nWaits;
+} //Waits
+
+#pragma endregion budget
+
+//////////////////////////////////////////////////////////////////////////
+// Writer queue.
+
+#pragma region queue
+
+/// \param depth Maximum number of entries, at least 1.
+
+CWriteQueue::CWriteQueue(size_t depth): m_nDepth(std::max<size_t>(depth, 1)){
+} //constructor
+
+/// Add drawn SVG to the queue, waiting for the writer if the queue is full.
+/// \param drawn Drawn SVG, which is moved into the queue.
+
+void CWriteQueue::Push(Drawn&& drawn){
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  if(m_qDrawn.size() >= m_nDepth){
+    m_nWaits++;
+    m_cvPop.wait(lock, [&]{return m_qDrawn.size() < m_nDepth;});
+  } //if
+
+  m_qDrawn.push_back(std::move(drawn));
+  m_cvPush.notify_one();
+} //Push
+
+/// Take the oldest entry from the queue, waiting if it is empty.
+/// \param drawn [out] Drawn SVG.
+/// \return false if the queue is empty and has been closed.
+
+bool CWriteQueue::Pop(Drawn& drawn){
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cvPush.wait(lock, [&]{return !m_qDrawn.empty() || m_bClosed;});
+  if(m_qDrawn.empty())return false;
+
+  drawn = std::move(m_qDrawn.front());
+  m_qDrawn.pop_front();
+  m_cvPop.notify_one();
+
+  return true;
+} //Pop
+
+/// Tell the writer that nothing more will be pushed, so that Pop() returns
+/// false once the queue is empty.
+
+void CWriteQueue::Close(){
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_bClosed = true;
+  m_cvPush.notify_all();
+} //Close
+
+/// \return Number of times that Push() had to wait.
+
+size_t CWriteQueue::Waits(){
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nWaits;
+} //Waits
+
+#pragma endregion queue
+
+//////////////////////////////////////////////////////////////////////////
+// Budgeted batches.
+
+#pragma region batch
+
+/// \brief Resident set size.
+///
+/// \return Resident set size of this process in bytes, or 0 if unknown.
+
+size_t ResidentBytes(){
+#ifdef _MSC_VER //Visual Studio
+  return 0;
+#else
+  FILE* input = fopen("/proc/self/statm", "rt"); //statm file
+  if(input == nullptr)return 0;
+
+  unsigned long size = 0, resident = 0; //sizes in pages
+  const int n = fscanf(input, "%lu %lu", &size, &resident); //fields read
+  fclose(input);
+
+  return n == 2? resident*(size_t)sysconf(_SC_PAGESIZE): 0;
+#endif
+} //ResidentBytes
+
+/// \brief Peak resident set size.
+///
+/// \return Largest resident set size of this process so far in bytes, or 0
+/// if unknown.
+
+size_t PeakResidentBytes(){
+#ifdef _MSC_VER //Visual Studio
+  return 0;
+#else
+  struct rusage usage; //resource usage
+  if(getrusage(RUSAGE_SELF, &usage) != 0)return 0;
+
+  #ifdef __APPLE__
+    return (size_t)usage.ru_maxrss; //in bytes
+  #else
+    return (size_t)usage.ru_maxrss*1024; //in kilobytes
+  #endif
+#endif
+} //PeakResidentBytes
+
+/// \brief Predicted memory footprint of a job.
+///
+/// A job in a budgeted batch holds its whole SVG in memory from when it
+/// starts drawing until it has been written, so its footprint is the size
+/// of its SVG as predicted by the cost model, with 5% to spare for error
+/// in the prediction, plus the output stream's buffer.
+///
+/// \param job Job descriptor.
+/// \param model Calibrated cost model.
+/// \return Predicted footprint in bytes.
+
+size_t Footprint(const Job& job, const CCostModel& model){
+  return (size_t)(1.05*model.Predict(job).bytes) + 65536;
+} //Footprint
+
+/// \brief Run a memory-budgeted batch.
+///
+/// Jobs are admitted in order, each waiting until its predicted footprint
+/// (see Footprint()) fits in the memory budget. An admitted job is drawn to
+/// a string on the thread pool and then pushed onto the writer queue,
+/// which blocks while the queue is full. A single writer thread writes the
+/// SVG files, or adds them to a tar archive, in the order in which the jobs
+/// were admitted, and releases each job's share of the budget once its SVG
+/// has been written and freed. SVG that is drawn ahead of its turn waits in
+/// the writer, still counted against the budget.
+///
+/// Under glibc the threshold above which `malloc` uses `mmap` is fixed at
+/// 1 MB. Otherwise glibc raises it each time a large block is freed, after
+/// which the SVG strings come from the heap and freeing them no longer
+/// gives the memory back to the system, so the resident set size drifts
+/// well above the budget.
+///
+/// \param jobs Job descriptors.
+/// \param order Indices of the jobs to be rendered, in the order in which
+/// they are to be admitted.
+/// \param model Calibrated cost model.
+/// \param pool Thread pool that draws the jobs.
+/// \param budget Memory budget.
+/// \param queue Writer queue.
+/// \param done Called with the job index and digest of each SVG file
+/// written, from the writer thread.
+/// \param memory [out] Memory used by each job, indexed like `order`.
+/// \param archive Pointer to an open tar archive to which the SVG is to be
+/// written, or `nullptr` to write SVG files.
+/// \param sha256 True to put the SHA-256 of each SVG file in its digest.
+/// \return Number of jobs that failed.
+
+size_t RunBudget(const std::vector<Job>& jobs,
+  const std::vector<size_t>& order, const CCostModel& model,
+  CThreadPool& pool, CMemoryBudget& budget, CWriteQueue& queue,
+  const std::function<void(size_t, const Digest&)>& done,
+  std::vector<JobMemory>& memory, CTarWriter* archive, bool sha256)
+{
+#ifdef __GLIBC__
+  mallopt(M_MMAP_THRESHOLD, 1 << 20);
+#endif
+
+  memory.assign(order.size(), JobMemory());
+  size_t failed = 0; //number of jobs that failed
+
+  std::thread writer([&]{
+    Drawn drawn; //drawn SVG
+    std::map<size_t, std::string> ahead; //SVG drawn ahead of its turn
+    size_t next = 0; //index of next SVG to be written
+
+    while(queue.Pop(drawn)){
+      ahead[drawn.k].swap(drawn.svg);
+
+      for(auto p=ahead.begin(); p!=ahead.end() && p->first==next;
+        p=ahead.erase(p), next++)
+      {
+        const Job& job = jobs[order[next]]; //job descriptor
+        const std::string fname = job.fname + ".svg"; //file name
+        std::vector<std::string> parts(1); //SVG in one piece
+        parts[0].swap(p->second);
+        Digest digest; //digest of SVG file
+        bool ok = false; //SVG written
+
+        if(archive != nullptr)
+          ok = archive->Add(ArchiveName(fname), parts[0], digest, sha256);
+        else ok = WriteParts(job, parts, digest, sha256);
+
+        if(ok)done(order[next], digest);
+
+        else{
+          printf("Cannot write %s\n", fname.c_str());
+          failed++;
+        } //else
+
+        std::vector<std::string>().swap(parts);
+        budget.Release(memory[next].estimate);
+      } //for
+    } //while
+  }); //writer thread
+
+  for(size_t k=0; k<order.size(); k++){
+    const Job& job = jobs[order[k]]; //job descriptor
+    memory[k].estimate = Footprint(job, model);
+    budget.Acquire(memory[k].estimate);
+
+    pool.Enqueue([&, k]{
+      Drawn drawn; //drawn SVG
+      drawn.k = k;
+      drawn.svg.reserve(memory[k].estimate);
+
+      COutput output(drawn.svg); //output stream
+      DrawJob(output, jobs[order[k]]);
+      output.Close();
+
+      memory[k].size = drawn.svg.size();
+      memory[k].processRss = ResidentBytes(); //whole process, all jobs
+      queue.Push(std::move(drawn));
+    });
+  } //for
+
+  pool.Wait();
+  queue.Close();
+  writer.join();
+
+  return failed;
+} //RunBudget
+
+#pragma endregion batch
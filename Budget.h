@@ -0,0 +1,127 @@
+/// \file Budget.h
+
+/// \brief Interface for memory-budgeted batches.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Budget_h__
+#define __Budget_h__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Cost.h"
+#include "ThreadPool.h"
+
+class CTarWriter;
+
+/// \brief Memory budget.
+///
+/// A count of bytes promised to jobs that are in progress, which may not
+/// exceed a fixed budget. Acquire() waits until the bytes asked for fit in
+/// what is left of the budget, and Release() gives them back. A request
+/// that is larger than the whole budget is granted when nothing else is
+/// in progress, so that an oversized job runs alone rather than never.
+
+class CMemoryBudget{
+  private:
+    size_t m_nBudget = 0; ///< Budget in bytes.
+    size_t m_nUsed = 0; ///< Bytes promised.
+    size_t m_nPeak = 0; ///< Largest number of bytes promised at once.
+    size_t m_nWaits = 0; ///< Number of times Acquire() had to wait.
+    std::mutex m_mutex; ///< Guards everything above.
+    std::condition_variable m_cvFree; ///< Signalled when bytes are released.
+
+  public:
+    CMemoryBudget(size_t bytes); ///< Constructor.
+
+    void Acquire(size_t bytes); ///< Wait for bytes.
+    void Release(size_t bytes); ///< Give bytes back.
+
+    size_t Peak(); ///< Largest number of bytes promised at once.
+    size_t Waits(); ///< Number of waits in Acquire().
+}; //CMemoryBudget
+
+/// \brief SVG waiting to be written.
+
+struct Drawn{
+  size_t k = 0; ///< Index into the batch.
+  std::string svg; ///< SVG.
+}; //Drawn
+
+/// \brief Bounded writer queue.
+///
+/// Drawn SVG is handed from the drawing threads to a single writer thread
+/// through a queue of limited depth. When the queue is full, Push() waits
+/// for the writer to catch up, so that a slow disk holds back the drawing
+/// threads instead of letting finished SVG pile up in memory.
+
+class CWriteQueue{
+  private:
+    std::deque<Drawn> m_qDrawn; ///< SVG waiting to be written.
+    size_t m_nDepth = 1; ///< Maximum number of entries.
+    bool m_bClosed = false; ///< No more entries will be pushed.
+    size_t m_nWaits = 0; ///< Number of times Push() had to wait.
+    std::mutex m_mutex; ///< Guards everything above.
+    std::condition_variable m_cvPush; ///< Signalled when an entry is pushed.
+    std::condition_variable m_cvPop; ///< Signalled when an entry is popped.
+
+  public:
+    CWriteQueue(size_t depth); ///< Constructor.
+
+    void Push(Drawn&& drawn); ///< Add an entry, waiting if full.
+    bool Pop(Drawn& drawn); ///< Remove an entry, waiting if empty.
+    void Close(); ///< Wake the writer when the queue runs dry.
+
+    size_t Waits(); ///< Number of waits in Push().
+}; //CWriteQueue
+
+/// \brief Memory used by one job of a budgeted batch.
+///
+/// The resident set size is that of the whole process at the moment the
+/// job finished drawing, including every other job in memory at the time,
+/// not the memory used by this job alone. It shows whether the batch as a
+/// whole stayed under its budget while this job was held.
+
+struct JobMemory{
+  size_t estimate = 0; ///< Predicted footprint in bytes.
+  size_t size = 0; ///< Size of its SVG in bytes.
+  size_t processRss = 0; ///< Process resident set size after drawing it.
+}; //JobMemory
+
+size_t ResidentBytes();
+size_t PeakResidentBytes();
+size_t Footprint(const Job& job, const CCostModel& model);
+
+size_t RunBudget(const std::vector<Job>& jobs,
+  const std::vector<size_t>& order, const CCostModel& model,
+  CThreadPool& pool, CMemoryBudget& budget, CWriteQueue& queue,
+  const std::function<void(size_t, const Digest&)>& done,
+  std::vector<JobMemory>& memory, CTarWriter* archive=nullptr,
+  bool sha256=false);
+
+#endif //__Budget_h__
@@ -0,0 +1,91 @@
+/// \file Cancel.cpp
+
+/// \brief Code for the cancellation flag CCancel.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Cancel.h"
+
+CCancel::CCancel(): m_bCancel(false), m_bPreempt(false){
+} //constructor
+
+/// Cancel the work for good.
+
+void CCancel::Cancel(){
+  m_bCancel = true;
+} //Cancel
+
+/// Ask the work to yield at its next check, or stop asking.
+/// \param preempt True to preempt, false to stop preempting.
+
+void CCancel::Preempt(bool preempt){
+  m_bPreempt = preempt;
+} //Preempt
+
+/// Set a deadline, after which the work is abandoned. This must be called
+/// before the flag is shared with other threads.
+/// \param seconds Seconds from now.
+
+void CCancel::SetDeadline(double seconds){
+  m_bDeadline = true;
+  m_tDeadline = std::chrono::steady_clock::now() +
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(seconds));
+} //SetDeadline
+
+/// Set the function that is called by Cancelled() when the work has been
+/// preempted. It is called on the thread doing the work, and should clear
+/// the preempted flag. This must be called before the flag is shared with
+/// other threads.
+/// \param yield Yield function.
+
+void CCancel::SetYield(const std::function<void()>& yield){
+  m_fnYield = yield;
+} //SetYield
+
+/// Check whether the work should be abandoned, first yielding if the work
+/// has been preempted and there is a yield function.
+/// \return true if the work should be abandoned.
+
+bool CCancel::Cancelled() const{
+  if(m_bPreempt && m_fnYield)m_fnYield();
+  return m_bCancel || IsExpired();
+} //Cancelled
+
+/// \return true if Cancel() has been called.
+
+bool CCancel::IsCancelled() const{
+  return m_bCancel;
+} //IsCancelled
+
+/// \return true if the work has been preempted and has not yet yielded.
+
+bool CCancel::IsPreempted() const{
+  return m_bPreempt;
+} //IsPreempted
+
+/// \return true if there is a deadline and it has passed.
+
+bool CCancel::IsExpired() const{
+  return m_bDeadline && std::chrono::steady_clock::now() > m_tDeadline;
+} //IsExpired
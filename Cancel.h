@@ -0,0 +1,70 @@
+/// \file Cancel.h
+
+/// \brief Interface for the cancellation flag CCancel.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Cancel_h__
+#define __Cancel_h__
+
+#include <stddef.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+/// \brief Cancellation flag.
+///
+/// Long drawing loops can be stopped part way through by giving them a
+/// cancellation flag, which they check between rings and every
+/// CCancel::CHUNK elements. The work is abandoned if the flag has been set
+/// by Cancel() or if its deadline has passed. If the flag has been set by
+/// Preempt(), the check calls the yield function instead, which can do more
+/// urgent work on the same thread before the loop carries on. The flag can
+/// be set from any thread.
+
+class CCancel{
+  private:
+    std::atomic<bool> m_bCancel; ///< Cancelled.
+    std::atomic<bool> m_bPreempt; ///< Preempted, to be restarted later.
+    bool m_bDeadline = false; ///< Has a deadline.
+    std::chrono::steady_clock::time_point m_tDeadline; ///< Deadline.
+    std::function<void()> m_fnYield; ///< Called when preempted.
+
+  public:
+    static const size_t CHUNK = 1024; ///< Elements drawn between checks.
+
+    CCancel(); ///< Constructor.
+
+    void Cancel(); ///< Cancel.
+    void Preempt(bool preempt=true); ///< Preempt or stop preempting.
+    void SetDeadline(double seconds); ///< Set deadline.
+    void SetYield(const std::function<void()>& yield); ///< Set yield function.
+
+    bool Cancelled() const; ///< Should the work be abandoned?
+    bool IsCancelled() const; ///< Was Cancel() called?
+    bool IsPreempted() const; ///< Was Preempt() called?
+    bool IsExpired() const; ///< Has the deadline passed?
+}; //CCancel
+
+#endif //__Cancel_h__
@@ -0,0 +1,778 @@
+/// \file Compress.cpp
+
+/// \brief Code for compressed output.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Compress.h"
+#include "Illusion.h"
+#include "Pack.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef USE_ZLIB
+  #include <zlib.h>
+#endif
+
+#ifdef USE_ZSTD
+  #include <zdict.h>
+  #include <zstd.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Zlib.
+
+#pragma region zlib
+
+#ifdef USE_ZLIB
+
+/// \brief Compress with zlib.
+///
+/// \param in Uncompressed bytes.
+/// \param out [out] Compressed bytes.
+/// \param level Compression level, 0 for the default.
+/// \param gzip True for gzip format, false for zlib format.
+/// \param dict Preset dictionary, empty for none (zlib format only).
+/// \return true if compression succeeded.
+
+static bool Deflate(const std::string& in, std::string& out, int level,
+  bool gzip, const std::string& dict)
+{
+  z_stream z; //zlib stream
+  memset(&z, 0, sizeof(z));
+
+  if(deflateInit2(&z, level == 0? Z_DEFAULT_COMPRESSION: level, Z_DEFLATED,
+    gzip? 15 + 16: 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      return false;
+
+  bool ok = dict.empty() || deflateSetDictionary(&z,
+    (const Bytef*)dict.data(), (uInt)dict.size()) == Z_OK; //no errors so far
+
+  out.resize(deflateBound(&z, (uLong)in.size()));
+  z.next_in = (Bytef*)in.data();
+  z.avail_in = (uInt)in.size();
+  z.next_out = (Bytef*)&out[0];
+  z.avail_out = (uInt)out.size();
+
+  ok = ok && deflate(&z, Z_FINISH) == Z_STREAM_END;
+  out.resize(z.total_out);
+  deflateEnd(&z);
+
+  return ok;
+} //Deflate
+
+/// \brief Decompress with zlib.
+///
+/// Either gzip or zlib format is accepted. A zlib stream that was
+/// compressed with a preset dictionary needs the same dictionary.
+///
+/// \param in Compressed bytes.
+/// \param out [out] Uncompressed bytes.
+/// \param dict Preset dictionary, empty for none.
+/// \return true if decompression succeeded.
+
+static bool Inflate(const std::string& in, std::string& out,
+  const std::string& dict)
+{
+  z_stream z; //zlib stream
+  memset(&z, 0, sizeof(z));
+  if(inflateInit2(&z, 15 + 32) != Z_OK)return false;
+
+  char buffer[65536]; //output buffer
+  int result = Z_OK; //result of inflate
+  out.clear();
+  z.next_in = (Bytef*)in.data();
+  z.avail_in = (uInt)in.size();
+
+  while(result == Z_OK){
+    z.next_out = (Bytef*)buffer;
+    z.avail_out = sizeof(buffer);
+    result = inflate(&z, Z_NO_FLUSH);
+
+    if(result == Z_NEED_DICT && !dict.empty())
+      result = inflateSetDictionary(&z, (const Bytef*)dict.data(),
+        (uInt)dict.size());
+
+    out.append(buffer, sizeof(buffer) - z.avail_out);
+  } //while
+
+  inflateEnd(&z);
+  return result == Z_STREAM_END;
+} //Inflate
+
+#endif //USE_ZLIB
+
+/// \brief Train a dictionary for deflate.
+///
+/// A deflate dictionary is simply text that is likely to occur in the files
+/// to be compressed, and only its last 32 KB can be used. SVG files have
+/// one element per line, so this one is made of whole lines. Each line
+/// scores its length times the number of samples other than the first that
+/// contain it, and the lines with the highest scores are chosen until the
+/// dictionary is full. They are placed in increasing order of score, since
+/// deflate codes short distances more cheaply.
+///
+/// \param samples Sample files.
+/// \param size Maximum size of dictionary in bytes.
+/// \param dict [out] Dictionary.
+
+static void TrainLines(const std::vector<std::string>& samples, size_t size,
+  std::string& dict)
+{
+  std::unordered_map<std::string, size_t> count; //samples containing line
+
+  for(const std::string& sample: samples){
+    std::unordered_set<std::string> seen; //lines in this sample
+    size_t start = 0; //start of line
+
+    while(start < sample.size()){
+      size_t end = sample.find('\n', start); //end of line
+      end = end == std::string::npos? sample.size(): end + 1;
+      seen.insert(sample.substr(start, end - start));
+      start = end;
+    } //while
+
+    for(const std::string& line: seen)
+      count[line]++;
+  } //for
+
+  std::vector<std::pair<size_t, const std::string*>> scored; //lines by score
+
+  for(const auto& p: count)
+    if(p.second > 1)
+      scored.push_back(std::make_pair((p.second - 1)*p.first.size(), &p.first));
+
+  std::sort(scored.begin(), scored.end(),
+    [](const std::pair<size_t, const std::string*>& a,
+      const std::pair<size_t, const std::string*>& b){
+        return a.first != b.first? a.first > b.first: *a.second < *b.second;
+      });
+
+  std::vector<const std::string*> chosen; //lines chosen, best first
+  size_t total = 0; //size of lines chosen
+
+  for(const auto& p: scored)
+    if(total + p.second->size() <= size){
+      chosen.push_back(p.second);
+      total += p.second->size();
+    } //if
+
+  dict.clear();
+
+  for(auto p=chosen.rbegin(); p!=chosen.rend(); p++)
+    dict += **p;
+} //TrainLines
+
+#pragma endregion zlib
+
+//////////////////////////////////////////////////////////////////////////
+// CCompressor.
+
+#pragma region CCompressor
+
+/// \param codec Compression format.
+/// \param dict Dictionary, empty for none. Gzip can't use one.
+/// \param level Compression level, 0 for the default.
+
+CCompressor::CCompressor(Codec codec, const std::string& dict, int level):
+  m_eCodec(codec), m_strDict(dict), m_nLevel(level)
+{
+#ifdef USE_ZSTD
+  if(codec == Codec::Zstd && !dict.empty()){
+    m_pCDict = ZSTD_createCDict(dict.data(), dict.size(),
+      level == 0? ZSTD_CLEVEL_DEFAULT: level);
+    m_pDDict = ZSTD_createDDict(dict.data(), dict.size());
+  } //if
+#endif
+} //constructor
+
+/// Free the digested dictionaries, if any.
+
+CCompressor::~CCompressor(){
+#ifdef USE_ZSTD
+  ZSTD_freeCDict((ZSTD_CDict*)m_pCDict);
+  ZSTD_freeDDict((ZSTD_DDict*)m_pDDict);
+#endif
+} //destructor
+
+/// Compress a whole file.
+/// \param in Uncompressed bytes.
+/// \param out [out] Compressed bytes.
+/// \return true if compression succeeded.
+
+bool CCompressor::Compress(const std::string& in, std::string& out) const{
+  switch(m_eCodec){
+#ifdef USE_ZLIB
+    case Codec::Gzip:
+      return m_strDict.empty() && Deflate(in, out, m_nLevel, true, "");
+
+    case Codec::Deflate:
+      return Deflate(in, out, m_nLevel, false, m_strDict);
+#endif
+
+#ifdef USE_ZSTD
+    case Codec::Zstd:{
+      ZSTD_CCtx* cctx = ZSTD_createCCtx(); //compression context
+      out.resize(ZSTD_compressBound(in.size()));
+
+      const size_t n = m_pCDict != nullptr?
+        ZSTD_compress_usingCDict(cctx, &out[0], out.size(), in.data(),
+          in.size(), (const ZSTD_CDict*)m_pCDict):
+        ZSTD_compressCCtx(cctx, &out[0], out.size(), in.data(), in.size(),
+          m_nLevel == 0? ZSTD_CLEVEL_DEFAULT: m_nLevel); //compressed size
+
+      ZSTD_freeCCtx(cctx);
+      if(ZSTD_isError(n))return false;
+
+      out.resize(n);
+      return true;
+    } //case
+#endif
+
+    default: return false;
+  } //switch
+} //Compress
+
+/// Decompress a whole file.
+/// \param in Compressed bytes.
+/// \param out [out] Uncompressed bytes.
+/// \return true if decompression succeeded.
+
+bool CCompressor::Decompress(const std::string& in, std::string& out) const{
+  switch(m_eCodec){
+#ifdef USE_ZLIB
+    case Codec::Gzip:
+    case Codec::Deflate:
+      return Inflate(in, out, m_strDict);
+#endif
+
+#ifdef USE_ZSTD
+    case Codec::Zstd:{
+      const unsigned long long size =
+        ZSTD_getFrameContentSize(in.data(), in.size()); //uncompressed size
+
+      if(size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN)
+        return false;
+
+      ZSTD_DCtx* dctx = ZSTD_createDCtx(); //decompression context
+      out.resize((size_t)size);
+
+      const size_t n = m_pDDict != nullptr?
+        ZSTD_decompress_usingDDict(dctx, &out[0], out.size(), in.data(),
+          in.size(), (const ZSTD_DDict*)m_pDDict):
+        ZSTD_decompressDCtx(dctx, &out[0], out.size(), in.data(), in.size());
+          //decompressed size
+
+      ZSTD_freeDCtx(dctx);
+      return !ZSTD_isError(n) && n == out.size();
+    } //case
+#endif
+
+    default: return false;
+  } //switch
+} //Decompress
+
+/// \return Name of compression format, including whether it has a
+/// dictionary.
+
+const char* CCompressor::Name() const{
+  switch(m_eCodec){
+    case Codec::Gzip: return "gzip";
+    case Codec::Deflate: return m_strDict.empty()? "zlib": "zlib+dict";
+    case Codec::Zstd: return m_strDict.empty()? "zstd": "zstd+dict";
+    default: return "";
+  } //switch
+} //Name
+
+/// \return Extension of compressed SVG files: `.svgz` for gzip,
+/// `.svg.zd` for zlib, and `.svg.zst` for Zstandard.
+
+const char* CCompressor::Extension() const{
+  switch(m_eCodec){
+    case Codec::Gzip: return ".svgz";
+    case Codec::Deflate: return ".svg.zd";
+    case Codec::Zstd: return ".svg.zst";
+    default: return "";
+  } //switch
+} //Extension
+
+#pragma endregion CCompressor
+
+//////////////////////////////////////////////////////////////////////////
+// Helper functions.
+
+#pragma region helpers
+
+/// \brief Codec support.
+///
+/// \param codec Compression format.
+/// \return true if this build supports the format.
+
+bool Supported(Codec codec){
+#ifdef USE_ZSTD
+  if(codec == Codec::Zstd)return true;
+#endif
+
+#ifdef USE_ZLIB
+  if(codec != Codec::Zstd)return true;
+#endif
+
+  return false;
+} //Supported
+
+/// \brief Train a dictionary.
+///
+/// Build a dictionary from sample files, with `ZDICT_trainFromBuffer` for
+/// Zstandard or TrainLines() for zlib. Gzip can't use a dictionary.
+///
+/// \param codec Compression format.
+/// \param samples Sample files.
+/// \param size Maximum size of dictionary in bytes.
+/// \param dict [out] Dictionary.
+/// \return true if a dictionary was made.
+
+bool TrainDictionary(Codec codec, const std::vector<std::string>& samples,
+  size_t size, std::string& dict)
+{
+  dict.clear();
+  if(!Supported(codec))return false;
+
+  if(codec == Codec::Deflate)
+    TrainLines(samples, std::min<size_t>(size, 32768), dict);
+
+#ifdef USE_ZSTD
+  if(codec == Codec::Zstd){
+    std::string all; //samples back to back
+    std::vector<size_t> sizes; //sample sizes
+
+    for(const std::string& sample: samples){
+      all += sample;
+      sizes.push_back(sample.size());
+    } //for
+
+    dict.resize(size);
+    const size_t n = ZDICT_trainFromBuffer(&dict[0], size, all.data(),
+      sizes.data(), (unsigned)sizes.size()); //dictionary size
+
+    dict.resize(ZDICT_isError(n)? 0: n);
+  } //if
+#endif
+
+  return !dict.empty();
+} //TrainDictionary
+
+/// \brief Read a whole file.
+///
+/// \param fname File name.
+/// \param s [out] File contents.
+/// \return true if the file was read.
+
+static bool ReadFile(const std::string& fname, std::string& s){
+  FILE* input = nullptr; //input file
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&input, fname.c_str(), "rb");
+#else
+  input = fopen(fname.c_str(), "rb");
+#endif
+
+  if(input == nullptr)return false;
+
+  char buffer[65536]; //read buffer
+  size_t n = 0; //number of bytes read
+  s.clear();
+
+  while((n = fread(buffer, 1, sizeof(buffer), input)) > 0)
+    s.append(buffer, n);
+
+  const bool ok = !ferror(input); //no read errors
+  fclose(input);
+  return ok;
+} //ReadFile
+
+/// \brief Write a whole file by way of a temporary file.
+///
+/// \param fname File name.
+/// \param s File contents.
+/// \return true if the file was written.
+
+static bool WriteFile(const std::string& fname, const std::string& s){
+  const std::string temp = TempName(fname); //temporary file name
+  COutput output; //output stream
+  if(!output.Open(temp, true))return false;
+
+  output.Write(s.data(), s.size());
+  output.Close();
+
+  return MoveIntoPlace(temp, fname, !output.Error());
+} //WriteFile
+
+/// \brief Draw a job to a string.
+///
+/// \param job Job descriptor.
+/// \param svg [out] SVG.
+
+static void DrawToString(const Job& job, std::string& svg){
+  svg.clear();
+  COutput output(svg); //output stream
+  DrawJob(output, job);
+} //DrawToString
+
+#pragma endregion helpers
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Train a compression dictionary.
+///
+/// The parameters are a job file as described in LoadJobs(), whose jobs
+/// are drawn as samples, and the name of the dictionary file to be
+/// written, optionally followed by `-zstd` to train a Zstandard dictionary
+/// instead of a zlib one and `-size bytes` for its maximum size (by default
+/// 32768 for zlib, which can't use any more, and 112640 for Zstandard).
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int TrainCommand(size_t argc, const char* const argv[]){
+  Codec codec = Codec::Deflate; //compression format
+  size_t size = 0; //dictionary size
+  bool ok = argc >= 2; //no errors so far
+
+  for(size_t i=2; ok && i<argc; i++){ //options
+    if(!strcmp(argv[i], "-zstd"))codec = Codec::Zstd;
+    else if(!strcmp(argv[i], "-size") && i + 1 < argc)
+      ok = (size = (size_t)strtoul(argv[++i], nullptr, 10)) > 0;
+    else ok = false;
+  } //for
+
+  if(!ok){
+    printf("Expected job file and dictionary file [-zstd] [-size bytes]\n");
+    return 1;
+  } //if
+
+  if(!Supported(codec)){
+    printf("This build does not support %s\n",
+      codec == Codec::Zstd? "Zstandard": "zlib");
+    return 1;
+  } //if
+
+  if(size == 0)size = codec == Codec::Zstd? 112640: 32768;
+  std::vector<Job> jobs; //job descriptors
+
+  if(!LoadJobs(argv[0], jobs)){
+    printf("Cannot load jobs from %s\n", argv[0]);
+    return 1;
+  } //if
+
+  CTimer timer; //stopwatch
+  std::vector<std::string> samples(jobs.size()); //sample SVG
+  std::string dict; //dictionary
+
+  for(size_t i=0; i<jobs.size(); i++)
+    DrawToString(jobs[i], samples[i]);
+
+  if(!TrainDictionary(codec, samples, size, dict)){
+    printf("Cannot train a dictionary from %zu samples\n", samples.size());
+    return 1;
+  } //if
+
+  if(!WriteFile(argv[1], dict)){
+    printf("Cannot write %s\n", argv[1]);
+    return 1;
+  } //if
+
+  printf("Trained a %zu byte %s dictionary from %zu samples in %0.3f s\n",
+    dict.size(), codec == Codec::Zstd? "Zstandard": "zlib", samples.size(),
+    timer.Elapsed());
+
+  return 0;
+} //TrainCommand
+
+/// \brief Render compressed illusions.
+///
+/// The parameter is a job file as described in LoadJobs(), optionally
+/// followed by `-dict file` for a dictionary made by TrainCommand(),
+/// `-zstd` for Zstandard, `-level l` for the compression level, and
+/// `-threads n` for the number of threads (default one per core). Each job
+/// is drawn to memory, compressed, and written to a file whose extension
+/// is given by CCompressor::Extension(): gzip (SVGZ) without a dictionary,
+/// or zlib with one, unless `-zstd` is given. The compression ratio and
+/// throughput are reported.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int CompressCommand(size_t argc, const char* const argv[]){
+  std::string dictfile; //dictionary file name
+  bool zstd = false; //use Zstandard
+  int level = 0; //compression level
+  size_t threads = 0; //number of threads
+  bool ok = argc > 0; //no errors so far
+
+  for(size_t i=1; ok && i<argc; i++){ //options
+    if(!strcmp(argv[i], "-dict") && i + 1 < argc)dictfile = argv[++i];
+    else if(!strcmp(argv[i], "-zstd"))zstd = true;
+    else if(!strcmp(argv[i], "-level") && i + 1 < argc)
+      ok = (level = atoi(argv[++i])) > 0;
+    else if(!strcmp(argv[i], "-threads") && i + 1 < argc)
+      ok = (threads = (size_t)strtoul(argv[++i], nullptr, 10)) > 0;
+    else ok = false;
+  } //for
+
+  if(!ok){
+    printf("Expected job file [-dict file] [-zstd] [-level l] [-threads n]\n");
+    return 1;
+  } //if
+
+  const Codec codec = zstd? Codec::Zstd:
+    dictfile.empty()? Codec::Gzip: Codec::Deflate; //compression format
+  std::string dict; //dictionary
+  std::vector<Job> jobs; //job descriptors
+
+  if(!Supported(codec)){
+    printf("This build does not support %s\n", zstd? "Zstandard": "zlib");
+    return 1;
+  } //if
+
+  if(!dictfile.empty() && !ReadFile(dictfile, dict)){
+    printf("Cannot read dictionary %s\n", dictfile.c_str());
+    return 1;
+  } //if
+
+  if(!LoadJobs(argv[0], jobs)){
+    printf("Cannot load jobs from %s\n", argv[0]);
+    return 1;
+  } //if
+
+  CTimer timer; //stopwatch
+  const CCompressor compressor(codec, dict, level); //compressor
+  CThreadPool pool(threads); //compression threads
+  std::atomic<size_t> raw(0), compressed(0), failed(0); //totals
+
+  for(const Job& job: jobs)
+    pool.Enqueue([&]{
+      std::string svg, out; //SVG and compressed SVG
+      DrawToString(job, svg);
+      const std::string fname = job.fname + compressor.Extension(); //file
+
+      if(compressor.Compress(svg, out) && WriteFile(fname, out)){
+        raw += svg.size();
+        compressed += out.size();
+      } //if
+
+      else{
+        printf("Cannot write %s\n", fname.c_str());
+        failed++;
+      } //else
+    });
+
+  pool.Wait();
+  const double t = timer.Elapsed(); //elapsed time
+
+  printf("Wrote %zu %s files in %0.3f s on %zu threads, %0.1f MB/s\n",
+    jobs.size() - failed, compressor.Name(), t, pool.Size(),
+    t > 0? raw/1048576.0/t: 0);
+  printf("%0.2f MB of SVG compressed to %0.2f MB, ratio %0.1f\n",
+    raw/1048576.0, compressed/1048576.0,
+    compressed > 0? (double)raw/compressed: 0);
+
+  return failed > 0? 1: 0;
+} //CompressCommand
+
+/// \brief Decompress a compressed SVG file.
+///
+/// The parameter is a file written by CompressCommand(), optionally
+/// followed by `-dict file` for the dictionary that it was compressed with.
+/// The format is recognized from the first bytes of the file, and the SVG
+/// is written to `stdout`. Errors are reported on `stderr`.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int DecompressCommand(size_t argc, const char* const argv[]){
+  std::string in, out, dict; //compressed, uncompressed, dictionary
+
+  if(!(argc == 1 || (argc == 3 && !strcmp(argv[1], "-dict")))){
+    printf("Expected compressed file [-dict file]\n");
+    return 1;
+  } //if
+
+  for(size_t i=0; i<argc; i+=2)
+    if(!ReadFile(argv[i], i == 0? in: dict)){
+      fprintf(stderr, "Cannot read %s\n", argv[i]);
+      return 1;
+    } //if
+
+  const unsigned char* p = (const unsigned char*)in.data(); //first bytes
+  Codec codec = Codec::Deflate; //compression format
+
+  if(in.size() >= 4 && p[0] == 0x28 && p[1] == 0xB5 && p[2] == 0x2F &&
+    p[3] == 0xFD)
+      codec = Codec::Zstd;
+  else if(in.size() >= 2 && p[0] == 0x1F && p[1] == 0x8B)
+    codec = Codec::Gzip;
+
+  const CCompressor compressor(codec, dict); //decompressor
+
+  if(!compressor.Decompress(in, out)){
+    fprintf(stderr, "Cannot decompress %s\n", argv[0]);
+    return 1;
+  } //if
+
+  fwrite(out.data(), 1, out.size(), stdout);
+  return 0;
+} //DecompressCommand
+
+/// \brief Benchmark compression.
+///
+/// The optional parameters are `-variants n` for the number of color
+/// variants to compress (default 5000, see MakeVariants()) and `-threads t`
+/// for the number of threads (default one per core). Every eleventh variant
+/// is used as a sample to train the dictionaries (eleventh rather than
+/// tenth so that all ten shapes are sampled), and the rest are drawn to
+/// memory and compressed and decompressed with each supported format. The
+/// compression ratio and the compression and decompression throughput in
+/// megabytes of SVG per second are reported for each, and each decompressed
+/// file is checked against the original.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchCompressCommand(size_t argc, const char* const argv[]){
+  size_t n = 5000; //number of variants
+  size_t threads = 0; //number of threads
+  bool ok = true; //no errors so far
+
+  for(size_t i=0; ok && i<argc; i++){ //options
+    if(!strcmp(argv[i], "-variants") && i + 1 < argc)
+      ok = (n = (size_t)strtoul(argv[++i], nullptr, 10)) >= 20;
+    else if(!strcmp(argv[i], "-threads") && i + 1 < argc)
+      ok = (threads = (size_t)strtoul(argv[++i], nullptr, 10)) > 0;
+    else ok = false;
+  } //for
+
+  if(!ok){
+    printf("Expected [-variants n] [-threads t] with n at least 20\n");
+    return 1;
+  } //if
+
+  if(!Supported(Codec::Gzip)){
+    printf("This build does not support zlib\n");
+    return 1;
+  } //if
+
+  std::vector<Job> jobs; //job descriptors
+  std::vector<std::string> samples, svg; //training and test SVG
+  MakeVariants(".", n, jobs);
+
+  for(size_t i=0; i<n; i++){
+    std::vector<std::string>& v = i%11 == 0? samples: svg; //where it goes
+    v.push_back(std::string());
+    DrawToString(jobs[i], v.back());
+  } //for
+
+  size_t raw = 0; //total size of test SVG
+  for(const std::string& s: svg)raw += s.size();
+
+  std::string zdict, sdict; //zlib and Zstandard dictionaries
+  TrainDictionary(Codec::Deflate, samples, 32768, zdict);
+  TrainDictionary(Codec::Zstd, samples, 112640, sdict);
+
+  std::vector<CCompressor*> codecs; //compressors to be benchmarked
+  codecs.push_back(new CCompressor(Codec::Gzip));
+  codecs.push_back(new CCompressor(Codec::Deflate, zdict));
+
+  if(Supported(Codec::Zstd)){
+    codecs.push_back(new CCompressor(Codec::Zstd));
+    codecs.push_back(new CCompressor(Codec::Zstd, sdict));
+  } //if
+
+  CThreadPool pool(threads); //compression threads
+  printf("%zu variants, %zu training samples, %zu test files, %0.2f MB\n",
+    n, samples.size(), svg.size(), raw/1048576.0);
+  printf("zlib dictionary %zu bytes, Zstandard dictionary %zu bytes\n",
+    zdict.size(), sdict.size());
+  printf("  %-10s %8s %12s %12s\n", "format", "ratio", "comp MB/s",
+    "decomp MB/s");
+
+  std::atomic<size_t> failed(0); //number of files that failed
+
+  for(const CCompressor* codec: codecs){
+    std::vector<std::string> packed(svg.size()); //compressed SVG
+    std::atomic<size_t> bytes(0); //total compressed size
+    const size_t chunk = 64; //files per task
+
+    CTimer timer; //stopwatch
+
+    for(size_t a=0; a<svg.size(); a+=chunk)
+      pool.Enqueue([&, a]{
+        for(size_t i=a; i<std::min(a + chunk, svg.size()); i++){
+          if(!codec->Compress(svg[i], packed[i]))failed++;
+          bytes += packed[i].size();
+        } //for
+      });
+
+    pool.Wait();
+    const double tComp = timer.Elapsed(); //compression time
+
+    timer.Start();
+
+    for(size_t a=0; a<svg.size(); a+=chunk)
+      pool.Enqueue([&, a]{
+        std::string out; //decompressed SVG
+
+        for(size_t i=a; i<std::min(a + chunk, svg.size()); i++)
+          if(!codec->Decompress(packed[i], out) || out != svg[i])failed++;
+      });
+
+    pool.Wait();
+    const double tDecomp = timer.Elapsed(); //decompression time
+
+    printf("  %-10s %8.1f %12.1f %12.1f\n", codec->Name(),
+      bytes > 0? (double)raw/bytes: 0, raw/1048576.0/tComp,
+      raw/1048576.0/tDecomp);
+
+    delete codec;
+  } //for
+
+  if(failed > 0)printf("%zu files failed to round trip\n", (size_t)failed);
+  return failed > 0? 1: 0;
+} //BenchCompressCommand
+
+#pragma endregion commands
@@ -0,0 +1,83 @@
+/// \file Compress.h
+
+/// \brief Interface for compressed output.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Compress_h__
+#define __Compress_h__
+
+#include <string>
+#include <vector>
+
+/// \brief Compression format.
+
+enum class Codec{
+  Gzip, ///< Gzip, as used by SVGZ files.
+  Deflate, ///< Zlib with a preset dictionary.
+  Zstd ///< Zstandard, with or without a dictionary.
+}; //Codec
+
+/// \brief Compressor.
+///
+/// Compresses and decompresses whole SVG files in memory in one of the
+/// formats in Codec, optionally with a dictionary. Small SVG files compress
+/// poorly on their own, because the compressor has to learn the structure
+/// of each one from scratch, but a dictionary built from a sample of
+/// similar files gives it a head start. Compress() and Decompress() may be
+/// called from several threads at once.
+///
+/// Zlib is used if `USE_ZLIB` is defined (as it is by the make file), and
+/// Zstandard if `USE_ZSTD` is defined (as it is by `make USE_ZSTD=1`).
+/// Otherwise the corresponding codecs fail.
+
+class CCompressor{
+  private:
+    Codec m_eCodec = Codec::Gzip; ///< Compression format.
+    std::string m_strDict; ///< Dictionary, empty for none.
+    int m_nLevel = 0; ///< Compression level, 0 for the default.
+    void* m_pCDict = nullptr; ///< Digested dictionary for compression.
+    void* m_pDDict = nullptr; ///< Digested dictionary for decompression.
+
+  public:
+    CCompressor(Codec codec, const std::string& dict="", int level=0); ///< Constructor.
+    CCompressor(const CCompressor&) = delete; ///< No copying.
+    ~CCompressor(); ///< Destructor.
+
+    bool Compress(const std::string& in, std::string& out) const; ///< Compress.
+    bool Decompress(const std::string& in, std::string& out) const; ///< Decompress.
+
+    const char* Name() const; ///< Name of format.
+    const char* Extension() const; ///< File name extension.
+}; //CCompressor
+
+bool Supported(Codec codec);
+bool TrainDictionary(Codec codec, const std::vector<std::string>& samples,
+  size_t size, std::string& dict);
+
+int TrainCommand(size_t argc, const char* const argv[]);
+int CompressCommand(size_t argc, const char* const argv[]);
+int DecompressCommand(size_t argc, const char* const argv[]);
+int BenchCompressCommand(size_t argc, const char* const argv[]);
+
+#endif //__Compress_h__
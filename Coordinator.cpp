@@ -0,0 +1,557 @@
+/// \file Coordinator.cpp
+
+/// \brief Code for the batch coordinator and its workers.
+///
+/// The coordinator splits the jobs in a job file into ranges of consecutive
+/// jobs and hands them out to worker processes that connect to it over a
+/// Unix domain socket. The protocol is line-based text:
+///
+///     worker: HELLO <pid>            coordinator: JOBS <job file>
+///     worker: NEXT [<a> <b>]         coordinator: RANGE <a> <b> | WAIT | DONE
+///     worker: FAIL <a> <b> <j>...    coordinator: RANGE <a> <b> | WAIT | DONE
+///
+/// A worker reports that it has finished jobs `a` to `b-1` by including them
+/// in its next `NEXT`. If any of them could not be rendered it sends `FAIL`
+/// instead, followed by the failed jobs. Those are handed out again, to
+/// any worker, until they have failed `MaxTries` times, after which the
+/// batch fails. If a worker's connection closes before it finishes
+/// its range, or it holds a range for longer than the lease time, the range
+/// is handed to another worker. Since each job writes its own file,
+/// rendering a job twice is harmless.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Coordinator.h"
+#include "Illusion.h"
+#include "Socket.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <utility>
+#include <thread>
+#include <vector>
+
+#ifndef _MSC_VER
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifndef _MSC_VER
+
+//////////////////////////////////////////////////////////////////////////
+// Worker.
+
+#pragma region worker
+
+/// \brief Run a worker.
+///
+/// Connect to the coordinator, load the job file that it names, and render
+/// the ranges of jobs that it hands out until it says that there are none
+/// left or hangs up.
+///
+/// \param path Socket path.
+/// \return 0 for success, 1 for failure.
+
+static int RunWorker(const char* path){
+  const int fd = Connect(path); //socket
+
+  if(fd < 0){
+    printf("Worker %d cannot connect to %s\n", (int)getpid(), path);
+    return 1;
+  } //if
+
+  std::string buffer; //text received but not yet used
+  std::string line; //line of text received
+  std::vector<Job> jobs; //job descriptors
+
+  SendLine(fd, "HELLO " + std::to_string(getpid()) + "\n");
+
+  if(!ReceiveLine(fd, buffer, line) || line.compare(0, 5, "JOBS ") ||
+    !LoadJobs(line.substr(5), jobs))
+  {
+    printf("Worker %d cannot load jobs\n", (int)getpid());
+    close(fd);
+    return 1;
+  } //if
+
+  std::string request = "NEXT\n"; //next request
+
+  while(SendLine(fd, request) && ReceiveLine(fd, buffer, line)){
+    size_t a = 0, b = 0; //range of jobs
+
+    if(sscanf(line.c_str(), "RANGE %zu %zu", &a, &b) == 2){
+      std::string failed; //jobs that could not be rendered
+
+      for(size_t i=a; i<b; i++)
+        if(i >= jobs.size() || !RenderJob(jobs[i])){
+          if(i < jobs.size())
+            printf("Cannot write %s.svg\n", jobs[i].fname.c_str());
+          fflush(stdout);
+          failed += " " + std::to_string(i);
+        } //if
+
+      request = (failed.empty()? "NEXT ": "FAIL ") + std::to_string(a) +
+        " " + std::to_string(b) + failed + "\n";
+    } //if
+
+    else if(line == "WAIT"){ //jobs in flight elsewhere may come back
+      usleep(10000);
+      request = "NEXT\n";
+    } //else if
+
+    else break; //done
+  } //while
+
+  close(fd);
+  return 0;
+} //RunWorker
+
+#pragma endregion worker
+
+//////////////////////////////////////////////////////////////////////////
+// Coordinator.
+
+#pragma region coordinator
+
+/// \brief Coordinator's record of a worker.
+
+struct Worker{
+  int fd = -1; ///< Socket file descriptor.
+  long pid = 0; ///< Process id reported by worker.
+  std::string buffer; ///< Text received but not yet used.
+  bool busy = false; ///< Has a range of jobs.
+  bool expired = false; ///< Range has been handed out again.
+  size_t a = 0; ///< First job in range.
+  size_t b = 0; ///< Job after last in range.
+  double start = 0; ///< Time range was handed out.
+  size_t jobs = 0; ///< Number of jobs finished.
+}; //Worker
+
+/// \brief Number of times a job is tried before the batch fails.
+
+static const size_t MaxTries = 3;
+
+/// \brief Coordinate a batch of jobs.
+///
+/// Hand out ranges of `chunk` jobs to the workers that connect to a
+/// socket, after starting `spawn` of them locally, until every job has
+/// been rendered or has failed `MaxTries` times.
+///
+/// \param jobs Job descriptors.
+/// \param jobfile Absolute path to the job file.
+/// \param path Socket path.
+/// \param chunk Number of jobs per range.
+/// \param lease Lease time in seconds.
+/// \param spawn Number of workers to start.
+/// \param t [out] Elapsed time in seconds.
+/// \param finished [out] Workers that connected, for the report.
+/// \param failures [out] Jobs that failed.
+/// \return true if the coordinator could listen on the socket.
+
+static bool Coordinate(const std::vector<Job>& jobs, const char* jobfile,
+  const char* path, size_t chunk, double lease, size_t spawn, double& t,
+  std::vector<Worker>& finished, std::vector<size_t>& failures)
+{
+  const int listener = Listen(path); //listening socket
+
+  if(listener < 0)
+    return false;
+
+  const size_t n = jobs.size(); //number of jobs
+  std::deque<std::pair<size_t, size_t>> pending; //ranges not handed out
+
+  for(size_t a=0; a<n; a+=chunk)
+    pending.push_back(std::make_pair(a, std::min(a + chunk, n)));
+
+  std::vector<pid_t> children; //workers started here
+
+  for(size_t i=0; i<spawn; i++){
+    const pid_t pid = fork();
+
+    if(pid == 0){ //child
+      close(listener);
+      _exit(RunWorker(path));
+    } //if
+
+    if(pid > 0)children.push_back(pid);
+  } //for
+
+  CTimer timer; //stopwatch
+  std::vector<bool> done(n, false); //which jobs are finished
+  std::vector<bool> failed(n, false); //which jobs have failed for good
+  std::vector<size_t> tries(n, 0); //number of failed attempts per job
+  size_t ndone = 0; //number of jobs finished
+  size_t nfailed = 0; //number of jobs failed for good
+  std::vector<Worker> workers; //connected workers
+
+  while(ndone + nfailed < n){
+    std::vector<pollfd> fds(1 + workers.size()); //descriptors to poll
+    fds[0].fd = listener;
+    fds[0].events = POLLIN;
+
+    for(size_t i=0; i<workers.size(); i++){
+      fds[i + 1].fd = workers[i].fd;
+      fds[i + 1].events = POLLIN;
+    } //for
+
+    poll(fds.data(), fds.size(), 100);
+    const double now = timer.Elapsed(); //current time
+
+    for(size_t i=workers.size(); i-- > 0;){ //for each worker, backwards
+      Worker& w = workers[i];
+      bool alive = true; //connection is open
+
+      if(fds[i + 1].revents){ //something to read
+        char s[4096]; //received bytes
+        const ssize_t k = recv(w.fd, s, sizeof(s), 0);
+        if(k <= 0)alive = false;
+        else w.buffer.append(s, k);
+      } //if
+
+      std::string line; //line of text received
+
+      while(alive && TakeLine(w.buffer, line)){
+        size_t a = 0, b = 0; //range finished
+        int used = 0; //characters of line parsed
+
+        if(!line.compare(0, 6, "HELLO ")){
+          w.pid = atol(line.c_str() + 6);
+          alive = SendLine(w.fd, "JOBS " + std::string(jobfile) + "\n");
+          continue;
+        } //if
+
+        if((!line.compare(0, 5, "NEXT ") || !line.compare(0, 5, "FAIL ")) &&
+          w.busy && sscanf(line.c_str() + 5, "%zu %zu%n", &a, &b, &used) == 2
+          && a == w.a && b == w.b)
+        { //range finished
+          std::vector<size_t> bad; //jobs in range that failed
+          const char* p = line.c_str() + 5 + used; //failed job list
+
+          for(char* q=nullptr; *p; p=q){
+            const size_t j = (size_t)strtoull(p, &q, 10); //failed job
+            if(q == p)break;
+            if(j >= a && j < b)bad.push_back(j);
+          } //for
+
+          for(size_t j=a; j<b; j++){
+            if(done[j])continue;
+
+            if(std::find(bad.begin(), bad.end(), j) == bad.end()){ //rendered
+              if(failed[j]){ //a late success after failing for good
+                failed[j] = false;
+                nfailed--;
+              } //if
+
+              done[j] = true;
+              ndone++;
+              w.jobs++;
+            } //if
+
+            else if(!failed[j] && ++tries[j] < MaxTries){ //try again
+              printf("Job %zu failed on worker %ld, reassigning it\n", j,
+                w.pid);
+              pending.push_back(std::make_pair(j, j + 1));
+            } //else if
+
+            else if(!failed[j]){ //give up
+              printf("Job %zu failed %zu times\n", j, tries[j]);
+              failed[j] = true;
+              nfailed++;
+            } //else if
+          } //for
+
+          w.busy = false;
+        } //if
+
+        while(!pending.empty()){ //skip ranges finished in the meantime
+          const std::pair<size_t, size_t>& r = pending.front();
+          size_t j = r.first;
+          while(j < r.second && (done[j] || failed[j]))j++;
+          if(j < r.second)break;
+          pending.pop_front();
+        } //while
+
+        if(ndone + nfailed == n)alive = SendLine(w.fd, "DONE\n");
+
+        else if(pending.empty())alive = SendLine(w.fd, "WAIT\n");
+
+        else{ //hand out a range
+          w.a = pending.front().first;
+          w.b = pending.front().second;
+          w.busy = true;
+          w.expired = false;
+          w.start = now;
+          pending.pop_front();
+          alive = SendLine(w.fd, "RANGE " + std::to_string(w.a) + " " +
+            std::to_string(w.b) + "\n");
+        } //else
+      } //while
+
+      if(alive && w.busy && !w.expired && now - w.start > lease){
+        printf("Worker %ld lease expired, reassigning jobs %zu to %zu\n",
+          w.pid, w.a, w.b - 1);
+        pending.push_front(std::make_pair(w.a, w.b));
+        w.expired = true;
+      } //if
+
+      if(!alive){ //worker hung up or died
+        if(w.busy && !w.expired){
+          printf("Worker %ld lost, reassigning jobs %zu to %zu\n", w.pid,
+            w.a, w.b - 1);
+          pending.push_front(std::make_pair(w.a, w.b));
+        } //if
+
+        close(w.fd);
+        finished.push_back(w);
+        workers.erase(workers.begin() + i);
+      } //if
+    } //for
+
+    if(fds[0].revents & POLLIN){ //new worker
+      Worker w;
+      w.fd = accept(listener, nullptr, nullptr);
+      if(w.fd >= 0)workers.push_back(w);
+    } //if
+  } //while
+
+  t = timer.Elapsed();
+
+  for(Worker& w: workers){ //tell the rest we're done
+    SendLine(w.fd, "DONE\n");
+    close(w.fd);
+    finished.push_back(w);
+  } //for
+
+  close(listener);
+  unlink(path);
+
+  for(pid_t pid: children)
+    waitpid(pid, nullptr, 0);
+
+  for(size_t j=0; j<n; j++)
+    if(failed[j])failures.push_back(j);
+
+  return true;
+} //Coordinate
+
+#pragma endregion coordinator
+
+#endif //_MSC_VER
+
+/// \brief Coordinate a batch of jobs.
+///
+/// The parameters are a job file as described in LoadJobs() and a socket
+/// path, optionally followed by `-chunk c` to hand out `c` jobs at a time
+/// (default 16), `-lease s` to hand out a range again if it is not
+/// finished after `s` seconds (default 600), and `-spawn w` to start
+/// `w` local workers. More workers can be started at any time with
+/// WorkerCommand(). The number of jobs per second, overall and per worker,
+/// is reported at the end.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int CoordinatorCommand(size_t argc, const char* const argv[]){
+#ifdef _MSC_VER //Visual Studio
+  printf("The coordinator is not supported under Windows\n");
+  return 1;
+#else
+  size_t chunk = 16; //jobs per range
+  size_t spawn = 0; //number of workers to start
+  double lease = 600; //lease time in seconds
+  bool ok = argc >= 2; //no errors so far
+
+  for(size_t i=2; ok && i+1<argc; i+=2){ //options
+    if(!strcmp(argv[i], "-chunk"))chunk = (size_t)strtoul(argv[i + 1], 0, 10);
+    else if(!strcmp(argv[i], "-spawn"))spawn = (size_t)strtoul(argv[i + 1], 0, 10);
+    else if(!strcmp(argv[i], "-lease"))lease = atof(argv[i + 1]);
+    else ok = false;
+  } //for
+
+  if(!ok || argc%2 || chunk == 0){
+    printf("Expected job file, socket [-chunk c] [-lease s] [-spawn w]\n");
+    return 1;
+  } //if
+
+  std::vector<Job> jobs; //job descriptors
+  char jobfile[PATH_MAX]; //absolute path to job file
+
+  if(!LoadJobs(argv[0], jobs) || realpath(argv[0], jobfile) == nullptr){
+    printf("Cannot load jobs from %s\n", argv[0]);
+    return 1;
+  } //if
+
+  const char* path = argv[1]; //socket path
+  const size_t n = jobs.size(); //number of jobs
+
+  printf("Coordinating %zu jobs in %zu ranges on %s\n", n,
+    (n + chunk - 1)/chunk, path);
+  fflush(stdout);
+
+  double t = 0; //elapsed time
+  std::vector<Worker> finished; //workers, for the report
+  std::vector<size_t> failures; //jobs that failed
+
+  if(!Coordinate(jobs, jobfile, path, chunk, lease, spawn, t, finished,
+    failures))
+  {
+    printf("Cannot listen on %s\n", path);
+    return 1;
+  } //if
+
+  printf("Rendered %zu jobs in %0.3f s, %0.1f jobs/s\n", n - failures.size(),
+    t, t > 0? (n - failures.size())/t: 0);
+
+  for(const Worker& w: finished)
+    if(w.pid != 0)
+      printf("  worker %ld: %zu jobs, %0.1f jobs/s\n", w.pid, w.jobs,
+        t > 0? w.jobs/t: 0);
+
+  if(!failures.empty()){
+    printf("%zu jobs failed:", failures.size());
+    for(size_t j: failures)printf(" %s", jobs[j].fname.c_str());
+    printf("\n");
+    return 1;
+  } //if
+
+  return 0;
+#endif
+} //CoordinatorCommand
+
+/// \brief Run a worker for a coordinator.
+///
+/// The parameter is the coordinator's socket path. Workers can be started
+/// on the same machine at any time while the coordinator is running.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int WorkerCommand(size_t argc, const char* const argv[]){
+#ifdef _MSC_VER //Visual Studio
+  printf("Workers are not supported under Windows\n");
+  return 1;
+#else
+  if(argc != 1){
+    printf("Expected socket path\n");
+    return 1;
+  } //if
+
+  return RunWorker(argv[0]);
+#endif
+} //WorkerCommand
+
+/// \brief Measure how the coordinator scales with the number of workers.
+///
+/// The parameter is a job file as described in LoadJobs(), optionally
+/// followed by `-max w` for the largest number of workers (default one per
+/// core) and `-chunk c` for the number of jobs per range (default 16).
+/// The whole job file is rendered with 1, 2, 4, and so on up to `w` local
+/// workers, and the aggregate number of jobs per second is reported for
+/// each, along with the speedup over one worker. The jobs are rendered
+/// once beforehand so that every run overwrites files that already exist.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchWorkersCommand(size_t argc, const char* const argv[]){
+#ifdef _MSC_VER //Visual Studio
+  printf("The coordinator is not supported under Windows\n");
+  return 1;
+#else
+  size_t chunk = 16; //jobs per range
+  size_t most = std::thread::hardware_concurrency(); //most workers
+  bool ok = argc%2 == 1; //no errors so far
+
+  for(size_t i=1; ok && i+1<argc; i+=2){ //options
+    if(!strcmp(argv[i], "-chunk"))chunk = (size_t)strtoul(argv[i + 1], 0, 10);
+    else if(!strcmp(argv[i], "-max"))most = (size_t)strtoul(argv[i + 1], 0, 10);
+    else ok = false;
+  } //for
+
+  if(!ok || chunk == 0){
+    printf("Expected job file [-max w] [-chunk c]\n");
+    return 1;
+  } //if
+
+  std::vector<Job> jobs; //job descriptors
+  char jobfile[PATH_MAX]; //absolute path to job file
+
+  if(!LoadJobs(argv[0], jobs) || realpath(argv[0], jobfile) == nullptr){
+    printf("Cannot load jobs from %s\n", argv[0]);
+    return 1;
+  } //if
+
+  const std::string path = "bench-workers-" + std::to_string(getpid()) +
+    ".sock"; //socket path
+  const size_t n = jobs.size(); //number of jobs
+  double t1 = 0; //time for one worker
+
+  for(const Job& job: jobs) //warm up
+    if(!RenderJob(job)){
+      printf("Cannot write %s.svg\n", job.fname.c_str());
+      return 1;
+    } //if
+
+  printf("%zu jobs, %zu per range\n", n, chunk);
+  printf("workers      time     jobs/s  speedup\n");
+  fflush(stdout);
+
+  for(size_t w=1; w<=std::max<size_t>(most, 1); w*=2){
+    double t = 0; //elapsed time
+    std::vector<Worker> finished; //workers, unused
+    std::vector<size_t> failures; //jobs that failed
+
+    if(!Coordinate(jobs, jobfile, path.c_str(), chunk, 600, w, t, finished,
+      failures))
+    {
+      printf("Cannot listen on %s\n", path.c_str());
+      return 1;
+    } //if
+
+    if(!failures.empty()){
+      printf("%zu jobs failed\n", failures.size());
+      return 1;
+    } //if
+
+    if(w == 1)t1 = t;
+    printf("%7zu %8.3f s %10.1f %7.2fx\n", w, t, t > 0? n/t: 0,
+      t > 0? t1/t: 0);
+    fflush(stdout);
+  } //for
+
+  return 0;
+#endif
+} //BenchWorkersCommand
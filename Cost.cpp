@@ -0,0 +1,635 @@
+/// \file Cost.cpp
+
+/// \brief Code for the cost model and batch planning.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Cost.h"
+#include "Huge.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <queue>
+
+//////////////////////////////////////////////////////////////////////////
+// Cost model.
+
+#pragma region model
+
+/// \brief Count the elements in a job.
+///
+/// Illusion 1 has SquareCount() squares in each of its `n` circles, and
+/// illusion 2 has two calls to TripleCircle(), each of which makes three
+/// rings of 72 ellipses (half of them blank), whatever `n` is.
+///
+/// \param job Job descriptor.
+/// \return Number of elements drawn.
+
+size_t JobElements(const Job& job){
+  if(job.kind == 2)
+    return 2*3*2*36;
+
+  size_t count = 0; //result
+
+  for(size_t i=0; i<job.n; i++){
+    const size_t sw = (size_t)job.p[2]; //square width
+
+    if(job.geometry == Geometry::Huge)
+      count += HugeSquareCount(job.p[0] + i*job.p[1], sw);
+    else count += SquareCount((float)job.p[0] + i*(float)job.p[1], sw);
+  } //for
+
+  return count;
+} //JobElements
+
+/// \brief Time drawing a job.
+///
+/// Draw a job to an output stream that only counts bytes, several times,
+/// and take the fastest time.
+///
+/// \param job Job descriptor.
+/// \param bytes [out] Size of SVG in bytes.
+/// \return Time to draw in seconds.
+
+static double TimeJob(const Job& job, size_t& bytes){
+  double best = 0; //fastest time
+
+  for(int k=0; k<3; k++){
+    CTimer timer; //stopwatch
+    COutput output; //output stream that only counts bytes
+    DrawJob(output, job);
+    const double t = timer.Elapsed(); //time taken
+
+    if(k == 0 || t < best)best = t;
+    bytes = output.Size();
+  } //for
+
+  return best;
+} //TimeJob
+
+/// \brief Fit a straight line.
+///
+/// Least squares fit of `y = c[0] + c[1]x`. With fewer than two distinct
+/// `x` values, or if the fitted `c[0]` is negative, the line goes through
+/// the origin and the mean instead.
+///
+/// \param x X values.
+/// \param y Y values.
+/// \param c [out] Coefficients.
+
+static void FitLine(const std::vector<double>& x, const std::vector<double>& y,
+  double c[2])
+{
+  const double n = (double)x.size(); //number of points
+  double sx = 0, sy = 0, sxx = 0, sxy = 0; //sums
+
+  for(size_t i=0; i<x.size(); i++){
+    sx += x[i]; sy += y[i];
+    sxx += x[i]*x[i]; sxy += x[i]*y[i];
+  } //for
+
+  const double d = n*sxx - sx*sx; //determinant
+
+  if(d > 1e-9*n*sxx){ //distinct x values
+    c[1] = (n*sxy - sx*sy)/d;
+    c[0] = (sy - c[1]*sx)/n;
+  } //if
+
+  if(d <= 1e-9*n*sxx || c[0] < 0){
+    c[0] = 0;
+    c[1] = sx > 0? sy/sx: 0;
+  } //else
+} //FitLine
+
+/// \brief Cost model variant.
+///
+/// \param kind Which optical illusion, 1 or 2.
+/// \param geometry Geometry used to place elements.
+/// \param flat True if the transform is on the element.
+/// \return Index of the variant's coefficients.
+
+static size_t Variant(size_t kind, Geometry geometry, bool flat){
+  return ((kind == 2? 3: 0) + (size_t)geometry)*2 + (flat? 1: 0);
+} //Variant
+
+/// \brief Name of a geometry.
+///
+/// \param geometry Geometry used to place elements.
+/// \return Name used in job files, or "float".
+
+static const char* GeometryName(Geometry geometry){
+  switch(geometry){
+    case Geometry::Fixed: return "fixed";
+    case Geometry::Huge: return "huge";
+    default: return "float";
+  } //switch
+} //GeometryName
+
+/// Start with rough coefficients, to be replaced by Calibrate().
+
+CCostModel::CCostModel(){
+  for(size_t v=0; v<VARIANTS; v++){
+    m_fBytes[v][0] = 500; m_fBytes[v][1] = 120;
+    m_fSeconds[v][0] = 1e-5; m_fSeconds[v][1] = 1e-6;
+    m_bCalibrated[v] = false;
+  } //for
+} //constructor
+
+/// Time a few calibration jobs of different sizes for each variant and fit
+/// the coefficients to the results. Each variant takes a few milliseconds,
+/// so if a list of jobs is given, only the variants that those jobs use are
+/// calibrated. Only drawing is timed, not writing to disk.
+/// \param jobs Job descriptors, or `nullptr` to calibrate every variant.
+
+void CCostModel::Calibrate(const std::vector<Job>* jobs){
+  bool used[VARIANTS]; //whether each variant is to be calibrated
+
+  for(size_t v=0; v<VARIANTS; v++)
+    used[v] = jobs == nullptr;
+
+  if(jobs != nullptr)
+    for(const Job& j: *jobs)
+      used[Variant(j.kind, j.geometry, j.flat)] = true;
+
+  Job job; //calibration job
+  job.fname = "calibration";
+  job.dark = "black"; job.light = "white"; job.bgclr = "gray";
+
+  for(size_t v=0; v<VARIANTS; v++){
+    if(!used[v])continue;
+
+    std::vector<double> x, bytes, seconds; //measurements
+    job.kind = v < VARIANTS/2? 1: 2;
+    job.geometry = (Geometry)(v/2%3);
+    job.flat = (v & 1) != 0;
+
+    for(size_t n=2; n<=32; n*=4){ //number of circles
+      job.w = 4000;
+      job.n = n;
+
+      if(job.kind == 1){
+        job.p[0] = 100; job.p[1] = 40; job.p[2] = 24;
+      } //if
+
+      else{
+        job.p[0] = 300; job.p[1] = 12; job.p[2] = 6;
+      } //else
+
+      size_t size = 0; //bytes drawn
+      const double t = TimeJob(job, size); //time taken
+
+      x.push_back((double)JobElements(job));
+      bytes.push_back((double)size);
+      seconds.push_back(t);
+    } //for
+
+    FitLine(x, bytes, m_fBytes[v]);
+    FitLine(x, seconds, m_fSeconds[v]);
+    m_bCalibrated[v] = true;
+  } //for
+} //Calibrate
+
+/// \param job Job descriptor.
+/// \return Predicted cost of job.
+
+Estimate CCostModel::Predict(const Job& job) const{
+  Estimate e; //result
+  const size_t v = Variant(job.kind, job.geometry, job.flat); //variant
+
+  e.elements = JobElements(job);
+  e.bytes = m_fBytes[v][0] + m_fBytes[v][1]*e.elements;
+  e.seconds = m_fSeconds[v][0] + m_fSeconds[v][1]*e.elements;
+
+  return e;
+} //Predict
+
+/// Print the coefficients of the calibrated variants to `stdout`.
+
+void CCostModel::Print() const{
+  for(size_t v=0; v<VARIANTS; v++)
+    if(m_bCalibrated[v])
+      printf("  illusion %d %-5s %-7s %6.0f + %6.2f bytes/element, "
+        "%5.1f us + %5.1f ns/element\n", v < VARIANTS/2? 1: 2,
+        GeometryName((Geometry)(v/2%3)), (v & 1)? "flat": "grouped",
+        m_fBytes[v][0], m_fBytes[v][1], 1e6*m_fSeconds[v][0],
+        1e9*m_fSeconds[v][1]);
+} //Print
+
+#pragma endregion model
+
+//////////////////////////////////////////////////////////////////////////
+// Batch planning.
+
+#pragma region planning
+
+/// \brief Plan a batch.
+///
+/// Make a list of pieces of work for a thread pool. A job whose predicted
+/// time is more than its share of the total, that is, the total predicted
+/// time divided by the number of threads, can be split into pieces no
+/// bigger than that share, so that a few giant jobs can't hold up the end
+/// of the batch. The pieces can be put in order of predicted time, longest
+/// first (LPT), which is the classic heuristic for minimizing the makespan
+/// when a pool of threads takes pieces in order.
+///
+/// \param jobs Job descriptors.
+/// \param todo Indices of jobs to be rendered.
+/// \param model Cost model.
+/// \param threads Number of threads.
+/// \param lpt True to put the longest pieces first.
+/// \param split True to split oversized jobs.
+/// \param plan [out] Pieces of work in the order they should be started.
+
+void PlanBatch(const std::vector<Job>& jobs, const std::vector<size_t>& todo,
+  const CCostModel& model, size_t threads, bool lpt, bool split,
+  std::vector<Piece>& plan)
+{
+  std::vector<Estimate> estimate(todo.size()); //predicted costs
+  double total = 0; //total predicted time
+
+  for(size_t i=0; i<todo.size(); i++){
+    estimate[i] = model.Predict(jobs[todo[i]]);
+    total += estimate[i].seconds;
+  } //for
+
+  const double share = total/std::max<size_t>(threads, 1); //time per thread
+  plan.clear();
+
+  for(size_t i=0; i<todo.size(); i++){
+    const Estimate& e = estimate[i]; //predicted cost of job
+    size_t parts = 1; //number of pieces
+
+    if(split && threads > 1 && e.seconds > share && e.elements > 1){
+      parts = (size_t)ceil(e.seconds/share);
+      parts = std::min(parts, std::min(threads, e.elements));
+    } //if
+
+    for(size_t k=0; k<parts; k++){
+      Piece piece;
+      piece.job = todo[i];
+      piece.a = e.elements*k/parts;
+      piece.b = e.elements*(k + 1)/parts;
+      piece.part = k;
+      piece.parts = parts;
+      piece.seconds = e.seconds/parts;
+      piece.bytes = e.bytes/parts;
+      plan.push_back(piece);
+    } //for
+  } //for
+
+  if(lpt)
+    std::stable_sort(plan.begin(), plan.end(),
+      [](const Piece& a, const Piece& b){return a.seconds > b.seconds;});
+} //PlanBatch
+
+/// \brief Makespan of a list schedule.
+///
+/// Compute the time taken by a pool of threads that take pieces of work
+/// in order, each thread taking the next piece as soon as it is free.
+///
+/// \param seconds Time taken by each piece, in the order they are taken.
+/// \param threads Number of threads.
+/// \return Time until the last thread finishes.
+
+double Makespan(const std::vector<double>& seconds, size_t threads){
+  std::priority_queue<double, std::vector<double>, std::greater<double>>
+    free; //time at which each thread is free
+
+  for(size_t i=0; i<std::max<size_t>(threads, 1); i++)
+    free.push(0);
+
+  double makespan = 0; //result
+
+  for(double t: seconds){
+    const double finish = free.top() + t; //when this piece finishes
+    free.pop();
+    free.push(finish);
+    makespan = std::max(makespan, finish);
+  } //for
+
+  return makespan;
+} //Makespan
+
+/// \brief Write the pieces of a split job.
+///
+/// Write SVG that has been drawn to memory in one or more pieces to the
+/// job's SVG file, by way of a temporary file.
+///
+/// \param job Job descriptor.
+/// \param parts SVG of each piece, in order.
+/// \param digest [out] Digest of SVG file.
+/// \param sha256 True to put the SHA-256 of the SVG file in the digest too.
+/// \return true if the SVG file was written.
+
+bool WriteParts(const Job& job, const std::vector<std::string>& parts,
+  Digest& digest, bool sha256)
+{
+  const std::string fname = job.fname + ".svg"; //file name
+  const std::string temp = TempName(fname); //temporary file name
+  CXXHash64 hash; //streaming hash
+  CSha256 sha; //streaming SHA-256
+  COutput output; //output stream
+
+  if(!output.Open(temp, true))
+    return false;
+
+  output.SetHash(&hash, sha256? &sha: nullptr);
+
+  for(const std::string& s: parts)
+    output.Write(s.data(), s.size());
+
+  output.Close();
+
+  if(!MoveIntoPlace(temp, fname, !output.Error()))
+    return false;
+
+  digest.size = output.Size();
+  digest.hash = hash.Digest();
+  if(sha256)digest.sha256 = sha.Digest();
+  return true;
+} //WriteParts
+
+/// \brief Run a batch plan.
+///
+/// Render the pieces of a plan made by PlanBatch() on a thread pool, in
+/// order. A job that has not been split is rendered with RenderJob(). The
+/// pieces of a split job are drawn to memory, reserved ahead from the
+/// predicted size so that the string is not grown again and again while
+/// drawing, and the last one to finish writes them all to the SVG file.
+/// The caller is notified of each SVG file written from the thread that
+/// wrote it.
+///
+/// \param jobs Job descriptors.
+/// \param plan Pieces of work.
+/// \param pool Thread pool.
+/// \param done Function called with the job index and digest of each SVG
+/// file written, which must be thread safe.
+/// \param seconds [out] Pointer to time taken by each piece, or `nullptr`.
+/// \param sha256 True to put the SHA-256 of each SVG file in its digest.
+/// \return Number of jobs that could not be written.
+
+size_t RunPlan(const std::vector<Job>& jobs, const std::vector<Piece>& plan,
+  CThreadPool& pool, const std::function<void(size_t, const Digest&)>& done,
+  std::vector<double>* seconds, bool sha256)
+{
+  /// \brief Pieces of a split job.
+
+  struct Parts{
+    std::vector<std::string> svg; ///< SVG of each piece.
+    std::atomic<size_t> left; ///< Number of pieces not yet drawn.
+  }; //Parts
+
+  std::vector<std::shared_ptr<Parts>> parts(jobs.size()); //split jobs
+  std::atomic<size_t> failed(0); //number of jobs that failed
+  if(seconds != nullptr)seconds->assign(plan.size(), 0);
+
+  for(const Piece& piece: plan)
+    if(piece.parts > 1 && !parts[piece.job]){
+      parts[piece.job] = std::make_shared<Parts>();
+      parts[piece.job]->svg.resize(piece.parts);
+      parts[piece.job]->left = piece.parts;
+    } //if
+
+  for(size_t k=0; k<plan.size(); k++)
+    pool.Enqueue([&, k]{
+      CTimer timer; //stopwatch
+      const Piece& piece = plan[k]; //piece of work
+      const Job& job = jobs[piece.job]; //job descriptor
+      Digest digest; //digest of SVG file
+      bool ok = true; //SVG file written, if it was this piece's turn
+
+      if(piece.parts == 1){
+        ok = RenderJob(job, &digest, nullptr, sha256);
+        if(ok)done(piece.job, digest);
+      } //if
+
+      else{
+        Parts& p = *parts[piece.job]; //pieces of job
+        Illusion illusion; //illusion descriptor
+        Describe(illusion, job);
+        p.svg[piece.part].reserve((size_t)(1.125*piece.bytes) + 4096);
+        COutput output(p.svg[piece.part]); //output stream
+
+        if(piece.part == 0){
+          DrawHeader(output, job.w, job.w);
+          DrawStyle(output, illusion);
+        } //if
+
+        DrawElements(output, illusion, piece.a, piece.b);
+
+        if(piece.part + 1 == piece.parts)CloseSVG(output);
+        else output.Close();
+
+        if(--p.left == 0){ //last piece drawn
+          ok = WriteParts(job, p.svg, digest, sha256);
+          p.svg.clear();
+          if(ok)done(piece.job, digest);
+        } //if
+      } //else
+
+      if(!ok){
+        printf("Cannot write %s.svg\n", job.fname.c_str());
+        failed++;
+      } //if
+
+      if(seconds != nullptr)(*seconds)[k] = timer.Elapsed();
+    });
+
+  pool.Wait();
+  return failed;
+} //RunPlan
+
+#pragma endregion planning
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Predict the cost of the jobs in a job file.
+///
+/// The parameter is a job file as described in LoadJobs(), optionally
+/// followed by `-check` to draw each job (without writing it) and compare
+/// the predictions with the actual size and time. The cost model is
+/// calibrated first and its coefficients are reported.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int CostCommand(size_t argc, const char* const argv[]){
+  const bool check = argc == 2 && !strcmp(argv[1], "-check"); //check predictions
+  std::vector<Job> jobs; //job descriptors
+
+  if(argc < 1 || argc > 2 || (argc == 2 && !check)){
+    printf("Expected job file [-check]\n");
+    return 1;
+  } //if
+
+  if(!LoadJobs(argv[0], jobs)){
+    printf("Cannot load jobs from %s\n", argv[0]);
+    return 1;
+  } //if
+
+  CTimer timer; //stopwatch
+  CCostModel model; //cost model
+  model.Calibrate(&jobs);
+  printf("Calibrated in %0.3f s\n", timer.Elapsed());
+  model.Print();
+
+  double elements = 0, bytes = 0, seconds = 0; //predicted totals
+  double actualBytes = 0, actualSeconds = 0; //actual totals
+  double errBytes = 0, errSeconds = 0; //total relative errors
+  size_t largest = 0; //index of largest job
+  double most = 0; //predicted time of largest job
+
+  for(size_t i=0; i<jobs.size(); i++){
+    const Estimate e = model.Predict(jobs[i]); //prediction
+    elements += e.elements;
+    bytes += e.bytes;
+    seconds += e.seconds;
+
+    if(e.seconds > most){
+      largest = i;
+      most = e.seconds;
+    } //if
+
+    if(check){
+      size_t size = 0; //actual bytes
+      const double t = TimeJob(jobs[i], size); //actual time
+      actualBytes += size;
+      actualSeconds += t;
+      errBytes += fabs(e.bytes - size)/size;
+      errSeconds += fabs(e.seconds - t)/t;
+    } //if
+  } //for
+
+  printf("%zu jobs, %0.0f elements\n", jobs.size(), elements);
+  printf("  predicted %0.0f bytes, %0.3f s\n", bytes, seconds);
+
+  if(check && !jobs.empty()){
+    printf("  actual    %0.0f bytes, %0.3f s\n", actualBytes, actualSeconds);
+    printf("  mean error per job %0.1f%% bytes, %0.1f%% time\n",
+      100*errBytes/jobs.size(), 100*errSeconds/jobs.size());
+  } //if
+
+  if(!jobs.empty())
+    printf("  largest job %s.svg, %0.1f%% of predicted time\n",
+      jobs[largest].fname.c_str(), 100*most/seconds);
+
+  return 0;
+} //CostCommand
+
+/// \brief Benchmark batch planning on a skewed job mix.
+///
+/// The parameter is a directory for the output files, optionally followed
+/// by `-threads n` to set the number of threads (default 4). The job mix is
+/// 96 small jobs followed by 3 giant ones, which is the worst case for a
+/// batch rendered in file order. It is rendered three times: in file
+/// order, in LPT order, and in LPT order with oversized jobs split. For
+/// each, three makespans are reported. The predicted makespan comes from
+/// the cost model. The replayed makespan comes from timing each piece on
+/// its own and scheduling the measured times on the threads, which shows
+/// the effect of the plan independently of the number of cores. The wall
+/// time is that of actually rendering on the threads.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchLptCommand(size_t argc, const char* const argv[]){
+  size_t threads = 4; //number of threads
+
+  if(argc == 3 && !strcmp(argv[1], "-threads"))
+    threads = std::max<size_t>(1, (size_t)strtoul(argv[2], nullptr, 10));
+
+  else if(argc != 1){
+    printf("Expected directory [-threads n]\n");
+    return 1;
+  } //if
+
+  const std::string dir = argv[0]; //output directory
+  std::vector<Job> jobs; //job descriptors
+  std::vector<size_t> todo; //indices of jobs
+
+  Job job; //job descriptor
+  job.kind = 1;
+  job.dark = "black"; job.light = "white"; job.bgclr = "gray";
+
+  for(size_t i=0; i<99; i++){
+    const bool giant = i >= 96; //giant job
+
+    job.fname = dir + (giant? "/giant": "/small") + std::to_string(i);
+    job.w = giant? 16000: 800;
+    job.n = giant? 150: 4;
+    job.p[0] = 100; job.p[1] = giant? 52.0f: 72.0f; job.p[2] = 24;
+
+    jobs.push_back(job);
+    todo.push_back(i);
+  } //for
+
+  CCostModel model; //cost model
+  model.Calibrate(&jobs);
+
+  CThreadPool serial(1); //pool for timing pieces one at a time
+  CThreadPool pool(threads); //pool for rendering
+  size_t failed = 0; //number of jobs that failed
+  const auto ignore = [](size_t, const Digest&){}; //nothing to do when done
+
+  printf("96 small jobs then 3 giant jobs, %zu threads\n", threads);
+  printf("  %-12s %10s %10s %10s\n", "plan", "predicted", "replayed", "wall");
+
+  for(int mode=0; mode<3; mode++){
+    const bool lpt = mode > 0; //longest first
+    const bool split = mode > 1; //split oversized jobs
+    std::vector<Piece> plan; //pieces of work
+    std::vector<double> predicted, measured; //piece times
+
+    PlanBatch(jobs, todo, model, threads, lpt, split, plan);
+
+    for(const Piece& piece: plan)
+      predicted.push_back(piece.seconds);
+
+    failed += RunPlan(jobs, plan, serial, ignore, &measured);
+
+    CTimer timer; //stopwatch
+    failed += RunPlan(jobs, plan, pool, ignore);
+    const double wall = timer.Elapsed(); //wall time
+
+    printf("  %-12s %8.3f s %8.3f s %8.3f s\n",
+      mode == 0? "file order": mode == 1? "LPT": "LPT + split",
+      Makespan(predicted, threads), Makespan(measured, threads), wall);
+  } //for
+
+  return failed? 1: 0;
+} //BenchLptCommand
+
+#pragma endregion commands
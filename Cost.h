@@ -0,0 +1,102 @@
+/// \file Cost.h
+
+/// \brief Interface for the cost model and batch planning.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Cost_h__
+#define __Cost_h__
+
+#include <functional>
+#include <vector>
+
+#include "Illusion.h"
+#include "ThreadPool.h"
+
+/// \brief Predicted cost of a job.
+
+struct Estimate{
+  size_t elements = 0; ///< Number of squares or ellipses.
+  double bytes = 0; ///< Size of SVG file in bytes.
+  double seconds = 0; ///< Time to draw.
+}; //Estimate
+
+/// \brief Cost model.
+///
+/// The number of elements in a job can be computed exactly from its
+/// parameters without drawing anything, and the size of the SVG file and
+/// the time taken to draw it are very nearly linear in the number of
+/// elements. The cost model predicts both from the element count using a
+/// constant and a per-element coefficient for each variant, that is, each
+/// kind of illusion drawn with each geometry, grouped or flat, since each
+/// variant draws its elements with different code. The coefficients are
+/// found by timing a few small calibration jobs on this machine.
+
+class CCostModel{
+  private:
+    static const size_t VARIANTS = 12; ///< Kinds times geometries times 2.
+
+    double m_fBytes[VARIANTS][2]; ///< Bytes per job and per element.
+    double m_fSeconds[VARIANTS][2]; ///< Seconds per job and per element.
+    bool m_bCalibrated[VARIANTS]; ///< Whether each variant was calibrated.
+
+  public:
+    CCostModel(); ///< Constructor.
+
+    void Calibrate(const std::vector<Job>* jobs=nullptr); ///< Calibrate.
+    Estimate Predict(const Job& job) const; ///< Predict the cost of a job.
+    void Print() const; ///< Print the coefficients.
+}; //CCostModel
+
+/// \brief Piece of a batch plan.
+///
+/// A job, or if the job has been split, a range of its elements. The
+/// pieces of a split job are drawn separately and written to the SVG file
+/// in order once they have all been drawn.
+
+struct Piece{
+  size_t job = 0; ///< Job index.
+  size_t a = 0; ///< Index of first element.
+  size_t b = 0; ///< Index of element after last one.
+  size_t part = 0; ///< Which piece of the job this is.
+  size_t parts = 1; ///< Number of pieces the job is split into.
+  double seconds = 0; ///< Predicted time.
+  double bytes = 0; ///< Predicted size of SVG.
+}; //Piece
+
+size_t JobElements(const Job& job);
+
+void PlanBatch(const std::vector<Job>& jobs, const std::vector<size_t>& todo,
+  const CCostModel& model, size_t threads, bool lpt, bool split,
+  std::vector<Piece>& plan);
+double Makespan(const std::vector<double>& seconds, size_t threads);
+bool WriteParts(const Job& job, const std::vector<std::string>& parts,
+  Digest& digest, bool sha256=false);
+size_t RunPlan(const std::vector<Job>& jobs, const std::vector<Piece>& plan,
+  CThreadPool& pool, const std::function<void(size_t, const Digest&)>& done,
+  std::vector<double>* seconds=nullptr, bool sha256=false);
+
+int CostCommand(size_t argc, const char* const argv[]);
+int BenchLptCommand(size_t argc, const char* const argv[]);
+
+#endif //__Cost_h__
@@ -0,0 +1,679 @@
+/// \file Crop.cpp
+
+/// \brief Code for cropped illusions.
+///
+/// An illusion is normally drawn in full and clipped by the SVG view box,
+/// so a crop of a quarter of the image is as large and as slow to draw as
+/// the whole thing. The functions here draw only the elements that can be
+/// seen through a crop rectangle. Every element of a ring has its center
+/// on a circle, so the elements that can be seen are those whose centers
+/// are in an interval of angles that can be computed from the rectangle
+/// alone, and only the elements with angles in those intervals need to
+/// be looked at.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "Crop.h"
+#include "Fixed.h"
+#include "Huge.h"
+#include "Perf.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <random>
+
+//////////////////////////////////////////////////////////////////////////
+// Geometry.
+
+#pragma region geometry
+
+static const double TWO_PI = 6.28318530717958647692; ///< Two pi.
+static const double SLACK = 0.25; ///< Allowance for rounding, in pixels.
+
+/// \brief Arc of a circle.
+///
+/// An interval of angles in radians, where `a` is in \f$[0, 2\pi)\f$ and
+/// `b` is greater than `a` but may be greater than \f$2\pi\f$.
+
+struct Arc{
+  double a = 0; ///< Start angle.
+  double b = 0; ///< End angle.
+}; //Arc
+
+/// \brief How far an element reaches from its center.
+///
+/// The radius of a disk about the center of an element that contains all
+/// of it, including half the width of the stroke, plus a little to allow
+/// for the position and orientation being rounded to tenths in the SVG.
+/// For squares that is half the diagonal of the square grown by half the
+/// stroke width on each side, \f$(sw + 3)/\sqrt{2}\f$, rounded up.
+///
+/// \param ring Ring descriptor.
+/// \return Bounding radius in pixels.
+
+static double Reach(const Ring& ring){
+  if(ring.shape == Shape::Square)
+    return 0.71*ring.sw + 2.15 + SLACK;
+
+  return std::max(fabs(ring.r0), fabs(ring.r1)) + 1.5 + SLACK;
+} //Reach
+
+/// \brief Place an element in double precision.
+///
+/// Call PlaceFixed() or PlaceHuge() for a fixed-point or huge ring,
+/// otherwise PlaceSquare() or PlaceEllipse(), and convert the result to
+/// double.
+///
+/// \param ring Ring descriptor.
+/// \param i Element index about circle.
+/// \param theta Angle to element (float geometry only).
+/// \param parity Element parity.
+/// \param x [out] Translation x, relative to the image center.
+/// \param y [out] Translation y, relative to the image center.
+/// \param phi [out] Orientation in degrees.
+
+void PlaceElement(const Ring& ring, size_t i, float theta, bool parity,
+  double& x, double& y, double& phi)
+{
+  if(ring.geometry == Geometry::Huge)
+    PlaceHuge(ring, i, parity, x, y, phi);
+
+  else if(ring.geometry == Geometry::Fixed){
+    FixedPlace place; //fixed-point placement
+    PlaceFixed(ring, i, parity, place);
+    x = place.x/65536.0;
+    y = place.y/65536.0;
+    phi = place.phi/65536.0;
+  } //if
+
+  else{
+    float fx, fy, fphi; //float placement
+
+    if(ring.shape == Shape::Square)
+      PlaceSquare(ring.r, parity, theta, fx, fy, fphi);
+    else PlaceEllipse(ring.r, theta, fx, fy, fphi);
+
+    x = fx; y = fy; phi = fphi;
+  } //else
+} //PlaceElement
+
+/// \brief Center of an element in image coordinates.
+///
+/// A square is a `rect` whose corner is at the image center and which is
+/// rotated about the image center before it is translated (see
+/// DrawStyle() and FormatSquare()), so its center is offset from the
+/// translation by half a diagonal, rotated. An ellipse is centered on the
+/// image center, so its center is just the translation.
+///
+/// \param ring Ring descriptor.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param i Element index about circle.
+/// \param theta Angle to element.
+/// \param parity Element parity.
+/// \param px [out] Element center x.
+/// \param py [out] Element center y.
+
+static void Center(const Ring& ring, size_t cx, size_t cy, size_t i,
+  float theta, bool parity, double& px, double& py)
+{
+  double x, y, phi; //element position and orientation
+  PlaceElement(ring, i, theta, parity, x, y, phi);
+
+  px = cx + x;
+  py = cy + y;
+
+  if(ring.shape == Shape::Square){
+    const double h = ring.sw/2.0; //half square width
+    const double a = phi*TWO_PI/360; //orientation in radians
+    px += h + h*cos(a) - h*sin(a);
+    py += h + h*sin(a) + h*cos(a);
+  } //if
+} //Center
+
+/// \brief Circle through the centers of the elements of a ring.
+///
+/// The center of element `i` is at angle \f$\theta_i + \alpha\f$ on a
+/// circle, where \f$\theta_i\f$ is the angle to the element. For squares
+/// the circle is about a point half a square width below and to the right
+/// of the image center and its radius depends on the parity (see
+/// Center()). For ellipses it is about the image center with radius `r`
+/// and \f$\alpha = 0\f$. Rings can have a negative radius (the inner
+/// sub-rings of small illusions of the second kind do), in which case the
+/// circle has radius \f$|r|\f$ and \f$\alpha\f$ is increased by
+/// \f$\pi\f$, so that the radius is never negative.
+///
+/// \param ring Ring descriptor.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param ox [out] Circle center x.
+/// \param oy [out] Circle center y.
+/// \param rho [out] Circle radius.
+/// \param alpha [out] Angle of element center minus angle to element.
+
+void RingCircle(const Ring& ring, size_t cx, size_t cy, double& ox,
+  double& oy, double& rho, double& alpha)
+{
+  ox = (double)cx;
+  oy = (double)cy;
+  rho = ring.r;
+  alpha = 0;
+
+  if(ring.shape == Shape::Square){
+    const double h = ring.sw/2.0; //half square width
+    const double b = (ring.parity? 12: -12)*TWO_PI/360; //tilt
+    const double vx = ring.r + h*cos(b) - h*sin(b); //center at angle 0
+    const double vy = h*sin(b) + h*cos(b);
+    ox += h;
+    oy += h;
+    rho = sqrt(vx*vx + vy*vy);
+    alpha = atan2(vy, vx);
+  } //if
+
+  if(rho < 0){ //on the far side of the center
+    rho = -rho;
+    alpha += TWO_PI/2;
+  } //if
+} //RingCircle
+
+/// \brief Decide whether an element can be seen through a crop rectangle.
+///
+/// This is the exact test: an element is drawn in a crop if the disk of
+/// radius Reach() about its center meets the crop rectangle.
+///
+/// \param ring Ring descriptor.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param i Element index about circle.
+/// \param theta Angle to element.
+/// \param parity Element parity.
+/// \param crop Crop rectangle.
+/// \return true if the element is visible.
+
+bool ElementVisible(const Ring& ring, size_t cx, size_t cy, size_t i,
+  float theta, bool parity, const Crop& crop)
+{
+  double px, py; //element center
+  Center(ring, cx, cy, i, theta, parity, px, py);
+
+  const double x0 = (double)crop.x, x1 = x0 + crop.w; //left and right
+  const double y0 = (double)crop.y, y1 = y0 + crop.h; //top and bottom
+  const double dx = px < x0? x0 - px: px > x1? px - x1: 0; //x distance
+  const double dy = py < y0? y0 - py: py > y1? py - y1: 0; //y distance
+  const double reach = Reach(ring); //bounding radius
+
+  return dx*dx + dy*dy <= reach*reach;
+} //ElementVisible
+
+/// \brief Is a point on a circle inside a rectangle?
+///
+/// \param rho Circle radius.
+/// \param psi Angle in radians.
+/// \param r Rectangle, left, right, top, and bottom, relative to the
+///   center of the circle.
+/// \return true if the point is inside the rectangle.
+
+static bool Inside(double rho, double psi, const double r[4]){
+  const double x = rho*cos(psi), y = rho*sin(psi); //point
+
+  return r[0] <= x && x <= r[1] && r[2] <= y && y <= r[3];
+} //Inside
+
+/// \brief Arcs of a circle inside a rectangle.
+///
+/// The boundary of the rectangle crosses the circle at no more than eight
+/// angles, two for each side, which can be found with `acos` and `asin`.
+/// These divide the circle into arcs that are either inside or outside
+/// the rectangle, which can be told apart by testing their midpoints.
+///
+/// \param rho Circle radius.
+/// \param r Rectangle, left, right, top, and bottom, relative to the
+///   center of the circle.
+/// \param arcs [out] Arcs inside the rectangle.
+
+static void Arcs(double rho, const double r[4], std::vector<Arc>& arcs){
+  arcs.clear();
+  double t[8]; //angles at which the sides cross the circle
+  size_t k = 0; //number of angles
+
+  for(size_t j=0; j<2; j++){ //left and right
+    if(fabs(r[j]) < rho){
+      const double a = acos(r[j]/rho); //in [0, pi]
+      t[k++] = a;
+      t[k++] = TWO_PI - a;
+    } //if
+  } //for
+
+  for(size_t j=2; j<4; j++){ //top and bottom
+    if(fabs(r[j]) < rho){
+      const double a = asin(r[j]/rho); //in [-pi/2, pi/2]
+      t[k++] = a < 0? a + TWO_PI: a;
+      t[k++] = TWO_PI/2 - a;
+    } //if
+  } //for
+
+  if(k == 0){ //circle is entirely inside or entirely outside
+    if(Inside(rho, 0, r)){
+      Arc arc; //the whole circle
+      arc.b = TWO_PI;
+      arcs.push_back(arc);
+    } //if
+
+    return;
+  } //if
+
+  std::sort(t, t + k);
+
+  for(size_t j=0; j<k; j++){
+    Arc arc; //arc between consecutive crossings
+    arc.a = t[j];
+    arc.b = j + 1 < k? t[j + 1]: t[0] + TWO_PI;
+
+    if(arc.b > arc.a && Inside(rho, (arc.a + arc.b)/2, r))
+      arcs.push_back(arc);
+  } //for
+} //Arcs
+
+/// \brief Intervals of element indices that may be visible.
+///
+/// The centers of the elements of a ring lie on a circle, and the centers
+/// of the elements that can be seen through the crop rectangle lie in that
+/// rectangle grown by Reach() on every side. The arcs of the circle inside
+/// the grown rectangle are found with Arcs() and converted to half-open
+/// intervals of element indices using the angle to the first element and
+/// the angle delta. The intervals are widened by one element on each side,
+/// and further in float geometry, to allow for the error that builds up as
+/// float angles are added. Every element that passes ElementVisible() is
+/// in one of the intervals, but not every element in the intervals passes
+/// it. The circle comes from RingCircle().
+///
+/// \param ring Ring descriptor.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param crop Crop rectangle.
+/// \param intervals [out] Sorted, disjoint intervals of element indices.
+
+void VisibleIntervals(const Ring& ring, size_t cx, size_t cy,
+  const Crop& crop, std::vector<std::pair<size_t, size_t>>& intervals)
+{
+  intervals.clear();
+  if(ring.n == 0)return;
+
+  double ox, oy, rho, alpha; //circle through element centers
+  RingCircle(ring, cx, cy, ox, oy, rho, alpha);
+
+  const double reach = Reach(ring); //bounding radius
+  const double r[4] = { //grown crop rectangle relative to center of circle
+    crop.x - reach - ox, crop.x + crop.w + reach - ox,
+    crop.y - reach - oy, crop.y + crop.h + reach - oy
+  }; //r
+
+  std::vector<Arc> arcs; //arcs of circle inside grown rectangle
+  Arcs(rho, r, arcs);
+
+  const size_t n = ring.n; //number of elements
+  const double d = ring.dtheta; //angle delta
+  const double first = ring.theta + alpha; //angle to first center
+  const double span = (n - 1)*d; //angle from first to last center
+  const double drift = ring.geometry != Geometry::Float? 0:
+    n*(fabs(ring.theta) + span + d)/16777216/d; //float error in elements
+
+  if(!(d > 0) || span > 64*TWO_PI || drift > n){ //look at every element
+    if(!arcs.empty())intervals.push_back(std::make_pair((size_t)0, n));
+    return;
+  } //if
+
+  const double m = 1 + ceil(drift); //margin in elements
+
+  for(const Arc& arc: arcs){
+    const double k0 = floor((first - arc.b)/TWO_PI); //first turn
+    const double k1 = ceil((first + span - arc.a)/TWO_PI); //last turn
+
+    for(double k=k0; k<=k1; k++){
+      const double lo = ceil((arc.a + k*TWO_PI - first)/d) - m; //first index
+      const double hi = floor((arc.b + k*TWO_PI - first)/d) + m; //last index
+
+      if(hi >= 0 && lo <= n - 1.0)
+        intervals.push_back(std::make_pair((size_t)std::max(lo, 0.0),
+          (size_t)std::min(hi, n - 1.0) + 1));
+    } //for
+  } //for
+
+  std::sort(intervals.begin(), intervals.end());
+  size_t j = 0; //number of merged intervals
+
+  for(size_t k=0; k<intervals.size(); k++){
+    if(j > 0 && intervals[k].first <= intervals[j - 1].second)
+      intervals[j - 1].second =
+        std::max(intervals[j - 1].second, intervals[k].second);
+    else intervals[j++] = intervals[k];
+  } //for
+
+  intervals.resize(j);
+} //VisibleIntervals
+
+#pragma endregion geometry
+
+//////////////////////////////////////////////////////////////////////////
+// Drawing.
+
+#pragma region drawing
+
+/// \brief Draw the visible elements of a ring.
+///
+/// Draw the elements in the intervals from VisibleIntervals() that pass
+/// ElementVisible(), in order. The elements drawn are byte-for-byte
+/// identical to those drawn by DrawRing(), because their angles and
+/// parities are advanced over the elements in between with NextElement()
+/// as in DrawElements(). That costs one float addition per skipped element,
+/// which is tiny next to drawing one. Fixed-point and huge rings compute
+/// angles from indices, so the skipped elements are jumped over in constant
+/// time. The elements are drawn with a CRingWriter.
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param ring Ring descriptor.
+/// \param crop Crop rectangle.
+/// \return Number of elements drawn.
+
+size_t DrawCroppedRing(COutput& output, size_t cx, size_t cy,
+  const Ring& ring, const Crop& crop)
+{
+  std::vector<std::pair<size_t, size_t>> intervals; //may be visible
+  VisibleIntervals(ring, cx, cy, crop, intervals);
+
+  size_t i = 0; //index of current element
+  float theta = ring.theta; //angle to current element
+  bool parity = ring.parity; //parity of current element
+  size_t count = 0; //number of elements drawn
+  const CRingWriter writer(ring, cx, cy); //element writer
+
+  for(const std::pair<size_t, size_t>& interval: intervals){
+    if(ring.geometry != Geometry::Float){ //jump to start of interval
+      i = interval.first;
+      parity = ring.shape == Shape::Ellipse && i > ring.flip?
+        !ring.parity: ring.parity;
+    } //if
+
+    else for(; i<interval.first; i++) //step to start of interval
+      NextElement(ring, i, theta, parity);
+
+    for(; i<interval.second; i++){ //for each element in interval
+      if(ElementVisible(ring, cx, cy, i, theta, parity, crop)){
+        writer.Draw(output, i, theta, parity);
+        count++;
+      } //if
+
+      NextElement(ring, i, theta, parity);
+    } //for
+  } //for
+
+  return count;
+} //DrawCroppedRing
+
+/// \brief Draw the visible elements of an illusion.
+///
+/// Output the style and background tags using DrawStyle(), then draw the
+/// visible elements of each ring in order using DrawCroppedRing(). The
+/// header, with the view box set to the crop rectangle by DrawHeader(),
+/// must already have been written.
+///
+/// \param output Output stream.
+/// \param illusion Illusion descriptor.
+/// \param crop Crop rectangle.
+/// \return Number of elements drawn.
+
+size_t DrawCroppedIllusion(COutput& output, const Illusion& illusion,
+  const Crop& crop)
+{
+  DrawStyle(output, illusion);
+  size_t count = 0; //number of elements drawn
+
+  for(const Ring& ring: illusion.rings)
+    count += DrawCroppedRing(output, illusion.cx, illusion.cy, ring, crop);
+
+  return count;
+} //DrawCroppedIllusion
+
+/// \brief Draw a cropped illusion by looking at every element.
+///
+/// The reference for DrawCroppedIllusion(): the same output, found by
+/// testing every element with ElementVisible().
+///
+/// \param output Output stream.
+/// \param illusion Illusion descriptor.
+/// \param crop Crop rectangle.
+/// \return Number of elements drawn.
+
+static size_t DrawCroppedExhaustively(COutput& output,
+  const Illusion& illusion, const Crop& crop)
+{
+  DrawStyle(output, illusion);
+  size_t count = 0; //number of elements drawn
+
+  for(const Ring& ring: illusion.rings){
+    float theta = ring.theta; //angle to current element
+    bool parity = ring.parity; //parity of current element
+
+    for(size_t i=0; i<ring.n; i++){
+      if(ElementVisible(ring, illusion.cx, illusion.cy, i, theta, parity,
+        crop))
+      {
+        DrawElement(output, illusion.cx, illusion.cy, ring, i, theta,
+          parity);
+        count++;
+      } //if
+
+      NextElement(ring, i, theta, parity);
+    } //for
+  } //for
+
+  return count;
+} //DrawCroppedExhaustively
+
+#pragma endregion drawing
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Draw a crop of an illusion.
+///
+/// The parameters are the left, top, width, and height of the crop
+/// rectangle in pixels followed by a job as described in ParseJob(). The
+/// SVG file has the size of the crop rectangle and its view box is the
+/// crop rectangle, and it contains only the elements that can be seen
+/// through it.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int CropCommand(size_t argc, const char* const argv[]){
+  Crop crop; //crop rectangle
+  size_t* v[4] = {&crop.x, &crop.y, &crop.w, &crop.h}; //crop parameters
+  bool ok = argc >= 4; //parameters are good so far
+
+  for(size_t k=0; k<4 && ok; k++){
+    char* end = nullptr; //end of number parsed
+    *v[k] = (size_t)strtoull(argv[k], &end, 10);
+    ok = end != argv[k] && *end == '\0';
+  } //for
+
+  Job job; //job descriptor
+
+  if(!ok || crop.w == 0 || crop.h == 0 || !ParseJob(job, argc - 4, argv + 4)){
+    printf("Expected <x> <y> <w> <h> <job>\n");
+    return 1;
+  } //if
+
+  Illusion illusion; //illusion descriptor
+  Describe(illusion, job);
+  const std::string fname = job.fname + ".svg"; //file name
+  COutput output; //output stream
+
+  if(!output.Open(fname)){
+    printf("Cannot open %s\n", fname.c_str());
+    return 1;
+  } //if
+
+  DrawHeader(output, crop.w, crop.h, crop.x, crop.y);
+  const size_t count = DrawCroppedIllusion(output, illusion, crop); //drawn
+  CloseSVG(output);
+
+  printf("Crop of %s: %zu of %zu elements, %zu bytes\n", fname.c_str(),
+    count, ElementCount(illusion), output.Size());
+
+  return output.Error()? 1: 0;
+} //CropCommand
+
+/// \brief Time drawing crops of different sizes.
+///
+/// The parameters are optionally `-reps n` (default 100) followed by a job
+/// as described in ParseJob(); without a job, the illusions `output1.svg`
+/// and `output2.svg` are used, along with two small illusions that have rings
+/// of negative radius (see NegativeRadiusJobs()). For each job, the whole
+/// illusion and square crops of the top left corner with sides of 1, 1/2,
+/// 1/4, and 1/8 of the image width are drawn to a string, and the number of
+/// elements, number of bytes, and time to draw are reported. Each crop, and
+/// 1000 crops at random positions with random sizes, are checked against
+/// crops drawn by testing every element. Even the largest crop, which
+/// covers the whole image, can leave out elements that lie outside the
+/// image.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 if every crop matches, 1 if not or for failure.
+
+int BenchCropCommand(size_t argc, const char* const argv[]){
+  size_t reps = 100; //number of repetitions
+  std::vector<Job> jobs; //jobs to time
+
+  if(argc >= 2 && !strcmp(argv[0], "-reps")){
+    reps = (size_t)strtoul(argv[1], nullptr, 10);
+    argc -= 2; argv += 2;
+  } //if
+
+  if(argc > 0){
+    jobs.push_back(Job());
+
+    if(!ParseJob(jobs[0], argc, argv) || reps == 0){
+      printf("Expected [-reps n] [job]\n");
+      return 1;
+    } //if
+  } //if
+
+  else{
+    BenchJobs(jobs);
+    NegativeRadiusJobs(jobs);
+  } //else
+
+  bool ok = true; //every crop matches
+
+  for(const Job& job: jobs){
+    Illusion illusion; //illusion descriptor
+    Describe(illusion, job);
+
+    CTimer timer; //stopwatch
+    std::string whole; //whole SVG
+
+    for(size_t rep=0; rep<reps; rep++){
+      whole.clear();
+      COutput output(whole); //output stream
+      DrawHeader(output, job.w, job.w);
+      DrawIllusion(output, illusion);
+      CloseSVG(output);
+    } //for
+
+    printf("%s: %zu elements, %zu bytes, %0.3f ms\n", job.fname.c_str(),
+      ElementCount(illusion), whole.size(), 1000*timer.Elapsed()/reps);
+    printf("  %-11s %6s %9s %9s %9s\n", "crop", "area", "elements", "bytes",
+      "ms");
+
+    for(size_t f=1; f<=8; f*=2){
+      Crop crop; //crop rectangle
+      crop.w = crop.h = (job.w + f - 1)/f;
+
+      std::string s0, s1; //cropped and reference SVG
+      size_t count = 0; //number of elements drawn
+      timer.Start();
+
+      for(size_t rep=0; rep<reps; rep++){
+        s0.clear();
+        COutput output(s0); //output stream
+        DrawHeader(output, crop.w, crop.h, crop.x, crop.y);
+        count = DrawCroppedIllusion(output, illusion, crop);
+        CloseSVG(output);
+      } //for
+
+      const double t = timer.Elapsed()/reps; //time per crop
+
+      COutput output(s1); //output stream for reference
+      DrawHeader(output, crop.w, crop.h, crop.x, crop.y);
+      DrawCroppedExhaustively(output, illusion, crop);
+      CloseSVG(output);
+
+      const std::string size = std::to_string(crop.w) + "x" +
+        std::to_string(crop.h); //crop size
+      printf("  %-11s %5.1f%% %9zu %9zu %9.3f%s\n", size.c_str(),
+        100.0*crop.w*crop.h/(job.w*job.w), count, s0.size(), 1000*t,
+        s0 == s1? "": "  CROP MISMATCH");
+
+      if(s0 != s1)ok = false;
+    } //for
+
+    const size_t CROPS = 1000; //number of random crops
+    std::mt19937_64 random(12345); //pseudorandom number generator
+    size_t mismatches = 0; //number of random crops that don't match
+
+    for(size_t k=0; k<CROPS; k++){
+      Crop crop; //crop rectangle
+      crop.x = random()%job.w;
+      crop.y = random()%job.w;
+      crop.w = 1 + random()%(job.w - crop.x);
+      crop.h = 1 + random()%(job.w - crop.y);
+
+      std::string s0, s1; //cropped and reference SVG
+      COutput output0(s0), output1(s1); //output streams
+      DrawCroppedIllusion(output0, illusion, crop);
+      DrawCroppedExhaustively(output1, illusion, crop);
+      output0.Close(); output1.Close();
+      if(s0 != s1)mismatches++;
+    } //for
+
+    printf("  %zu random crops, %zu mismatches\n", CROPS, mismatches);
+    if(mismatches > 0)ok = false;
+  } //for
+
+  return ok? 0: 1;
+} //BenchCropCommand
+
+#pragma endregion commands
@@ -0,0 +1,63 @@
+/// \file Crop.h
+
+/// \brief Interface for cropped illusions.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Crop_h__
+#define __Crop_h__
+
+#include <utility>
+#include <vector>
+
+#include "Illusion.h"
+
+/// \brief Crop rectangle.
+///
+/// A rectangle in image coordinates, in pixels. It may extend past the
+/// edges of the image.
+
+struct Crop{
+  size_t x = 0; ///< X coordinate of left edge.
+  size_t y = 0; ///< Y coordinate of top edge.
+  size_t w = 0; ///< Width.
+  size_t h = 0; ///< Height.
+}; //Crop
+
+void PlaceElement(const Ring& ring, size_t i, float theta, bool parity,
+  double& x, double& y, double& phi);
+void RingCircle(const Ring& ring, size_t cx, size_t cy, double& ox,
+  double& oy, double& rho, double& alpha);
+bool ElementVisible(const Ring& ring, size_t cx, size_t cy, size_t i,
+  float theta, bool parity, const Crop& crop);
+void VisibleIntervals(const Ring& ring, size_t cx, size_t cy,
+  const Crop& crop, std::vector<std::pair<size_t, size_t>>& intervals);
+size_t DrawCroppedRing(COutput& output, size_t cx, size_t cy,
+  const Ring& ring, const Crop& crop);
+size_t DrawCroppedIllusion(COutput& output, const Illusion& illusion,
+  const Crop& crop);
+
+int CropCommand(size_t argc, const char* const argv[]);
+int BenchCropCommand(size_t argc, const char* const argv[]);
+
+#endif //__Crop_h__
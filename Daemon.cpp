@@ -0,0 +1,518 @@
+/// \file Daemon.cpp
+
+/// \brief Code for the rendering daemon and its client.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Daemon.h"
+#include "Illusion.h"
+#include "Socket.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifndef _MSC_VER
+
+//////////////////////////////////////////////////////////////////////////
+// SVG cache.
+
+#pragma region cache
+
+/// \brief SVG cache.
+///
+/// The SVG documents most recently drawn by the daemon, keyed by the hash
+/// of the job that drew them with its file name left out, since the file
+/// name doesn't affect the SVG. When the documents take up more than the
+/// budget, the oldest are discarded. Documents are shared with the threads
+/// that are sending them, so they can be discarded while in use.
+
+class CSvgCache{
+  private:
+    std::mutex m_mutex; ///< Guards everything below.
+    std::unordered_map<uint64_t, std::shared_ptr<const std::string>> m_mapSvg; ///< Documents by key.
+    std::deque<uint64_t> m_qKey; ///< Keys, oldest first.
+    size_t m_nBytes = 0; ///< Size of documents in bytes.
+    size_t m_nBudget = 0; ///< Maximum size of documents in bytes.
+
+  public:
+    CSvgCache(size_t budget); ///< Constructor.
+
+    std::shared_ptr<const std::string> Get(const Job& job); ///< Get a document.
+}; //CSvgCache
+
+/// \param budget Maximum size of documents in bytes.
+
+CSvgCache::CSvgCache(size_t budget): m_nBudget(budget){
+} //constructor
+
+/// Get the SVG document for a job, drawing it if it is not in the cache.
+/// \param job Job descriptor.
+/// \return SVG document.
+
+std::shared_ptr<const std::string> CSvgCache::Get(const Job& job){
+  Job anon = job; //job without file name
+  anon.fname.clear();
+  const uint64_t key = JobHash(anon); //cache key
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_mapSvg.find(key); //cache entry
+    if(it != m_mapSvg.end())return it->second;
+  }
+
+  std::string* svg = new std::string; //SVG document
+  COutput output(*svg); //output stream
+  DrawJob(output, job);
+  std::shared_ptr<const std::string> result(svg);
+
+  if(svg->size() <= m_nBudget){
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_mapSvg.insert({key, result}).second){ //not drawn by another thread
+      m_qKey.push_back(key);
+      m_nBytes += svg->size();
+
+      while(m_nBytes > m_nBudget){ //discard oldest
+        m_nBytes -= m_mapSvg[m_qKey.front()]->size();
+        m_mapSvg.erase(m_qKey.front());
+        m_qKey.pop_front();
+      } //while
+    } //if
+  } //if
+
+  return result;
+} //Get
+
+#pragma endregion cache
+
+//////////////////////////////////////////////////////////////////////////
+// Protocol.
+
+#pragma region protocol
+
+// A client sends two lines, a request consisting of a verb and the client's
+// working directory separated by a space, and a job. The verb is `RENDER` to
+// have the daemon write the SVG file, or `SVG` to have it send the SVG back.
+// The daemon replies with `OK` and the size of the SVG in bytes, followed by
+// the SVG itself for `SVG`, or `ERR` and an error message, and hangs up.
+
+/// \brief Serve one request.
+///
+/// \param fd Socket file descriptor, which is closed afterwards.
+/// \param cache SVG cache.
+
+static void Serve(int fd, CSvgCache& cache){
+  std::string buffer; //text received but not yet used
+  std::string request; //request line
+  std::string line; //job line
+
+  if(ReceiveLine(fd, buffer, request) && ReceiveLine(fd, buffer, line)){
+    const size_t space = request.find(' '); //end of verb
+    const std::string verb = request.substr(0, space); //verb
+    const std::string cwd = space == std::string::npos? "":
+      request.substr(space + 1); //client's working directory
+
+    const char* argv[16]; //job parameters
+    size_t argc = 0; //number of job parameters
+    char* p = &line[0]; //current character
+
+    while(argc < 16){ //split line at spaces
+      while(*p == ' ')*p++ = 0;
+      if(*p == 0)break;
+      argv[argc++] = p;
+      while(*p != 0 && *p != ' ')p++;
+    } //while
+
+    Job job; //job descriptor
+
+    if(!ParseJob(job, argc, argv))
+      SendLine(fd, "ERR Bad job parameters\n");
+
+    else if(verb == "SVG"){
+      const auto svg = cache.Get(job); //SVG document
+      if(SendLine(fd, "OK " + std::to_string(svg->size()) + "\n"))
+        SendLine(fd, *svg);
+    } //else if
+
+    else if(verb == "RENDER"){
+      const auto svg = cache.Get(job); //SVG document
+      std::string fname = job.fname + ".svg"; //file name
+      if(fname[0] != '/' && !cwd.empty())fname = cwd + "/" + fname;
+
+      const std::string temp = TempName(fname); //temporary file name
+      COutput output; //output stream
+      bool ok = output.Open(temp, true); //no errors so far
+
+      if(ok){
+        output.Write(svg->data(), svg->size());
+        output.Close();
+      } //if
+
+      if(MoveIntoPlace(temp, fname, ok && !output.Error()))
+        SendLine(fd, "OK " + std::to_string(svg->size()) + "\n");
+      else SendLine(fd, "ERR Cannot write " + job.fname + ".svg\n");
+    } //else if
+
+    else SendLine(fd, "ERR Unknown request\n");
+  } //if
+
+  close(fd);
+} //Serve
+
+/// \brief Make a request of the daemon.
+///
+/// \param path Socket path.
+/// \param verb Verb, either `RENDER` or `SVG`.
+/// \param argc Number of job parameters.
+/// \param argv Job parameters.
+/// \param reply [out] Error message, or the SVG document for `SVG`.
+/// \return Size of SVG document in bytes, or `(size_t)-1` on failure.
+
+static size_t Request(const char* path, const char* verb, size_t argc,
+  const char* const argv[], std::string& reply)
+{
+  char cwd[PATH_MAX]; //working directory
+  if(getcwd(cwd, sizeof(cwd)) == nullptr)cwd[0] = 0;
+
+  std::string request = std::string(verb) + " " + cwd + "\n"; //request
+
+  for(size_t i=0; i<argc; i++)
+    request += std::string(argv[i]) + (i + 1 < argc? " ": "\n");
+
+  const int fd = Connect(path); //socket
+
+  if(fd < 0){
+    reply = "Cannot connect to " + std::string(path);
+    return (size_t)-1;
+  } //if
+
+  std::string buffer; //bytes received but not yet used
+  std::string line; //status line
+  size_t size = (size_t)-1; //size of SVG
+
+  if(!SendLine(fd, request) || !ReceiveLine(fd, buffer, line))
+    reply = "No reply from daemon";
+
+  else if(line.compare(0, 3, "OK "))
+    reply = line.compare(0, 4, "ERR ")? line: line.substr(4);
+
+  else{
+    size = (size_t)strtoull(line.c_str() + 3, nullptr, 10);
+
+    if(!strcmp(verb, "SVG") && !ReceiveBytes(fd, buffer, size, reply)){
+      reply = "SVG truncated";
+      size = (size_t)-1;
+    } //if
+  } //else
+
+  close(fd);
+  return size;
+} //Request
+
+/// \brief Run the daemon.
+///
+/// Accept connections forever, serving each one on a thread from a pool.
+///
+/// \param listener Listening socket file descriptor.
+/// \param threads Number of threads, 0 for one per hardware thread.
+/// \param budget SVG cache budget in bytes.
+
+static void RunDaemon(int listener, size_t threads, size_t budget){
+  CThreadPool pool(threads); //threads that serve requests
+  CSvgCache cache(budget); //SVG cache
+
+  for(;;){
+    const int fd = accept(listener, nullptr, nullptr); //client socket
+    if(fd >= 0)pool.Enqueue([fd, &cache]{Serve(fd, cache);});
+  } //for
+} //RunDaemon
+
+#pragma endregion protocol
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark helpers.
+
+#pragma region benchmark
+
+/// \brief Run a command in a new process.
+///
+/// Start this program in a new process with some parameters, discarding its
+/// output, and wait for it to finish.
+///
+/// \param args Parameters, not including the program name.
+/// \return true if the process ran and exited with status 0.
+
+static bool RunProcess(const std::vector<std::string>& args){
+  std::vector<char*> argv; //parameters for exec
+  argv.push_back((char*)"main.exe");
+  for(const std::string& s: args)argv.push_back((char*)s.c_str());
+  argv.push_back(nullptr);
+
+  const pid_t pid = fork(); //child process id
+
+  if(pid == 0){ //child
+    const int null = open("/dev/null", O_WRONLY); //discard output
+    if(null >= 0)dup2(null, 1);
+    execv("/proc/self/exe", argv.data());
+    _exit(127);
+  } //if
+
+  int status = 0; //child exit status
+  return pid > 0 && waitpid(pid, &status, 0) == pid &&
+    WIFEXITED(status) && WEXITSTATUS(status) == 0;
+} //RunProcess
+
+/// \brief Print latency statistics.
+///
+/// \param name Name of thing measured.
+/// \param t Latencies in seconds, which will be sorted.
+
+static void PrintLatency(const char* name, std::vector<double>& t){
+  if(t.empty())return;
+  std::sort(t.begin(), t.end());
+
+  double sum = 0; //total time
+  for(double x: t)sum += x;
+
+  const size_t n = t.size(); //number of calls
+  printf("  %-22s mean %8.3f ms, median %8.3f ms, p99 %8.3f ms\n", name,
+    1000*sum/n, 1000*t[n/2], 1000*t[std::min(n - 1, (size_t)(0.99*n))]);
+} //PrintLatency
+
+#pragma endregion benchmark
+
+#endif //_MSC_VER
+
+/// \brief Run the daemon.
+///
+/// The parameters are a socket path, optionally followed by `-threads n` to
+/// set the number of threads (by default one per hardware thread) and
+/// `-cache m` to keep up to `m` MB of recently drawn SVG in memory
+/// (default 64). The daemon serves requests from ClientCommand() until it
+/// is killed.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 1 for failure, otherwise doesn't return.
+
+int DaemonCommand(size_t argc, const char* const argv[]){
+#ifdef _MSC_VER //Visual Studio
+  printf("The daemon is not supported under Windows\n");
+  return 1;
+#else
+  size_t threads = 0; //number of threads
+  size_t cache = 64; //cache budget in MB
+  bool ok = argc%2 == 1; //no errors so far
+
+  for(size_t i=1; ok && i+1<argc; i+=2){ //options
+    if(!strcmp(argv[i], "-threads"))threads = (size_t)strtoul(argv[i + 1], 0, 10);
+    else if(!strcmp(argv[i], "-cache"))cache = (size_t)strtoul(argv[i + 1], 0, 10);
+    else ok = false;
+  } //for
+
+  if(!ok){
+    printf("Expected socket [-threads n] [-cache m]\n");
+    return 1;
+  } //if
+
+  const int listener = Listen(argv[0]); //listening socket
+
+  if(listener < 0){
+    printf("Cannot listen on %s\n", argv[0]);
+    return 1;
+  } //if
+
+  signal(SIGPIPE, SIG_IGN);
+  printf("Daemon listening on %s\n", argv[0]);
+  fflush(stdout);
+
+  RunDaemon(listener, threads, cache << 20);
+  return 0;
+#endif
+} //DaemonCommand
+
+/// \brief Run a command in the daemon.
+///
+/// The parameters are the daemon's socket path followed by a command and
+/// its parameters, which are the same as for the command run directly.
+/// The commands are `render <job>`, which has the daemon write the SVG
+/// file, and `svg <job>`, which has the daemon send the SVG back to be
+/// written to `stdout`. Relative file names are relative to the client's
+/// working directory.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int ClientCommand(size_t argc, const char* const argv[]){
+#ifdef _MSC_VER //Visual Studio
+  printf("The client is not supported under Windows\n");
+  return 1;
+#else
+  const char* verb = nullptr; //request verb
+
+  if(argc >= 2 && !strcmp(argv[1], "render"))verb = "RENDER";
+  else if(argc >= 2 && !strcmp(argv[1], "svg"))verb = "SVG";
+
+  if(verb == nullptr){
+    printf("Expected socket followed by render or svg and a job\n");
+    return 1;
+  } //if
+
+  Job job; //job descriptor
+
+  if(!ParseJob(job, argc - 2, argv + 2)){
+    printf("Bad job parameters\n");
+    return 1;
+  } //if
+
+  std::string reply; //error message or SVG
+  const size_t size = Request(argv[0], verb, argc - 2, argv + 2, reply);
+
+  if(size == (size_t)-1){
+    printf("%s\n", reply.c_str());
+    return 1;
+  } //if
+
+  if(!strcmp(verb, "SVG"))
+    fwrite(reply.data(), 1, reply.size(), stdout);
+  else printf("Optical illusion %zu to %s.svg\n", job.kind, job.fname.c_str());
+
+  return 0;
+#endif
+} //ClientCommand
+
+/// \brief Benchmark the daemon.
+///
+/// The parameters are the number of calls followed by a job. A daemon is
+/// started on a temporary socket, and the job is rendered that many times
+/// in each of four ways: by a new process running the `render` command
+/// (a cold start), by a new process running the `client render` command,
+/// and by requests made directly from this process for the daemon to
+/// write the file or send the SVG back. The last two measure the cost of a
+/// call with process startup taken out. The mean, median, and 99th
+/// percentile latency per call are reported for each.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchDaemonCommand(size_t argc, const char* const argv[]){
+#ifdef _MSC_VER //Visual Studio
+  printf("The daemon is not supported under Windows\n");
+  return 1;
+#else
+  Job job; //job descriptor
+
+  if(argc < 2 || !ParseJob(job, argc - 1, argv + 1)){
+    printf("Expected number of calls and a job\n");
+    return 1;
+  } //if
+
+  const size_t n = (size_t)strtoull(argv[0], nullptr, 10); //number of calls
+  const std::string path = "/tmp/illusion-bench-" +
+    std::to_string(getpid()) + ".sock"; //socket path
+  const int listener = Listen(path.c_str()); //listening socket
+
+  if(listener < 0){
+    printf("Cannot listen on %s\n", path.c_str());
+    return 1;
+  } //if
+
+  fflush(stdout);
+  const pid_t daemon = fork(); //daemon process id
+
+  if(daemon == 0){ //child
+    signal(SIGPIPE, SIG_IGN);
+    RunDaemon(listener, 0, 64 << 20);
+    _exit(0);
+  } //if
+
+  close(listener);
+
+  std::vector<std::string> render = {"render"}; //render command
+  std::vector<std::string> client = {"client", path, "render"}; //client command
+
+  for(size_t i=1; i<argc; i++){
+    render.push_back(argv[i]);
+    client.push_back(argv[i]);
+  } //for
+
+  std::vector<double> tCold, tClient, tRender, tSvg; //latencies
+  std::string reply; //reply from daemon
+  size_t failed = 0; //number of failed calls
+  CTimer timer; //stopwatch
+
+  for(size_t i=0; i<n; i++){
+    timer.Start();
+    if(!RunProcess(render))failed++;
+    tCold.push_back(timer.Elapsed());
+
+    timer.Start();
+    if(!RunProcess(client))failed++;
+    tClient.push_back(timer.Elapsed());
+
+    timer.Start();
+    if(Request(path.c_str(), "RENDER", argc - 1, argv + 1, reply) == (size_t)-1)
+      failed++;
+    tRender.push_back(timer.Elapsed());
+
+    timer.Start();
+    if(Request(path.c_str(), "SVG", argc - 1, argv + 1, reply) == (size_t)-1)
+      failed++;
+    tSvg.push_back(timer.Elapsed());
+  } //for
+
+  kill(daemon, SIGTERM);
+  waitpid(daemon, nullptr, 0);
+  unlink(path.c_str());
+
+  printf("%zu calls each, %zu failed\n", n, failed);
+  PrintLatency("cold process", tCold);
+  PrintLatency("client process", tClient);
+  PrintLatency("request, write file", tRender);
+  PrintLatency("request, send SVG", tSvg);
+
+  return failed? 1: 0;
+#endif
+} //BenchDaemonCommand
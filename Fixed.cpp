@@ -0,0 +1,799 @@
+/// \file Fixed.cpp
+
+/// \brief Code for fixed-point geometry.
+///
+/// The float geometry of DrawSquare() and DrawEllipse() calls `cosf` and
+/// `sinf`, whose last bits differ between C libraries, and accumulates
+/// angles in float, so the same job can produce different SVG on different
+/// machines. The fixed-point path here uses only integer arithmetic once
+/// the float parameters of a ring descriptor have been converted exactly to
+/// fixed point, so it produces the same bytes everywhere. Angles are binary
+/// angles, in which a full turn is \f$2^{32}\f$, so that they wrap around
+/// for free, and sines and cosines come from a 1024-entry table built with
+/// integer arithmetic, refined with a short Taylor series. Coordinates have
+/// 16 fractional bits and trigonometric values 30, so radii must be less
+/// than 131072 pixels.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Fixed.h"
+#include "Perf.h"
+#include "Template.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// Fixed-point arithmetic.
+
+#pragma region arithmetic
+
+static const size_t TABLE = 1024; ///< Number of table entries per turn.
+static const int64_t ONE = (int64_t)1 << 30; ///< 1.0 with 30 fraction bits.
+static const int64_t TWO_PI = 6746518852LL; ///< 2 pi with 30 fraction bits.
+static const uint64_t PI60 = 0x3243F6A8885A308DULL; ///< Pi, 60 fraction bits.
+static const uint64_t TURN = 174992710548ULL; ///< 2^40/(2 pi), rounded.
+
+/// \brief Shift right, rounding.
+///
+/// Halves are rounded away from zero. Unlike `>>` on a negative number, the
+/// result does not depend on the compiler.
+///
+/// \param x Number.
+/// \param s Number of bits, at least 1.
+/// \return `x` divided by \f$2^s\f$, rounded.
+
+static inline int64_t Round(int64_t x, int s){
+  const uint64_t half = (uint64_t)1 << (s - 1); //one half
+  if(x >= 0)return (int64_t)(((uint64_t)x + half) >> s);
+  return -(int64_t)(((uint64_t)-x + half) >> s);
+} //Round
+
+/// \brief Multiply by a sine or cosine.
+///
+/// The product of a number with 16 fraction bits and a sine or cosine with
+/// 30 fraction bits can need more than 64 bits, so the number is multiplied
+/// in two 32-bit halves.
+///
+/// \param r Number with 16 fraction bits.
+/// \param c Sine or cosine with 30 fraction bits.
+/// \return `r*c` with 16 fraction bits, rounded like Round().
+
+static inline int64_t MulTrig(int64_t r, int64_t c){
+  const uint64_t a = (uint64_t)(r < 0? -r: r); //magnitude of r
+  const uint64_t b = (uint64_t)(c < 0? -c: c); //magnitude of c
+  const uint64_t half = (uint64_t)1 << 29; //one half
+
+  const uint64_t v = (((a >> 32)*b) << 2) + (((a & 0xFFFFFFFF)*b + half) >> 30);
+  return (r < 0) != (c < 0)? -(int64_t)v: (int64_t)v;
+} //MulTrig
+
+/// \brief Multiply with 60 fraction bits.
+///
+/// \param a Non-negative number with 60 fraction bits, less than 4.
+/// \param b Non-negative number with 60 fraction bits, less than 4.
+/// \return `a*b` with 60 fraction bits, truncated.
+
+static uint64_t Mul60(uint64_t a, uint64_t b){
+  const uint64_t a1 = a >> 32, a0 = a & 0xFFFFFFFF; //halves of a
+  const uint64_t b1 = b >> 32, b0 = b & 0xFFFFFFFF; //halves of b
+
+  return ((a1*b1) << 4) + ((a1*b0 + a0*b1) >> 28) + ((a0*b0) >> 60);
+} //Mul60
+
+/// \brief Split a float into integers.
+///
+/// Read the IEEE 754 bits of a float, which are the same on every platform
+/// that this program runs on.
+///
+/// \param x Float.
+/// \param m [out] Mantissa, less than \f$2^{24}\f$, or 0 for infinities and
+///   NaNs.
+/// \param e [out] Exponent, such that `x` is \f$\pm m 2^{e - 150}\f$.
+/// \return true if `x` is negative.
+
+static bool Split(float x, int64_t& m, int& e){
+  uint32_t bits; //bits of x
+  memcpy(&bits, &x, sizeof(bits));
+
+  e = (bits >> 23) & 0xFF;
+  m = bits & 0x7FFFFF;
+
+  if(e == 0xFF)m = 0; //infinity or NaN
+  else if(e == 0)e = 1; //subnormal
+  else m |= 0x800000; //implicit leading 1
+
+  return (bits >> 31) != 0;
+} //Split
+
+/// \brief Scale a float exactly.
+///
+/// \param x Float.
+/// \param bits Number of fraction bits in the result.
+/// \return `x` with `bits` fraction bits, rounded, computed from the bits of
+///   `x` with integer arithmetic.
+
+static int64_t Scale(float x, int bits){
+  int64_t m; int e; //mantissa and exponent
+  const bool negative = Split(x, m, e); //sign
+  const int s = 150 - e - bits; //right shift
+
+  int64_t v = 0; //result
+  if(s <= 0)v = m << (-s < 39? -s: 39);
+  else if(s < 63)v = Round(m, s);
+
+  return negative? -v: v;
+} //Scale
+
+/// \brief Sine and cosine table.
+///
+/// Sines and cosines of multiples of 1/1024 of a turn with 30 fraction bits.
+/// Only the first 129 are computed, from their Taylor series with 60
+/// fraction bits; the rest follow by symmetry.
+
+class CTrigTable{
+  public:
+    int32_t m_nSin[TABLE]; ///< Sines.
+    int32_t m_nCos[TABLE]; ///< Cosines.
+
+    CTrigTable(); ///< Constructor.
+}; //CTrigTable
+
+CTrigTable::CTrigTable(){
+  const size_t EIGHTH = TABLE/8; //number of entries in an eighth of a turn
+  int64_t s[EIGHTH + 1], c[EIGHTH + 1]; //sines and cosines up to pi/4
+
+  for(size_t k=0; k<=EIGHTH; k++){
+    const uint64_t x = k*(PI60/(TABLE/2)); //angle with 60 fraction bits
+    const uint64_t x2 = Mul60(x, x); //angle squared
+    uint64_t term = x; //current term of Taylor series for sine
+    int64_t sum = (int64_t)x; //sine so far
+
+    for(uint64_t n=2; term>0; n+=2){
+      term = Mul60(term, x2)/(n*(n + 1));
+      sum += (n & 2)? -(int64_t)term: (int64_t)term;
+    } //for
+
+    s[k] = Round(sum, 30);
+
+    term = (uint64_t)1 << 60; //current term of Taylor series for cosine
+    sum = (int64_t)term; //cosine so far
+
+    for(uint64_t n=1; term>0; n+=2){
+      term = Mul60(term, x2)/(n*(n + 1));
+      sum += (n & 2)? (int64_t)term: -(int64_t)term;
+    } //for
+
+    c[k] = Round(sum, 30);
+  } //for
+
+  const size_t QUARTER = TABLE/4; //number of entries in a quarter turn
+
+  for(size_t k=0; k<TABLE; k++){
+    const size_t j = k%QUARTER; //index within quadrant
+    int64_t sj = j <= EIGHTH? s[j]: c[QUARTER - j]; //sine within quadrant
+    int64_t cj = j <= EIGHTH? c[j]: s[QUARTER - j]; //cosine within quadrant
+
+    switch(k/QUARTER){
+      case 0: m_nSin[k] = (int32_t)sj; m_nCos[k] = (int32_t)cj; break;
+      case 1: m_nSin[k] = (int32_t)cj; m_nCos[k] = (int32_t)-sj; break;
+      case 2: m_nSin[k] = (int32_t)-sj; m_nCos[k] = (int32_t)-cj; break;
+      case 3: m_nSin[k] = (int32_t)-cj; m_nCos[k] = (int32_t)sj; break;
+    } //switch
+  } //for
+} //constructor
+
+/// \brief Fixed-point sine and cosine.
+///
+/// Look up the nearest table entry below the angle and add the remainder
+/// with the angle sum formulas, using two terms of the Taylor series for the
+/// sine and cosine of the remainder, which is less than 1/1024 of a turn.
+/// The error is a few units in the last place.
+///
+/// \param theta Angle, where \f$2^{32}\f$ is a full turn.
+/// \param s [out] Sine with 30 fraction bits.
+/// \param c [out] Cosine with 30 fraction bits.
+
+void FixedSinCos(uint32_t theta, int32_t& s, int32_t& c){
+  static const CTrigTable table; //sine and cosine table
+
+  const size_t k = theta >> 22; //table index
+  const int64_t b = (int64_t)(((theta & 0x3FFFFF)*(uint64_t)TWO_PI) >> 32);
+  const int64_t b2 = Round(b*b, 30); //remainder squared
+  const int64_t sb = b - Round(b2*b, 30)/6; //sine of remainder
+  const int64_t cb = ONE - b2/2; //cosine of remainder
+
+  const int64_t sk = table.m_nSin[k], ck = table.m_nCos[k]; //table entries
+
+  s = (int32_t)Round(sk*cb + ck*sb, 30);
+  c = (int32_t)Round(ck*cb - sk*sb, 30);
+} //FixedSinCos
+
+/// \brief Convert an angle to fixed point.
+///
+/// \param theta Angle in radians, less than \f$2^{31}\f$ in magnitude.
+/// \return Angle where \f$2^{32}\f$ is a full turn, not reduced mod a turn,
+///   computed from the bits of `theta` with integer arithmetic.
+
+int64_t FixedAngle(float theta){
+  int64_t m; int e; //mantissa and exponent
+  const bool negative = Split(theta, m, e); //sign
+  const int64_t p = m*(int64_t)TURN; //theta/(2 pi), 190 - e fraction bits
+  const int s = 158 - e; //right shift, positive since |theta| < 2^31
+  const int64_t v = s < 63? Round(p, s): 0; //result
+
+  return negative? -v: v;
+} //FixedAngle
+
+/// \param x Float.
+/// \return `x` with 16 fraction bits, rounded, computed from the bits of `x`
+///   with integer arithmetic.
+
+int64_t FixedFromFloat(float x){
+  return Scale(x, 16);
+} //FixedFromFloat
+
+#pragma endregion arithmetic
+
+//////////////////////////////////////////////////////////////////////////
+// Geometry.
+
+#pragma region geometry
+
+/// \brief Angle to a square.
+///
+/// Divide \f$2^{32}i + n/2\f$ by \f$n\f$ by long division in 16-bit
+/// steps, so that nothing overflows for any `i` as long as \f$n < 2^{48}\f$.
+///
+/// \param i Element index about circle.
+/// \param n Number of elements in ring.
+/// \param rem [out] Remainder.
+/// \return Quotient, which is `i/n` of a turn rounded to nearest.
+
+static int64_t SquareAngle(uint64_t i, uint64_t n, uint64_t& rem){
+  uint64_t q = i/n; //quotient
+  rem = i%n;
+
+  for(size_t k=0; k<2; k++){
+    rem <<= 16;
+    q = (q << 16) + rem/n;
+    rem %= n;
+  } //for
+
+  rem += n/2; //round to nearest
+
+  if(rem >= n){
+    rem -= n;
+    q++;
+  } //if
+
+  return (int64_t)q;
+} //SquareAngle
+
+/// \brief Angle to an element.
+///
+/// For squares this is exactly `i/n` of a turn, rounded. For ellipses it is
+/// the ring's first angle plus `i` times its angle delta, converted to fixed
+/// point with FixedAngle() and accumulated exactly. Use CFixedAngle to step
+/// through a ring instead.
+///
+/// \param ring Ring descriptor.
+/// \param i Element index about circle.
+/// \return Angle where \f$2^{32}\f$ is a full turn.
+
+int64_t FixedElementAngle(const Ring& ring, size_t i){
+  uint64_t rem = 0; //remainder
+
+  if(ring.shape == Shape::Square)
+    return SquareAngle(i, std::max<uint64_t>(ring.n, 1), rem);
+
+  return FixedAngle(ring.theta) + (int64_t)i*FixedAngle(ring.dtheta);
+} //FixedElementAngle
+
+/// \param ring Ring descriptor.
+/// \param i Index of first element.
+
+CFixedAngle::CFixedAngle(const Ring& ring, size_t i):
+  m_bSquare(ring.shape == Shape::Square)
+{
+  if(m_bSquare){
+    m_nN = std::max<uint64_t>(ring.n, 1);
+    m_nQuotient = ((uint64_t)1 << 32)/m_nN;
+    m_nRemainder = ((uint64_t)1 << 32)%m_nN;
+    m_nAngle = SquareAngle(i, m_nN, m_nRem);
+  } //if
+
+  else{
+    m_nDelta = FixedAngle(ring.dtheta);
+    m_nAngle = FixedAngle(ring.theta) + (int64_t)i*m_nDelta;
+  } //else
+} //constructor
+
+/// \return Angle to current element, where \f$2^{32}\f$ is a full turn.
+
+int64_t CFixedAngle::Angle() const{
+  return m_nAngle;
+} //Angle
+
+/// Step to the next element. The remainder of a square angle and the
+/// remainder of a full turn are both less than `n`, so at most one carry is
+/// needed.
+
+void CFixedAngle::Next(){
+  if(m_bSquare){
+    m_nAngle += (int64_t)m_nQuotient;
+    m_nRem += m_nRemainder;
+
+    if(m_nRem >= m_nN){
+      m_nRem -= m_nN;
+      m_nAngle++;
+    } //if
+  } //if
+
+  else m_nAngle += m_nDelta;
+} //Next
+
+/// \brief Place an element in fixed point.
+///
+/// The fixed-point equivalent of PlaceSquare() and PlaceEllipse().
+///
+/// \param ring Ring descriptor.
+/// \param i Element index about circle.
+/// \param parity Element parity.
+/// \param place [out] Position and orientation with 16 fraction bits.
+
+void PlaceFixed(const Ring& ring, size_t i, bool parity, FixedPlace& place){
+  PlaceFixed(ring, FixedFromFloat(ring.r), FixedElementAngle(ring, i),
+    parity, place);
+} //PlaceFixed
+
+/// \brief Place an element in fixed point at a given angle.
+///
+/// For placing every element of a ring in turn, with the radius converted
+/// once per ring and the angle stepped with CFixedAngle.
+///
+/// \param ring Ring descriptor.
+/// \param r Circle radius with 16 fraction bits, from FixedFromFloat().
+/// \param theta Angle to element, from FixedElementAngle() or CFixedAngle.
+/// \param parity Element parity.
+/// \param place [out] Position and orientation with 16 fraction bits.
+
+void PlaceFixed(const Ring& ring, int64_t r, int64_t theta, bool parity,
+  FixedPlace& place)
+{
+  int32_t s, c; //sine and cosine
+  FixedSinCos((uint32_t)theta, s, c);
+
+  place.x = MulTrig(r, c);
+  place.y = MulTrig(r, s);
+  place.phi = Round(theta*360, 16); //degrees
+
+  if(ring.shape == Shape::Square)
+    place.phi += (parity? 12: -12)*((int64_t)1 << 16);
+  else place.phi += (int64_t)90 << 16;
+} //PlaceFixed
+
+/// \brief Append a fixed-point number to a buffer.
+///
+/// The number is written with one decimal place like `%0.1f`, rounding
+/// halves away from zero, including the sign of negative numbers that round
+/// to zero.
+///
+/// \param p [in, out] Pointer to the end of the buffer.
+/// \param x Number with 16 fraction bits.
+
+static void AppendFixed(char*& p, int64_t x){
+  const int64_t tenths = Round(x*10, 16); //number of tenths
+
+  if(x < 0)*p++ = '-';
+  const uint64_t t = (uint64_t)(tenths < 0? -tenths: tenths); //magnitude
+
+  AppendUnsigned(p, t/10);
+  *p++ = '.';
+  *p++ = (char)('0' + t%10);
+} //AppendFixed
+
+/// \brief Append a string to a buffer.
+///
+/// \param p [in, out] Pointer to the end of the buffer.
+/// \param s Null-terminated string.
+
+static void Append(char*& p, const char* s){
+  while(*s)*p++ = *s++;
+} //Append
+
+/// \brief Fixed-point ring constants.
+///
+/// The parts of PlaceFixed() and DrawFixedElement() that are the same for
+/// every element of a ring, so that DrawFixedRing() computes them once.
+
+class CFixedRing{
+  public:
+    const Ring& m_ring; ///< Ring descriptor.
+    int64_t m_nRadius = 0; ///< Circle radius with 16 fraction bits.
+    int64_t m_nHalf = 0; ///< Half square width with 16 fraction bits.
+    char m_szHead[32]; ///< Text before the translation.
+    char m_szMid[128]; ///< Text from the rotation center to the class.
+    size_t m_nHead = 0; ///< Length of m_szHead.
+    size_t m_nMid = 0; ///< Length of m_szMid.
+
+    CFixedRing(const Ring& ring, size_t cx, size_t cy); ///< Constructor.
+    void Draw(COutput& output, size_t i, int64_t theta,
+      bool parity) const; ///< Draw.
+}; //CFixedRing
+
+/// \param ring Ring descriptor.
+/// \param cx Image center x.
+/// \param cy Image center y.
+
+CFixedRing::CFixedRing(const Ring& ring, size_t cx, size_t cy): m_ring(ring){
+  const bool square = ring.shape == Shape::Square; //shape is square
+
+  m_nRadius = FixedFromFloat(ring.r);
+  m_nHalf = square? (int64_t)ring.sw << 15: 0;
+
+  char* p = m_szHead; //end of text before the translation
+
+  if(ring.flat)Append(p, square? "<rect": "<ellipse");
+  else Append(p, "<g");
+
+  Append(p, " transform=\"translate(");
+  m_nHead = p - m_szHead;
+
+  p = m_szMid;
+  *p++ = ' ';
+  AppendUnsigned(p, cx); *p++ = ' ';
+  AppendUnsigned(p, cy);
+  Append(p, ring.flat? ")\" ": square? ")\"><rect ": ")\"><ellipse ");
+
+  if(square){
+    Append(p, "width=\""); AppendUnsigned(p, ring.sw);
+    Append(p, "\" height=\""); AppendUnsigned(p, ring.sw);
+  } //if
+
+  else{
+    Append(p, "rx=\""); AppendFixed(p, FixedFromFloat(ring.r0));
+    Append(p, "\" ry=\""); AppendFixed(p, FixedFromFloat(ring.r1));
+    Append(p, "\" ");
+  } //else
+
+  m_nMid = p - m_szMid;
+} //constructor
+
+/// \brief Draw one element of the ring.
+///
+/// \param output Output stream.
+/// \param i Element index about circle.
+/// \param theta Angle to element, from FixedElementAngle() or CFixedAngle.
+/// \param parity Element parity.
+
+void CFixedRing::Draw(COutput& output, size_t i, int64_t theta,
+  bool parity) const
+{
+  const bool square = m_ring.shape == Shape::Square; //shape is square
+  int32_t s, c; //sine and cosine
+  FixedSinCos((uint32_t)theta, s, c);
+
+  int64_t phi = Round(theta*360, 16); //orientation in degrees
+  if(square)phi += (parity? 12: -12)*((int64_t)1 << 16);
+  else phi += (int64_t)90 << 16;
+
+  char buffer[256]; //element text
+  char* p = buffer; //end of element text
+
+  memcpy(p, m_szHead, m_nHead);
+  p += m_nHead;
+  AppendFixed(p, MulTrig(m_nRadius, c) + m_nHalf); *p++ = ' ';
+  AppendFixed(p, MulTrig(m_nRadius, s) + m_nHalf);
+  Append(p, ")rotate(");
+  AppendFixed(p, phi);
+  memcpy(p, m_szMid, m_nMid);
+  p += m_nMid;
+
+  if(square)
+    Append(p, (i & 1)? "\" class=\"b\"": "\" class=\"w\"");
+
+  else{
+    const size_t j = i%4; //position in pattern of four
+
+    if((parity && j == 0) || (!parity && j == 2))
+      Append(p, "class=\"b\"");
+    else if((parity && j == 2) || (!parity && j == 0))
+      Append(p, "class=\"w\"");
+  } //else
+
+  Append(p, m_ring.flat? "/>\n": "/></g>\n");
+  output.Write(buffer, p - buffer);
+} //Draw
+
+/// \brief Draw one element in fixed point.
+///
+/// The fixed-point equivalent of DrawElement(), with the same SVG tags, but
+/// with the numbers formatted by integer arithmetic so that the output is
+/// the same on every platform.
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param ring Ring descriptor.
+/// \param i Element index about circle.
+/// \param parity Element parity.
+
+void DrawFixedElement(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  size_t i, bool parity)
+{
+  CFixedRing(ring, cx, cy).Draw(output, i, FixedElementAngle(ring, i),
+    parity);
+} //DrawFixedElement
+
+/// \brief Draw a ring in fixed point.
+///
+/// The fixed-point equivalent of DrawRing(). The text and numbers that are
+/// the same for every element are computed once, and the angle is stepped
+/// from one element to the next with CFixedAngle.
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param ring Ring descriptor.
+/// \param cancel Pointer to a cancellation flag, or `nullptr`.
+/// \return false if cancelled part way through.
+
+bool DrawFixedRing(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  const CCancel* cancel)
+{
+  const CFixedRing fixed(ring, cx, cy); //ring constants
+  CFixedAngle angle(ring); //angle to element
+  bool parity = ring.parity; //element parity
+
+  for(size_t i=0; i<ring.n; i++, angle.Next()){
+    if(i%CCancel::CHUNK == 0 && cancel != nullptr && cancel->Cancelled())
+      return false;
+
+    fixed.Draw(output, i, angle.Angle(), parity);
+    if(ring.shape == Shape::Ellipse && i == ring.flip)parity = !parity;
+  } //for
+
+  return true;
+} //DrawFixedRing
+
+#pragma endregion geometry
+
+//////////////////////////////////////////////////////////////////////////
+// Differential test.
+
+#pragma region bench
+
+/// \brief Compare fixed-point geometry with float geometry.
+///
+/// The parameters are optionally `-reps n` (default 200) followed by a job
+/// as described in ParseJob(); without a job, the illusions `output1.svg`
+/// and `output2.svg` are used. First FixedSinCos() is compared with `sinf`
+/// and `cosf` at a million angles, both measured against `sin` and `cos`
+/// in double precision. Then for each job every element is placed with both
+/// PlaceFixed() and PlaceSquare() or PlaceEllipse(), and the largest
+/// differences in position and orientation are reported, along with the
+/// number of elements whose SVG differs, the time to place and draw all
+/// elements both ways, and the XXH64 of the fixed-point SVG, which should
+/// be the same on every machine. The check fails if any position or
+/// orientation differs by 0.05 or more, half of the last printed digit.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 if the differences are within bounds, 1 if not or for failure.
+
+int BenchFixedCommand(size_t argc, const char* const argv[]){
+  size_t reps = 200; //number of repetitions
+  std::vector<Job> jobs; //jobs to compare
+
+  if(argc >= 2 && !strcmp(argv[0], "-reps")){
+    reps = (size_t)strtoul(argv[1], nullptr, 10);
+    argc -= 2; argv += 2;
+  } //if
+
+  if(argc > 0){
+    jobs.push_back(Job());
+
+    if(!ParseJob(jobs[0], argc, argv) || reps == 0){
+      printf("Expected [-reps n] [job]\n");
+      return 1;
+    } //if
+  } //if
+
+  else BenchJobs(jobs);
+
+  const size_t ANGLES = 1 << 20; //number of angles to test
+  double fixederr = 0, floaterr = 0; //largest trig errors
+
+  for(size_t k=0; k<ANGLES; k++){
+    const uint32_t theta = (uint32_t)(k*4096 + k%4093); //angle
+    const double t = theta*(2*3.14159265358979323846/4294967296.0); //radians
+    int32_t s, c; //fixed-point sine and cosine
+    FixedSinCos(theta, s, c);
+
+    fixederr = std::max(fixederr, fabs(s/1073741824.0 - sin(t)));
+    fixederr = std::max(fixederr, fabs(c/1073741824.0 - cos(t)));
+    const double f = (float)t; //angle rounded to float
+    floaterr = std::max(floaterr, fabs((double)sinf((float)f) - sin(f)));
+    floaterr = std::max(floaterr, fabs((double)cosf((float)f) - cos(f)));
+  } //for
+
+  printf("Largest error in sine and cosine at %zu angles: fixed %0.2e, "
+    "float %0.2e\n", ANGLES, fixederr, floaterr);
+
+  double ttrig[2] = {0}; //time for fixed and float sine and cosine
+  volatile int64_t trigsink = 0; //so that the trig isn't optimized away
+
+  for(size_t k=0; k<2; k++){
+    CTimer timer; //stopwatch
+    int64_t sum = 0; //sum of results
+
+    for(size_t j=0; j<ANGLES; j++){
+      const uint32_t theta = (uint32_t)(j*4096 + j%4093); //angle
+
+      if(k == 0){
+        int32_t s, c; //fixed-point sine and cosine
+        FixedSinCos(theta, s, c);
+        sum += s + c;
+      } //if
+
+      else{
+        const float t = theta*(2*3.14159265f/4294967296.0f); //radians
+        sum += (int64_t)(1073741824.0f*(sinf(t) + cosf(t)));
+      } //else
+    } //for
+
+    trigsink = trigsink + sum;
+    ttrig[k] = timer.Elapsed()/ANGLES;
+  } //for
+
+  printf("Sine and cosine: fixed %0.1f ns, sinf and cosf %0.1f ns\n",
+    1e9*ttrig[0], 1e9*ttrig[1]);
+
+  bool ok = true; //within bounds
+
+  for(const Job& job: jobs){
+    Illusion illusion; //illusion descriptor
+    Describe(illusion, job);
+    const size_t n = ElementCount(illusion); //number of elements
+
+    double dxy = 0, dphi = 0; //largest differences
+    size_t differ = 0; //number of elements with different SVG
+    size_t stepped = 0; //number of stepped angles that are wrong
+
+    for(Ring ring: illusion.rings){
+      float theta = ring.theta; //angle to element
+      bool parity = ring.parity; //element parity
+      CFixedAngle angle(ring); //stepped angle to element
+
+      for(size_t i=0; i<ring.n; i++, angle.Next()){
+        if(angle.Angle() != FixedElementAngle(ring, i))stepped++;
+
+        float x, y, phi; //float placement
+        FixedPlace place; //fixed-point placement
+
+        if(ring.shape == Shape::Square)
+          PlaceSquare(ring.r, parity, theta, x, y, phi);
+        else PlaceEllipse(ring.r, theta, x, y, phi);
+
+        PlaceFixed(ring, i, parity, place);
+
+        dxy = std::max(dxy, fabs(x - place.x/65536.0));
+        dxy = std::max(dxy, fabs(y - place.y/65536.0));
+        dphi = std::max(dphi, fabs(phi - place.phi/65536.0));
+
+        std::string a, b; //float and fixed SVG
+        COutput outa(a), outb(b); //output streams
+        ring.geometry = Geometry::Float;
+        DrawElement(outa, illusion.cx, illusion.cy, ring, i, theta, parity);
+        ring.geometry = Geometry::Fixed;
+        DrawElement(outb, illusion.cx, illusion.cy, ring, i, theta, parity);
+        outa.Close(); outb.Close();
+        if(a != b)differ++;
+
+        NextElement(ring, i, theta, parity);
+      } //for
+    } //for
+
+    if(dxy >= 0.05 || dphi >= 0.05 || stepped > 0)ok = false;
+
+    double t[4] = {0}; //place float, place fixed, draw float, draw fixed
+    volatile int64_t sink = 0; //so that placement isn't optimized away
+
+    for(size_t k=0; k<4; k++){
+      Illusion copy = illusion; //illusion with geometry selected
+      SetGeometry(copy, k == 3? Geometry::Fixed: Geometry::Float);
+
+      CTimer timer; //stopwatch
+
+      for(size_t rep=0; rep<reps; rep++)
+        if(k < 2){
+          for(const Ring& ring: copy.rings){
+            float theta = ring.theta; //angle to element
+            bool parity = ring.parity; //element parity
+            CFixedAngle angle(ring); //fixed-point angle to element
+            const int64_t r = FixedFromFloat(ring.r); //fixed-point radius
+
+            for(size_t i=0; i<ring.n; i++, angle.Next()){
+              if(k == 0){
+                float x, y, phi; //float placement
+
+                if(ring.shape == Shape::Square)
+                  PlaceSquare(ring.r, parity, theta, x, y, phi);
+                else PlaceEllipse(ring.r, theta, x, y, phi);
+
+                sink = sink + (int64_t)x;
+              } //if
+
+              else{
+                FixedPlace place; //fixed-point placement
+                PlaceFixed(ring, r, angle.Angle(), parity, place);
+                sink = sink + place.x;
+              } //else
+
+              NextElement(ring, i, theta, parity);
+            } //for
+          } //for
+        } //if
+
+        else{
+          COutput count; //count-only output
+          DrawIllusion(count, copy);
+        } //else
+
+      t[k] = timer.Elapsed()/reps/n;
+    } //for
+
+    std::string svg; //fixed-point SVG
+    Job fixedjob = job; //job with fixed-point geometry
+    fixedjob.geometry = Geometry::Fixed;
+    COutput output(svg); //output stream for SVG
+    DrawJob(output, fixedjob);
+    output.Close();
+
+    CXXHash64 hash; //hash of fixed-point SVG
+    hash.Update(svg.data(), svg.size());
+
+    printf("%s: %zu elements\n", job.fname.c_str(), n);
+    printf("  largest difference %0.5f px, %0.5f degrees\n", dxy, dphi);
+    printf("  %zu elements (%0.2f%%) differ in the SVG\n", differ,
+      100.0*differ/n);
+    if(stepped > 0)printf("  %zu stepped angles are wrong\n", stepped);
+    printf("  place: float %0.1f ns, fixed %0.1f ns per element\n", 1e9*t[0],
+      1e9*t[1]);
+    printf("  draw:  float %0.1f ns, fixed %0.1f ns per element\n", 1e9*t[2],
+      1e9*t[3]);
+    printf("  fixed-point SVG %zu bytes, XXH64 %s\n", svg.size(),
+      HexHash(hash.Digest()).c_str());
+  } //for
+
+  if(!ok)printf("Differences are out of bounds\n");
+  return ok? 0: 1;
+} //BenchFixedCommand
+
+#pragma endregion bench
@@ -0,0 +1,83 @@
+/// \file Fixed.h
+
+/// \brief Interface for fixed-point geometry.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Fixed_h__
+#define __Fixed_h__
+
+#include <stdint.h>
+
+#include "Illusion.h"
+
+/// \brief Fixed-point element placement.
+///
+/// The position and orientation of one element in fixed point with 16
+/// fractional bits, as computed by PlaceFixed().
+
+struct FixedPlace{
+  int64_t x = 0; ///< Center x, relative to the image center.
+  int64_t y = 0; ///< Center y, relative to the image center.
+  int64_t phi = 0; ///< Orientation in degrees.
+}; //FixedPlace
+
+/// \brief Fixed-point angle stepper.
+///
+/// The angles to the elements of a ring in order, as computed by
+/// FixedElementAngle(), but with no division per element. For squares the
+/// angle to element `i` is \f$(2^{32}i + n/2)/n\f$ rounded down, which is
+/// kept as a quotient and a remainder and stepped by the quotient and
+/// remainder of \f$2^{32}/n\f$. For ellipses the angle delta is added.
+
+class CFixedAngle{
+  private:
+    bool m_bSquare = false; ///< Shape is square.
+    uint64_t m_nN = 1; ///< Number of elements in ring.
+    uint64_t m_nQuotient = 0; ///< Quotient of a full turn by n.
+    uint64_t m_nRemainder = 0; ///< Remainder of a full turn by n.
+    int64_t m_nDelta = 0; ///< Angle delta between ellipses.
+    int64_t m_nAngle = 0; ///< Angle to current element.
+    uint64_t m_nRem = 0; ///< Remainder of current square angle.
+
+  public:
+    CFixedAngle(const Ring& ring, size_t i=0); ///< Constructor.
+    int64_t Angle() const; ///< Angle to current element.
+    void Next(); ///< Step to the next element.
+}; //CFixedAngle
+
+void FixedSinCos(uint32_t theta, int32_t& s, int32_t& c);
+int64_t FixedAngle(float theta);
+int64_t FixedFromFloat(float x);
+int64_t FixedElementAngle(const Ring& ring, size_t i);
+void PlaceFixed(const Ring& ring, size_t i, bool parity, FixedPlace& place);
+void PlaceFixed(const Ring& ring, int64_t r, int64_t theta, bool parity,
+  FixedPlace& place);
+void DrawFixedElement(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  size_t i, bool parity);
+bool DrawFixedRing(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  const CCancel* cancel=nullptr);
+
+int BenchFixedCommand(size_t argc, const char* const argv[]);
+
+#endif //__Fixed_h__
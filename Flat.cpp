@@ -0,0 +1,259 @@
+/// \file Flat.cpp
+
+/// \brief Code for comparing grouped and flat elements.
+///
+/// Each element is normally written as a `rect` or `ellipse` inside a `g`
+/// tag that has its transform. SVG allows the transform on the element
+/// itself, which renders the same with half as many nodes and fewer bytes.
+/// The flat mode of FormatSquare() and FormatEllipse() does that. This file
+/// checks that the two are equivalent and measures the difference in
+/// size, in time to write, and in time for a reader to parse.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Flat.h"
+#include "Illusion.h"
+#include "Perf.h"
+#include "Timer.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// Parsing.
+
+#pragma region parsing
+
+/// \brief Document node.
+///
+/// One node of the tree built by ParseSvg(), with the allocations that a
+/// reader building a document object model would make.
+
+struct Node{
+  std::string name; ///< Tag name.
+  std::vector<std::pair<std::string, std::string>> attributes; ///< Attributes.
+  size_t parent = 0; ///< Index of parent node, or the node itself if root.
+}; //Node
+
+/// \brief Parse SVG into a tree of nodes.
+///
+/// A stand-in for what a browser or other reader does with the SVG that we
+/// write: tokenize the tags and build a node with a copy of its name and
+/// attributes for each one. It understands only as much XML as we write;
+/// the XML declaration, comments, and text are skipped.
+///
+/// \param svg SVG text.
+/// \param nodes [out] Nodes in document order.
+/// \return Number of attributes.
+
+static size_t ParseSvg(const std::string& svg, std::vector<Node>& nodes){
+  nodes.clear();
+  std::vector<size_t> open; //indices of open nodes
+  size_t attributes = 0; //number of attributes
+  const char* p = svg.c_str(); //current character
+
+  while((p = strchr(p, '<')) != nullptr){
+    if(p[1] == '?' || p[1] == '!' || p[1] == '/'){ //declaration, comment, end
+      if(p[1] == '/' && !open.empty())open.pop_back();
+      p = strchr(p, '>');
+      if(p == nullptr)break;
+      p++;
+      continue;
+    } //if
+
+    Node node; //new node
+    node.parent = open.empty()? nodes.size(): open.back();
+    const char* q = ++p; //end of name
+
+    while(*q && !isspace((unsigned char)*q) && *q != '/' && *q != '>')q++;
+    node.name.assign(p, q);
+    p = q;
+
+    bool closed = false; //tag closes itself
+
+    while(*p && *p != '>'){
+      if(*p == '/'){closed = true; p++; continue;}
+      if(isspace((unsigned char)*p)){p++; continue;}
+
+      const char* eq = strchr(p, '='); //end of attribute name
+      if(eq == nullptr || eq[1] != '"')return attributes;
+      const char* end = strchr(eq + 2, '"'); //end of attribute value
+      if(end == nullptr)return attributes;
+
+      node.attributes.emplace_back(std::string(p, eq),
+        std::string(eq + 2, end));
+      attributes++;
+      p = end + 1;
+    } //while
+
+    if(*p == '>')p++;
+    nodes.push_back(std::move(node));
+    if(!closed)open.push_back(nodes.size() - 1);
+  } //while
+
+  return attributes;
+} //ParseSvg
+
+/// \brief Move transforms from groups to elements.
+///
+/// Rewrite SVG drawn with grouped elements, each of which is
+/// `<g transform="t"><rect .../></g>` or the same with an `ellipse`, as
+/// `<rect transform="t" .../>`, leaving everything else alone. This is what
+/// the flat mode of FormatSquare() and FormatEllipse() should produce.
+///
+/// \param svg SVG text with grouped elements.
+/// \return SVG text with flat elements.
+
+std::string FlattenGroups(const std::string& svg){
+  static const std::string OPEN = "<g transform=\""; //start of group
+  static const std::string CLOSE = "/></g>"; //end of element and group
+  std::string flat; //result
+  flat.reserve(svg.size());
+  size_t pos = 0; //position in svg
+
+  while(true){
+    const size_t g = svg.find(OPEN, pos); //start of group
+    const size_t t = g + OPEN.size(); //start of transform
+    const size_t q = g == std::string::npos? g: svg.find('"', t); //its end
+    const size_t tag = q == std::string::npos? q: q + 2; //start of element
+    const size_t sp = tag == std::string::npos? tag: svg.find(' ', tag);
+    const size_t end = sp == std::string::npos? sp: svg.find(CLOSE, sp);
+
+    if(end == std::string::npos){ //no more groups
+      flat.append(svg, pos, std::string::npos);
+      return flat;
+    } //if
+
+    flat.append(svg, pos, g - pos); //before the group
+    flat.append(svg, tag, sp - tag); //element name
+    flat += " transform=\"";
+    flat.append(svg, t, q - t); //transform
+    flat += "\"";
+    flat.append(svg, sp, end - sp); //attributes
+    flat += "/>";
+    pos = end + CLOSE.size();
+  } //while
+} //FlattenGroups
+
+#pragma endregion parsing
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Compare grouped and flat elements.
+///
+/// The parameters are optionally `-reps n` (default 20) followed by a job
+/// as described in ParseJob(); without a job, the illusions `output1.svg`
+/// and `output2.svg` are used. For each job, the illusion is drawn with
+/// grouped elements and with flat elements, and for each the number of
+/// bytes and nodes, the time to write it to a file, and the time to parse
+/// it with ParseSvg() are reported. The fastest of the repetitions is used.
+/// The flat SVG is checked against the grouped SVG rewritten by
+/// FlattenGroups().
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 if the flat SVG matches, 1 if not or for failure.
+
+int BenchFlatCommand(size_t argc, const char* const argv[]){
+  size_t reps = 20; //number of repetitions
+  std::vector<Job> jobs; //jobs to compare
+
+  if(argc >= 2 && !strcmp(argv[0], "-reps")){
+    reps = (size_t)strtoul(argv[1], nullptr, 10);
+    argc -= 2; argv += 2;
+  } //if
+
+  if(argc > 0){
+    jobs.push_back(Job());
+
+    if(!ParseJob(jobs[0], argc, argv) || reps == 0){
+      printf("Expected [-reps n] [job]\n");
+      return 1;
+    } //if
+  } //if
+
+  else BenchJobs(jobs);
+
+  bool ok = true; //flat SVG matches
+
+  for(Job job: jobs){
+    printf("%s:\n", job.fname.c_str());
+    printf("  %-8s %9s %7s %10s %9s %9s\n", "mode", "bytes", "nodes",
+      "attributes", "write ms", "parse ms");
+
+    const std::string fname = job.fname; //file name without extension
+    std::string svg[2]; //grouped and flat SVG
+
+    for(int flat=0; flat<2; flat++){
+      job.flat = flat != 0;
+      job.fname = fname + (flat? "-flat": "-grouped");
+      double write = INFINITY, parse = INFINITY; //fastest times
+
+      COutput output(svg[flat]); //output stream
+      DrawJob(output, job);
+      output.Close();
+
+      std::vector<Node> nodes; //parsed nodes
+      size_t attributes = 0; //number of attributes
+
+      for(size_t rep=0; rep<reps; rep++){
+        CTimer timer; //stopwatch
+
+        if(!RenderJob(job)){
+          printf("Cannot write %s.svg\n", job.fname.c_str());
+          return 1;
+        } //if
+
+        write = std::min(write, timer.Elapsed());
+
+        timer.Start();
+        attributes = ParseSvg(svg[flat], nodes);
+        parse = std::min(parse, timer.Elapsed());
+      } //for
+
+      remove((job.fname + ".svg").c_str());
+
+      printf("  %-8s %9zu %7zu %10zu %9.3f %9.3f\n", flat? "flat": "grouped",
+        svg[flat].size(), nodes.size(), attributes, 1000*write, 1000*parse);
+    } //for
+
+    const bool same = FlattenGroups(svg[0]) == svg[1]; //flat SVG matches
+    printf("  flat %s grouped with transforms moved\n",
+      same? "matches": "DOES NOT MATCH");
+    ok = ok && same;
+  } //for
+
+  return ok? 0: 1;
+} //BenchFlatCommand
+
+#pragma endregion commands
@@ -0,0 +1,533 @@
+/// \file Hash.cpp
+
+/// \brief Code for the streaming hashes CXXHash64 and CSha256.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Hash.h"
+#include "Illusion.h"
+#include "Perf.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// XXH64.
+
+#pragma region XXH64
+
+static const uint64_t P1 = 0x9E3779B185EBCA87ULL; ///< XXH64 prime 1.
+static const uint64_t P2 = 0xC2B2AE3D27D4EB4FULL; ///< XXH64 prime 2.
+static const uint64_t P3 = 0x165667B19E3779F9ULL; ///< XXH64 prime 3.
+static const uint64_t P4 = 0x85EBCA77C2B2AE63ULL; ///< XXH64 prime 4.
+static const uint64_t P5 = 0x27D4EB2F165667C5ULL; ///< XXH64 prime 5.
+
+/// \brief Rotate left.
+/// \param x Value.
+/// \param r Number of bits.
+/// \return `x` rotated left by `r` bits.
+
+static inline uint64_t Rotl(uint64_t x, int r){
+  return (x << r) | (x >> (64 - r));
+} //Rotl
+
+/// \brief Read 8 bytes, little-endian.
+/// \param p Pointer to bytes.
+/// \return 64-bit value.
+
+static inline uint64_t Read64(const unsigned char* p){
+  uint64_t x; //result
+  memcpy(&x, p, 8);
+  return x;
+} //Read64
+
+/// \brief Read 4 bytes, little-endian.
+/// \param p Pointer to bytes.
+/// \return 32-bit value.
+
+static inline uint32_t Read32(const unsigned char* p){
+  uint32_t x; //result
+  memcpy(&x, p, 4);
+  return x;
+} //Read32
+
+/// \brief Add 8 bytes to a lane.
+/// \param acc Lane accumulator.
+/// \param x 8 bytes of input.
+/// \return New lane accumulator.
+
+static inline uint64_t Round(uint64_t acc, uint64_t x){
+  acc += x*P2;
+  return Rotl(acc, 31)*P1;
+} //Round
+
+/// \brief Merge a lane into the hash.
+/// \param h Hash.
+/// \param x Lane accumulator.
+/// \return New hash.
+
+static inline uint64_t Merge(uint64_t h, uint64_t x){
+  h ^= Round(0, x);
+  return h*P1 + P4;
+} //Merge
+
+/// \param seed Seed.
+
+CXXHash64::CXXHash64(uint64_t seed): m_nSeed(seed){
+  Reset();
+} //constructor
+
+void CXXHash64::Reset(){
+  m_nLane[0] = m_nSeed + P1 + P2;
+  m_nLane[1] = m_nSeed + P2;
+  m_nLane[2] = m_nSeed;
+  m_nLane[3] = m_nSeed - P1;
+  m_nBuffered = 0;
+  m_nTotal = 0;
+} //Reset
+
+/// \param p Pointer to bytes.
+/// \param n Number of bytes.
+
+void CXXHash64::Update(const void* p, size_t n){
+  const unsigned char* s = (const unsigned char*)p; //next byte
+  m_nTotal += n;
+
+  if(m_nBuffered + n < 32){ //not enough for a stripe
+    memcpy(m_pBuffer + m_nBuffered, s, n);
+    m_nBuffered += n;
+    return;
+  } //if
+
+  if(m_nBuffered > 0){ //finish the buffered stripe
+    const size_t k = 32 - m_nBuffered; //bytes needed
+    memcpy(m_pBuffer + m_nBuffered, s, k);
+    s += k;
+    n -= k;
+
+    for(int i=0; i<4; i++)
+      m_nLane[i] = Round(m_nLane[i], Read64(m_pBuffer + 8*i));
+
+    m_nBuffered = 0;
+  } //if
+
+  uint64_t v0 = m_nLane[0], v1 = m_nLane[1]; //lanes in registers
+  uint64_t v2 = m_nLane[2], v3 = m_nLane[3];
+
+  for(; n>=32; s+=32, n-=32){ //whole stripes
+    v0 = Round(v0, Read64(s));
+    v1 = Round(v1, Read64(s + 8));
+    v2 = Round(v2, Read64(s + 16));
+    v3 = Round(v3, Read64(s + 24));
+  } //for
+
+  m_nLane[0] = v0; m_nLane[1] = v1;
+  m_nLane[2] = v2; m_nLane[3] = v3;
+
+  memcpy(m_pBuffer, s, n);
+  m_nBuffered = n;
+} //Update
+
+/// \return XXH64 of all bytes added since construction or the last reset.
+
+uint64_t CXXHash64::Digest() const{
+  uint64_t h; //result
+
+  if(m_nTotal >= 32){
+    h = Rotl(m_nLane[0], 1) + Rotl(m_nLane[1], 7) + Rotl(m_nLane[2], 12) +
+      Rotl(m_nLane[3], 18);
+
+    for(int i=0; i<4; i++)
+      h = Merge(h, m_nLane[i]);
+  } //if
+
+  else h = m_nSeed + P5;
+
+  h += m_nTotal;
+
+  const unsigned char* s = m_pBuffer; //next byte
+  size_t n = m_nBuffered; //bytes left
+
+  for(; n>=8; s+=8, n-=8){
+    h ^= Round(0, Read64(s));
+    h = Rotl(h, 27)*P1 + P4;
+  } //for
+
+  if(n >= 4){
+    h ^= (uint64_t)Read32(s)*P1;
+    h = Rotl(h, 23)*P2 + P3;
+    s += 4;
+    n -= 4;
+  } //if
+
+  for(; n>0; s++, n--){
+    h ^= (*s)*P5;
+    h = Rotl(h, 11)*P1;
+  } //for
+
+  h ^= h >> 33; h *= P2; //avalanche
+  h ^= h >> 29; h *= P3;
+  h ^= h >> 32;
+
+  return h;
+} //Digest
+
+#pragma endregion XXH64
+
+//////////////////////////////////////////////////////////////////////////
+// SHA-256.
+
+#pragma region SHA256
+
+/// \brief SHA-256 round constants.
+
+static const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+  0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+  0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+  0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+  0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+  0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+}; //K
+
+/// \brief Rotate right.
+/// \param x Value.
+/// \param r Number of bits.
+/// \return `x` rotated right by `r` bits.
+
+static inline uint32_t Rotr(uint32_t x, int r){
+  return (x >> r) | (x << (32 - r));
+} //Rotr
+
+CSha256::CSha256(){
+  Reset();
+} //constructor
+
+void CSha256::Reset(){
+  static const uint32_t H[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+    0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}; //initial
+
+  memcpy(m_nState, H, sizeof(H));
+  m_nBuffered = 0;
+  m_nTotal = 0;
+} //Reset
+
+/// \param p Pointer to 64 bytes.
+
+void CSha256::Block(const unsigned char* p){
+  uint32_t w[64]; //message schedule
+
+  for(int i=0; i<16; i++, p+=4)
+    w[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+      (uint32_t)p[2] << 8 | p[3];
+
+  for(int i=16; i<64; i++){
+    const uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^
+      (w[i - 15] >> 3);
+    const uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^
+      (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  } //for
+
+  uint32_t a = m_nState[0], b = m_nState[1], c = m_nState[2]; //working
+  uint32_t d = m_nState[3], e = m_nState[4], f = m_nState[5]; //variables
+  uint32_t g = m_nState[6], h = m_nState[7];
+
+  for(int i=0; i<64; i++){
+    const uint32_t t1 = h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) +
+      ((e & f) ^ (~e & g)) + K[i] + w[i];
+    const uint32_t t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) +
+      ((a & b) ^ (a & c) ^ (b & c));
+
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  } //for
+
+  m_nState[0] += a; m_nState[1] += b; m_nState[2] += c; m_nState[3] += d;
+  m_nState[4] += e; m_nState[5] += f; m_nState[6] += g; m_nState[7] += h;
+} //Block
+
+/// \param p Pointer to bytes.
+/// \param n Number of bytes.
+
+void CSha256::Update(const void* p, size_t n){
+  const unsigned char* s = (const unsigned char*)p; //next byte
+  m_nTotal += n;
+
+  if(m_nBuffered > 0){ //fill the buffered block
+    const size_t k = std::min(n, 64 - m_nBuffered); //bytes to buffer
+    memcpy(m_pBuffer + m_nBuffered, s, k);
+    m_nBuffered += k;
+    s += k;
+    n -= k;
+
+    if(m_nBuffered < 64)return;
+    Block(m_pBuffer);
+    m_nBuffered = 0;
+  } //if
+
+  for(; n>=64; s+=64, n-=64) //whole blocks
+    Block(s);
+
+  memcpy(m_pBuffer, s, n);
+  m_nBuffered = n;
+} //Update
+
+/// \return SHA-256 of all bytes added since construction or the last reset,
+/// as 64 hex digits.
+
+std::string CSha256::Digest() const{
+  CSha256 tail(*this); //copy to be padded
+  const uint64_t bits = m_nTotal*8; //message length in bits
+  unsigned char pad[72] = {0x80}; //padding and length
+
+  const size_t k = (m_nBuffered < 56? 56: 120) - m_nBuffered; //pad bytes
+
+  for(int i=0; i<8; i++)
+    pad[k + i] = (unsigned char)(bits >> (56 - 8*i));
+
+  tail.Update(pad, k + 8);
+
+  char s[65]; //result
+
+  for(int i=0; i<8; i++)
+    snprintf(s + 8*i, 9, "%08x", tail.m_nState[i]);
+
+  return s;
+} //Digest
+
+#pragma endregion SHA256
+
+//////////////////////////////////////////////////////////////////////////
+// Helper functions.
+
+#pragma region helpers
+
+/// \brief Hash a file.
+///
+/// \param fname File name including extension.
+/// \param size [out] File size in bytes.
+/// \return XXH64 of the file contents, or 0 if it cannot be read, in which
+/// case the size is set to `(size_t)-1`.
+
+uint64_t HashFile(const std::string& fname, size_t& size){
+  FILE* input = nullptr; //input file pointer
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&input, fname.c_str(), "rb");
+#else
+  input = fopen(fname.c_str(), "rb");
+#endif
+
+  size = (size_t)-1;
+  if(input == nullptr)return 0;
+
+  CXXHash64 hash; //streaming hash
+  char buffer[65536]; //read buffer
+  size_t n = 0; //number of bytes read
+  size = 0;
+
+  while((n = fread(buffer, 1, sizeof(buffer), input)) > 0){
+    hash.Update(buffer, n);
+    size += n;
+  } //while
+
+  fclose(input);
+  return hash.Digest();
+} //HashFile
+
+/// \brief Hash to hex.
+///
+/// \param hash Hash.
+/// \return Hash as 16 hex digits.
+
+std::string HexHash(uint64_t hash){
+  char s[17]; //result
+  snprintf(s, sizeof(s), "%016llx", (unsigned long long)hash);
+  return s;
+} //HexHash
+
+#pragma endregion helpers
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark.
+
+#pragma region bench
+
+/// \brief Check the hashes against known answers.
+///
+/// XXH64 with seed 0 and SHA-256 are checked on the empty string, on
+/// `abc`, and on 1000 bytes counting up modulo 251, which spans many XXH64
+/// stripes and SHA-256 blocks and is fed to the hashes in uneven pieces so
+/// that the streaming code is exercised too. The expected digests come from
+/// the reference implementations.
+///
+/// \return true if every digest matches.
+
+static bool KnownAnswers(){
+  std::string s[3] = {"", "abc", ""}; //inputs
+  for(size_t i=0; i<1000; i++)s[2] += (char)(i%251);
+
+  const uint64_t xx[3] = {0xef46db3751d8e999ULL, 0x44bc2cf5ad770999ULL,
+    0xf306f04aa88b54d3ULL}; //XXH64 of inputs
+
+  const char* sha[3] = {
+    "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+    "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+    "4e4c294b331f7a2099a379bec34b9f9fc03dc46ab465d998f4d683da53487e6d"
+  }; //SHA-256 of inputs
+
+  bool ok = true; //all digests match
+
+  for(size_t i=0; i<3; i++){
+    CXXHash64 hash; //streaming hash
+    CSha256 sha256; //streaming SHA-256
+
+    for(size_t a=0, len=1; a<s[i].size(); a+=len, len=len*3 + 1){
+      const size_t n = std::min(len, s[i].size() - a); //piece length
+      hash.Update(s[i].data() + a, n);
+      sha256.Update(s[i].data() + a, n);
+    } //for
+
+    if(hash.Digest() != xx[i] || sha256.Digest() != sha[i]){
+      printf("Known answer mismatch on %zu bytes\n", s[i].size());
+      ok = false;
+    } //if
+  } //for
+
+  return ok;
+} //KnownAnswers
+
+/// \brief Benchmark the cost of hashing on the write path.
+///
+/// The parameters are optionally `-reps n` (default 200) followed by a job
+/// as described in ParseJob(); without a job, the illusions `output1.svg`
+/// and `output2.svg` are used. Each job is drawn `n` times through COutput
+/// with no hash, with XXH64, and with XXH64 and SHA-256 hashing the bytes as
+/// they are flushed, both to a count-only output (to isolate the cost of
+/// hashing from that of the file system) and to a file in the current
+/// directory. The time per repetition and the overhead of hashing are
+/// reported, along with the speed of each hash on its own. Both hashes are
+/// first checked against known answers (see KnownAnswers()).
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchHashCommand(size_t argc, const char* const argv[]){
+  size_t reps = 200; //number of repetitions
+  std::vector<Job> jobs; //jobs to benchmark
+
+  if(argc >= 2 && !strcmp(argv[0], "-reps")){
+    reps = (size_t)strtoul(argv[1], nullptr, 10);
+    argc -= 2; argv += 2;
+  } //if
+
+  if(argc > 0){
+    jobs.push_back(Job());
+
+    if(!ParseJob(jobs[0], argc, argv) || reps == 0){
+      printf("Expected [-reps n] [job]\n");
+      return 1;
+    } //if
+  } //if
+
+  else BenchJobs(jobs);
+
+  if(!KnownAnswers())return 1;
+  printf("XXH64 and SHA-256 match their known answers\n");
+
+  const std::string fname = TempName("bench-hash") + ".svg"; //output file
+
+  for(const Job& job: jobs){
+    std::string svg; //SVG of job
+    COutput output(svg); //output stream for SVG
+    DrawJob(output, job);
+    output.Close();
+
+    printf("%s: %zu bytes, %zu reps\n", job.fname.c_str(), svg.size(), reps);
+    printf("  %-10s %-14s %10s %10s\n", "output", "hash", "us/rep",
+      "overhead");
+
+    for(size_t file=0; file<2; file++){
+      double base = 0; //time with no hash
+
+      for(size_t k=0; k<3; k++){
+        CTimer timer; //stopwatch
+
+        for(size_t rep=0; rep<reps; rep++){
+          CXXHash64 hash; //streaming hash
+          CSha256 sha; //streaming SHA-256
+          COutput out; //output stream
+          if(file == 1)out.Open(fname, true);
+          if(k > 0)out.SetHash(&hash, k == 2? &sha: nullptr);
+          DrawJob(out, job);
+        } //for
+
+        const double t = timer.Elapsed()/reps; //time per rep
+        if(k == 0)base = t;
+
+        const char* name[] = {"none", "XXH64", "XXH64+SHA-256"}; //hashes
+        printf("  %-10s %-14s %10.2f %+9.1f%%\n", file? "file": "count",
+          name[k], 1e6*t, 100*(t/base - 1));
+      } //for
+    } //for
+
+    CTimer timer; //stopwatch
+    volatile uint64_t sink = 0; //so that hashing isn't optimized away
+
+    for(size_t rep=0; rep<reps; rep++){
+      CXXHash64 hash; //streaming hash
+      hash.Update(svg.data(), svg.size());
+      sink ^= hash.Digest();
+    } //for
+
+    const double txx = timer.Elapsed(); //time for XXH64
+    timer.Start();
+
+    for(size_t rep=0; rep<reps; rep++){
+      CSha256 sha; //streaming SHA-256
+      sha.Update(svg.data(), svg.size());
+      sink ^= sha.Digest()[0];
+    } //for
+
+    const double tsha = timer.Elapsed(); //time for SHA-256
+    const double mb = (double)svg.size()*reps/1048576.0; //megabytes hashed
+
+    printf("  XXH64 %0.0f MB/s, SHA-256 %0.0f MB/s\n", mb/txx, mb/tsha);
+  } //for
+
+  remove(fname.c_str());
+  return 0;
+} //BenchHashCommand
+
+#pragma endregion bench
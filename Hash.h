@@ -0,0 +1,95 @@
+/// \file Hash.h
+
+/// \brief Interface for the streaming hash CXXHash64.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Hash_h__
+#define __Hash_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+/// \brief Streaming 64-bit hash.
+///
+/// An implementation of the XXH64 non-cryptographic hash function, which
+/// processes 32 bytes at a time in four independent lanes. Bytes can be
+/// added a few at a time as they are written, and the result is the same
+/// as if they had been hashed all at once.
+
+class CXXHash64{
+  private:
+    uint64_t m_nLane[4]; ///< Accumulators for the four lanes.
+    unsigned char m_pBuffer[32]; ///< Bytes not yet added to the lanes.
+    size_t m_nBuffered = 0; ///< Number of bytes in buffer.
+    uint64_t m_nTotal = 0; ///< Total number of bytes hashed.
+    uint64_t m_nSeed = 0; ///< Seed.
+
+  public:
+    CXXHash64(uint64_t seed=0); ///< Constructor.
+
+    void Reset(); ///< Start again.
+    void Update(const void* p, size_t n); ///< Hash more bytes.
+    uint64_t Digest() const; ///< Hash of bytes so far.
+}; //CXXHash64
+
+/// \brief Streaming SHA-256.
+///
+/// An implementation of the SHA-256 cryptographic hash function (FIPS
+/// 180-4), for when an output's hash has to stand up to someone trying to
+/// forge it, which XXH64 can't. It is roughly ten times slower than
+/// CXXHash64, so it is optional wherever it is used.
+
+class CSha256{
+  private:
+    uint32_t m_nState[8]; ///< Hash state.
+    unsigned char m_pBuffer[64]; ///< Bytes not yet added to the state.
+    size_t m_nBuffered = 0; ///< Number of bytes in buffer.
+    uint64_t m_nTotal = 0; ///< Total number of bytes hashed.
+
+    void Block(const unsigned char* p); ///< Add a 64-byte block.
+
+  public:
+    CSha256(); ///< Constructor.
+
+    void Reset(); ///< Start again.
+    void Update(const void* p, size_t n); ///< Hash more bytes.
+    std::string Digest() const; ///< Hash of bytes so far in hex.
+}; //CSha256
+
+/// \brief Digest of an output file.
+
+struct Digest{
+  size_t size = 0; ///< Size in bytes.
+  uint64_t hash = 0; ///< XXH64 hash.
+  std::string sha256; ///< SHA-256 hash in hex, or empty if not computed.
+}; //Digest
+
+uint64_t HashFile(const std::string& fname, size_t& size);
+std::string HexHash(uint64_t hash);
+
+int BenchHashCommand(size_t argc, const char* const argv[]);
+
+#endif //__Hash_h__
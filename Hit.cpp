@@ -0,0 +1,443 @@
+/// \file Hit.cpp
+
+/// \brief Code for the hit tester CHitTester.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "Hit.h"
+#include "Crop.h"
+#include "Perf.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <random>
+
+static const double TWO_PI = 6.28318530717958647692; ///< Two pi.
+
+//////////////////////////////////////////////////////////////////////////
+// Exact test.
+
+#pragma region exact
+
+/// \brief Test whether a point is on an element.
+///
+/// Undo the element's translation and its rotation about the image center
+/// to put the point in the frame in which the `rect` or `ellipse` is drawn,
+/// then test it against the square, including half the width of its
+/// stroke, or the ellipse. Blank ellipses are invisible, so they are never
+/// hit.
+///
+/// \param ring Ring descriptor.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param i Element index about circle.
+/// \param theta Angle to element.
+/// \param parity Element parity.
+/// \param x Point x.
+/// \param y Point y.
+/// \param cls [out] SVG class of the element, if it is hit.
+/// \return true if the point is on the element.
+
+bool HitElement(const Ring& ring, size_t cx, size_t cy, size_t i,
+  float theta, bool parity, double x, double y, char& cls)
+{
+  const bool square = ring.shape == Shape::Square; //shape is square
+
+  if(square)cls = (i & 1)? 'b': 'w';
+
+  else{
+    const size_t j = i%4; //position in pattern of four
+    if((parity && j == 0) || (!parity && j == 2))cls = 'b';
+    else if((parity && j == 2) || (!parity && j == 0))cls = 'w';
+    else return false; //blank
+  } //else
+
+  double tx, ty, phi; //translation and orientation
+  PlaceElement(ring, i, theta, parity, tx, ty, phi);
+
+  if(square){
+    tx += ring.sw/2.0;
+    ty += ring.sw/2.0;
+  } //if
+
+  const double a = phi*TWO_PI/360; //orientation in radians
+  const double ux = x - tx - cx, uy = y - ty - cy; //point less translation
+  const double u = ux*cos(a) + uy*sin(a); //rotated back
+  const double v = uy*cos(a) - ux*sin(a);
+
+  if(square)
+    return -1.5 <= u && u <= ring.sw + 1.5 && -1.5 <= v && v <= ring.sw + 1.5;
+
+  const double p = u/ring.r0, q = v/ring.r1; //in units of the radii
+  return p*p + q*q <= 1;
+} //HitElement
+
+/// \brief Angle to an element.
+///
+/// DrawRing() adds the angle delta once per element, so the angle it draws
+/// element `i` at can only be found by doing the same `i` times. Here it is
+/// computed directly from the index instead. The two differ only by float
+/// rounding, which moves an element by less than a thousandth of a pixel,
+/// far less than the tenth of a pixel to which the SVG is written.
+///
+/// \param ring Ring descriptor.
+/// \param i Element index about circle.
+/// \return Angle to element.
+
+static float ElementAngle(const Ring& ring, size_t i){
+  return ring.theta + i*ring.dtheta;
+} //ElementAngle
+
+/// \brief Find the element under a point by looking at every element.
+///
+/// The reference for CHitTester::Query(). Every element of every ring is
+/// tested with HitElement(), and the last one hit, which is the one drawn
+/// on top, is the result. Angles come from ElementAngle() and parities are
+/// advanced with NextElement().
+///
+/// \param illusion Illusion descriptor.
+/// \param x Point x.
+/// \param y Point y.
+/// \param hit [out] Element hit, if any.
+/// \return true if an element was hit.
+
+bool HitExhaustively(const Illusion& illusion, double x, double y, Hit& hit){
+  bool found = false; //whether an element was hit
+
+  for(size_t k=0; k<illusion.rings.size(); k++){
+    const Ring& ring = illusion.rings[k]; //current ring
+    bool parity = ring.parity; //parity of current element
+
+    for(size_t i=0; i<ring.n; i++){
+      char cls; //SVG class
+
+      if(HitElement(ring, illusion.cx, illusion.cy, i, ElementAngle(ring, i),
+        parity, x, y, cls))
+      {
+        hit.ring = k;
+        hit.index = i;
+        hit.cls = cls;
+        found = true;
+      } //if
+
+      if(ring.shape == Shape::Ellipse && i == ring.flip)
+        parity = !parity; //as in NextElement()
+    } //for
+  } //for
+
+  return found;
+} //HitExhaustively
+
+#pragma endregion exact
+
+//////////////////////////////////////////////////////////////////////////
+// Hit tester.
+
+#pragma region tester
+
+/// Record the circle through the element centers of each ring (see
+/// RingCircle()) and the band of distances from the image center that its
+/// elements cover, and put each ring into the buckets for the bands of
+/// width `m_fBand` that it overlaps. The band width is the widest ring, so
+/// each ring is in at most two buckets, and as long as rings don't overlap
+/// each bucket has only a few rings. RingCircle() never gives a negative
+/// radius, but the range of buckets is clamped to the table anyway.
+///
+/// \param illusion Illusion descriptor.
+
+void CHitTester::Build(const Illusion& illusion){
+  m_illusion = illusion;
+  m_vCircles.clear();
+  m_vBuckets.clear();
+  m_fBand = 1;
+
+  double outer = 0; //largest distance reached
+
+  for(const Ring& ring: illusion.rings){
+    Circle circle; //ring geometry
+    RingCircle(ring, illusion.cx, illusion.cy, circle.ox, circle.oy,
+      circle.rho, circle.alpha);
+
+    circle.reach = ring.shape == Shape::Square? (ring.sw + 3)*0.7072:
+      std::max(fabs(ring.r0), fabs(ring.r1)); //as tested by HitElement()
+
+    const double width = circle.rho*ring.dtheta; //distance between elements
+    const double span = width > 0? circle.reach/width: ring.n; //neighbors
+    circle.span = 1 + (size_t)std::min(span, ring.n/2.0);
+
+    const double off = hypot(circle.ox - illusion.cx,
+      circle.oy - illusion.cy); //offset of circle from image center
+    m_fBand = std::max(m_fBand, 2*(circle.reach + off));
+    outer = std::max(outer, circle.rho + circle.reach + off);
+    m_vCircles.push_back(circle);
+  } //for
+
+  m_vBuckets.resize((size_t)(outer/m_fBand) + 1);
+
+  for(size_t k=0; k<m_vCircles.size(); k++){
+    const Circle& circle = m_vCircles[k]; //ring geometry
+    const double off = hypot(circle.ox - illusion.cx,
+      circle.oy - illusion.cy); //offset of circle from image center
+    const double lo = std::max(0.0, circle.rho - circle.reach - off); //inner
+    const double hi = std::max(0.0, circle.rho + circle.reach + off); //outer
+    const size_t last = m_vBuckets.size() - 1; //index of last bucket
+
+    for(size_t b=std::min((size_t)(lo/m_fBand), last);
+      b<=std::min((size_t)(hi/m_fBand), last); b++)
+        m_vBuckets[b].push_back(k);
+  } //for
+} //Build
+
+/// Look up the bucket for the point's distance from the image center. For
+/// each ring in it, latest drawn first, find the index of the element
+/// whose center is nearest in angle to the point and test it and its
+/// neighbors exactly with HitElement(), skipping any whose centers are out
+/// of reach. The first ring with a hit has the element drawn on top.
+///
+/// \param x Point x.
+/// \param y Point y.
+/// \param hit [out] Element hit, if any.
+/// \return true if an element was hit.
+
+bool CHitTester::Query(double x, double y, Hit& hit) const{
+  const double d = hypot(x - m_illusion.cx, y - m_illusion.cy); //distance
+  const size_t b = (size_t)(d/m_fBand); //bucket
+
+  if(b >= m_vBuckets.size())return false;
+
+  const std::vector<size_t>& bucket = m_vBuckets[b]; //rings in bucket
+
+  for(size_t k=bucket.size(); k-->0;){ //latest drawn first
+    const Ring& ring = m_illusion.rings[bucket[k]]; //current ring
+    const Circle& circle = m_vCircles[bucket[k]]; //its geometry
+    if(ring.n == 0 || !(ring.dtheta > 0))continue;
+
+    const double dx = x - circle.ox, dy = y - circle.oy; //point from center
+    const double dist = hypot(dx, dy); //distance from center
+    if(fabs(dist - circle.rho) > circle.reach)continue;
+
+    double psi = atan2(dy, dx) - circle.alpha - ring.theta; //angle past
+      //the center of the first element
+    psi -= TWO_PI*floor(psi/TWO_PI);
+
+    const double turn = TWO_PI/ring.dtheta; //elements per turn
+    const bool closed = fabs(ring.n - turn) < 0.5; //ring is a full circle
+    const size_t turns = closed? 1: (size_t)ceil(ring.n/turn); //turns
+    bool found = false; //whether an element was hit
+
+    for(size_t t=0; t<turns; t++){
+      const double c = floor((psi + t*TWO_PI)/ring.dtheta + 0.5); //nearest
+
+      for(double j=c - circle.span; j<=c + circle.span; j++){
+        double i = j; //index of element
+
+        if(closed)i -= ring.n*floor(i/ring.n);
+        else if(i < 0 || i >= ring.n)continue;
+
+        const size_t n = (size_t)i; //index of element
+        if(found && n <= hit.index)continue;
+
+        const double delta = psi + t*TWO_PI - j*ring.dtheta; //angle to center
+        const double d2 = dist*dist + circle.rho*circle.rho -
+          2*dist*circle.rho*cos(delta); //squared distance to center
+        if(d2 > circle.reach*circle.reach)continue;
+
+        const float theta = ElementAngle(ring, n); //angle to element
+        const bool parity = ring.shape == Shape::Ellipse && n > ring.flip?
+          !ring.parity: ring.parity; //parity of element
+        char cls; //SVG class
+
+        if(HitElement(ring, m_illusion.cx, m_illusion.cy, n, theta, parity,
+          x, y, cls))
+        {
+          hit.ring = bucket[k];
+          hit.index = n;
+          hit.cls = cls;
+          found = true;
+        } //if
+      } //for
+    } //for
+
+    if(found)return true;
+  } //for
+
+  return false;
+} //Query
+
+#pragma endregion tester
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Find the element under a point.
+///
+/// The parameters are the coordinates of a point in pixels followed by a
+/// job as described in ParseJob(). The ring, element index, and SVG class
+/// of the element drawn on top at that point are printed.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 if an element was hit, 1 if not or for failure.
+
+int HitCommand(size_t argc, const char* const argv[]){
+  char* end0 = nullptr; //end of x parsed
+  char* end1 = nullptr; //end of y parsed
+  Job job; //job descriptor
+
+  const double x = argc >= 2? strtod(argv[0], &end0): 0; //point x
+  const double y = argc >= 2? strtod(argv[1], &end1): 0; //point y
+
+  if(argc < 2 || *end0 != '\0' || *end1 != '\0' ||
+    !ParseJob(job, argc - 2, argv + 2))
+  {
+    printf("Expected <x> <y> <job>\n");
+    return 1;
+  } //if
+
+  Illusion illusion; //illusion descriptor
+  Describe(illusion, job);
+
+  CHitTester tester; //hit tester
+  tester.Build(illusion);
+  Hit hit; //element hit
+
+  if(!tester.Query(x, y, hit)){
+    printf("Nothing at (%g, %g)\n", x, y);
+    return 1;
+  } //if
+
+  printf("Ring %zu, element %zu, class %c at (%g, %g)\n", hit.ring,
+    hit.index, hit.cls, x, y);
+
+  return 0;
+} //HitCommand
+
+/// \brief Time hit tests against looking at every element.
+///
+/// The parameters are optionally `-queries n` (default one million)
+/// followed by a job as described in ParseJob(); without a job, the
+/// illusions `output1.svg` and `output2.svg` are used, along with two small
+/// illusions that have rings of negative radius (see NegativeRadiusJobs()).
+/// Random points in the image are tested with CHitTester::Query(), and as
+/// many of the same points as can be done in reasonable time with
+/// HitExhaustively(). The queries per second are reported for both, along
+/// with the number of points on which they disagree, which should be zero.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 if the two agree on every point, 1 if not or for failure.
+
+int BenchHitCommand(size_t argc, const char* const argv[]){
+  size_t queries = 1000000; //number of queries
+  std::vector<Job> jobs; //jobs to time
+
+  if(argc >= 2 && !strcmp(argv[0], "-queries")){
+    queries = (size_t)strtoul(argv[1], nullptr, 10);
+    argc -= 2; argv += 2;
+  } //if
+
+  if(argc > 0){
+    jobs.push_back(Job());
+
+    if(!ParseJob(jobs[0], argc, argv) || queries == 0){
+      printf("Expected [-queries n] [job]\n");
+      return 1;
+    } //if
+  } //if
+
+  else{
+    BenchJobs(jobs);
+    NegativeRadiusJobs(jobs);
+  } //else
+
+  bool ok = true; //hit tests agree
+
+  for(const Job& job: jobs){
+    Illusion illusion; //illusion descriptor
+    Describe(illusion, job);
+    const size_t n = ElementCount(illusion); //number of elements
+
+    std::mt19937_64 random(12345); //pseudorandom number generator
+    std::uniform_real_distribution<double> coord(0, (double)job.w); //point
+    std::vector<double> points(2*queries); //query points
+
+    for(double& p: points)
+      p = coord(random);
+
+    CTimer timer; //stopwatch
+    CHitTester tester; //hit tester
+    tester.Build(illusion);
+    const double tBuild = timer.Elapsed(); //time to build
+
+    std::vector<Hit> hits(queries); //hit test results
+    std::vector<bool> found(queries); //whether anything was hit
+    size_t count = 0; //number of hits
+    timer.Start();
+
+    for(size_t q=0; q<queries; q++){
+      const bool b = tester.Query(points[2*q], points[2*q + 1], hits[q]);
+      found[q] = b;
+      count += b;
+    } //for
+
+    const double tQuery = timer.Elapsed()/queries; //time per query
+
+    const size_t brute = std::min(queries,
+      std::max((size_t)100, (size_t)100000000/std::max(n, (size_t)1)));
+    size_t disagree = 0; //number of points decided differently
+    timer.Start();
+
+    for(size_t q=0; q<brute; q++){
+      Hit hit; //reference result
+      const bool b = HitExhaustively(illusion, points[2*q], points[2*q + 1],
+        hit);
+
+      if(b != found[q] || (b && (hit.ring != hits[q].ring ||
+        hit.index != hits[q].index || hit.cls != hits[q].cls)))disagree++;
+    } //for
+
+    const double tBrute = timer.Elapsed()/brute; //time per query
+
+    printf("%s: %zu elements in %zu rings, built in %0.3f ms\n",
+      job.fname.c_str(), n, illusion.rings.size(), 1000*tBuild);
+    printf("  hit test     %12.0f queries/s %10.1f ns  %0.1f%% hit\n",
+      1/tQuery, 1e9*tQuery, 100.0*count/queries);
+    printf("  brute force  %12.0f queries/s %10.1f ns  (%zu queries)\n",
+      1/tBrute, 1e9*tBrute, brute);
+    printf("  %0.0fx faster, %zu disagreements\n", tBrute/tQuery, disagree);
+
+    if(disagree > 0)ok = false;
+  } //for
+
+  return ok? 0: 1;
+} //BenchHitCommand
+
+#pragma endregion commands
@@ -0,0 +1,88 @@
+/// \file Hit.h
+
+/// \brief Interface for the hit tester CHitTester.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Hit_h__
+#define __Hit_h__
+
+#include <vector>
+
+#include "Illusion.h"
+
+/// \brief Result of a hit test.
+///
+/// The element under a point, identified by the index of its ring in
+/// drawing order and its index about the ring, and its SVG class.
+
+struct Hit{
+  size_t ring = 0; ///< Ring index.
+  size_t index = 0; ///< Element index about circle.
+  char cls = 0; ///< SVG class, `b` for dark or `w` for light.
+}; //Hit
+
+/// \brief Hit tester.
+///
+/// A hit tester finds the element under a point in constant time by
+/// inverting the geometry of the rings instead of looking at every element.
+/// The distance from the image center selects a bucket of rings that reach
+/// that distance, the angle about each ring's circle selects the elements
+/// that might be at that angle, and an exact test in each candidate
+/// element's own rotated frame decides. Building it takes time proportional
+/// to the number of rings, not elements.
+
+class CHitTester{
+  private:
+    /// \brief Ring geometry.
+    ///
+    /// The circle through the centers of a ring's elements and how far
+    /// the elements reach from it.
+
+    struct Circle{
+      double ox = 0; ///< Circle center x.
+      double oy = 0; ///< Circle center y.
+      double rho = 0; ///< Circle radius.
+      double alpha = 0; ///< Angle of element center minus angle to element.
+      double reach = 0; ///< Bounding radius of elements.
+      size_t span = 1; ///< Neighbors to test on each side.
+    }; //Circle
+
+    Illusion m_illusion; ///< Illusion descriptor.
+    std::vector<Circle> m_vCircles; ///< Geometry of each ring.
+    std::vector<std::vector<size_t>> m_vBuckets; ///< Rings in each band.
+    double m_fBand = 1; ///< Width of band of distances per bucket.
+
+  public:
+    void Build(const Illusion& illusion); ///< Build the tester.
+    bool Query(double x, double y, Hit& hit) const; ///< Test a point.
+}; //CHitTester
+
+bool HitElement(const Ring& ring, size_t cx, size_t cy, size_t i,
+  float theta, bool parity, double x, double y, char& cls);
+bool HitExhaustively(const Illusion& illusion, double x, double y, Hit& hit);
+
+int HitCommand(size_t argc, const char* const argv[]);
+int BenchHitCommand(size_t argc, const char* const argv[]);
+
+#endif //__Hit_h__
@@ -0,0 +1,375 @@
+/// \file Huge.cpp
+
+/// \brief Code for huge geometry.
+///
+/// The float geometry of DrawSquare() and DrawEllipse() breaks down in
+/// rings of billions of elements. The angle delta is so small that adding
+/// it to a float angle eventually stops changing it, and float coordinates
+/// at a radius of a billion pixels are multiples of 64 pixels. The huge
+/// geometry here computes the number of squares, the angle to each element,
+/// and its position in double precision directly from its index, with
+/// 64-bit counts throughout. Elements are streamed to the output one at a
+/// time, so memory use does not depend on the number of elements.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+
+#include "Huge.h"
+#include "Budget.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+static const double TWO_PI = 6.28318530717958647692; ///< Two pi.
+
+//////////////////////////////////////////////////////////////////////////
+// Geometry.
+
+#pragma region geometry
+
+/// \brief Number of squares in a huge circle of squares.
+///
+/// The same as SquareCount(), but computed in double precision, so that
+/// it is exact for circles of billions of squares.
+///
+/// \param r Circle radius in pixels.
+/// \param sw Square width and height.
+/// \return Number of squares, which is always even.
+
+size_t HugeSquareCount(double r, size_t sw){
+  if(!(r > 0) || sw == 0)return 0;
+
+  const double n = ceil(TWO_PI*r/(1.5*sw)); //number of squares
+  return n < 9e18? (size_t)n & ~(size_t)1: 0;
+} //HugeSquareCount
+
+/// \brief Angle to an element of a huge ring.
+///
+/// The angle is computed from the index rather than by adding up angle
+/// deltas. A ring whose elements go once around the circle, as all rings
+/// made by Describe() do, uses exactly `i/n` of a turn rather than the
+/// float angle delta, which is too coarse for billions of elements.
+///
+/// \param ring Ring descriptor.
+/// \param i Element index about circle.
+/// \return Angle to element in radians.
+
+double HugeElementAngle(const Ring& ring, size_t i){
+  const double d = ring.dtheta; //angle delta
+  const double n = (double)ring.n; //number of elements
+
+  if(fabs(n*d - TWO_PI) < 1e-3*TWO_PI)
+    return ring.theta + TWO_PI*(i/n);
+
+  return ring.theta + i*d;
+} //HugeElementAngle
+
+/// \brief Place an element of a huge ring.
+///
+/// The double equivalent of PlaceSquare() and PlaceEllipse(). The position
+/// is an offset from the image center, which is added in the SVG, so its
+/// precision doesn't depend on how large the image is.
+///
+/// \param ring Ring descriptor.
+/// \param i Element index about circle.
+/// \param parity Element parity.
+/// \param x [out] Center x, relative to the image center.
+/// \param y [out] Center y, relative to the image center.
+/// \param phi [out] Orientation in degrees.
+
+void PlaceHuge(const Ring& ring, size_t i, bool parity, double& x, double& y,
+  double& phi)
+{
+  const double theta = HugeElementAngle(ring, i); //angle to element
+  x = ring.r*cos(theta);
+  y = ring.r*sin(theta);
+
+  if(ring.shape == Shape::Square)
+    phi = 12*(parity? 1: -1) + 360*theta/TWO_PI;
+  else phi = 90 + 360*theta/TWO_PI;
+} //PlaceHuge
+
+/// \brief Draw an element of a huge ring.
+///
+/// The double equivalent of DrawSquare() and DrawEllipse(), writing the
+/// same tags in one call to COutput::Printf().
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param ring Ring descriptor.
+/// \param i Element index about circle.
+/// \param parity Element parity.
+
+void DrawHugeElement(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  size_t i, bool parity)
+{
+  double x, y, phi; //position and orientation
+  PlaceHuge(ring, i, parity, x, y, phi);
+
+  if(ring.shape == Shape::Square){
+    const double h = ring.sw/2.0; //half square width
+
+    output.Printf(ring.flat?
+      "<rect transform=\"translate(%0.1f %0.1f)rotate(%0.1f %zu %zu)\" "
+      "width=\"%zu\" height=\"%zu\" class=\"%c\"/>\n":
+      "<g transform=\"translate(%0.1f %0.1f)rotate(%0.1f %zu %zu)\">"
+      "<rect width=\"%zu\" height=\"%zu\" class=\"%c\"/></g>\n",
+      x + h, y + h, phi, cx, cy, ring.sw, ring.sw, (i & 1)? 'b': 'w');
+  } //if
+
+  else{
+    const size_t j = i%4; //position in pattern of four
+    const char* cls = ""; //class, if any
+
+    if((parity && j == 0) || (!parity && j == 2))cls = "class=\"b\"";
+    else if((parity && j == 2) || (!parity && j == 0))cls = "class=\"w\"";
+
+    output.Printf(ring.flat?
+      "<ellipse transform=\"translate(%0.1f %0.1f)rotate(%0.1f %zu %zu)\" "
+      "rx=\"%0.1f\" ry=\"%0.1f\" %s/>\n":
+      "<g transform=\"translate(%0.1f %0.1f)rotate(%0.1f %zu %zu)\">"
+      "<ellipse rx=\"%0.1f\" ry=\"%0.1f\" %s/></g>\n",
+      x, y, phi, cx, cy, ring.r0, ring.r1, cls);
+  } //else
+} //DrawHugeElement
+
+/// \brief Draw a huge ring.
+///
+/// The double equivalent of DrawRing(). Nothing is stored per element, so
+/// a ring of any size is drawn in constant memory.
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param ring Ring descriptor.
+/// \param cancel Pointer to a cancellation flag, or `nullptr`.
+/// \return false if cancelled part way through.
+
+bool DrawHugeRing(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  const CCancel* cancel)
+{
+  bool parity = ring.parity; //element parity
+
+  for(size_t i=0; i<ring.n; i++){
+    if(i%CCancel::CHUNK == 0 && cancel != nullptr && cancel->Cancelled())
+      return false;
+
+    DrawHugeElement(output, cx, cy, ring, i, parity);
+    if(ring.shape == Shape::Ellipse && i == ring.flip)parity = !parity;
+  } //for
+
+  return true;
+} //DrawHugeRing
+
+#pragma endregion geometry
+
+//////////////////////////////////////////////////////////////////////////
+// Stress test.
+
+#pragma region bench
+
+/// \brief Compare float and huge geometry on a ring of billions of squares.
+///
+/// Use a ring of radius 3 billion pixels and squares 2 pixels wide, which
+/// has more than \f$2^{32}\f$ squares. Report the number of squares given by
+/// HugeSquareCount() and by the old 32-bit mask, how far around the ring a
+/// float angle gets before adding the angle delta stops changing it, how
+/// coarse float coordinates are at that radius, and the largest error in
+/// the spacing of squares in huge geometry at the start, middle, and end
+/// of the ring.
+///
+/// \return true if the spacing error is less than a thousandth of a pixel.
+
+static bool CheckPrecision(){
+  const float r = 3e9f; //circle radius
+  const size_t sw = 2; //square width
+  const size_t n = HugeSquareCount(r, sw); //number of squares
+  const size_t masked = (size_t)ceil((2*PI*r)/(1.5f*sw)) & 0xFFFFFFFE; //old
+
+  printf("Ring of radius %0.0f with %zu-pixel squares:\n", r, sw);
+  printf("  %zu squares (%zu with a 32-bit mask)\n", n, masked);
+
+  const float dtheta = 2*PI/n; //float angle delta
+  float theta = 0; //float angle
+  size_t stall = 0; //index at which the float angle stops advancing
+
+  while(stall < n && theta + dtheta != theta){
+    theta += dtheta;
+    stall++;
+  } //while
+
+  printf("  float angles stop advancing after %zu squares, %0.4f%% of the "
+    "way around\n", stall, 100.0*stall/n);
+  printf("  float coordinates are multiples of %0.0f pixels at this radius\n",
+    nextafterf(r, 2*r) - r);
+
+  Ring ring; //huge ring
+  ring.r = r;
+  ring.sw = sw;
+  ring.n = n;
+  ring.dtheta = dtheta;
+  ring.geometry = Geometry::Huge;
+
+  const double chord = 2*ring.r*sin(TWO_PI/2/n); //expected spacing
+  double error = 0; //largest error in spacing
+
+  for(size_t i: {(size_t)0, n/2, n - 2}){
+    double x0, y0, x1, y1, phi; //positions of squares i and i + 1
+    PlaceHuge(ring, i, true, x0, y0, phi);
+    PlaceHuge(ring, i + 1, true, x1, y1, phi);
+    error = std::max(error, fabs(hypot(x1 - x0, y1 - y0) - chord));
+  } //for
+
+  printf("  huge geometry spacing %0.6f pixels, largest error %0.2e\n",
+    chord, error);
+
+  return error < 0.001;
+} //CheckPrecision
+
+/// \brief Stream a multi-gigabyte illusion.
+///
+/// The parameters are optionally `-gb g` (default 2), `-keep`, and a file
+/// name without extension (default `huge`). First CheckPrecision() compares
+/// float and huge geometry on a ring of billions of squares. Then a single
+/// huge ring of 24-pixel squares, large enough to make about `g` gigabytes
+/// of SVG, is written to the file, reporting the throughput and resident
+/// set size every tenth of the way, to show that both are steady. The file
+/// is deleted afterwards unless `-keep` is given.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchHugeCommand(size_t argc, const char* const argv[]){
+  double gb = 2; //gigabytes of SVG
+  bool keep = false; //keep the file
+  std::string fname = "huge"; //file name without extension
+  bool named = false; //file name given
+  bool ok = true; //parameters are good so far
+
+  for(size_t k=0; k<argc && ok; k++){
+    if(!strcmp(argv[k], "-gb") && k + 1 < argc)
+      ok = (gb = strtod(argv[++k], nullptr)) > 0;
+    else if(!strcmp(argv[k], "-keep"))keep = true;
+    else if(argv[k][0] != '-' && !named){
+      fname = argv[k];
+      named = true;
+    } //else if
+    else ok = false;
+  } //for
+
+  if(!ok){
+    printf("Expected [-gb g] [-keep] [fname]\n");
+    return 1;
+  } //if
+
+  ok = CheckPrecision();
+
+  const size_t sw = 24; //square width
+  Ring ring; //huge ring
+  ring.r = 1e6f;
+  ring.sw = sw;
+  ring.n = HugeSquareCount(ring.r, sw);
+  ring.dtheta = (float)(TWO_PI/ring.n);
+  ring.geometry = Geometry::Huge;
+
+  COutput sample; //count-only output stream for sampling element size
+  for(size_t i=0; i<1000; i++)
+    DrawHugeElement(sample, 0, 0, ring, i*(ring.n/1000), ring.parity);
+
+  const double bytes = gb*1073741824; //target SVG size
+  const double each = sample.Size()/1000.0 + 10; //bytes per element, roughly
+  ring.r = bytes/each*1.5*sw/TWO_PI;
+  ring.n = HugeSquareCount(ring.r, sw);
+  ring.dtheta = (float)(TWO_PI/ring.n);
+
+  const size_t w = 2*((size_t)ring.r + 2*sw); //image width
+  const size_t cx = w/2 - sw/2; //image center, as in DescribeIllusion1()
+  const std::string name = fname + ".svg"; //file name
+  COutput output; //output stream
+
+  if(!output.Open(name)){
+    printf("Cannot open %s\n", name.c_str());
+    return 1;
+  } //if
+
+  printf("Writing %s: %zu squares on a circle of radius %0.0f\n",
+    name.c_str(), ring.n, ring.r);
+  printf("  %5s %10s %9s %9s %12s %9s\n", "done", "MB", "s", "MB/s",
+    "elements/s", "RSS MB");
+
+  Illusion illusion; //illusion descriptor for the style tag
+  illusion.w = w;
+  illusion.cx = illusion.cy = cx;
+  illusion.dark = "black";
+  illusion.light = "white";
+  illusion.bgclr = "gray";
+
+  DrawHeader(output, w, w);
+  DrawStyle(output, illusion);
+
+  CTimer timer; //stopwatch
+  double last = 0; //time at end of previous tenth
+  size_t i = 0; //index of next element
+  size_t lastsize = output.Size(); //bytes at end of previous tenth
+
+  for(size_t tenth=1; tenth<=10; tenth++){
+    const size_t end = ring.n/10*tenth + (tenth == 10? ring.n%10: 0); //stop
+
+    for(; i<end; i++)
+      DrawHugeElement(output, cx, cx, ring, i, ring.parity);
+
+    const double t = timer.Elapsed(); //time so far
+    const double mb = (output.Size() - lastsize)/1048576.0; //megabytes
+
+    printf("  %4zu%% %10.1f %9.2f %9.1f %12.0f %9.1f\n", 10*tenth,
+      output.Size()/1048576.0, t, mb/(t - last), (ring.n/10)/(t - last),
+      ResidentBytes()/1048576.0);
+
+    last = t;
+    lastsize = output.Size();
+  } //for
+
+  CloseSVG(output);
+  const double t = timer.Elapsed(); //total time
+
+  printf("  %zu bytes in %0.2f s, %0.1f MB/s, peak RSS %0.1f MB\n",
+    output.Size(), t, output.Size()/1048576.0/t,
+    PeakResidentBytes()/1048576.0);
+
+  if(output.Error()){
+    printf("Error writing %s\n", name.c_str());
+    ok = false;
+  } //if
+
+  if(!keep)remove(name.c_str());
+  return ok? 0: 1;
+} //BenchHugeCommand
+
+#pragma endregion bench
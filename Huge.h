@@ -0,0 +1,43 @@
+/// \file Huge.h
+
+/// \brief Interface for huge geometry.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Huge_h__
+#define __Huge_h__
+
+#include "Illusion.h"
+
+size_t HugeSquareCount(double r, size_t sw);
+double HugeElementAngle(const Ring& ring, size_t i);
+void PlaceHuge(const Ring& ring, size_t i, bool parity, double& x, double& y,
+  double& phi);
+void DrawHugeElement(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  size_t i, bool parity);
+bool DrawHugeRing(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  const CCancel* cancel=nullptr);
+
+int BenchHugeCommand(size_t argc, const char* const argv[]);
+
+#endif //__Huge_h__
@@ -0,0 +1,1334 @@
+/// \file Illusion.cpp
+
+/// \brief Code for the optical illusion generators.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include "Illusion.h"
+#include "Fixed.h"
+#include "Huge.h"
+#include "Template.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+#ifdef _MSC_VER //Visual Studio
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+const float PI = 3.14159265358979323846f; ///< Pi.
+
+/// Generator version. This must be incremented whenever a change to the code
+/// changes the SVG written for any job, so that outputs made by an earlier
+/// version are no longer considered up to date (see JobHash()).
+
+const unsigned GENERATOR_VERSION = 1;
+
+//////////////////////////////////////////////////////////////////////////
+// Helper fuctions.
+
+#pragma region helpers
+
+/// \brief Draw SVG header.
+///
+/// Print the header tag and an open `svg` tag. The view box is normally the
+/// whole image, but it can be moved to show a crop of it, and the image can
+/// be displayed at a different size from the view box to scale it.
+/// \param output Output stream.
+/// \param w Image width.
+/// \param h Image height.
+/// \param x X coordinate of the left of the view box.
+/// \param y Y coordinate of the top of the view box.
+/// \param dw Display width, or 0 for the image width.
+/// \param dh Display height, or 0 for the image height.
+
+void DrawHeader(COutput& output, size_t w, size_t h, size_t x, size_t y,
+  size_t dw, size_t dh)
+{
+  output.Printf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"); //xml tag
+
+  output.Printf("<svg width=\"%zu\" height=\"%zu\" ", dw > 0? dw: w,
+    dh > 0? dh: h); //svg tag
+  output.Printf("viewBox=\"%zu %zu %zu %zu\" ", x, y, w, h);
+  output.Printf("xmlns=\"http://www.w3.org/2000/svg\">\n");
+    
+  output.Printf("<!-- Created by Ian Parberry -->\n"); //author comment
+} //DrawHeader
+
+/// \brief Open SVG file.
+///
+/// Open an SVG file for writing and print the header tag and an
+/// open `svg` tag using DrawHeader().
+/// \param output [out] Reference to output stream.
+/// \param fname File name without extension.
+/// \param w Image width.
+/// \param h Image height.
+/// \return true if open succeeded.
+
+bool OpenSVG(COutput& output, const std::string& fname, size_t w, size_t h){
+  if(output.Open(fname + ".svg")){ //write header to file
+    DrawHeader(output, w, h);
+    return true; //success
+  } //if
+
+  return false; //failure
+} //OpenSVG
+
+/// \brief Close SVG file.
+///
+/// Print a close `svg` tag and close the SVG file.
+/// \param output Reference to output stream.
+
+void CloseSVG(COutput& output){
+  if(output.IsOpen()){
+    output.Printf("</svg>\n"); //close the svg tag
+    output.Close();
+  } //if
+} //CloseSVG
+
+#pragma endregion helpers
+
+//////////////////////////////////////////////////////////////////////////
+// Optical Illusion 1 - circles of squares.
+
+#pragma region Illusion1
+
+/// \brief Number of squares in a circle of squares.
+///
+/// If the radius of the circle is `r`, the width of the squares is `sw`, and
+/// the squares are placed half a width apart, then the number of squares is
+/// the circumference divided by `1.5*sw`, rounded down to an even number.
+/// Only the lowest bit is cleared, so counts of \f$2^{32}\f$ or more are not
+/// truncated, but the count is computed in float, so above \f$2^{24}\f$ it
+/// is only approximate (see HugeSquareCount()).
+///
+/// \param r Circle radius in pixels.
+/// \param sw Square width and height.
+/// \return Number of squares, which is always even.
+
+size_t SquareCount(float r, size_t sw){
+  return (size_t)ceil((2*PI*r)/(1.5f*sw)) & ~(size_t)1;
+} //SquareCount
+
+/// \brief Place a square.
+///
+/// Compute the position and orientation of one square of a circle of
+/// squares, without drawing it.
+///
+/// \param r Circle radius in pixels.
+/// \param parity Square orientation parity.
+/// \param theta Angle to square.
+/// \param x [out] Square center x, relative to the image center.
+/// \param y [out] Square center y, relative to the image center.
+/// \param phi [out] Square orientation in degrees.
+
+void PlaceSquare(float r, bool parity, float theta, float& x, float& y,
+  float& phi)
+{
+  x = r*cosf(theta); //square center x
+  y = r*sinf(theta); //square center y
+  phi = 12*(parity? 1: -1) + 180*theta/PI; //square orientation
+} //PlaceSquare
+
+/// \brief Format a square that has been placed.
+///
+/// This function outputs an SVG `transform` and an SVG `rect` tag for one
+/// square of a circle of squares whose position and orientation have been
+/// computed by PlaceSquare(). Squares with odd index are black and squares
+/// with even index are white. The `rect` is normally wrapped in a group
+/// that has the transform, but if `flat` is true the transform is put on
+/// the `rect` itself, which renders the same with one node instead of two.
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param sw Square width and height.
+/// \param i Square index about circle.
+/// \param x Square center x, relative to the image center.
+/// \param y Square center y, relative to the image center.
+/// \param phi Square orientation in degrees.
+/// \param flat True to put the transform on the `rect` instead of a group.
+
+void FormatSquare(COutput& output, size_t cx, size_t cy, size_t sw, size_t i,
+  float x, float y, float phi, bool flat)
+{
+  output.Printf(flat? "<rect transform=\"translate(%0.1f %0.1f)":
+    "<g transform=\"translate(%0.1f %0.1f)",
+    x + sw/2.0f, y + sw/2.0f); //translate
+  output.Printf(flat? "rotate(%0.1f %zu %zu)\" ":
+    "rotate(%0.1f %zu %zu)\"><rect ", phi, cx, cy); //rotate
+  output.Printf("width=\"%zu\" height=\"%zu\" ", sw, sw); //rectangle
+
+  if(i&1)output.Printf("class=\"b\""); //black
+  else output.Printf("class=\"w\""); //white
+
+  output.Printf(flat? "/>\n": "/></g>\n"); //close rect tag and group
+} //FormatSquare
+
+/// \brief Draw a square to a file in SVG format.
+///
+/// This function places one square of a circle of squares with
+/// PlaceSquare() and outputs it with FormatSquare().
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param r Circle radius in pixels.
+/// \param sw Square width and height.
+/// \param parity Square orientation parity.
+/// \param i Square index about circle.
+/// \param theta Angle to square.
+/// \param flat True to put the transform on the `rect` instead of a group.
+
+void DrawSquare(COutput& output, size_t cx, size_t cy, float r, size_t sw,
+  bool parity, size_t i, float theta, bool flat)
+{
+  float x, y, phi; //square center and orientation
+  PlaceSquare(r, parity, theta, x, y, phi);
+  FormatSquare(output, cx, cy, sw, i, x, y, phi, flat);
+} //DrawSquare
+
+/// \brief Compile a template for squares.
+///
+/// Make a template that writes exactly what FormatSquare() does, with the
+/// image center and square width filled in. Its holes are the translation
+/// x and y, the orientation, and the class.
+///
+/// \param t [out] Template.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param sw Square width and height.
+/// \param flat True to put the transform on the `rect` instead of a group.
+
+void CompileSquare(CTemplate& t, size_t cx, size_t cy, size_t sw, bool flat){
+  t.Constant(flat? "<rect transform=\"translate(": "<g transform=\"translate(");
+  t.TenthsHole(); //x
+  t.Constant(" ");
+  t.TenthsHole(); //y
+  t.Constant(")rotate(");
+  t.TenthsHole(); //orientation
+  t.Constant(flat? " %zu %zu)\" ": " %zu %zu)\"><rect ", cx, cy);
+  t.Constant("width=\"%zu\" height=\"%zu\" class=\"", sw, sw);
+  t.TextHole(); //class
+  t.Constant(flat? "\"/>\n": "\"/></g>\n");
+} //CompileSquare
+
+/// \brief Draw a circle of squares to a file in SVG format.
+/// 
+/// This function outputs SVG `transform` and SVG `rect` tags to the output
+/// file, alternating between black and white. The squares are spaced apart by
+/// approximately half a square width and tilted slightly from the perpendicular
+/// to a line drawn from the center of the circle to the center of the square.
+/// The number of squares is chosen so as to fit the spacing constraint, 
+/// which need not be exact for the optical illusion to work. Each square
+/// is placed using PlaceSquare() and written with a template compiled once
+/// by CompileSquare(), which is faster than DrawSquare() and writes the
+/// same bytes. Used for optical illusion 1.
+///
+/// \image html OneRingOfSquares.svg height=240
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param r Circle radius in pixels.
+/// \param sw Square width and height.
+/// \param parity Square initial orientation parity.
+/// \param cancel Pointer to a cancellation flag, or `nullptr`.
+/// \param flat True to put the transforms on the `rect`s instead of groups.
+/// \return false if cancelled part way through.
+
+bool DrawCircleOfSquares(COutput& output, size_t cx, size_t cy, float r,
+  size_t sw, bool parity, const CCancel* cancel, bool flat)
+{
+  const size_t n = SquareCount(r, sw); //number of squares on circle
+
+  const float dtheta = 2*PI/n; //angle delta to next square
+  float theta = 0; //angle to current square
+
+  CTemplate square; //template for squares
+  CompileSquare(square, cx, cy, sw, flat);
+
+  for(size_t i=0; i<n; i++){ //for each square
+    if(i%CCancel::CHUNK == 0 && cancel != nullptr && cancel->Cancelled())
+      return false;
+
+    float x, y, phi; //square center and orientation
+    PlaceSquare(r, parity, theta, x, y, phi);
+
+    const float v[3] = {x + sw/2.0f, y + sw/2.0f, phi}; //tenths holes
+    const char* cls = (i&1)? "b": "w"; //black or white
+    square.Emit(output, v, &cls);
+
+    theta += dtheta; //next square
+  } //for
+
+  return true;
+} //DrawCircleOfSquares
+
+/// \brief Describe the first optical illusion.
+///
+/// The image consists of four concentric circles of tilted squares,
+/// alternating between light and dark squares. This function fills in
+/// an illusion descriptor with one ring descriptor for each call to
+/// DrawCircleOfSquares() that is required, alternating the parity of the
+/// squares from one circle to the next.
+///
+/// \param illusion [out] Illusion descriptor.
+/// \param w Width and height of image in pixels.
+/// \param n Number of circles.
+/// \param r0 Initial circle radius.
+/// \param dr Radius delta.
+/// \param sw Width of squares.
+/// \param dark A dark SVG color.
+/// \param light A light SVG color.
+/// \param bgclr A mid-range SVG color for the background.
+
+void DescribeIllusion1(Illusion& illusion, size_t w, size_t n, float r0,
+  float dr, size_t sw, const char dark[], const char light[],
+  const char bgclr[])
+{
+  illusion.kind = 1;
+  illusion.w = w;
+  illusion.cx = w/2 - sw/2; //center x coordinate
+  illusion.cy = illusion.cx; //center y coordinate
+  illusion.dark = dark;
+  illusion.light = light;
+  illusion.bgclr = bgclr;
+  illusion.rings.clear();
+
+  for(size_t i=0; i<n; i++){ //for each circle of squares
+    Ring ring;
+    ring.shape = Shape::Square;
+    ring.r = r0 + i*dr;
+    ring.sw = sw;
+    ring.n = SquareCount(ring.r, sw);
+    ring.dtheta = 2*PI/ring.n;
+    ring.parity = (i&1) != 0;
+    illusion.rings.push_back(ring);
+  } //for
+} //DescribeIllusion1
+
+/// \brief Draw the first optical illusion to a file in SVG format.
+/// 
+/// The image consists of four concentric circles of tilted squares,
+/// alternating between light and dark squares. This function calls
+/// DescribeIllusion1() to compute the ring descriptors and then
+/// DrawIllusion() to output the `style` tag, the background, and one circle
+/// of squares per ring descriptor.
+///
+/// \image html output1.svg height=250
+/// 
+/// \param fname File name without extension.
+/// \param w Width and height of image in pixels.
+/// \param n Number of circles.
+/// \param r0 Initial circle radius.
+/// \param dr Radius delta.
+/// \param sw Width of squares.
+/// \param dark A dark SVG color.
+/// \param light A light SVG color.
+/// \param bgclr A mid-range SVG color for the background.
+
+void OpticalIllusion1(const std::string& fname, size_t w, size_t n,
+  float r0, float dr, size_t sw, const char dark[], const char light[],
+  const char bgclr[])
+{
+  Illusion illusion; //illusion descriptor
+  DescribeIllusion1(illusion, w, n, r0, dr, sw, dark, light, bgclr);
+  COutput output; //output stream
+
+  if(OpenSVG(output, fname, w, w)){
+    printf("Optical illusion 1 to %s.svg\n", fname.c_str());
+    DrawIllusion(output, illusion);
+    CloseSVG(output); //clean up and exit
+  } //if
+} //OpticalIllusion1
+
+#pragma endregion Illusion1
+
+//////////////////////////////////////////////////////////////////////////
+// Optical Illusion 2 - circles of circles of ellipses.
+
+#pragma region Illusion2
+
+/// \brief Select ellipse color based on index.
+/// 
+/// If parity is true, ellipse is black when i%4=0, white when ji%4==2, and 
+/// blank when i%4==1 and i%4==3. If parity is false, black and white are
+/// flipped. This function outputs the appropriate class name, `class="b"` for
+/// black and `class="w"` for white, to the output file. Used for optical
+/// illusion 2.
+/// 
+/// \param output Output stream.
+/// \param i Ellipse index about circle.
+/// \param parity True if first ellipse is black, false if white.
+
+void SelectEllipseColor(COutput& output, size_t i, bool parity){
+  const size_t j = i%4;
+  if((parity && j == 0) || (!parity && j == 2))
+    output.Printf("class=\"b\""); //black ellipse
+  else if((parity && j == 2) || (!parity && j == 0))
+    output.Printf("class=\"w\""); //white ellipse
+} //SelectEllipseColor
+
+/// \brief Class attribute of an ellipse.
+///
+/// The attribute that SelectEllipseColor() writes, for a template's text
+/// hole.
+///
+/// \param i Ellipse index about circle.
+/// \param parity True if first ellipse is black, false if white.
+/// \return Class attribute, or an empty string if the ellipse is blank.
+
+static const char* EllipseClass(size_t i, bool parity){
+  const size_t j = i%4; //position in pattern of four
+
+  if((parity && j == 0) || (!parity && j == 2))return "class=\"b\"";
+  if((parity && j == 2) || (!parity && j == 0))return "class=\"w\"";
+  return "";
+} //EllipseClass
+
+/// \brief Place an ellipse.
+///
+/// Compute the position and orientation of one ellipse of a circle of
+/// ellipses, without drawing it.
+///
+/// \param r Radius of circle.
+/// \param theta Angle to ellipse.
+/// \param x [out] Ellipse center x, relative to the image center.
+/// \param y [out] Ellipse center y, relative to the image center.
+/// \param phi [out] Ellipse orientation in degrees.
+
+void PlaceEllipse(float r, float theta, float& x, float& y, float& phi){
+  x = r*cosf(theta); //ellipse center x
+  y = r*sinf(theta); //ellipse center y
+  phi = 90 + 180*theta/PI; //ellipse orientation
+} //PlaceEllipse
+
+/// \brief Format an ellipse that has been placed.
+///
+/// This function outputs an SVG `transform` and an SVG `ellipse` tag for one
+/// ellipse of a circle of ellipses whose position and orientation have been
+/// computed by PlaceEllipse(), with its color chosen by
+/// SelectEllipseColor(). As in FormatSquare(), the transform is put on a
+/// group unless `flat` is true.
+///
+/// \param output Output stream.
+/// \param cx X coordinate of center of image in pixels.
+/// \param cy Y coordinate of center of image in pixels.
+/// \param r0 Long radius of ellipse.
+/// \param r1 Short radius of ellipse.
+/// \param i Ellipse index about circle.
+/// \param parity True if first ellipse is black, false if white.
+/// \param x Ellipse center x, relative to the image center.
+/// \param y Ellipse center y, relative to the image center.
+/// \param phi Ellipse orientation in degrees.
+/// \param flat True to put the transform on the `ellipse` instead of a group.
+
+void FormatEllipse(COutput& output, size_t cx, size_t cy, float r0,
+  float r1, size_t i, bool parity, float x, float y, float phi, bool flat)
+{
+  output.Printf(flat? "<ellipse transform=\"translate(%0.1f %0.1f)":
+    "<g transform=\"translate(%0.1f %0.1f)", x, y); //translate
+  output.Printf(flat? "rotate(%0.1f %zu %zu)\" ":
+    "rotate(%0.1f %zu %zu)\"><ellipse ", phi, cx, cy); //rotate
+  output.Printf("rx=\"%0.1f\" ry=\"%0.1f\" ", r0, r1); //ellipse
+    
+  SelectEllipseColor(output, i, parity);
+
+  output.Printf(flat? "/>\n": "/></g>\n"); //close ellipse tag and group
+} //FormatEllipse
+
+/// \brief Draw an ellipse to a file in SVG format.
+///
+/// This function places one ellipse of a circle of ellipses with
+/// PlaceEllipse() and outputs it with FormatEllipse().
+///
+/// \param output Output stream.
+/// \param cx X coordinate of center of image in pixels.
+/// \param cy Y coordinate of center of image in pixels.
+/// \param r Radius of circle.
+/// \param r0 Long radius of ellipse.
+/// \param r1 Short radius of ellipse.
+/// \param i Ellipse index about circle.
+/// \param theta Angle to ellipse.
+/// \param parity True if first ellipse is black, false if white.
+/// \param flat True to put the transform on the `ellipse` instead of a group.
+
+void DrawEllipse(COutput& output, size_t cx, size_t cy, float r, float r0,
+  float r1, size_t i, float theta, bool parity, bool flat)
+{
+  float x, y, phi; //ellipse center and orientation
+  PlaceEllipse(r, theta, x, y, phi);
+  FormatEllipse(output, cx, cy, r0, r1, i, parity, x, y, phi, flat);
+} //DrawEllipse
+
+/// \brief Compile a template for ellipses.
+///
+/// Make a template that writes exactly what FormatEllipse() does, with the
+/// image center and radii filled in. Its holes are the translation x and
+/// y, the orientation, and the class attribute, if any.
+///
+/// \param t [out] Template.
+/// \param cx X coordinate of center of image in pixels.
+/// \param cy Y coordinate of center of image in pixels.
+/// \param r0 Long radius of ellipse.
+/// \param r1 Short radius of ellipse.
+/// \param flat True to put the transform on the `ellipse` instead of a group.
+
+void CompileEllipse(CTemplate& t, size_t cx, size_t cy, float r0, float r1,
+  bool flat)
+{
+  t.Constant(flat? "<ellipse transform=\"translate(":
+    "<g transform=\"translate(");
+  t.TenthsHole(); //x
+  t.Constant(" ");
+  t.TenthsHole(); //y
+  t.Constant(")rotate(");
+  t.TenthsHole(); //orientation
+  t.Constant(flat? " %zu %zu)\" ": " %zu %zu)\"><ellipse ", cx, cy);
+  t.Constant("rx=\"%0.1f\" ry=\"%0.1f\" ", r0, r1);
+  t.TextHole(); //class attribute
+  t.Constant(flat? "/>\n": "/></g>\n");
+} //CompileEllipse
+
+/// \brief Draw circle of ellipses to a file in SVG format.
+/// 
+/// Draw a circle of elipses oriented so that the long axis of each ellipse is
+/// perpendicular to a line drawn from the center of the circles to the center
+/// of the ellipse. This function outputs SVG `transform` and SVG `ellipse` tags
+/// to the output file. Each ellipse is placed using PlaceEllipse() and
+/// written with a template compiled once by CompileEllipse(), which is
+/// faster than DrawEllipse() and writes the same bytes. Used for optical
+/// illusion 2.
+/// 
+/// \param output Output stream.
+/// \param cx X coordinate of center of image in pixels.
+/// \param cy Y coordinate of center of image in pixels.
+/// \param r Radius of circle.
+/// \param r0 Long radius of ellipses.
+/// \param r1 Short radius of ellipses.
+/// \param n Number of ellipses in ring.
+/// \param theta Angle to first ellipse.
+/// \param dtheta Angle delta.
+/// \param parity True if first ellipse is black, false if white.
+/// \param flip True to clip the ordering of colots of ellipses.
+/// \param cancel Pointer to a cancellation flag, or `nullptr`.
+/// \param flat True to put the transforms on the `ellipse`s instead of
+///   groups.
+/// \return false if cancelled part way through.
+
+bool DrawCircleOfEllipses(COutput& output, size_t cx, size_t cy, float r,
+  float r0, float r1, size_t n, float theta, float dtheta, bool parity,
+  size_t flip, const CCancel* cancel, bool flat)
+{
+  CTemplate ellipse; //template for ellipses
+  CompileEllipse(ellipse, cx, cy, r0, r1, flat);
+
+  for(size_t i=0; i<n; i++){ //for each ellipse
+    if(i%CCancel::CHUNK == 0 && cancel != nullptr && cancel->Cancelled())
+      return false;
+
+    float x, y, phi; //ellipse center and orientation
+    PlaceEllipse(r, theta, x, y, phi);
+
+    const float v[3] = {x, y, phi}; //tenths holes
+    const char* cls = EllipseClass(i, parity); //class attribute, if any
+
+    ellipse.Emit(output, v, &cls);
+    theta += dtheta; //next ellipse
+    if(i == flip)parity = !parity; //flip parity if we need to
+  } //for
+
+  return true;
+} //DrawCircleOfEllipses
+
+/// \brief Describe 3 concentric circles of ellipses.
+/// 
+/// This function appends three ring descriptors to a list of rings, one for
+/// each circle of ellipses. The middle circle comes first, then
+/// the inner circle, then the outer circle. The parameters are chosen as
+/// described in DrawTripleCircle().
+/// 
+/// \param rings [in, out] List of ring descriptors.
+/// \param r Radius of braid.
+/// \param r0 Long radius of ellipses.
+/// \param r1 Short radius of ellipses.
+/// \param n Number of ellipses in ring.
+/// \param flip True to flip the ordering of colors of ellipses.
+
+void TripleCircle(std::vector<Ring>& rings, float r, float r0, float r1,
+  size_t n, bool flip)
+{
+  const float dtheta = PI/n; //angle delta to next ellipse
+  float theta = (flip? PI: -PI)/2; //angle to next ellipse
+  n *= 2; //include spaces
+
+  Ring ring; //ellipse parameters common to all three circles
+  ring.shape = Shape::Ellipse;
+  ring.r0 = r0;
+  ring.r1 = r1;
+  ring.n = n;
+  ring.dtheta = dtheta;
+
+  ring.r = r; //middle circle
+  ring.theta = theta;
+  ring.parity = true;
+  rings.push_back(ring);
+  
+  ring.r = r - r1; //inner circle
+  ring.theta = theta + dtheta;
+  ring.flip = n/2 - 1;
+  rings.push_back(ring);
+
+  ring.r = r + r1; //outer circle
+  ring.parity = false;
+  ring.flip = n/2 - 2;
+  rings.push_back(ring);
+} //TripleCircle
+
+/// \brief Draw 3 concentric circles of ellipses to a file in SVG format.
+/// 
+/// This function calls TripleCircle() to describe three circles of
+/// ellipses and draws each of them using DrawCircleOfEllipses(). The middle
+/// circle is drawn first, then the inner circle, then the outer circle. The
+/// parameters for the calls DrawCircleOfEllipses() are chosen so as to
+/// achieve the following.
+/// 
+/// The inner circle starts with a black ellipse centered at the top and
+/// alternates with white ellipses each spaced roughly one ellipse long-axis
+/// apart for a total of 36 ellipses as shown in the next image.
+/// 
+/// \image html ring1-middle.svg height=250
+///
+/// The inner circle also has 36 ellipses, but it starts with a gap centered
+/// at the top with black ellipses to the left and right and a gap centered at
+/// the bottom with white ellipses to the left and right. Black and white
+/// alternate for the rest of the circle.
+/// 
+/// \image html ring2-inner.svg height=250
+///
+/// The outer circle of a ring is similar to the inner circle
+/// but has black and white interchanged.
+/// 
+/// \image html ring3-outer.svg height=250
+/// 
+/// Used for optical illusion 2.
+/// 
+/// \param output Output stream.
+/// \param cx X coordinate of center of image in pixels.
+/// \param cy Y coordinate of center of image in pixels.
+/// \param r Radius of braid.
+/// \param r0 Long radius of ellipses.
+/// \param r1 Short radius of ellipses.
+/// \param n Number of ellipses in ring.
+/// \param flip True to flip the ordering of colors of ellipses.
+
+void DrawTripleCircle(COutput& output, size_t cx, size_t cy, float r,
+  float r0, float r1, size_t n, bool flip)
+{
+  std::vector<Ring> rings; //ring descriptors
+  TripleCircle(rings, r, r0, r1, n, flip);
+
+  for(const Ring& ring: rings)
+    DrawRing(output, cx, cy, ring);
+} //DrawTripleCircle
+
+/// \brief Describe the second optical illusion.
+/// 
+/// The image consists of a pair of concentric rings, each of which is made
+/// up of three concentric circles of ellipses. This function fills in an
+/// illusion descriptor, calling TripleCircle() twice, once for each
+/// triplet of circles. Each ring has 36 ellipses regardless of `n`.
+///
+/// \param illusion [out] Illusion descriptor.
+/// \param w Width and height of image in pixels.
+/// \param n Number of ellipses in ring.
+/// \param r Radius of braid.
+/// \param r0 Long radius of ellipses.
+/// \param r1 Short radius of ellipses.
+/// \param dark A dark SVG color.
+/// \param light A light SVG color.
+/// \param bgclr A mid-range SVG color for the background.
+
+void DescribeIllusion2(Illusion& illusion, size_t w, size_t n, float r,
+  float r0, float r1, const char dark[], const char light[],
+  const char bgclr[])
+{
+  illusion.kind = 2;
+  illusion.w = w;
+  illusion.cx = w/2; //center x coordinate
+  illusion.cy = illusion.cx; //center y coordinate
+  illusion.dark = dark;
+  illusion.light = light;
+  illusion.bgclr = bgclr;
+  illusion.rings.clear();
+
+  TripleCircle(illusion.rings, r, r0, r1, 36);
+  TripleCircle(illusion.rings, r - 64, 0.8f*r0, 0.8f*r1, 36, true);
+} //DescribeIllusion2
+
+/// \brief Draw the second optical illusion to a file in SVG format.
+/// 
+/// The image consists of a pair of concentric rings, each of which is made
+/// up of three concentric circles of ellipses. This function calls
+/// DescribeIllusion2() to compute the ring descriptors and then
+/// DrawIllusion() to output the `style` tag, the background, and one circle
+/// of ellipses per ring descriptor.
+///
+/// \image html output2.svg height=250
+/// 
+/// \param fname File name without extension.
+/// \param w Width and height of image in pixels.
+/// \param n Number of ellipses in ring.
+/// \param r Radius of braid.
+/// \param r0 Long radius of ellipses.
+/// \param r1 Short radius of ellipses.
+/// \param dark A dark SVG color.
+/// \param light A light SVG color.
+/// \param bgclr A mid-range SVG color for the background.
+
+void OpticalIllusion2(const std::string& fname, size_t w, size_t n,
+  float r, float r0, float r1, const char dark[], const char light[],
+  const char bgclr[])
+{
+  Illusion illusion; //illusion descriptor
+  DescribeIllusion2(illusion, w, n, r, r0, r1, dark, light, bgclr);
+  COutput output; //output stream
+
+  if(OpenSVG(output, fname, w, w)){
+    printf("Optical illusion 2 to %s.svg\n", fname.c_str());
+    DrawIllusion(output, illusion);
+    CloseSVG(output); //clean up and exit
+  } //if
+} //OpticalIllusion2
+
+#pragma endregion Illusion2
+
+//////////////////////////////////////////////////////////////////////////
+// Illusion descriptors.
+
+#pragma region descriptors
+
+/// \brief Draw a ring to a file in SVG format.
+///
+/// Call DrawCircleOfSquares() or DrawCircleOfEllipses(), depending on the
+/// shape of the elements, with the parameters from a ring descriptor, or
+/// DrawFixedRing() or DrawHugeRing() if the ring uses fixed-point or huge
+/// geometry.
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param ring Ring descriptor.
+/// \param cancel Pointer to a cancellation flag, or `nullptr`.
+/// \return false if cancelled part way through.
+
+bool DrawRing(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  const CCancel* cancel)
+{
+  if(ring.geometry == Geometry::Fixed)
+    return DrawFixedRing(output, cx, cy, ring, cancel);
+
+  if(ring.geometry == Geometry::Huge)
+    return DrawHugeRing(output, cx, cy, ring, cancel);
+
+  if(ring.shape == Shape::Square)
+    return DrawCircleOfSquares(output, cx, cy, ring.r, ring.sw, ring.parity,
+      cancel, ring.flat);
+
+  return DrawCircleOfEllipses(output, cx, cy, ring.r, ring.r0, ring.r1,
+    ring.n, ring.theta, ring.dtheta, ring.parity, ring.flip, cancel,
+    ring.flat);
+} //DrawRing
+
+/// \brief Draw one element of a ring to a file in SVG format.
+///
+/// Call DrawSquare() or DrawEllipse(), depending on the shape of the
+/// elements, or DrawFixedElement() or DrawHugeElement() if the ring uses
+/// fixed-point or huge geometry. This is used to draw part of a ring. The
+/// angle and parity must
+/// be the ones that DrawRing() would use for this element, which can be
+/// computed by starting with the ring descriptor's angle and parity and
+/// calling NextElement() once per element.
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param ring Ring descriptor.
+/// \param i Element index about circle.
+/// \param theta Angle to element.
+/// \param parity Element parity.
+
+void DrawElement(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  size_t i, float theta, bool parity)
+{
+  if(ring.geometry == Geometry::Fixed)
+    DrawFixedElement(output, cx, cy, ring, i, parity);
+
+  else if(ring.geometry == Geometry::Huge)
+    DrawHugeElement(output, cx, cy, ring, i, parity);
+
+  else if(ring.shape == Shape::Square)
+    DrawSquare(output, cx, cy, ring.r, ring.sw, parity, i, theta,
+      ring.flat);
+
+  else DrawEllipse(output, cx, cy, ring.r, ring.r0, ring.r1, i, theta,
+    parity, ring.flat);
+} //DrawElement
+
+/// Compile a template for the ring's elements if it uses float geometry.
+/// \param ring Ring descriptor, which must outlive the writer.
+/// \param cx Image center x.
+/// \param cy Image center y.
+
+CRingWriter::CRingWriter(const Ring& ring, size_t cx, size_t cy):
+  m_ring(ring), m_nCx(cx), m_nCy(cy)
+{
+  if(ring.geometry != Geometry::Float)return;
+
+  if(ring.shape == Shape::Square)
+    CompileSquare(m_template, cx, cy, ring.sw, ring.flat);
+  else CompileEllipse(m_template, cx, cy, ring.r0, ring.r1, ring.flat);
+} //constructor
+
+/// Draw an element with the same angle and parity that DrawElement() would
+/// be given. Float elements are placed with PlaceSquare() or PlaceEllipse()
+/// and written with Format(). Fixed-point and huge elements are drawn by
+/// DrawElement().
+/// \param output Output stream.
+/// \param i Element index about circle.
+/// \param theta Angle to element.
+/// \param parity Element parity.
+
+void CRingWriter::Draw(COutput& output, size_t i, float theta,
+  bool parity) const
+{
+  if(m_ring.geometry != Geometry::Float){
+    DrawElement(output, m_nCx, m_nCy, m_ring, i, theta, parity);
+    return;
+  } //if
+
+  float x, y, phi; //element center and orientation
+
+  if(m_ring.shape == Shape::Square)
+    PlaceSquare(m_ring.r, parity, theta, x, y, phi);
+  else PlaceEllipse(m_ring.r, theta, x, y, phi);
+
+  Format(output, i, parity, x, y, phi);
+} //Draw
+
+/// Write a float element that has been placed, exactly as FormatSquare() or
+/// FormatEllipse() would, with the ring's template.
+/// \param output Output stream.
+/// \param i Element index about circle.
+/// \param parity Element parity.
+/// \param x Element center x, relative to the image center.
+/// \param y Element center y, relative to the image center.
+/// \param phi Element orientation in degrees.
+
+void CRingWriter::Format(COutput& output, size_t i, bool parity, float x,
+  float y, float phi) const
+{
+  if(m_ring.shape == Shape::Square){
+    const float v[3] = {x + m_ring.sw/2.0f, y + m_ring.sw/2.0f, phi}; //holes
+    const char* cls = (i&1)? "b": "w"; //black or white
+    m_template.Emit(output, v, &cls);
+  } //if
+
+  else{
+    const float v[3] = {x, y, phi}; //tenths holes
+    const char* cls = EllipseClass(i, parity); //class attribute, if any
+    m_template.Emit(output, v, &cls);
+  } //else
+} //Format
+
+/// \brief Advance to the next element of a ring.
+///
+/// Update the angle and parity in exactly the same way as
+/// DrawCircleOfSquares() and DrawCircleOfEllipses() do, so that the
+/// results are bit-for-bit identical.
+///
+/// \param ring Ring descriptor.
+/// \param i Index of the current element.
+/// \param theta [in, out] Angle to element.
+/// \param parity [in, out] Element parity.
+
+void NextElement(const Ring& ring, size_t i, float& theta, bool& parity){
+  theta += ring.dtheta; //next element
+  
+  if(ring.shape == Shape::Ellipse && i == ring.flip)
+    parity = !parity; //flip parity if we need to
+} //NextElement
+
+/// \brief Draw the style and background tags to a file in SVG format.
+///
+/// This function outputs an SVG `style` tag (the use of which reduces the
+/// SVG file size) for either the squares of optical illusion 1 or the
+/// ellipses of optical illusion 2, followed by the background `rect` tag.
+///
+/// \param output Output stream.
+/// \param illusion Illusion descriptor.
+
+void DrawStyle(COutput& output, const Illusion& illusion){
+  const size_t cx = illusion.cx; //center x coordinate
+  const size_t cy = illusion.cy; //center y coordinate
+  const char* dark = illusion.dark.c_str(); //dark color
+  const char* light = illusion.light.c_str(); //light color
+
+  output.Printf("<style>"); //open style tag
+
+  if(illusion.kind == 1){ //squares
+    output.Printf("rect{fill:none;stroke-width:3}"); //rectangle
+    output.Printf("rect.b{x:%zu;y:%zu;stroke:%s;}", cx, cy, dark); //black rect
+    output.Printf("rect.w{x:%zu;y:%zu;stroke:%s;}", cx, cy, light); //white rect
+  } //if
+
+  else{ //ellipses
+    output.Printf("ellipse{fill:none;stroke-width:3}");	//ellipse
+    output.Printf("ellipse.b{cx:%zu;cy:%zu;stroke:none;fill:%s;}",
+      cx, cy, dark);	//dark ellipse
+    output.Printf("ellipse.w{cx:%zu;cy:%zu;stroke:none;fill:%s;}",
+      cx, cy, light);	//light ellipse
+  } //else
+
+  output.Printf("</style>\n"); //close style tag
+    
+  //background
+  output.Printf("<rect width=\"%zu\" height=\"%zu\" ",
+    illusion.w, illusion.w); //rectangle
+  output.Printf("style=\"fill:%s\"/>\n", illusion.bgclr.c_str()); //fill
+} //DrawStyle
+
+/// \brief Draw an illusion to a file in SVG format.
+///
+/// Output the style and background tags using DrawStyle(), then draw each
+/// ring in order using DrawRing(). The SVG file must already be open.
+/// If a cancellation flag is given, it is checked between rings and
+/// every CCancel::CHUNK elements, and drawing stops if it is set.
+///
+/// \param output Output stream.
+/// \param illusion Illusion descriptor.
+/// \param cancel Pointer to a cancellation flag, or `nullptr`.
+/// \return false if cancelled part way through.
+
+bool DrawIllusion(COutput& output, const Illusion& illusion,
+  const CCancel* cancel)
+{
+  DrawStyle(output, illusion);
+
+  for(const Ring& ring: illusion.rings)
+    if(!DrawRing(output, illusion.cx, illusion.cy, ring, cancel))
+      return false;
+
+  return true;
+} //DrawIllusion
+
+/// \brief Draw a range of elements of an illusion.
+///
+/// Draw the elements of an illusion with indices in a half-open range,
+/// numbering the elements of all rings consecutively in drawing order.
+/// Skipped elements are not drawn, but their angles and parities are
+/// advanced with NextElement(), so the elements that are drawn are
+/// byte-for-byte identical to those drawn by DrawIllusion(). Drawing every
+/// range of a partition of the elements in order, preceded by the header
+/// and style and followed by the close tag, gives the whole illusion. The
+/// elements of each ring are drawn with a CRingWriter.
+///
+/// \param output Output stream.
+/// \param illusion Illusion descriptor.
+/// \param a Index of first element to draw.
+/// \param b Index of element after last one to draw.
+/// \param cancel Pointer to a cancellation flag, or `nullptr`.
+/// \return false if cancelled part way through.
+
+bool DrawElements(COutput& output, const Illusion& illusion, size_t a,
+  size_t b, const CCancel* cancel)
+{
+  size_t first = 0; //index of first element of current ring
+
+  for(const Ring& ring: illusion.rings){ //for each ring
+    if(first >= b)break;
+
+    if(first + ring.n > a){ //ring overlaps range
+      const CRingWriter writer(ring, illusion.cx, illusion.cy); //writer
+      float theta = ring.theta; //angle to current element
+      bool parity = ring.parity; //parity of current element
+
+      for(size_t i=0; i<ring.n && first + i<b; i++){ //for each element
+        if(first + i >= a){
+          if((first + i - a)%CCancel::CHUNK == 0 && cancel != nullptr &&
+            cancel->Cancelled())return false;
+
+          writer.Draw(output, i, theta, parity);
+        } //if
+
+        NextElement(ring, i, theta, parity);
+      } //for
+    } //if
+
+    first += ring.n;
+  } //for
+
+  return true;
+} //DrawElements
+
+/// \brief Count elements.
+///
+/// \param illusion Illusion descriptor.
+/// \return Total number of squares or ellipses drawn.
+
+size_t ElementCount(const Illusion& illusion){
+  size_t count = 0; //result
+
+  for(const Ring& ring: illusion.rings)
+    count += ring.n;
+
+  return count;
+} //ElementCount
+
+#pragma endregion descriptors
+
+//////////////////////////////////////////////////////////////////////////
+// Jobs.
+
+#pragma region jobs
+
+/// \brief Parse a job.
+///
+/// Parse the parameters of one call to OpticalIllusion1() or
+/// OpticalIllusion2() from a list of ten strings: the illusion number (1 or
+/// 2), the file name without extension, the width, the number of circles or
+/// ellipses, three shape parameters, and the dark, light, and background
+/// colors. For example, `1 output1 800 4 100 72 24 black white gray`.
+/// An eleventh string `fixed` selects the fixed-point geometry of
+/// DrawFixedRing(), which draws the same SVG on every platform, and `huge`
+/// selects the double geometry of DrawHugeRing(), which keeps its precision
+/// in rings of billions of elements. A string `flat`, after that or in its
+/// place, puts each element's transform on the element instead of a group
+/// (see FormatSquare()).
+///
+/// \param job [out] Job descriptor.
+/// \param argc Number of strings.
+/// \param argv Array of strings.
+/// \return true if the strings describe a valid job.
+
+bool ParseJob(Job& job, size_t argc, const char* const argv[]){
+  job.flat = argc > 10 && !strcmp(argv[argc - 1], "flat");
+  if(job.flat)argc--; //flat comes last
+
+  if(argc == 11 && !strcmp(argv[10], "fixed"))
+    job.geometry = Geometry::Fixed;
+  else if(argc == 11 && !strcmp(argv[10], "huge"))
+    job.geometry = Geometry::Huge;
+  else if(argc != 10)return false; //wrong number of parameters
+  else job.geometry = Geometry::Float;
+
+  char* end = nullptr; //end of number parsed
+  bool ok = true; //no errors so far
+
+  job.kind = (size_t)strtoul(argv[0], &end, 10);
+  ok = ok && *end == 0 && (job.kind == 1 || job.kind == 2);
+
+  job.fname = argv[1];
+  ok = ok && !job.fname.empty();
+
+  job.w = (size_t)strtoul(argv[2], &end, 10);
+  ok = ok && *end == 0 && job.w > 0;
+  
+  job.n = (size_t)strtoul(argv[3], &end, 10);
+  ok = ok && *end == 0;
+
+  for(size_t i=0; i<3; i++){
+    job.p[i] = strtod(argv[4 + i], &end);
+    ok = ok && *end == 0 && job.p[i] >= 0;
+  } //for
+
+  if(job.kind == 1) //square width must be a positive whole number
+    ok = ok && job.p[2] >= 1 && job.p[2] == floor(job.p[2]);
+
+  job.dark = argv[7];
+  job.light = argv[8];
+  job.bgclr = argv[9];
+
+  return ok;
+} //ParseJob
+
+/// \brief Load jobs from a file.
+///
+/// A job file has one job per line in the format described in ParseJob(),
+/// with the parameters separated by white space. Blank lines and lines
+/// starting with `#` are ignored.
+///
+/// \param fname File name including extension.
+/// \param jobs [out] Job descriptors.
+/// \return true if the file was read and every job in it is valid.
+
+bool LoadJobs(const std::string& fname, std::vector<Job>& jobs){
+  FILE* input = nullptr; //input file pointer
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&input, fname.c_str(), "rt");
+#else
+  input = fopen(fname.c_str(), "rt");
+#endif
+
+  if(input == nullptr)return false;
+
+  jobs.clear();
+  char line[1024]; //one line of the file
+  size_t lineno = 0; //line number
+  bool ok = true; //no errors so far
+
+  while(ok && fgets(line, sizeof(line), input) != nullptr){
+    lineno++;
+    const char* argv[16]; //parameters
+    size_t argc = 0; //number of parameters
+    char* p = line; //current character
+
+    while(argc < 16){ //split line at white space
+      while(*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')*p++ = 0;
+      if(*p == 0 || *p == '#')break;
+      argv[argc++] = p;
+      while(*p != 0 && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')p++;
+    } //while
+
+    if(argc > 0){ //not a blank line
+      Job job;
+      ok = ParseJob(job, argc, argv);
+      if(ok)jobs.push_back(job);
+      else printf("%s line %zu: bad job\n", fname.c_str(), lineno);
+    } //if
+  } //while
+
+  fclose(input);
+  return ok;
+} //LoadJobs
+
+/// \brief Describe a job.
+///
+/// Fill in an illusion descriptor using either DescribeIllusion1() or
+/// DescribeIllusion2() with the parameters from a job descriptor. Huge
+/// circles of squares get their radii in double precision, since a float
+/// radius of billions of pixels is a multiple of hundreds of pixels.
+///
+/// \param illusion [out] Illusion descriptor.
+/// \param job Job descriptor.
+
+void Describe(Illusion& illusion, const Job& job){
+  const char* dark = job.dark.c_str(); //dark color
+  const char* light = job.light.c_str(); //light color
+  const char* bgclr = job.bgclr.c_str(); //background color
+
+  if(job.kind == 1)
+    DescribeIllusion1(illusion, job.w, job.n, job.p[0], job.p[1],
+      (size_t)job.p[2], dark, light, bgclr);
+
+  else DescribeIllusion2(illusion, job.w, job.n, job.p[0], job.p[1],
+    job.p[2], dark, light, bgclr);
+
+  if(job.kind == 1 && job.geometry == Geometry::Huge)
+    for(size_t i=0; i<illusion.rings.size(); i++) //radii in double
+      illusion.rings[i].r = job.p[0] + i*job.p[1];
+
+  SetGeometry(illusion, job.geometry);
+
+  for(Ring& ring: illusion.rings)
+    ring.flat = job.flat;
+} //Describe
+
+/// \brief Set the geometry of all rings.
+///
+/// Huge rings of squares have their number of squares recomputed in double
+/// precision by HugeSquareCount(), and their angle delta to match.
+///
+/// \param illusion [in, out] Illusion descriptor.
+/// \param geometry Geometry used to place elements.
+
+void SetGeometry(Illusion& illusion, Geometry geometry){
+  for(Ring& ring: illusion.rings){
+    ring.geometry = geometry;
+
+    if(geometry == Geometry::Huge && ring.shape == Shape::Square){
+      ring.n = HugeSquareCount(ring.r, ring.sw);
+      ring.dtheta = ring.n > 0? 2*PI/ring.n: 0;
+    } //if
+  } //for
+} //SetGeometry
+
+/// \brief Draw a job.
+///
+/// Draw a job's illusion as a complete SVG document.
+///
+/// \param output Output stream.
+/// \param job Job descriptor.
+/// \param cancel Pointer to a cancellation flag, or `nullptr`.
+/// \return false if cancelled part way through.
+
+bool DrawJob(COutput& output, const Job& job, const CCancel* cancel){
+  Illusion illusion; //illusion descriptor
+  Describe(illusion, job);
+
+  DrawHeader(output, job.w, job.w);
+  const bool ok = DrawIllusion(output, illusion, cancel); //not cancelled
+  CloseSVG(output);
+
+  return ok;
+} //DrawJob
+
+/// \brief Temporary file name.
+///
+/// Make a name for a temporary file in the same directory as a file that is
+/// to be written, so that it can be renamed into place with MoveIntoPlace().
+/// The name includes the process id and a per-process counter, so that no
+/// two processes or threads use the same one.
+///
+/// \param fname File name.
+/// \return Temporary file name.
+
+std::string TempName(const std::string& fname){
+  static std::atomic<unsigned> counter(0); //number of names made so far
+
+#ifdef _MSC_VER //Visual Studio
+  const int pid = _getpid(); //process id
+#else
+  const int pid = (int)getpid(); //process id
+#endif
+
+  return fname + "." + std::to_string(pid) + "." +
+    std::to_string(counter++) + ".tmp";
+} //TempName
+
+/// \brief Move a temporary file into place.
+///
+/// Rename a temporary file that has been written successfully over the file
+/// that it replaces, or remove it if it has not.
+///
+/// \param temp Temporary file name.
+/// \param fname File name.
+/// \param ok True if the temporary file was written successfully.
+/// \return true if the temporary file was renamed.
+
+bool MoveIntoPlace(const std::string& temp, const std::string& fname, bool ok){
+#ifdef _MSC_VER //Visual Studio won't rename over an existing file
+  if(ok)remove(fname.c_str());
+#endif
+
+  if(!ok || rename(temp.c_str(), fname.c_str()) != 0){
+    remove(temp.c_str());
+    return false;
+  } //if
+
+  return true;
+} //MoveIntoPlace
+
+/// \brief Render a job.
+///
+/// Draw a job's illusion to an SVG file named after the job, without
+/// printing anything. The SVG is written to a temporary file which is
+/// renamed only after it has been written successfully, so that a partial
+/// file is never mistaken for a finished one.
+///
+/// \param job Job descriptor.
+/// \param digest [out] Pointer to digest of SVG file, or `nullptr`.
+/// \param cancel Pointer to a cancellation flag, or `nullptr`.
+/// \param sha256 True to put the SHA-256 of the SVG file in the digest too.
+/// \return true if the SVG file was written, false if it could not be
+/// written or the job was cancelled.
+
+bool RenderJob(const Job& job, Digest* digest, const CCancel* cancel,
+  bool sha256)
+{
+  const std::string fname = job.fname + ".svg"; //file name
+  const std::string temp = TempName(fname); //temporary file name
+  CXXHash64 hash; //streaming hash
+  CSha256 sha; //streaming SHA-256
+  COutput output; //output stream
+
+  if(!output.Open(temp, true))
+    return false;
+
+  output.SetHash(&hash, sha256 && digest != nullptr? &sha: nullptr);
+  const bool drawn = DrawJob(output, job, cancel); //not cancelled
+
+  if(!MoveIntoPlace(temp, fname, drawn && !output.Error()))
+    return false;
+
+  if(digest != nullptr){
+    digest->size = output.Size();
+    digest->hash = hash.Digest();
+    if(sha256)digest->sha256 = sha.Digest();
+  } //if
+
+  return true;
+} //RenderJob
+
+/// \brief Hash a job.
+///
+/// Hash every parameter of a job together with the generator version. Two
+/// jobs with the same hash write the same SVG file, so an output whose
+/// recorded job hash is unchanged need not be rendered again.
+///
+/// \param job Job descriptor.
+/// \return Job hash.
+
+uint64_t JobHash(const Job& job){
+  CXXHash64 hash; //streaming hash
+  const uint64_t v[4] = {GENERATOR_VERSION, job.kind, job.w, job.n};
+
+  hash.Update(v, sizeof(v));
+
+  if(job.geometry == Geometry::Huge) //radii in double precision
+    hash.Update(job.p, sizeof(job.p));
+
+  else{ //so float hashes are unchanged
+    const float p[3] = {(float)job.p[0], (float)job.p[1], (float)job.p[2]};
+    hash.Update(p, sizeof(p));
+  } //else
+
+  if(job.geometry != Geometry::Float){ //so float hashes are unchanged
+    const uint64_t geometry = (uint64_t)job.geometry; //1 fixed, 2 huge
+    hash.Update(&geometry, sizeof(geometry));
+  } //if
+
+  if(job.flat){ //so grouped hashes are unchanged
+    const uint64_t flat = 3; //after the geometries
+    hash.Update(&flat, sizeof(flat));
+  } //if
+
+  for(const std::string* s: {&job.fname, &job.dark, &job.light, &job.bgclr}){
+    const uint64_t n = s->size(); //length, so that strings can't run together
+    hash.Update(&n, sizeof(n));
+    hash.Update(s->data(), s->size());
+  } //for
+
+  return hash.Digest();
+} //JobHash
+
+#pragma endregion jobs
@@ -0,0 +1,214 @@
+/// \file Illusion.h
+
+/// \brief Interface for the optical illusion generators.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Illusion_h__
+#define __Illusion_h__
+
+#include <string>
+#include <vector>
+
+#include "Cancel.h"
+#include "Output.h"
+#include "Template.h"
+
+extern const float PI; ///< Pi.
+extern const unsigned GENERATOR_VERSION; ///< Generator version.
+
+/// \brief Shape of the elements in a ring.
+
+enum class Shape{
+  Square, ///< Tilted squares, used for optical illusion 1.
+  Ellipse ///< Ellipses, used for optical illusion 2.
+}; //Shape
+
+/// \brief Geometry used to place elements.
+
+enum class Geometry{
+  Float, ///< Float, used by DrawSquare() and DrawEllipse().
+  Fixed, ///< Fixed point, used by DrawFixedRing().
+  Huge ///< Double, used by DrawHugeRing() for rings of billions of elements.
+}; //Geometry
+
+/// \brief Ring descriptor.
+///
+/// A ring descriptor records the parameters that are passed to
+/// DrawCircleOfSquares() or DrawCircleOfEllipses() to draw one circle of
+/// elements. A whole illusion is determined by a handful of these, so they
+/// are a much more compact representation than the SVG that they expand to.
+
+struct Ring{
+  Shape shape = Shape::Square; ///< Shape of elements.
+  double r = 0; ///< Circle radius, exact for huge rings.
+  size_t sw = 0; ///< Square width and height (squares only).
+  float r0 = 0; ///< Long radius of ellipses (ellipses only).
+  float r1 = 0; ///< Short radius of ellipses (ellipses only).
+  size_t n = 0; ///< Number of elements in ring.
+  float theta = 0; ///< Angle to first element.
+  float dtheta = 0; ///< Angle delta.
+  bool parity = true; ///< Parity of first element.
+  size_t flip = 999999; ///< Index after which parity flips (ellipses only).
+  Geometry geometry = Geometry::Float; ///< Geometry used to place elements.
+  bool flat = false; ///< Put the transform on the element, not a group.
+}; //Ring
+
+/// \brief Illusion descriptor.
+///
+/// Everything needed to write an optical illusion in SVG format: the image
+/// size, the center of the circles, the colors used in the `style` tag, and
+/// the list of rings in the order in which they are drawn.
+
+struct Illusion{
+  size_t kind = 1; ///< Which optical illusion, 1 or 2.
+  size_t w = 0; ///< Width and height of image in pixels.
+  size_t cx = 0; ///< X coordinate of center of circles.
+  size_t cy = 0; ///< Y coordinate of center of circles.
+  std::string dark; ///< A dark SVG color.
+  std::string light; ///< A light SVG color.
+  std::string bgclr; ///< A mid-range SVG color for the background.
+  std::vector<Ring> rings; ///< Rings in drawing order.
+}; //Illusion
+
+/// \brief Job descriptor.
+///
+/// The parameters of one call to OpticalIllusion1() or OpticalIllusion2(),
+/// in the order in which they appear on the command line.
+
+struct Job{
+  size_t kind = 1; ///< Which optical illusion, 1 or 2.
+  std::string fname; ///< File name without extension.
+  size_t w = 0; ///< Width and height of image in pixels.
+  size_t n = 0; ///< Number of circles or number of ellipses.
+  double p[3] = {0, 0, 0}; ///< Either r0, dr, sw or r, r0, r1.
+  std::string dark; ///< A dark SVG color.
+  std::string light; ///< A light SVG color.
+  std::string bgclr; ///< A mid-range SVG color for the background.
+  Geometry geometry = Geometry::Float; ///< Geometry used to place elements.
+  bool flat = false; ///< Put the transform on the element, not a group.
+}; //Job
+
+/// \brief Ring writer.
+///
+/// Draws elements of one ring, one at a time, exactly as DrawElement()
+/// does. The template for a float ring is compiled once, by CompileSquare()
+/// or CompileEllipse(), so drawing part of a ring element by element costs
+/// about as much as DrawRing() does per element.
+
+class CRingWriter{
+  private:
+    const Ring& m_ring; ///< Ring descriptor.
+    size_t m_nCx = 0; ///< Image center x.
+    size_t m_nCy = 0; ///< Image center y.
+    CTemplate m_template; ///< Element template, for float geometry.
+
+  public:
+    CRingWriter(const Ring& ring, size_t cx, size_t cy); ///< Constructor.
+
+    void Draw(COutput& output, size_t i, float theta,
+      bool parity) const; ///< Draw an element.
+    void Format(COutput& output, size_t i, bool parity, float x, float y,
+      float phi) const; ///< Write a placed element.
+}; //CRingWriter
+
+//helpers
+
+void DrawHeader(COutput& output, size_t w, size_t h, size_t x=0,
+  size_t y=0, size_t dw=0, size_t dh=0);
+bool OpenSVG(COutput& output, const std::string& fname, size_t w, size_t h);
+void CloseSVG(COutput& output);
+
+//optical illusion 1
+
+size_t SquareCount(float r, size_t sw);
+void PlaceSquare(float r, bool parity, float theta, float& x, float& y,
+  float& phi);
+void FormatSquare(COutput& output, size_t cx, size_t cy, size_t sw, size_t i,
+  float x, float y, float phi, bool flat=false);
+void DrawSquare(COutput& output, size_t cx, size_t cy, float r, size_t sw,
+  bool parity, size_t i, float theta, bool flat=false);
+void CompileSquare(CTemplate& t, size_t cx, size_t cy, size_t sw,
+  bool flat=false);
+bool DrawCircleOfSquares(COutput& output, size_t cx, size_t cy, float r,
+  size_t sw, bool parity, const CCancel* cancel=nullptr, bool flat=false);
+void DescribeIllusion1(Illusion& illusion, size_t w, size_t n, float r0,
+  float dr, size_t sw, const char dark[], const char light[],
+  const char bgclr[]);
+void OpticalIllusion1(const std::string& fname, size_t w, size_t n,
+  float r0, float dr, size_t sw, const char dark[], const char light[],
+  const char bgclr[]);
+
+//optical illusion 2
+
+void PlaceEllipse(float r, float theta, float& x, float& y, float& phi);
+void FormatEllipse(COutput& output, size_t cx, size_t cy, float r0,
+  float r1, size_t i, bool parity, float x, float y, float phi,
+  bool flat=false);
+void DrawEllipse(COutput& output, size_t cx, size_t cy, float r, float r0,
+  float r1, size_t i, float theta, bool parity, bool flat=false);
+void CompileEllipse(CTemplate& t, size_t cx, size_t cy, float r0, float r1,
+  bool flat=false);
+bool DrawCircleOfEllipses(COutput& output, size_t cx, size_t cy, float r,
+  float r0, float r1, size_t n, float theta, float dtheta, bool parity,
+  size_t flip=999999, const CCancel* cancel=nullptr, bool flat=false);
+void TripleCircle(std::vector<Ring>& rings, float r, float r0, float r1,
+  size_t n, bool flip=false);
+void DrawTripleCircle(COutput& output, size_t cx, size_t cy, float r,
+  float r0, float r1, size_t n, bool flip=false);
+void DescribeIllusion2(Illusion& illusion, size_t w, size_t n, float r,
+  float r0, float r1, const char dark[], const char light[],
+  const char bgclr[]);
+void OpticalIllusion2(const std::string& fname, size_t w, size_t n,
+  float r, float r0, float r1, const char dark[], const char light[],
+  const char bgclr[]);
+
+//illusion descriptors
+
+bool DrawRing(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  const CCancel* cancel=nullptr);
+void DrawElement(COutput& output, size_t cx, size_t cy, const Ring& ring,
+  size_t i, float theta, bool parity);
+void NextElement(const Ring& ring, size_t i, float& theta, bool& parity);
+void DrawStyle(COutput& output, const Illusion& illusion);
+bool DrawIllusion(COutput& output, const Illusion& illusion,
+  const CCancel* cancel=nullptr);
+bool DrawElements(COutput& output, const Illusion& illusion, size_t a,
+  size_t b, const CCancel* cancel=nullptr);
+size_t ElementCount(const Illusion& illusion);
+
+//jobs
+
+bool ParseJob(Job& job, size_t argc, const char* const argv[]);
+bool LoadJobs(const std::string& fname, std::vector<Job>& jobs);
+void Describe(Illusion& illusion, const Job& job);
+void SetGeometry(Illusion& illusion, Geometry geometry);
+bool DrawJob(COutput& output, const Job& job,
+  const CCancel* cancel=nullptr);
+std::string TempName(const std::string& fname);
+bool MoveIntoPlace(const std::string& temp, const std::string& fname, bool ok);
+bool RenderJob(const Job& job, Digest* digest=nullptr,
+  const CCancel* cancel=nullptr, bool sha256=false);
+uint64_t JobHash(const Job& job);
+
+#endif //__Illusion_h__
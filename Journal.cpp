@@ -0,0 +1,448 @@
+/// \file Journal.cpp
+
+/// \brief Code for the batch journal CJournal.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Illusion.h"
+#include "Journal.h"
+#include "Output.h"
+#include "ThreadPool.h"
+#include "Timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// CJournal.
+
+#pragma region CJournal
+
+/// Close the journal file, if it is open.
+
+CJournal::~CJournal(){
+  Close();
+} //destructor
+
+/// Read every complete line of a journal file. A missing journal file is
+/// treated as an empty one.
+/// \param fname Journal file name.
+/// \return Number of files in the journal.
+
+size_t CJournal::Load(const std::string& fname){
+  FILE* input = nullptr; //input file pointer
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&input, fname.c_str(), "rb");
+#else
+  input = fopen(fname.c_str(), "rb");
+#endif
+
+  m_mapDigest.clear();
+  m_bTorn = false;
+  m_nLines = 0;
+  if(input == nullptr)return 0;
+
+  std::string text; //contents of journal
+  char buffer[1 << 16]; //read buffer
+  size_t n = 0; //number of bytes read
+
+  while((n = fread(buffer, 1, sizeof(buffer), input)) > 0)
+    text.append(buffer, n);
+
+  fclose(input);
+
+  m_bTorn = !text.empty() && text.back() != '\n';
+  m_mapDigest.reserve(text.size()/32); //lines are rarely shorter than this
+  const char* p = text.c_str(); //start of current line
+
+  for(;;){ //for each complete line
+    const char* eol = strchr(p, '\n'); //end of line
+    if(eol == nullptr)break;
+
+    char* end = nullptr; //end of number
+    Digest digest;
+    digest.hash = strtoull(p, &end, 16);
+    const bool ok = end == p + 16 && *end == ' '; //hash ok
+
+    if(ok){
+      p = end + 1;
+      digest.size = (size_t)strtoull(p, &end, 10);
+
+      if(end > p && *end == ' ' && end + 1 < eol)
+        m_mapDigest[std::string((const char*)end + 1, eol)] = digest;
+    } //if
+
+    p = eol + 1;
+    m_nLines++;
+  } //for
+
+  return m_mapDigest.size();
+} //Load
+
+/// Open a journal file for appending. If the last line is partial, it is
+/// terminated first so that it cannot corrupt the next line.
+/// \param fname Journal file name.
+/// \param sync True to flush each line to disk before returning from
+/// Append().
+/// \return true if open succeeded.
+
+bool CJournal::Open(const std::string& fname, bool sync){
+  Close();
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&m_pFile, fname.c_str(), "ab");
+#else
+  m_pFile = fopen(fname.c_str(), "ab");
+#endif
+
+  if(m_pFile == nullptr)return false;
+
+  if(m_bTorn){
+    fputc('\n', m_pFile);
+    fflush(m_pFile);
+    m_bTorn = false;
+  } //if
+
+  m_bSync = sync;
+  return true;
+} //Open
+
+void CJournal::Close(){
+  if(m_pFile != nullptr){
+    fclose(m_pFile);
+    m_pFile = nullptr;
+  } //if
+} //Close
+
+/// Append a line to the journal file and record the digest.
+/// \param path Output file name.
+/// \param digest Digest of output file.
+/// \return true if the line was written.
+
+bool CJournal::Append(const std::string& path, const Digest& digest){
+  m_mapDigest[path] = digest;
+  if(m_pFile == nullptr)return false;
+
+  char line[4096]; //one line
+  const int n = snprintf(line, sizeof(line), "%016llx %zu %s\n",
+    (unsigned long long)digest.hash, digest.size, path.c_str());
+
+  if(n <= 0 || (size_t)n >= sizeof(line))return false;
+
+  bool ok = fwrite(line, 1, n, m_pFile) == (size_t)n &&
+    fflush(m_pFile) == 0; //one write per line
+  m_nLines++;
+
+#ifndef _MSC_VER
+  if(m_bSync)ok = ok && fsync(fileno(m_pFile)) == 0;
+#endif
+
+  return ok;
+} //Append
+
+/// Write a fresh journal file containing one line for each of a list of
+/// files, in the order in which they are listed, leaving out files that are
+/// not in the journal. This discards lines that have been superseded by later
+/// ones. The new journal file is written under a temporary name and renamed
+/// into place, so the old one survives a failed write. The journal file is
+/// closed first if it is open.
+/// \param fname Journal file name.
+/// \param paths Output file names.
+/// \return true if the journal file was written.
+
+bool CJournal::Save(const std::string& fname,
+  const std::vector<std::string>& paths)
+{
+  Close();
+
+  const std::string temp = fname + ".tmp"; //temporary file name
+  COutput output; //output stream
+  size_t lines = 0; //number of lines written
+  if(!output.Open(temp, true))return false;
+
+  for(const std::string& path: paths){
+    const auto it = m_mapDigest.find(path); //journal entry
+
+    if(it != m_mapDigest.end()){
+      output.Printf("%016llx %zu %s\n", (unsigned long long)it->second.hash,
+        it->second.size, path.c_str());
+      lines++;
+    } //if
+  } //for
+
+  output.Close();
+
+#ifdef _MSC_VER //Visual Studio won't rename over an existing file
+  remove(fname.c_str());
+#endif
+
+  if(output.Error() || rename(temp.c_str(), fname.c_str()) != 0){
+    remove(temp.c_str());
+    return false;
+  } //if
+
+  m_nLines = lines;
+  return true;
+} //Save
+
+/// \param path Output file name.
+/// \param digest [out] Digest of output file.
+/// \return true if the file is in the journal.
+
+bool CJournal::Find(const std::string& path, Digest& digest) const{
+  const auto it = m_mapDigest.find(path); //journal entry
+  if(it == m_mapDigest.end())return false;
+
+  digest = it->second;
+  return true;
+} //Find
+
+/// \return Number of files in the journal.
+
+size_t CJournal::Size() const{
+  return m_mapDigest.size();
+} //Size
+
+/// \return Number of lines in the journal file, including those that have
+/// been superseded by later ones.
+
+size_t CJournal::Lines() const{
+  return m_nLines;
+} //Lines
+
+#pragma endregion CJournal
+
+//////////////////////////////////////////////////////////////////////////
+// Verification.
+
+#pragma region verification
+
+/// \brief File size.
+///
+/// \param fname File name.
+/// \return Size of file in bytes, or `(size_t)-1` if it does not exist.
+
+size_t FileSize(const std::string& fname){
+#ifdef _MSC_VER //Visual Studio
+  struct _stat64 st; //file status
+  if(_stat64(fname.c_str(), &st) != 0)return (size_t)-1;
+#else
+  struct stat st; //file status
+  if(stat(fname.c_str(), &st) != 0)return (size_t)-1;
+#endif
+
+  return (size_t)st.st_size;
+} //FileSize
+
+/// \brief Verify a file against its digest.
+///
+/// \param fname File name.
+/// \param digest Digest of file.
+/// \param quick True to check only the size, false to check the hash too.
+/// \return true if the file matches the digest.
+
+bool Verify(const std::string& fname, const Digest& digest, bool quick){
+  size_t size = 0; //file size
+
+  if(quick)
+    return FileSize(fname) == digest.size;
+
+  const uint64_t hash = HashFile(fname, size); //file hash
+  return size == digest.size && hash == digest.hash;
+} //Verify
+
+#pragma endregion verification
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark.
+
+#pragma region benchmark
+
+/// \brief Benchmark the journal.
+///
+/// The parameter is the number of jobs, optionally followed by a journal
+/// file name (default `bench.journal`) and `-norender`. The jobs, which
+/// alternate between the two default illusions, are rendered and journaled,
+/// then the journal is loaded again, and every job is looked up in it and
+/// has its output verified, which is the work done by a restarted batch
+/// before rendering anything. Verification is timed both with `-quick`,
+/// which checks sizes only, and by default, which hashes every output, on
+/// one thread and on one thread per core. With `-norender` nothing is
+/// rendered or verified and the journal holds made-up digests, so that the
+/// journal itself can be timed at a million jobs or more. The journal and
+/// outputs are deleted afterwards.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchJournalCommand(size_t argc, const char* const argv[]){
+  const bool render = argc < 2 || strcmp(argv[argc - 1], "-norender");
+  if(!render)argc--;
+
+  if(argc < 1 || argc > 2){
+    printf("Expected number of jobs [journal file] [-norender]\n");
+    return 1;
+  } //if
+
+  const size_t n = (size_t)strtoull(argv[0], nullptr, 10); //number of jobs
+  const std::string fname = argc > 1? argv[1]: "bench.journal"; //journal
+  std::vector<std::string> paths(n); //output file names
+  std::vector<Digest> digests(n); //digests of outputs
+  size_t bytes = 0; //total size of outputs
+
+  CTimer timer; //stopwatch
+
+  for(size_t i=0; i<n && !render; i++){ //make up digests
+    paths[i] = "bench/job" + std::to_string(i) + ".svg";
+    digests[i].size = 15000 + i%1000;
+    digests[i].hash = 0x9E3779B97F4A7C15ULL*(i + 1);
+  } //for
+
+  for(size_t i=0; i<n && render; i++){ //render the outputs
+    Job job; //job descriptor
+    job.kind = i%2 + 1;
+    job.fname = "journal" + std::to_string(i);
+    job.w = 800;
+    job.n = job.kind == 1? 4: 3;
+    job.p[0] = job.kind == 1? 100.0f: 300.0f;
+    job.p[1] = job.kind == 1? 72.0f: 12.0f;
+    job.p[2] = job.kind == 1? 24.0f: 6.0f;
+    job.dark = "black";
+    job.light = "white";
+    job.bgclr = "gray";
+    paths[i] = job.fname + ".svg";
+
+    if(!RenderJob(job, &digests[i])){
+      printf("Cannot write %s\n", paths[i].c_str());
+      return 1;
+    } //if
+
+    bytes += digests[i].size;
+  } //for
+
+  const double tRender = timer.Elapsed(); //time to render
+
+  remove(fname.c_str());
+  timer.Start();
+
+  CJournal writer; //journal for writing
+
+  if(!writer.Open(fname)){
+    printf("Cannot write %s\n", fname.c_str());
+    return 1;
+  } //if
+
+  for(size_t i=0; i<n; i++)
+    writer.Append(paths[i], digests[i]);
+
+  writer.Close();
+  const double tAppend = timer.Elapsed(); //time to append
+
+  timer.Start();
+  CJournal reader; //journal for reading
+  const size_t loaded = reader.Load(fname); //number of files in journal
+  const double tLoad = timer.Elapsed(); //time to load
+
+  timer.Start();
+  size_t found = 0; //number of jobs found in journal
+
+  for(size_t i=0; i<n; i++)
+    if(reader.Find(paths[i], digests[i]))found++;
+
+  const double tFind = timer.Elapsed(); //time to look up
+  const double tIndex = tLoad + tFind; //journal overhead
+
+  if(!render){
+    remove(fname.c_str());
+
+    printf("Journal of %zu jobs, nothing rendered\n", n);
+    printf("  append  %10.3f s, %8.3f us/job\n", tAppend, 1e6*tAppend/n);
+    printf("  load    %10.3f s, %8.3f us/job\n", tLoad, 1e6*tLoad/n);
+    printf("  lookup  %10.3f s, %8.3f us/job\n", tFind, 1e6*tFind/n);
+    printf("  restart overhead %0.3f s before verifying outputs\n", tIndex);
+
+    return loaded == n && found == n? 0: 1;
+  } //if
+
+  timer.Start();
+  size_t quick = 0; //number of outputs with the right size
+
+  for(size_t i=0; i<n; i++)
+    if(Verify(paths[i], digests[i], true))quick++;
+
+  const double tStat = timer.Elapsed(); //time to check sizes
+
+  timer.Start();
+  size_t hashed = 0; //number of outputs with the right hash
+
+  for(size_t i=0; i<n; i++)
+    if(Verify(paths[i], digests[i], false))hashed++;
+
+  const double tHash = timer.Elapsed(); //time to check hashes
+
+  CThreadPool pool; //one thread per core
+  std::vector<char> valid(n, 0); //whether each output has the right hash
+  timer.Start();
+
+  for(size_t i=0; i<n; i++)
+    pool.Enqueue([&, i](){valid[i] = Verify(paths[i], digests[i], false);});
+
+  pool.Wait();
+  const double tPool = timer.Elapsed(); //time to check hashes in parallel
+  const size_t pooled = std::count(valid.begin(), valid.end(), 1); //valid
+
+  remove(fname.c_str());
+
+  for(const std::string& path: paths)
+    remove(path.c_str());
+
+  printf("Journal of %zu jobs, %0.1f MB of output rendered in %0.3f s\n", n,
+    bytes/1048576.0, tRender);
+  printf("  append  %10.3f s, %8.3f us/job\n", tAppend, 1e6*tAppend/n);
+  printf("  load    %10.3f s, %8.3f us/job\n", tLoad, 1e6*tLoad/n);
+  printf("  lookup  %10.3f s, %8.3f us/job\n", tFind, 1e6*tFind/n);
+  printf("  stat    %10.3f s, %8.3f us/job\n", tStat, 1e6*tStat/n);
+  printf("  hash    %10.3f s, %8.3f us/job, %0.1f MB/s\n", tHash,
+    1e6*tHash/n, tHash > 0? bytes/1048576.0/tHash: 0);
+  printf("  hash on %zu threads %0.3f s, %0.3f us/job\n", pool.Size(), tPool,
+    1e6*tPool/n);
+  printf("  restart overhead %0.3f s with -quick, %0.3f s without\n",
+    tIndex + tStat, tIndex + tHash);
+
+  return loaded == n && found == n && quick == n && hashed == n &&
+    pooled == n? 0: 1;
+} //BenchJournalCommand
+
+#pragma endregion benchmark
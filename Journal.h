@@ -0,0 +1,78 @@
+/// \file Journal.h
+
+/// \brief Interface for the batch journal CJournal.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Journal_h__
+#define __Journal_h__
+
+#include <stdio.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Hash.h"
+
+/// \brief Batch journal.
+///
+/// A journal is an append-only text file with one line per finished output,
+/// consisting of the hash of the output in hex, its size in bytes, and
+/// its file name, for example
+///
+///     9b0c2d1f6a4e3c88 15506 output1.svg
+///
+/// Each line is appended with a single write as soon as its output has been
+/// renamed into place, so an interrupted batch leaves at worst a partial
+/// last line, which is ignored when the journal is loaded. If a file name
+/// appears more than once, the last line wins.
+
+class CJournal{
+  private:
+    FILE* m_pFile = nullptr; ///< Journal file open for appending.
+    bool m_bSync = false; ///< Flush each line to disk.
+    bool m_bTorn = false; ///< Journal ends in a partial line.
+    size_t m_nLines = 0; ///< Number of complete lines in journal file.
+    std::unordered_map<std::string, Digest> m_mapDigest; ///< Digests by file name.
+
+  public:
+    ~CJournal(); ///< Destructor.
+
+    size_t Load(const std::string& fname); ///< Load a journal.
+    bool Open(const std::string& fname, bool sync=false); ///< Open for appending.
+    void Close(); ///< Close.
+
+    bool Append(const std::string& path, const Digest& digest); ///< Append a line.
+    bool Save(const std::string& fname, const std::vector<std::string>& paths); ///< Rewrite.
+    bool Find(const std::string& path, Digest& digest) const; ///< Look up a file.
+    size_t Size() const; ///< Number of files.
+    size_t Lines() const; ///< Number of lines.
+}; //CJournal
+
+size_t FileSize(const std::string& fname);
+bool Verify(const std::string& fname, const Digest& digest, bool quick);
+
+int BenchJournalCommand(size_t argc, const char* const argv[]);
+
+#endif //__Journal_h__
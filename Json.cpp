@@ -0,0 +1,122 @@
+/// \file Json.cpp
+
+/// \brief Code for the minimal JSON parser CJsonParser.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Json.h"
+
+#include <stdlib.h>
+
+/// \param s Null-terminated string to be parsed.
+
+CJsonParser::CJsonParser(const char* s): m_pNext(s){
+} //constructor
+
+void CJsonParser::SkipSpace(){
+  while(*m_pNext == ' ' || *m_pNext == '\t' || *m_pNext == '\r' ||
+    *m_pNext == '\n')
+    m_pNext++;
+} //SkipSpace
+
+/// \param c Character.
+/// \return true if `c` was the next non-space character.
+
+bool CJsonParser::Accept(char c){
+  SkipSpace();
+
+  if(*m_pNext == c){
+    m_pNext++;
+    return true;
+  } //if
+
+  return false;
+} //Accept
+
+/// \param c Character.
+
+void CJsonParser::Expect(char c){
+  if(!Accept(c))m_bOK = false;
+} //Expect
+
+/// \return The string without quotes.
+
+std::string CJsonParser::String(){
+  std::string s; //result
+  Expect('"');
+
+  while(m_bOK && *m_pNext != '"'){
+    if(*m_pNext == '\\')m_pNext++;
+    if(*m_pNext == 0)m_bOK = false;
+    else s += *m_pNext++;
+  } //while
+
+  Expect('"');
+  return s;
+} //String
+
+/// \return The number parsed.
+
+size_t CJsonParser::Unsigned(){
+  SkipSpace();
+  char* end = nullptr; //end of number
+  const size_t n = (size_t)strtoull(m_pNext, &end, 10);
+  if(end == m_pNext || *m_pNext == '-')m_bOK = false;
+  m_pNext = end;
+  return n;
+} //Unsigned
+
+/// \return The number parsed.
+
+float CJsonParser::Float(){
+  SkipSpace();
+  char* end = nullptr; //end of number
+  const float x = strtof(m_pNext, &end);
+  if(end == m_pNext)m_bOK = false;
+  m_pNext = end;
+  return x;
+} //Float
+
+/// \return The number parsed.
+
+double CJsonParser::Double(){
+  SkipSpace();
+  char* end = nullptr; //end of number
+  const double x = strtod(m_pNext, &end);
+  if(end == m_pNext)m_bOK = false;
+  m_pNext = end;
+  return x;
+} //Double
+
+/// \return true if there have been no errors.
+
+bool CJsonParser::OK() const{
+  return m_bOK;
+} //OK
+
+/// \return true if there is nothing left to parse.
+
+bool CJsonParser::Done(){
+  SkipSpace();
+  return *m_pNext == 0;
+} //Done
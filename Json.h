@@ -0,0 +1,59 @@
+/// \file Json.h
+
+/// \brief Interface for the minimal JSON parser CJsonParser.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Json_h__
+#define __Json_h__
+
+#include <string>
+
+/// \brief Minimal JSON parser.
+///
+/// This is just enough JSON to read what this program writes, for example
+/// ring descriptor files (see WriteRings()): objects with number and string
+/// values and arrays. The caller walks the structure it expects, and any
+/// mismatch makes OK() false.
+
+class CJsonParser{
+  private:
+    const char* m_pNext = nullptr; ///< Next character to be parsed.
+    bool m_bOK = true; ///< No errors so far.
+
+    void SkipSpace(); ///< Skip white space.
+
+  public:
+    CJsonParser(const char* s); ///< Constructor.
+
+    bool Accept(char c); ///< Accept a character if it is next.
+    void Expect(char c); ///< Require a character to be next.
+    std::string String(); ///< Parse a string.
+    size_t Unsigned(); ///< Parse an unsigned integer.
+    float Float(); ///< Parse a float.
+    double Double(); ///< Parse a double.
+    bool OK() const; ///< Parse succeeded.
+    bool Done(); ///< Nothing but white space left.
+}; //CJsonParser
+
+#endif //__Json_h__
@@ -0,0 +1,208 @@
+/// \file Make.cpp
+
+/// \brief Code for incremental rebuilds of job files.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Make.h"
+#include "Timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+/// \brief Rebuild the out of date outputs of a list of jobs.
+///
+/// The dependency file is a journal (see CJournal) in which the hash field
+/// of each line is the JobHash() of the job that wrote the output, rather
+/// than a hash of the output itself. A job is rendered again only if it is
+/// not in the dependency file, its job hash has changed, or (if requested)
+/// its output is missing or has changed size. This makes the cost of
+/// checking a job a hash table lookup and perhaps a `stat`, so that a large
+/// job file with a few edited lines can be brought up to date almost
+/// instantly. If several jobs write the same output, the last one wins, as
+/// it would in a batch.
+///
+/// Each output is added to the dependency file as soon as it is finished, so
+/// an interrupted rebuild loses nothing. Afterwards the dependency file is
+/// rewritten to contain exactly one line per output if it mentions outputs
+/// that are no longer in the job list, or if more than half of its lines
+/// have been superseded by later ones.
+///
+/// \param jobs Job descriptors.
+/// \param depsfile Dependency file name.
+/// \param deps Contents of dependency file, updated as jobs are rendered.
+/// \param pool Thread pool for rendering.
+/// \param check True to check the size of outputs that appear up to date.
+/// \param report [out] What was done and how long it took.
+/// \return true if every output is up to date.
+
+bool Make(const std::vector<Job>& jobs, const std::string& depsfile,
+  CJournal& deps, CThreadPool& pool, bool check, MakeReport& report)
+{
+  CTimer timer; //stopwatch for each phase
+  size_t stale = deps.Size(); //number of outputs no longer wanted
+  std::vector<std::string> paths; //output file names, one per output
+  std::unordered_map<std::string, size_t> last; //last job for each output
+  paths.reserve(jobs.size());
+  last.reserve(jobs.size());
+
+  for(size_t i=0; i<jobs.size(); i++){
+    const auto result = last.insert({jobs[i].fname + ".svg", i});
+    if(result.second)paths.push_back(result.first->first);
+    else result.first->second = i; //a later job writes the same output
+  } //for
+
+  std::vector<size_t> dirty; //indices of jobs to be rendered
+  std::vector<uint64_t> jobhash(jobs.size()); //job hashes
+  size_t found = 0; //number of outputs in dependency file
+
+  for(const std::string& path: paths){
+    const size_t i = last[path]; //job index
+    Digest digest; //digest recorded in dependency file
+    jobhash[i] = JobHash(jobs[i]);
+    const bool known = deps.Find(path, digest); //in dependency file
+    if(known)found++;
+
+    if(!known || digest.hash != jobhash[i] ||
+      (check && FileSize(path) != digest.size))
+        dirty.push_back(i);
+  } //for
+
+  stale -= found;
+  report.outputs = paths.size();
+  report.dirty = dirty.size();
+  report.tCheck = timer.Elapsed();
+
+  timer.Start();
+  std::atomic<size_t> failed(0); //number of jobs that failed
+  bool depsok = true; //dependency file written ok
+
+  if(!dirty.empty()){
+    if(!deps.Open(depsfile))
+      depsok = false;
+
+    std::mutex mutex; //guards the dependency file
+
+    for(const size_t i: dirty)
+      pool.Enqueue([&, i]{
+        Digest digest; //digest of output
+
+        if(RenderJob(jobs[i], &digest)){
+          digest.hash = jobhash[i];
+          std::lock_guard<std::mutex> lock(mutex);
+          if(!deps.Append(jobs[i].fname + ".svg", digest))depsok = false;
+        } //if
+
+        else{
+          printf("Cannot write %s.svg\n", jobs[i].fname.c_str());
+          failed++;
+        } //else
+      });
+
+    pool.Wait();
+  } //if
+
+  report.failed = failed;
+  report.tRender = timer.Elapsed();
+
+  timer.Start();
+
+  if(stale > 0 || deps.Lines() > 2*deps.Size())
+    depsok = deps.Save(depsfile, paths) && depsok;
+
+  report.tSave = timer.Elapsed();
+
+  if(!depsok)
+    printf("Cannot write %s\n", depsfile.c_str());
+
+  return failed == 0 && depsok;
+} //Make
+
+/// \brief Rebuild the out of date outputs of a job file.
+///
+/// The parameters are a job file as described in LoadJobs(), optionally
+/// followed by `-deps <file>` to name the dependency file (by default the
+/// job file name with `.deps` appended) and `-threads <n>` to set the number
+/// of rendering threads (by default one per hardware thread). See Make().
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int MakeCommand(size_t argc, const char* const argv[]){
+  std::string depsfile = argc > 0? std::string(argv[0]) + ".deps": ""; //dependency file
+  size_t threads = 0; //number of threads
+  bool ok = argc > 0; //no errors so far
+
+  for(size_t i=1; ok && i<argc; i++){ //options
+    if(!strcmp(argv[i], "-deps") && i + 1 < argc)
+      depsfile = argv[++i];
+    else if(!strcmp(argv[i], "-threads") && i + 1 < argc)
+      threads = (size_t)strtoul(argv[++i], nullptr, 10);
+    else ok = false;
+  } //for
+
+  if(!ok){
+    printf("Expected job file [-deps file] [-threads n]\n");
+    return 1;
+  } //if
+
+  CTimer total; //stopwatch for everything
+  CTimer timer; //stopwatch for each phase
+  std::vector<Job> jobs; //job descriptors
+
+  if(!LoadJobs(argv[0], jobs)){
+    printf("Cannot load jobs from %s\n", argv[0]);
+    return 1;
+  } //if
+
+  const double tParse = timer.Elapsed(); //time to load jobs
+
+  timer.Start();
+  CJournal deps; //dependency file
+  deps.Load(depsfile);
+  const double tLoad = timer.Elapsed(); //time to load dependency file
+
+  CThreadPool pool(threads); //rendering threads
+  MakeReport report; //what Make() did
+  ok = Make(jobs, depsfile, deps, pool, true, report);
+
+  printf("%zu outputs, %zu up to date, %zu rendered",
+    report.outputs, report.outputs - report.dirty,
+    report.dirty - report.failed);
+  if(report.dirty > 0)printf(" on %zu threads", pool.Size());
+  printf(", %zu failed\n", report.failed);
+
+  printf("  load jobs %8.3f ms\n", 1000*tParse);
+  printf("  load deps %8.3f ms\n", 1000*tLoad);
+  printf("  check     %8.3f ms\n", 1000*report.tCheck);
+  printf("  render    %8.3f ms\n", 1000*report.tRender);
+  printf("  save deps %8.3f ms\n", 1000*report.tSave);
+  printf("  total     %8.3f ms\n", 1000*total.Elapsed());
+
+  return ok? 0: 1;
+} //MakeCommand
@@ -0,0 +1,50 @@
+/// \file Make.h
+
+/// \brief Interface for incremental rebuilds of job files.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Make_h__
+#define __Make_h__
+
+#include "Illusion.h"
+#include "Journal.h"
+#include "ThreadPool.h"
+
+/// \brief Report from Make().
+
+struct MakeReport{
+  size_t outputs = 0; ///< Number of outputs.
+  size_t dirty = 0; ///< Number of outputs that were out of date.
+  size_t failed = 0; ///< Number of outputs that could not be written.
+  double tCheck = 0; ///< Seconds spent finding out of date outputs.
+  double tRender = 0; ///< Seconds spent rendering them.
+  double tSave = 0; ///< Seconds spent rewriting the dependency file.
+}; //MakeReport
+
+bool Make(const std::vector<Job>& jobs, const std::string& depsfile,
+  CJournal& deps, CThreadPool& pool, bool check, MakeReport& report);
+
+int MakeCommand(size_t argc, const char* const argv[]);
+
+#endif //__Make_h__
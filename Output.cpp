@@ -0,0 +1,193 @@
+/// \file Output.cpp
+
+/// \brief Code for the buffered output stream COutput.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Output.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+COutput::COutput(){
+} //constructor
+
+/// \param output File pointer, which must be open for writing.
+
+COutput::COutput(FILE* output): m_pFile(output){
+} //constructor
+
+/// \param s String to which the output will be appended.
+
+COutput::COutput(std::string& s): m_pString(&s){
+} //constructor
+
+/// Flush the buffer and close the output file if we opened it.
+
+COutput::~COutput(){
+  Close();
+} //destructor
+
+/// Open a file for writing. Subsequent output goes to the file instead of
+/// wherever it was going before. Files are opened in text mode unless
+/// they are to be hashed, in which case they should be opened in binary mode
+/// so that the hash is of the bytes in the file.
+/// \param fname File name including extension.
+/// \param binary True to open in binary mode.
+/// \return true if open succeeded.
+
+bool COutput::Open(const std::string& fname, bool binary){
+  Close();
+  const char* mode = binary? "wb": "wt"; //file mode
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&m_pFile, fname.c_str(), mode);
+#else
+  m_pFile = fopen(fname.c_str(), mode);
+#endif
+
+  m_bOwnFile = m_pFile != nullptr;
+  m_pString = nullptr;
+  m_bError = false;
+
+  return m_bOwnFile;
+} //Open
+
+/// Flush the buffer, close the output file if we opened it, and stop writing
+/// to the file or string. The byte count is retained.
+
+void COutput::Close(){
+  Flush();
+
+  if(m_bOwnFile && fclose(m_pFile) != 0)
+    m_bError = true;
+
+  m_pFile = nullptr;
+  m_bOwnFile = false;
+  m_pString = nullptr;
+} //Close
+
+/// \return true if output goes to a file or string.
+
+bool COutput::IsOpen() const{
+  return m_pFile != nullptr || m_pString != nullptr;
+} //IsOpen
+
+/// \return true if a write to the output file failed since it was opened.
+
+bool COutput::Error() const{
+  return m_bError;
+} //Error
+
+/// Hash all bytes from now on as they are flushed from the buffer. The
+/// hash is up to date only after a call to Flush() or Close().
+/// \param hash Pointer to a streaming hash, or `nullptr` to stop hashing.
+/// \param sha256 Pointer to a streaming SHA-256, or `nullptr` for none.
+
+void COutput::SetHash(CXXHash64* hash, CSha256* sha256){
+  Flush();
+  m_pHash = hash;
+  m_pSha256 = sha256;
+} //SetHash
+
+/// Write formatted output, using the same format string conventions as
+/// `printf`.
+/// \param fmt Format string.
+
+void COutput::Printf(const char* fmt, ...){
+  va_list args; //argument list
+  va_start(args, fmt);
+  int n = vsnprintf(m_pBuffer + m_nCount, BUFSIZE - m_nCount, fmt, args);
+  va_end(args);
+
+  if(n < 0)return; //format error
+
+  if((size_t)n >= BUFSIZE - m_nCount){ //didn't fit, flush and try again
+    Flush();
+
+    if((size_t)n < BUFSIZE){ //fits in an empty buffer
+      va_start(args, fmt);
+      vsnprintf(m_pBuffer, BUFSIZE, fmt, args);
+      va_end(args);
+    } //if
+
+    else{ //bigger than the buffer
+      std::string s(n + 1, 0);
+      va_start(args, fmt);
+      vsnprintf(&s[0], s.size(), fmt, args);
+      va_end(args);
+      Write(s.data(), n);
+      return;
+    } //else
+  } //if
+
+  m_nCount += n;
+} //Printf
+
+/// Write unformatted output.
+/// \param s Pointer to bytes to be written.
+/// \param n Number of bytes to be written.
+
+void COutput::Write(const char* s, size_t n){
+  if(n > BUFSIZE - m_nCount){ //doesn't fit
+    Flush();
+
+    if(n >= BUFSIZE){ //too big to buffer, write it directly
+      Send(s, n);
+      return;
+    } //if
+  } //if
+
+  memcpy(m_pBuffer + m_nCount, s, n);
+  m_nCount += n;
+} //Write
+
+/// Send bytes to the output file or string, if any, and the hash, if any,
+/// bypassing the buffer.
+/// \param s Pointer to bytes to be sent.
+/// \param n Number of bytes to be sent.
+
+void COutput::Send(const char* s, size_t n){
+  if(m_pFile != nullptr && fwrite(s, 1, n, m_pFile) != n)m_bError = true;
+  if(m_pString != nullptr)m_pString->append(s, n);
+  if(m_pHash != nullptr)m_pHash->Update(s, n);
+  if(m_pSha256 != nullptr)m_pSha256->Update(s, n);
+  m_nFlushed += n;
+} //Send
+
+/// Send the contents of the buffer to the output file or string, if any,
+/// and empty it.
+
+void COutput::Flush(){
+  if(m_nCount > 0){
+    Send(m_pBuffer, m_nCount);
+    m_nCount = 0;
+  } //if
+} //Flush
+
+/// \return Total number of bytes written, including those still in the
+/// buffer.
+
+size_t COutput::Size() const{
+  return m_nFlushed + m_nCount;
+} //Size
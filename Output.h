@@ -0,0 +1,81 @@
+/// \file Output.h
+
+/// \brief Interface for the buffered output stream COutput.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Output_h__
+#define __Output_h__
+
+#include <stdio.h>
+#include <string>
+
+#include "Hash.h"
+
+/// \brief Buffered output stream.
+///
+/// SVG is written to an output stream a few bytes at a time. The bytes are
+/// collected in a buffer which, when full, is flushed to a file, appended
+/// to a string, or simply discarded. In all three cases the output stream
+/// counts the bytes written, so that discarding them is a cheap way of
+/// measuring how large the output would be. Optionally, the bytes can also
+/// be hashed as they are flushed, with XXH64, SHA-256, or both.
+
+class COutput{
+  private:
+    static const size_t BUFSIZE = 65536; ///< Buffer size in bytes.
+
+    FILE* m_pFile = nullptr; ///< Output file, if any.
+    bool m_bOwnFile = false; ///< True if we opened the output file.
+    std::string* m_pString = nullptr; ///< Output string, if any.
+    CXXHash64* m_pHash = nullptr; ///< Hash of bytes flushed, if any.
+    CSha256* m_pSha256 = nullptr; ///< SHA-256 of bytes flushed, if any.
+    bool m_bError = false; ///< True if a write to the file failed.
+
+    char m_pBuffer[BUFSIZE]; ///< Buffer.
+    size_t m_nCount = 0; ///< Number of bytes in buffer.
+    size_t m_nFlushed = 0; ///< Number of bytes flushed from buffer.
+
+    void Send(const char* s, size_t n); ///< Send bytes past the buffer.
+
+  public:
+    COutput(); ///< Constructor for counting bytes only.
+    COutput(FILE* output); ///< Constructor for an open file.
+    COutput(std::string& s); ///< Constructor for a string.
+    ~COutput(); ///< Destructor.
+
+    bool Open(const std::string& fname, bool binary=false); ///< Open a file.
+    void Close(); ///< Flush and close.
+    bool IsOpen() const; ///< Is there somewhere to write to?
+    bool Error() const; ///< Did a write fail?
+    void SetHash(CXXHash64* hash,
+      CSha256* sha256=nullptr); ///< Hash bytes as they are flushed.
+
+    void Printf(const char* fmt, ...); ///< Formatted write.
+    void Write(const char* s, size_t n); ///< Unformatted write.
+    void Flush(); ///< Flush the buffer.
+
+    size_t Size() const; ///< Number of bytes written so far.
+}; //COutput
+
+#endif //__Output_h__
@@ -0,0 +1,723 @@
+/// \file Pack.cpp
+
+/// \brief Code for the deduplicating pack store.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Journal.h"
+#include "Pack.h"
+#include "Timer.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#ifdef _MSC_VER //Visual Studio
+  #include <io.h>
+#else
+  #include <limits.h>
+  #include <sys/uio.h>
+  #include <unistd.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Helpers.
+
+#pragma region helpers
+
+/// \brief Open a file.
+///
+/// \param fname File name.
+/// \param mode File mode, as for `fopen`.
+/// \return File pointer, or `nullptr` if the file could not be opened.
+
+static FILE* OpenFile(const std::string& fname, const char* mode){
+  FILE* file = nullptr; //file pointer
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&file, fname.c_str(), mode);
+#else
+  file = fopen(fname.c_str(), mode);
+#endif
+
+  return file;
+} //OpenFile
+
+/// \brief Read the complete lines of a text file.
+///
+/// A missing file has no lines, and a partial last line left by an
+/// interrupted write is ignored.
+///
+/// \param fname File name.
+/// \param lines [out] Lines without their newlines.
+
+static void ReadLines(const std::string& fname,
+  std::vector<std::string>& lines)
+{
+  lines.clear();
+  FILE* input = OpenFile(fname, "rb"); //input file
+  if(input == nullptr)return;
+
+  std::string line; //current line
+  int c = 0; //current character
+
+  while((c = fgetc(input)) != EOF)
+    if(c == '\n'){
+      lines.push_back(line);
+      line.clear();
+    } //if
+    else line += (char)c;
+
+  fclose(input);
+} //ReadLines
+
+/// \brief Write a list of byte ranges to a file descriptor.
+///
+/// On POSIX systems the ranges are written with `writev`, up to `IOV_MAX`
+/// at a time, so that a whole SVG file usually takes a single system call
+/// and no copying.
+///
+/// \param fd File descriptor.
+/// \param spans Pointer and size of each byte range.
+/// \return true if everything was written.
+
+static bool WriteSpans(int fd,
+  std::vector<std::pair<const char*, size_t>>& spans)
+{
+#ifdef _MSC_VER //Visual Studio
+  for(const auto& span: spans)
+    if(_write(fd, span.first, (unsigned)span.second) != (int)span.second)
+      return false;
+
+  return true;
+#else
+  std::vector<struct iovec> iov(spans.size()); //io vectors
+
+  for(size_t i=0; i<spans.size(); i++){
+    iov[i].iov_base = (void*)spans[i].first;
+    iov[i].iov_len = spans[i].second;
+  } //for
+
+  size_t first = 0; //first io vector not yet written
+
+  while(first < iov.size()){
+    const int count = (int)std::min<size_t>(iov.size() - first, IOV_MAX);
+    ssize_t n = writev(fd, &iov[first], count); //bytes written
+    if(n < 0)return false;
+
+    while(first < iov.size() && (size_t)n >= iov[first].iov_len)
+      n -= iov[first++].iov_len;
+
+    if(first < iov.size()){ //partial write, skip what was written
+      iov[first].iov_base = (char*)iov[first].iov_base + n;
+      iov[first].iov_len -= n;
+    } //if
+  } //while
+
+  return true;
+#endif
+} //WriteSpans
+
+/// \brief Draw a job as fragments.
+///
+/// Draw a job's SVG split at ring boundaries: the header and style, one
+/// fragment for each ring, and the close tag. Concatenated in order, the
+/// fragments are the same as the output of DrawJob().
+///
+/// \param job Job descriptor.
+/// \param fragments [out] Fragments of SVG.
+
+void DrawFragments(const Job& job, std::vector<std::string>& fragments){
+  Illusion illusion; //illusion descriptor
+  Describe(illusion, job);
+  fragments.assign(illusion.rings.size() + 2, std::string());
+
+  COutput output(fragments[0]); //output stream
+  DrawHeader(output, job.w, job.w);
+  DrawStyle(output, illusion);
+  output.Close();
+
+  for(size_t i=0; i<illusion.rings.size(); i++){
+    COutput ring(fragments[i + 1]); //output stream for ring
+    DrawRing(ring, illusion.cx, illusion.cy, illusion.rings[i]);
+  } //for
+
+  COutput close(fragments.back()); //output stream for close tag
+  CloseSVG(close);
+} //DrawFragments
+
+#pragma endregion helpers
+
+//////////////////////////////////////////////////////////////////////////
+// CPackStore.
+
+#pragma region CPackStore
+
+/// Close the pack files, if they are open.
+
+CPackStore::~CPackStore(){
+  Close();
+} //destructor
+
+/// Read the data, index, and manifest files into memory. Index lines that
+/// refer past the end of the data, and manifest lines that refer to
+/// missing fragments, are ignored, so that a pack whose files were not all
+/// written completely is still consistent.
+/// \return true if the data file was read, or did not exist.
+
+bool CPackStore::Load(){
+  m_strData.clear();
+  m_mapFragment.clear();
+  m_mapManifest.clear();
+  m_vNames.clear();
+  m_nRaw = 0;
+
+  FILE* input = OpenFile(m_strName + ".dat", "rb"); //data file
+
+  if(input != nullptr){
+    char buffer[65536]; //read buffer
+    size_t n = 0; //bytes read
+
+    while((n = fread(buffer, 1, sizeof(buffer), input)) > 0)
+      m_strData.append(buffer, n);
+
+    const bool ok = !ferror(input); //read succeeded
+    fclose(input);
+    if(!ok)return false;
+  } //if
+
+  std::vector<std::string> lines; //lines of text file
+  ReadLines(m_strName + ".idx", lines);
+
+  for(const std::string& line: lines){
+    unsigned long long key = 0; //fragment key
+    Fragment f; //fragment location
+
+    if(sscanf(line.c_str(), "%llx %zu %zu", &key, &f.offset, &f.size) == 3 &&
+      f.offset <= m_strData.size() && f.size <= m_strData.size() - f.offset)
+        m_mapFragment[key] = f;
+  } //for
+
+  ReadLines(m_strName + ".man", lines);
+
+  for(const std::string& line: lines){
+    const char* s = line.c_str(); //remainder of line
+    char* end = nullptr; //end of number parsed
+    const size_t n = (size_t)strtoul(s, &end, 10); //number of fragments
+    std::vector<uint64_t> keys; //fragment keys
+    size_t size = 0; //size of SVG file
+    bool ok = end != s; //no errors so far
+
+    for(size_t i=0; ok && i<n; i++){
+      s = end;
+      keys.push_back((uint64_t)strtoull(s, &end, 16));
+      const auto p = m_mapFragment.find(keys.back()); //fragment
+      ok = end != s && p != m_mapFragment.end();
+      if(ok)size += p->second.size;
+    } //for
+
+    if(ok && *end == ' ' && end[1] != 0){
+      const std::string fname(end + 1); //file name
+      if(m_mapManifest.find(fname) == m_mapManifest.end())
+        m_vNames.push_back(fname);
+      else m_nRaw -= Size(fname); //replaced by a later line
+
+      m_mapManifest[fname] = keys;
+      m_nRaw += size;
+    } //if
+  } //for
+
+  return true;
+} //Load
+
+/// Open a pack store, creating it if it doesn't exist, and load it into
+/// memory.
+/// \param name Pack name, to which the extensions of the pack files are
+/// added.
+/// \return true if the pack files could be read and opened for appending.
+
+bool CPackStore::Open(const std::string& name){
+  Close();
+  m_strName = name;
+  m_bError = false;
+
+  if(!Load())return false;
+
+  m_pData = OpenFile(name + ".dat", "ab");
+  m_pIndex = OpenFile(name + ".idx", "ab");
+  m_pManifest = OpenFile(name + ".man", "ab");
+
+  if(m_pData == nullptr || m_pIndex == nullptr || m_pManifest == nullptr){
+    Close();
+    return false;
+  } //if
+
+  return true;
+} //Open
+
+/// Close the pack files. The data file is closed before the index, and the
+/// index before the manifests, so that nothing refers to bytes that might
+/// not have been written.
+/// \return true if every write succeeded.
+
+bool CPackStore::Close(){
+  FILE** files[3] = {&m_pData, &m_pIndex, &m_pManifest}; //pack files
+  bool open = false; //some pack file was open
+
+  for(FILE** f: files)
+    if(*f != nullptr){
+      if(fclose(*f) != 0)m_bError = true;
+      *f = nullptr;
+      open = true;
+    } //if
+
+  return open && !m_bError;
+} //Close
+
+/// Store a fragment if it isn't already in the pack.
+/// \param fragment Fragment of SVG.
+/// \return Key of fragment.
+
+uint64_t CPackStore::Store(const std::string& fragment){
+  CXXHash64 hash; //hash of fragment
+  hash.Update(fragment.data(), fragment.size());
+  uint64_t key = hash.Digest(); //fragment key
+
+  for(;;){ //probe for the fragment or a free key
+    const auto p = m_mapFragment.find(key); //fragment with this key
+
+    if(p == m_mapFragment.end())break;
+
+    if(p->second.size == fragment.size() && !memcmp(fragment.data(),
+      m_strData.data() + p->second.offset, fragment.size()))
+        return key; //already stored
+
+    key++;
+  } //for
+
+  Fragment& f = m_mapFragment[key]; //new fragment
+  f.offset = m_strData.size();
+  f.size = fragment.size();
+  m_strData += fragment;
+
+  if(fwrite(fragment.data(), 1, fragment.size(), m_pData) != fragment.size())
+    m_bError = true;
+
+  fprintf(m_pIndex, "%s %zu %zu\n", HexHash(key).c_str(), f.offset, f.size);
+
+  return key;
+} //Store
+
+/// Add an SVG file to the pack, storing only fragments that aren't in it
+/// already. If a file of the same name is already in the pack, the new one
+/// replaces it, unless it is the same file, in which case nothing is
+/// written to the manifest file.
+/// \param fname File name.
+/// \param fragments Fragments of the SVG, in order (see DrawFragments()).
+/// \return true if the pack is open and no writes have failed.
+
+bool CPackStore::Add(const std::string& fname,
+  const std::vector<std::string>& fragments)
+{
+  if(m_pManifest == nullptr)return false;
+
+  std::vector<uint64_t> keys; //fragment keys
+  std::string line = std::to_string(fragments.size()); //manifest line
+  size_t size = 0; //size of SVG file
+
+  for(const std::string& fragment: fragments){
+    keys.push_back(Store(fragment));
+    line += " " + HexHash(keys.back());
+    size += fragment.size();
+  } //for
+
+  const auto p = m_mapManifest.find(fname); //existing manifest
+
+  if(p == m_mapManifest.end())
+    m_vNames.push_back(fname);
+
+  else if(p->second == keys) //same file again
+    return !m_bError;
+
+  else m_nRaw -= Size(fname); //replaced
+
+  line += " " + fname + "\n";
+
+  if(fwrite(line.data(), 1, line.size(), m_pManifest) != line.size())
+    m_bError = true;
+
+  m_mapManifest[fname] = keys;
+  m_nRaw += size;
+  return !m_bError;
+} //Add
+
+/// Reassemble an SVG file and write it to a file descriptor with a vectored
+/// write, straight from the fragments in memory.
+/// \param fname File name.
+/// \param fd File descriptor open for writing.
+/// \return true if the file is in the pack and was written.
+
+bool CPackStore::Extract(const std::string& fname, int fd) const{
+  const auto p = m_mapManifest.find(fname); //manifest
+  if(p == m_mapManifest.end())return false;
+
+  std::vector<std::pair<const char*, size_t>> spans; //fragments
+
+  for(uint64_t key: p->second){
+    const Fragment& f = m_mapFragment.at(key); //fragment
+    spans.push_back(std::make_pair(m_strData.data() + f.offset, f.size));
+  } //for
+
+  return WriteSpans(fd, spans);
+} //Extract
+
+/// Reassemble an SVG file and write it to the file of that name, by way of
+/// a temporary file.
+/// \param fname File name.
+/// \return true if the file is in the pack and was written.
+
+bool CPackStore::Extract(const std::string& fname) const{
+  if(m_mapManifest.find(fname) == m_mapManifest.end())return false;
+  const std::string temp = TempName(fname); //temporary file name
+
+#ifdef _MSC_VER //Visual Studio
+  int fd = -1; //file descriptor
+  _sopen_s(&fd, temp.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+    _SH_DENYWR, _S_IREAD | _S_IWRITE);
+#else
+  const int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+
+  if(fd < 0)return false;
+  bool ok = Extract(fname, fd); //written
+
+#ifdef _MSC_VER //Visual Studio
+  ok = _close(fd) == 0 && ok;
+#else
+  ok = close(fd) == 0 && ok;
+#endif
+
+  return MoveIntoPlace(temp, fname, ok);
+} //Extract
+
+/// \return Names of the SVG files in the pack, in the order in which they
+/// were first added.
+
+const std::vector<std::string>& CPackStore::Names() const{
+  return m_vNames;
+} //Names
+
+/// \return Number of distinct fragments in the pack.
+
+size_t CPackStore::Fragments() const{
+  return m_mapFragment.size();
+} //Fragments
+
+/// \return Total size in bytes of the SVG files in the pack.
+
+size_t CPackStore::Raw() const{
+  return m_nRaw;
+} //Raw
+
+/// \param fname File name.
+/// \return Size in bytes of an SVG file in the pack, 0 if it isn't there.
+
+size_t CPackStore::Size(const std::string& fname) const{
+  const auto p = m_mapManifest.find(fname); //manifest
+  if(p == m_mapManifest.end())return 0;
+
+  size_t size = 0; //size of file
+
+  for(uint64_t key: p->second)
+    size += m_mapFragment.at(key).size;
+
+  return size;
+} //Size
+
+#pragma endregion CPackStore
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Make color variants of a few illusions.
+///
+/// Make jobs for a corpus of illusions in which most of the bytes are
+/// shared, as they would be in a real collection of variants: 10 shapes of
+/// 800-pixel illusions, each with many combinations of dark, light, and
+/// background colors from a palette of 22. Job `i` has shape `i%10`, and
+/// the colors are the digits of `i/10` in base 22. The SVG files are named
+/// `variant<i>.svg` in the given directory.
+///
+/// \param dir Directory.
+/// \param n Number of variants.
+/// \param jobs [out] Job descriptors.
+
+void MakeVariants(const std::string& dir, size_t n, std::vector<Job>& jobs){
+  static const char* color[] = {"black", "white", "gray", "red", "green",
+    "blue", "yellow", "cyan", "magenta", "orange", "purple", "brown",
+    "pink", "navy", "teal", "olive", "maroon", "silver", "gold", "indigo",
+    "coral", "forestgreen"}; //colors
+  const size_t ncolors = sizeof(color)/sizeof(color[0]); //number of colors
+
+  static const float shape[][5] = {
+    {1, 3, 100, 72, 24}, {1, 4, 100, 72, 24}, {1, 5, 100, 72, 24},
+    {1, 4, 100, 72, 20}, {1, 5, 100, 72, 20}, {1, 4, 120, 60, 20},
+    {2, 3, 300, 12, 6}, {2, 3, 250, 12, 6}, {2, 3, 300, 12, 5},
+    {2, 3, 250, 10, 5}}; //kind, n, and shape parameters
+  const size_t nshapes = sizeof(shape)/sizeof(shape[0]); //number of shapes
+
+  jobs.assign(n, Job());
+
+  for(size_t i=0; i<n; i++){
+    Job& job = jobs[i]; //job descriptor
+    const float* s = shape[i%nshapes]; //shape
+    size_t c = i/nshapes; //color combination
+
+    job.kind = (size_t)s[0];
+    job.fname = dir + "/variant" + std::to_string(i);
+    job.w = 800;
+    job.n = (size_t)s[1];
+    job.p[0] = s[2]; job.p[1] = s[3]; job.p[2] = s[4];
+    job.dark = color[c%ncolors]; c /= ncolors;
+    job.light = color[c%ncolors]; c /= ncolors;
+    job.bgclr = color[c%ncolors];
+  } //for
+} //MakeVariants
+
+/// \brief Print the storage savings of a pack.
+///
+/// \param pack Pack store.
+/// \param name Pack name.
+
+static void PrintSavings(const CPackStore& pack, const std::string& name){
+  const size_t stored = FileSize(name + ".dat") + FileSize(name + ".idx") +
+    FileSize(name + ".man"); //bytes in pack files
+
+  printf("%zu files, %zu distinct fragments\n", pack.Names().size(),
+    pack.Fragments());
+  printf("%0.2f MB of SVG stored in %0.2f MB, %0.1f times smaller\n",
+    pack.Raw()/1048576.0, stored/1048576.0,
+    stored > 0? (double)pack.Raw()/stored: 0);
+} //PrintSavings
+
+/// \brief Add the illusions in a job file to a pack store.
+///
+/// The parameters are a job file as described in LoadJobs() and a pack
+/// name (see CPackStore). Each job's SVG is drawn in fragments and added to
+/// the pack under the name of its SVG file, and the storage savings are
+/// reported.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int PackCommand(size_t argc, const char* const argv[]){
+  if(argc != 2){
+    printf("Expected job file and pack name\n");
+    return 1;
+  } //if
+
+  std::vector<Job> jobs; //job descriptors
+
+  if(!LoadJobs(argv[0], jobs)){
+    printf("Cannot load jobs from %s\n", argv[0]);
+    return 1;
+  } //if
+
+  CTimer timer; //stopwatch
+  CPackStore pack; //pack store
+  std::vector<std::string> fragments; //fragments of SVG
+  bool ok = pack.Open(argv[1]); //no errors so far
+
+  for(size_t i=0; ok && i<jobs.size(); i++){
+    DrawFragments(jobs[i], fragments);
+    ok = pack.Add(jobs[i].fname + ".svg", fragments);
+  } //for
+
+  ok = pack.Close() && ok;
+
+  if(!ok){
+    printf("Cannot write pack %s\n", argv[1]);
+    return 1;
+  } //if
+
+  printf("Packed %zu jobs in %0.3f s\n", jobs.size(), timer.Elapsed());
+  PrintSavings(pack, argv[1]);
+
+  return 0;
+} //PackCommand
+
+/// \brief Extract SVG files from a pack store.
+///
+/// The parameters are a pack name, optionally followed by the name of one
+/// SVG file in it, which is written to `stdout`. Otherwise every SVG file in
+/// the pack is written to the file of that name and the throughput is
+/// reported.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int UnpackCommand(size_t argc, const char* const argv[]){
+  if(argc != 1 && argc != 2){
+    printf("Expected pack name [file name]\n");
+    return 1;
+  } //if
+
+  CPackStore pack; //pack store
+
+  if(!pack.Open(argv[0])){
+    fprintf(stderr, "Cannot open pack %s\n", argv[0]);
+    return 1;
+  } //if
+
+  pack.Close();
+
+  if(argc == 2){ //one file to stdout
+    fflush(stdout);
+
+    if(!pack.Extract(argv[1], 1)){
+      fprintf(stderr, "Cannot extract %s\n", argv[1]);
+      return 1;
+    } //if
+
+    return 0;
+  } //if
+
+  CTimer timer; //stopwatch
+  size_t failed = 0; //number of files not written
+  size_t bytes = 0; //number of bytes written
+
+  for(const std::string& fname: pack.Names())
+    if(pack.Extract(fname))bytes += pack.Size(fname);
+    else{
+      printf("Cannot write %s\n", fname.c_str());
+      failed++;
+    } //else
+
+  const double t = timer.Elapsed(); //elapsed time
+  const size_t n = pack.Names().size() - failed; //number of files written
+
+  printf("Extracted %zu files in %0.3f s, %0.1f files/s, %0.1f MB/s\n", n, t,
+    t > 0? n/t: 0, t > 0? bytes/1048576.0/t: 0);
+
+  return failed > 0? 1: 0;
+} //UnpackCommand
+
+/// \brief Benchmark the pack store.
+///
+/// The parameters are a directory, optionally followed by `-variants n`
+/// (default 100000). That many variants of a few illusions in different
+/// colors are packed into a fresh pack store `bench` in the directory, and
+/// then every one of them is extracted into the directory. The storage
+/// savings and the throughput of packing and extraction are reported, and
+/// a sample of the extracted files is checked against the output of
+/// DrawJob().
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchPackCommand(size_t argc, const char* const argv[]){
+  size_t n = 100000; //number of variants
+
+  if(argc == 3 && !strcmp(argv[1], "-variants"))
+    n = std::max<size_t>(1, (size_t)strtoul(argv[2], nullptr, 10));
+
+  else if(argc != 1){
+    printf("Expected directory [-variants n]\n");
+    return 1;
+  } //if
+
+  const std::string dir = argv[0]; //output directory
+  const std::string name = dir + "/bench"; //pack name
+
+  std::vector<Job> jobs; //job descriptors
+  MakeVariants(dir, n, jobs);
+
+  remove((name + ".dat").c_str());
+  remove((name + ".idx").c_str());
+  remove((name + ".man").c_str());
+
+  CTimer timer; //stopwatch
+  CPackStore pack; //pack store
+  std::vector<std::string> fragments; //fragments of SVG
+  bool ok = pack.Open(name); //no errors so far
+
+  for(size_t i=0; ok && i<n; i++){
+    DrawFragments(jobs[i], fragments);
+    ok = pack.Add(jobs[i].fname + ".svg", fragments);
+  } //for
+
+  ok = pack.Close() && ok;
+  const double tPack = timer.Elapsed(); //time to pack
+
+  if(!ok){
+    printf("Cannot write pack %s\n", name.c_str());
+    return 1;
+  } //if
+
+  printf("Packed %zu variants in %0.3f s, %0.1f variants/s\n", n, tPack,
+    n/tPack);
+  PrintSavings(pack, name);
+
+  timer.Start();
+  size_t failed = 0; //number of files not extracted
+
+  for(const std::string& fname: pack.Names())
+    if(!pack.Extract(fname))failed++;
+
+  const double tExtract = timer.Elapsed(); //time to extract
+
+  printf("Extracted %zu files in %0.3f s, %0.1f files/s, %0.1f MB/s\n",
+    n - failed, tExtract, (n - failed)/tExtract,
+    pack.Raw()/1048576.0/tExtract);
+
+  size_t wrong = 0; //number of sampled files that differ
+
+  for(size_t i=0; i<n; i+=std::max<size_t>(1, n/100)){
+    std::string svg; //expected SVG
+    COutput output(svg); //output stream
+    DrawJob(output, jobs[i]);
+    output.Close();
+
+    CXXHash64 hash; //hash of expected SVG
+    hash.Update(svg.data(), svg.size());
+    size_t size = 0; //size of extracted file
+
+    if(HashFile(jobs[i].fname + ".svg", size) != hash.Digest() ||
+      size != svg.size())
+        wrong++;
+  } //for
+
+  if(failed > 0)printf("%zu files could not be extracted\n", failed);
+  if(wrong > 0)printf("%zu sampled files are wrong\n", wrong);
+
+  return failed > 0 || wrong > 0? 1: 0;
+} //BenchPackCommand
+
+#pragma endregion commands
@@ -0,0 +1,106 @@
+/// \file Pack.h
+
+/// \brief Interface for the deduplicating pack store.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Pack_h__
+#define __Pack_h__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Illusion.h"
+
+/// \brief Deduplicating pack store.
+///
+/// Illusions that differ only in their colors have the same rings, because
+/// the colors are set in the `style` tag and the elements refer to them by
+/// class. A pack store splits each SVG file at ring boundaries into
+/// fragments: the header and style, one fragment per ring, and the close
+/// tag. Each distinct fragment is stored once, keyed by its XXH64 hash, and
+/// each SVG file is stored as a manifest listing the keys of its fragments.
+/// In the unlikely event that two different fragments have the same hash,
+/// the second is stored under the next free key.
+///
+/// A pack store named `pack` consists of three append-only files:
+/// `pack.dat` holds the fragments back to back, `pack.idx` has a line for
+/// each fragment with its key in hex, offset, and size, and `pack.man` has a
+/// line for each SVG file with the number of fragments, their keys, and the
+/// file name. The fragments are kept in memory while the pack is open, so
+/// that an SVG file can be reassembled from them with a single vectored
+/// write.
+
+class CPackStore{
+  private:
+    /// \brief Location of a fragment in the data file.
+
+    struct Fragment{
+      size_t offset = 0; ///< Offset in bytes.
+      size_t size = 0; ///< Size in bytes.
+    }; //Fragment
+
+    std::string m_strName; ///< Pack name.
+    std::string m_strData; ///< Contents of data file.
+    std::unordered_map<uint64_t, Fragment> m_mapFragment; ///< Fragments by key.
+    std::unordered_map<std::string, std::vector<uint64_t>> m_mapManifest; ///< Manifests by file name.
+    std::vector<std::string> m_vNames; ///< File names in the order added.
+
+    FILE* m_pData = nullptr; ///< Data file open for appending.
+    FILE* m_pIndex = nullptr; ///< Index file open for appending.
+    FILE* m_pManifest = nullptr; ///< Manifest file open for appending.
+    bool m_bError = false; ///< True if a write failed.
+    size_t m_nRaw = 0; ///< Total size of the SVG files in the pack.
+
+    bool Load(); ///< Load the pack files.
+    uint64_t Store(const std::string& fragment); ///< Store a fragment.
+
+  public:
+    ~CPackStore(); ///< Destructor.
+
+    bool Open(const std::string& name); ///< Open a pack store.
+    bool Close(); ///< Close it.
+
+    bool Add(const std::string& fname,
+      const std::vector<std::string>& fragments); ///< Add an SVG file.
+    bool Extract(const std::string& fname, int fd) const; ///< Write to file descriptor.
+    bool Extract(const std::string& fname) const; ///< Write to file.
+
+    const std::vector<std::string>& Names() const; ///< File names.
+    size_t Fragments() const; ///< Number of distinct fragments.
+    size_t Raw() const; ///< Total size of SVG files added.
+    size_t Size(const std::string& fname) const; ///< Size of an SVG file.
+}; //CPackStore
+
+void DrawFragments(const Job& job, std::vector<std::string>& fragments);
+void MakeVariants(const std::string& dir, size_t n, std::vector<Job>& jobs);
+
+int PackCommand(size_t argc, const char* const argv[]);
+int UnpackCommand(size_t argc, const char* const argv[]);
+int BenchPackCommand(size_t argc, const char* const argv[]);
+
+#endif //__Pack_h__
@@ -0,0 +1,399 @@
+/// \file Perf.cpp
+
+/// \brief Code for hardware performance counters.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Perf.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// CPerfCounters.
+
+#pragma region CPerfCounters
+
+/// Open the counters, disabled. Counters that can't be opened are marked
+/// unavailable.
+
+CPerfCounters::CPerfCounters(){
+  for(size_t i=0; i<COUNT; i++){
+    m_nFd[i] = -1;
+    m_fValue[i] = 0;
+  } //for
+
+#ifdef __linux__
+  static const uint32_t type[COUNT] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE}; //types
+
+  static const uint64_t config[COUNT] = {PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_SW_PAGE_FAULTS}; //events
+
+  for(size_t i=0; i<COUNT; i++){
+    struct perf_event_attr attr; //event attributes
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type[i];
+    attr.config = config[i];
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+      PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    m_nFd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  } //for
+#endif
+} //constructor
+
+/// Close the counters.
+
+CPerfCounters::~CPerfCounters(){
+#ifdef __linux__
+  for(size_t i=0; i<COUNT; i++)
+    if(m_nFd[i] >= 0)close(m_nFd[i]);
+#endif
+} //destructor
+
+/// Reset and enable the available counters.
+
+void CPerfCounters::Start(){
+#ifdef __linux__
+  for(size_t i=0; i<COUNT; i++)
+    if(m_nFd[i] >= 0){
+      ioctl(m_nFd[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(m_nFd[i], PERF_EVENT_IOC_ENABLE, 0);
+    } //if
+#endif
+} //Start
+
+/// Disable the available counters and add their counts, scaled for
+/// multiplexing, to the totals.
+
+void CPerfCounters::Stop(){
+#ifdef __linux__
+  for(size_t i=0; i<COUNT; i++)
+    if(m_nFd[i] >= 0)
+      ioctl(m_nFd[i], PERF_EVENT_IOC_DISABLE, 0);
+
+  for(size_t i=0; i<COUNT; i++)
+    if(m_nFd[i] >= 0){
+      uint64_t v[3] = {0, 0, 0}; //value, time enabled, time running
+
+      if(read(m_nFd[i], v, sizeof(v)) == (ssize_t)sizeof(v) && v[2] > 0)
+        m_fValue[i] += (double)v[0]*v[1]/v[2];
+    } //if
+#endif
+} //Stop
+
+/// \param i Counter index.
+/// \return true if the counter could be opened.
+
+bool CPerfCounters::Available(size_t i) const{
+  return i < COUNT && m_nFd[i] >= 0;
+} //Available
+
+/// \return true if any counter could be opened.
+
+bool CPerfCounters::Any() const{
+  for(size_t i=0; i<COUNT; i++)
+    if(m_nFd[i] >= 0)return true;
+
+  return false;
+} //Any
+
+/// \param i Counter index.
+/// \return Total count between calls to Start() and Stop().
+
+double CPerfCounters::Value(size_t i) const{
+  return i < COUNT? m_fValue[i]: 0;
+} //Value
+
+/// \param i Counter index.
+/// \return Short name of counter.
+
+const char* CPerfCounters::Name(size_t i){
+  static const char* name[COUNT] = {"cycles", "instructions",
+    "branch-misses", "cache-misses", "page-faults"}; //names
+
+  return i < COUNT? name[i]: "";
+} //Name
+
+#pragma endregion CPerfCounters
+
+//////////////////////////////////////////////////////////////////////////
+// Phase benchmark.
+
+#pragma region bench
+
+/// \brief Geometry phase.
+///
+/// Place every element of an illusion with PlaceSquare() or
+/// PlaceEllipse(), stepping angle and parity with NextElement().
+///
+/// \param illusion Illusion descriptor.
+/// \param placed [out] Placed elements in drawing order.
+
+void PlaceElements(const Illusion& illusion, std::vector<Placed>& placed){
+  size_t k = 0; //index into placed
+
+  for(const Ring& ring: illusion.rings){
+    float theta = ring.theta; //angle to element
+    bool parity = ring.parity; //element parity
+
+    for(size_t i=0; i<ring.n; i++, k++){
+      Placed& p = placed[k]; //placed element
+      p.parity = parity;
+
+      if(ring.shape == Shape::Square)
+        PlaceSquare(ring.r, parity, theta, p.x, p.y, p.phi);
+      else PlaceEllipse(ring.r, theta, p.x, p.y, p.phi);
+
+      NextElement(ring, i, theta, parity);
+    } //for
+  } //for
+} //PlaceElements
+
+/// \brief Formatting phase.
+///
+/// Output the style tag and every placed element with the ring's template,
+/// as DrawIllusion() does (see CRingWriter).
+///
+/// \param output Output stream.
+/// \param illusion Illusion descriptor.
+/// \param placed Placed elements in drawing order.
+
+void FormatElements(COutput& output, const Illusion& illusion,
+  const std::vector<Placed>& placed)
+{
+  const size_t cx = illusion.cx, cy = illusion.cy; //image center
+  size_t k = 0; //index into placed
+  DrawStyle(output, illusion);
+
+  for(const Ring& ring: illusion.rings){
+    const CRingWriter writer(ring, cx, cy); //element writer
+
+    for(size_t i=0; i<ring.n; i++, k++){
+      const Placed& p = placed[k]; //placed element
+      writer.Format(output, i, p.parity, p.x, p.y, p.phi);
+    } //for
+  } //for
+} //FormatElements
+
+/// \brief Default benchmark jobs.
+///
+/// \param jobs [out] The jobs that draw `output1.svg` and `output2.svg`, one
+///   for each kind of illusion.
+
+void BenchJobs(std::vector<Job>& jobs){
+  const char* job1[] = {"1", "output1", "800", "4", "100", "72", "24",
+    "black", "white", "gray"}; //output1.svg
+  const char* job2[] = {"2", "output2", "800", "3", "300", "12", "6",
+    "black", "white", "gray"}; //output2.svg
+
+  jobs.resize(2);
+  ParseJob(jobs[0], 10, job1);
+  ParseJob(jobs[1], 10, job2);
+} //BenchJobs
+
+/// \brief Benchmark jobs with rings of negative radius.
+///
+/// The inner triplet of circles of the second illusion is drawn at the braid
+/// radius less 64 pixels (see DescribeIllusion2()), so in illusions with a
+/// small braid radius its circles have negative radii, and each element is
+/// on the far side of the center from its angle.
+///
+/// \param jobs [in, out] Jobs to which two such jobs are appended.
+
+void NegativeRadiusJobs(std::vector<Job>& jobs){
+  const char* job1[] = {"2", "negative1", "619", "4", "52", "15", "2",
+    "black", "white", "gray"}; //inner radii -10 to -14
+  const char* job2[] = {"2", "negative2", "1122", "4", "53", "4", "5",
+    "black", "white", "gray"}; //inner radii -7 to -15
+
+  jobs.resize(jobs.size() + 2);
+  ParseJob(jobs[jobs.size() - 2], 10, job1);
+  ParseJob(jobs[jobs.size() - 1], 10, job2);
+} //NegativeRadiusJobs
+
+/// \brief Benchmark the phases of generating an illusion.
+///
+/// The parameters are optionally `-reps n` (default 200) followed by a job
+/// as described in ParseJob(); without a job, the illusions `output1.svg`
+/// and `output2.svg` are used. Generation is timed in three phases, each
+/// repeated `n` times: geometry (PlaceSquare() or PlaceEllipse() for every
+/// element), formatting (DrawStyle() and the ring templates for every
+/// placed element, to a count-only output), and I/O (OpenSVG(),
+/// writing the formatted bytes, and CloseSVG(), to a temporary file in the
+/// current directory), and for comparison the whole job drawn to a file.
+/// For each phase the time per repetition and per element are reported,
+/// along with any performance counters (see CPerfCounters) that are
+/// available, per element, and instructions per cycle. The phases are
+/// checked to produce the same SVG as DrawJob().
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchPhasesCommand(size_t argc, const char* const argv[]){
+  size_t reps = 200; //number of repetitions
+  std::vector<Job> jobs; //jobs to benchmark
+
+  if(argc >= 2 && !strcmp(argv[0], "-reps")){
+    reps = (size_t)strtoul(argv[1], nullptr, 10);
+    argc -= 2; argv += 2;
+  } //if
+
+  if(argc > 0){
+    jobs.push_back(Job());
+
+    if(!ParseJob(jobs[0], argc, argv) || reps == 0){
+      printf("Expected [-reps n] [job]\n");
+      return 1;
+    } //if
+  } //if
+
+  else BenchJobs(jobs);
+
+  const std::string fname = TempName("bench-phases"); //I/O phase file
+  bool ok = true; //no errors so far
+
+  for(const Job& job: jobs){
+    Illusion illusion; //illusion descriptor
+    Describe(illusion, job);
+    const size_t n = ElementCount(illusion); //number of elements
+    std::vector<Placed> placed(n); //placed elements
+
+    std::string expected, actual, body; //SVG from DrawJob() and phases
+    COutput output(expected); //output stream
+    DrawJob(output, job);
+    output.Close();
+
+    PlaceElements(illusion, placed);
+    COutput bodyoutput(body); //output stream for body
+    FormatElements(bodyoutput, illusion, placed);
+    bodyoutput.Close();
+
+    COutput actualoutput(actual); //output stream for phases
+    DrawHeader(actualoutput, job.w, job.w);
+    actualoutput.Write(body.data(), body.size());
+    CloseSVG(actualoutput);
+
+    if(actual != expected){
+      printf("Phases don't match DrawJob() for %s\n", job.fname.c_str());
+      ok = false;
+    } //if
+
+    const char* phase[] = {"geometry", "format", "I/O", "all"}; //names
+    double seconds[4] = {0}; //time for each phase
+    CPerfCounters counters[4]; //counters for each phase
+
+    for(size_t k=0; k<4; k++){
+      CTimer timer; //stopwatch
+      counters[k].Start();
+
+      for(size_t rep=0; rep<reps; rep++)
+        switch(k){
+          case 0: PlaceElements(illusion, placed); break;
+
+          case 1:{
+            COutput count; //count-only output
+            FormatElements(count, illusion, placed);
+          } break;
+
+          case 2:{
+            COutput file; //output file
+
+            if(OpenSVG(file, fname, job.w, job.w)){
+              file.Write(body.data(), body.size());
+              CloseSVG(file);
+            } //if
+          } break;
+
+          case 3:{
+            COutput file; //output file
+
+            if(OpenSVG(file, fname, job.w, job.w)){
+              DrawIllusion(file, illusion);
+              CloseSVG(file);
+            } //if
+          } break;
+        } //switch
+
+      counters[k].Stop();
+      seconds[k] = timer.Elapsed();
+    } //for
+
+    remove((fname + ".svg").c_str());
+
+    printf("%s: %zu elements, %zu bytes, %zu reps\n", job.fname.c_str(), n,
+      expected.size(), reps);
+    printf("  %-8s %10s %9s", "phase", "us/rep", "ns/elem");
+
+    for(size_t i=0; i<CPerfCounters::COUNT; i++)
+      printf(" %13s", CPerfCounters::Name(i));
+
+    printf(" %6s\n", "IPC");
+
+    for(size_t k=0; k<4; k++){
+      const double per = (double)n*reps; //number of elements placed
+      printf("  %-8s %10.2f %9.2f", phase[k], 1e6*seconds[k]/reps,
+        1e9*seconds[k]/per);
+
+      for(size_t i=0; i<CPerfCounters::COUNT; i++)
+        if(counters[k].Available(i))
+          printf(" %13.2f", counters[k].Value(i)/per);
+        else printf(" %13s", "n/a");
+
+      if(counters[k].Available(CPerfCounters::CYCLES) &&
+        counters[k].Available(CPerfCounters::INSTRUCTIONS) &&
+        counters[k].Value(CPerfCounters::CYCLES) > 0)
+          printf(" %6.2f\n", counters[k].Value(CPerfCounters::INSTRUCTIONS)/
+            counters[k].Value(CPerfCounters::CYCLES));
+      else printf(" %6s\n", "n/a");
+    } //for
+  } //for
+
+  if(!CPerfCounters().Available(CPerfCounters::CYCLES))
+    printf("Hardware counters are unavailable here, see perf_event_open(2) "
+      "and /proc/sys/kernel/perf_event_paranoid\n");
+
+  printf("Counts are per element\n");
+  return ok? 0: 1;
+} //BenchPhasesCommand
+
+#pragma endregion bench
@@ -0,0 +1,97 @@
+/// \file Perf.h
+
+/// \brief Interface for hardware performance counters.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Perf_h__
+#define __Perf_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "Illusion.h"
+
+/// \brief Performance counters.
+///
+/// A set of Linux `perf_event_open` counters for this thread, counting
+/// user-space events only: CPU cycles, instructions, branch misses, cache
+/// misses, and page faults. Each counter is opened separately, so any that
+/// the kernel, the hardware, or `perf_event_paranoid` won't allow (as in
+/// most virtual machines, or on other operating systems) are simply
+/// reported as unavailable while the rest still count. If the kernel has to
+/// share the hardware counters between events, the counts are scaled up by
+/// the fraction of the time for which each event was actually counted.
+
+class CPerfCounters{
+  public:
+    static const size_t COUNT = 5; ///< Number of counters.
+
+    /// \brief Counter indices.
+
+    enum{
+      CYCLES, ///< CPU cycles.
+      INSTRUCTIONS, ///< Instructions retired.
+      BRANCH_MISSES, ///< Mispredicted branches.
+      CACHE_MISSES, ///< Last level cache misses.
+      PAGE_FAULTS ///< Page faults, a software event.
+    }; //enum
+
+  private:
+    int m_nFd[COUNT]; ///< File descriptors, -1 if unavailable.
+    double m_fValue[COUNT]; ///< Counts accumulated so far.
+
+  public:
+    CPerfCounters(); ///< Constructor.
+    CPerfCounters(const CPerfCounters&) = delete; ///< No copying.
+    ~CPerfCounters(); ///< Destructor.
+
+    void Start(); ///< Start counting.
+    void Stop(); ///< Stop counting and accumulate.
+
+    bool Available(size_t i) const; ///< Is a counter available?
+    bool Any() const; ///< Is any counter available?
+    double Value(size_t i) const; ///< Accumulated count.
+    static const char* Name(size_t i); ///< Name of counter.
+}; //CPerfCounters
+
+/// \brief Placed element.
+
+struct Placed{
+  float x = 0; ///< Center x, relative to the image center.
+  float y = 0; ///< Center y, relative to the image center.
+  float phi = 0; ///< Orientation in degrees.
+  bool parity = true; ///< Parity.
+}; //Placed
+
+void PlaceElements(const Illusion& illusion, std::vector<Placed>& placed);
+void FormatElements(COutput& output, const Illusion& illusion,
+  const std::vector<Placed>& placed);
+void BenchJobs(std::vector<Job>& jobs);
+void NegativeRadiusJobs(std::vector<Job>& jobs);
+
+int BenchPhasesCommand(size_t argc, const char* const argv[]);
+
+#endif //__Perf_h__
@@ -0,0 +1,273 @@
+/// \file Range.cpp
+
+/// \brief Code for the byte range index CRangeIndex.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Range.h"
+#include "Timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+static const char FOOTER[] = "</svg>\n"; ///< Close tag, as written by CloseSVG().
+
+//////////////////////////////////////////////////////////////////////////
+// CRangeIndex.
+
+#pragma region CRangeIndex
+
+/// Draw the illusion once, discarding the bytes and recording where each
+/// ring starts and a checkpoint every `STRIDE` elements.
+/// \param illusion Illusion descriptor.
+
+void CRangeIndex::Build(const Illusion& illusion){
+  m_illusion = illusion;
+  m_strHead.clear();
+  m_vCheckpoints.clear();
+  m_vFirst.clear();
+  m_vStart.clear();
+
+  COutput head(m_strHead); //header output stream
+  DrawHeader(head, illusion.w, illusion.w);
+  DrawStyle(head, illusion);
+  head.Close();
+
+  const size_t base = m_strHead.size(); //offset of first ring
+  COutput counter; //output stream that only counts bytes
+
+  for(const Ring& ring: illusion.rings){ //for each ring
+    m_vFirst.push_back(m_vCheckpoints.size());
+    m_vStart.push_back(base + counter.Size());
+
+    const CRingWriter writer(ring, illusion.cx, illusion.cy); //writer
+    float theta = ring.theta; //angle to current element
+    bool parity = ring.parity; //parity of current element
+
+    for(size_t i=0; i<ring.n; i++){ //for each element
+      if(i%STRIDE == 0){ //checkpoint
+        Checkpoint cp;
+        cp.offset = base + counter.Size();
+        cp.i = i;
+        cp.theta = theta;
+        cp.parity = parity;
+        m_vCheckpoints.push_back(cp);
+      } //if
+
+      writer.Draw(counter, i, theta, parity);
+      NextElement(ring, i, theta, parity);
+    } //for
+  } //for
+
+  m_vFirst.push_back(m_vCheckpoints.size()); //sentinels
+  m_vStart.push_back(base + counter.Size());
+  m_nSize = m_vStart.back() + strlen(FOOTER);
+} //Build
+
+/// Draw the bytes of the SVG file in the half-open range [a, b). Only the
+/// elements that overlap the range are drawn.
+/// \param output Output stream.
+/// \param a Offset of first byte.
+/// \param b Offset of byte after last.
+
+void CRangeIndex::Draw(COutput& output, size_t a, size_t b) const{
+  b = std::min(b, m_nSize);
+  if(a >= b)return; //empty range
+
+  const size_t head = m_strHead.size(); //end of header
+  const size_t body = m_vStart.back(); //end of rings
+
+  if(a < head) //header
+    output.Write(m_strHead.data() + a, std::min(b, head) - a);
+
+  if(a < body && b > head){ //rings
+    size_t pos = std::max(a, head); //next byte to be drawn
+    const size_t nRings = m_illusion.rings.size(); //number of rings
+    size_t r = std::upper_bound(m_vStart.begin(), m_vStart.end() - 1, pos) -
+      m_vStart.begin() - 1; //ring containing pos
+
+    std::string s; //one element
+    COutput scratch(s); //output stream for one element
+
+    for(; r<nRings && m_vStart[r]<b; r++){ //for each ring in range
+      const Ring& ring = m_illusion.rings[r];
+      auto first = m_vCheckpoints.begin() + m_vFirst[r]; //first checkpoint
+      auto last = m_vCheckpoints.begin() + m_vFirst[r + 1]; //past last one
+      if(first == last)continue; //empty ring
+
+      auto cp = std::upper_bound(first, last, pos,
+        [](size_t x, const Checkpoint& c){return x < c.offset;});
+      if(cp != first)--cp; //checkpoint at or before pos
+
+      const CRingWriter writer(ring, m_illusion.cx, m_illusion.cy); //writer
+      size_t offset = cp->offset; //offset of current element
+      float theta = cp->theta; //angle to current element
+      bool parity = cp->parity; //parity of current element
+
+      for(size_t i=cp->i; i<ring.n && offset<b; i++){ //for each element
+        s.clear();
+        writer.Draw(scratch, i, theta, parity);
+        scratch.Flush();
+
+        if(offset + s.size() > pos){ //element overlaps range
+          const size_t lo = std::max(pos, offset) - offset; //first byte
+          const size_t hi = std::min(b, offset + s.size()) - offset; //last
+          output.Write(s.data() + lo, hi - lo);
+        } //if
+
+        offset += s.size();
+        NextElement(ring, i, theta, parity);
+      } //for
+
+      pos = m_vStart[r + 1];
+    } //for
+  } //if
+
+  if(b > body){ //footer
+    const size_t lo = std::max(a, body) - body; //first byte of footer
+    output.Write(FOOTER + lo, b - body - lo);
+  } //if
+} //Draw
+
+/// \return Size of the SVG file in bytes.
+
+size_t CRangeIndex::Size() const{
+  return m_nSize;
+} //Size
+
+/// \return Approximate size of the index in bytes.
+
+size_t CRangeIndex::IndexSize() const{
+  return m_strHead.size() + m_vCheckpoints.size()*sizeof(Checkpoint) +
+    (m_vFirst.size() + m_vStart.size())*sizeof(size_t) +
+    m_illusion.rings.size()*sizeof(Ring);
+} //IndexSize
+
+#pragma endregion CRangeIndex
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark.
+
+#pragma region benchmark
+
+/// \brief Benchmark byte range drawing.
+///
+/// The parameters are a job as described in ParseJob(), optionally followed
+/// by a range length in bytes which defaults to 65536. A job never ends in
+/// a number, so a number at the end is the length. The whole illusion
+/// is drawn without writing it anywhere, then the byte range index is built
+/// and used to draw the last range of the given length. The warm time to the
+/// first byte is the time to draw the first byte of that range once the
+/// index exists, and the cold time adds describing the illusion and building
+/// its index, which is what a server that built indices lazily would pay on
+/// the first request. If the illusion is small enough, the range is
+/// compared against the whole SVG.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchRangeCommand(size_t argc, const char* const argv[]){
+  Job job; //job descriptor
+  size_t len = 65536; //range length
+
+  if(argc > 10){ //maybe a length at the end
+    char* end = nullptr; //end of number parsed
+    const size_t n = (size_t)strtoull(argv[argc - 1], &end, 10); //length
+
+    if(end != argv[argc - 1] && *end == '\0'){
+      len = n;
+      argc--;
+    } //if
+  } //if
+
+  if(!ParseJob(job, argc, argv)){
+    printf("Bad job parameters\n");
+    return 1;
+  } //if
+
+  CTimer timer; //stopwatch
+  Illusion illusion; //illusion descriptor
+  Describe(illusion, job);
+  const double tDescribe = timer.Elapsed(); //time to describe illusion
+
+  timer.Start();
+
+  COutput counter; //output stream that only counts bytes
+  DrawHeader(counter, illusion.w, illusion.w);
+  DrawIllusion(counter, illusion);
+  counter.Write(FOOTER, strlen(FOOTER));
+  const double tFull = timer.Elapsed(); //time to draw everything
+
+  timer.Start();
+  CRangeIndex index; //byte range index
+  index.Build(illusion);
+  const double tIndex = timer.Elapsed(); //time to build index
+
+  const size_t size = index.Size(); //SVG size
+  const size_t a = size > len? size - len: 0; //start of range
+  std::string s0, s1; //ranges drawn
+
+  timer.Start();
+  COutput first(s0); //output stream for first byte
+  index.Draw(first, a, a + 1);
+  first.Flush();
+  const double tFirst = timer.Elapsed(); //time to first byte
+
+  timer.Start();
+  COutput range(s1); //output stream for range
+  index.Draw(range, a, size);
+  range.Flush();
+  const double tRange = timer.Elapsed(); //time to draw range
+
+  printf("%s: %zu elements, %zu bytes of SVG\n", job.fname.c_str(),
+    ElementCount(illusion), size);
+  printf("  draw everything   %10.3f ms\n", 1000*tFull);
+  printf("  build index       %10.3f ms (%zu bytes)\n", 1000*tIndex,
+    index.IndexSize());
+  printf("  first byte, warm  %10.3f ms at offset %zu\n", 1000*tFirst, a);
+  printf("  first byte, cold  %10.3f ms (describe, build index, draw)\n",
+    1000*(tDescribe + tIndex + tFirst));
+  printf("  draw range        %10.3f ms (%zu bytes)\n", 1000*tRange,
+    size - a);
+
+  bool ok = counter.Size() == size && s1.size() == size - a &&
+    s0.size() == 1 && s0[0] == s1[0]; //sanity checks
+
+  if(size <= 64*1024*1024){ //small enough to compare against whole SVG
+    std::string s; //whole SVG
+    COutput whole(s); //output stream for whole SVG
+    DrawHeader(whole, illusion.w, illusion.w);
+    DrawIllusion(whole, illusion);
+    whole.Write(FOOTER, strlen(FOOTER));
+    whole.Flush();
+    ok = ok && s.compare(a, std::string::npos, s1) == 0;
+  } //if
+
+  if(!ok)printf("  RANGE MISMATCH\n");
+  return ok? 0: 1;
+} //BenchRangeCommand
+
+#pragma endregion benchmark
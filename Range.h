@@ -0,0 +1,76 @@
+/// \file Range.h
+
+/// \brief Interface for the byte range index CRangeIndex.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Range_h__
+#define __Range_h__
+
+#include "Illusion.h"
+
+/// \brief Checkpoint in a ring.
+///
+/// Everything needed to start drawing a ring part way through: the element
+/// index, the angle and parity that the element is drawn with, and the
+/// offset of its first byte in the SVG file.
+
+struct Checkpoint{
+  size_t offset = 0; ///< Offset of first byte of element.
+  size_t i = 0; ///< Element index about circle.
+  float theta = 0; ///< Angle to element.
+  bool parity = true; ///< Element parity.
+}; //Checkpoint
+
+/// \brief Byte range index.
+///
+/// A byte range index records where each ring starts in an illusion's SVG
+/// file, and a checkpoint every `STRIDE` elements within each ring. The
+/// checkpoints are prefix sums of serialized element sizes, so any byte
+/// range can be drawn by seeking to the nearest checkpoint at or before its
+/// start and drawing elements from there until its end, without drawing
+/// anything else. The index takes one pass over the elements to build and
+/// its size is proportional to the number of elements divided by `STRIDE`.
+
+class CRangeIndex{
+  private:
+    static const size_t STRIDE = 128; ///< Elements between checkpoints.
+
+    Illusion m_illusion; ///< Illusion descriptor.
+    std::string m_strHead; ///< Header, style, and background.
+    std::vector<Checkpoint> m_vCheckpoints; ///< Checkpoints for all rings.
+    std::vector<size_t> m_vFirst; ///< Index of first checkpoint of each ring.
+    std::vector<size_t> m_vStart; ///< Offset of first byte of each ring.
+    size_t m_nSize = 0; ///< Size of SVG file in bytes.
+
+  public:
+    void Build(const Illusion& illusion); ///< Build the index.
+    void Draw(COutput& output, size_t a, size_t b) const; ///< Draw a range.
+
+    size_t Size() const; ///< Size of SVG file.
+    size_t IndexSize() const; ///< Size of index.
+}; //CRangeIndex
+
+int BenchRangeCommand(size_t argc, const char* const argv[]);
+
+#endif //__Range_h__
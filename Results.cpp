@@ -0,0 +1,540 @@
+/// \file Results.cpp
+
+/// \brief Code for benchmark results and their comparison.
+///
+/// A benchmark results file is JSON written by BenchJsonCommand(), for
+/// example
+///
+///     {"version":1,"generator":1,"benchmarks":[
+///      {"name":"output1/geometry","elements":146,"reps":9000,
+///       "seconds":[2.1520e-06,2.1490e-06,...]},...]}
+///
+/// with one entry in `seconds` per sample. CompareCommand() reads two of
+/// them and decides, benchmark by benchmark, whether the second is slower.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Results.h"
+#include "Illusion.h"
+#include "Json.h"
+#include "Perf.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <functional>
+
+static const unsigned RESULTS_VERSION = 1; ///< Results file format version.
+
+//////////////////////////////////////////////////////////////////////////
+// Reading and writing.
+
+#pragma region files
+
+/// \brief Write benchmark results.
+///
+/// \param results Benchmark results.
+/// \return Results file contents in JSON.
+
+std::string WriteResults(const std::vector<BenchResult>& results){
+  char buffer[64]; //for formatting numbers
+  std::string s; //result
+
+  snprintf(buffer, sizeof(buffer), "{\"version\":%u,\"generator\":%u,",
+    RESULTS_VERSION, GENERATOR_VERSION);
+  s += buffer;
+  s += "\"benchmarks\":[";
+
+  for(size_t i=0; i<results.size(); i++){
+    const BenchResult& r = results[i]; //current result
+    if(i > 0)s += ",";
+    s += "\n {\"name\":\"" + r.name + "\",";
+    snprintf(buffer, sizeof(buffer), "\"elements\":%zu,\"reps\":%zu,",
+      r.elements, r.reps);
+    s += buffer;
+    s += "\"seconds\":[";
+
+    for(size_t j=0; j<r.seconds.size(); j++){
+      snprintf(buffer, sizeof(buffer), j > 0? ",%.6e": "%.6e", r.seconds[j]);
+      s += buffer;
+    } //for
+
+    s += "]}";
+  } //for
+
+  s += "]}\n";
+  return s;
+} //WriteResults
+
+/// \brief Read benchmark results.
+///
+/// \param results [out] Benchmark results.
+/// \param text Results file contents.
+/// \return true if the results were read successfully.
+
+bool ReadResults(std::vector<BenchResult>& results, const std::string& text){
+  CJsonParser parser(text.c_str());
+  results.clear();
+  parser.Expect('{');
+
+  do{ //for each key
+    const std::string key = parser.String();
+    parser.Expect(':');
+
+    if(key == "version"){
+      if(parser.Unsigned() != RESULTS_VERSION)return false;
+    } //if
+
+    else if(key == "generator")parser.Unsigned();
+
+    else if(key == "benchmarks"){
+      parser.Expect('[');
+
+      if(!parser.Accept(']'))do{ //for each benchmark
+        BenchResult r; //current result
+        parser.Expect('{');
+
+        do{ //for each key
+          const std::string field = parser.String();
+          parser.Expect(':');
+
+          if(field == "name")r.name = parser.String();
+          else if(field == "elements")r.elements = parser.Unsigned();
+          else if(field == "reps")r.reps = parser.Unsigned();
+
+          else if(field == "seconds"){
+            parser.Expect('[');
+
+            if(!parser.Accept(']')){
+              do r.seconds.push_back(parser.Double());
+              while(parser.OK() && parser.Accept(','));
+              parser.Expect(']');
+            } //if
+          } //else if
+
+          else return false; //unknown key
+        }while(parser.OK() && parser.Accept(','));
+
+        parser.Expect('}');
+        results.push_back(r);
+      }while(parser.OK() && parser.Accept(','));
+
+      parser.Expect(']');
+    } //else if
+
+    else return false; //unknown key
+  }while(parser.OK() && parser.Accept(','));
+
+  parser.Expect('}');
+  return parser.OK() && parser.Done();
+} //ReadResults
+
+/// \brief Save a benchmark results file.
+///
+/// \param fname File name including extension.
+/// \param results Benchmark results.
+/// \return true if save succeeded.
+
+bool SaveResults(const std::string& fname,
+  const std::vector<BenchResult>& results)
+{
+  FILE* output = nullptr; //output file pointer
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&output, fname.c_str(), "wt");
+#else
+  output = fopen(fname.c_str(), "wt");
+#endif
+
+  if(output == nullptr)return false;
+
+  const std::string text = WriteResults(results);
+  bool ok = fwrite(text.data(), 1, text.size(), output) == text.size();
+  if(fclose(output) != 0)ok = false;
+  return ok;
+} //SaveResults
+
+/// \brief Load a benchmark results file.
+///
+/// \param fname File name including extension.
+/// \param results [out] Benchmark results.
+/// \return true if load succeeded.
+
+bool LoadResults(const std::string& fname, std::vector<BenchResult>& results){
+  FILE* input = nullptr; //input file pointer
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&input, fname.c_str(), "rt");
+#else
+  input = fopen(fname.c_str(), "rt");
+#endif
+
+  if(input == nullptr)return false;
+
+  char buffer[65536]; //read buffer
+  size_t n = 0; //number of bytes read
+  std::string text; //file contents
+
+  while((n = fread(buffer, 1, sizeof(buffer), input)) > 0)
+    text.append(buffer, n);
+
+  fclose(input);
+  return ReadResults(results, text);
+} //LoadResults
+
+#pragma endregion files
+
+//////////////////////////////////////////////////////////////////////////
+// Statistics.
+
+#pragma region statistics
+
+/// \param v Samples, which must not be empty.
+/// \return Median of the samples.
+
+double Median(std::vector<double> v){
+  const size_t n = v.size(); //number of samples
+  std::sort(v.begin(), v.end());
+  return n%2 == 1? v[n/2]: (v[n/2 - 1] + v[n/2])/2;
+} //Median
+
+/// \brief Median absolute deviation.
+///
+/// The median of the absolute differences between the samples and their
+/// median, a measure of spread that, unlike the standard deviation, isn't
+/// thrown off by the occasional sample that was interrupted.
+///
+/// \param v Samples, which must not be empty.
+/// \return Median absolute deviation of the samples.
+
+double MedianDeviation(const std::vector<double>& v){
+  const double m = Median(v); //median
+  std::vector<double> d; //absolute deviations
+
+  for(double x: v)
+    d.push_back(fabs(x - m));
+
+  return Median(d);
+} //MedianDeviation
+
+/// \brief Mann-Whitney U test.
+///
+/// Test whether two sets of samples come from the same distribution, making
+/// no assumption about its shape. The samples are ranked together, with
+/// tied samples sharing the mean of their ranks, and the rank sum of the
+/// first set is compared with what it would be if the sets were
+/// interchangeable, using the normal approximation with tie and continuity
+/// corrections (good enough for 8 or more samples in each set).
+///
+/// \param a First set of samples.
+/// \param b Second set of samples.
+/// \return Two-sided p-value, the probability of a difference at least this
+///   large in rank sums if the distributions are the same.
+
+double MannWhitney(const std::vector<double>& a, const std::vector<double>& b){
+  const double na = (double)a.size(), nb = (double)b.size(); //set sizes
+  const size_t n = a.size() + b.size(); //total number of samples
+  if(a.empty() || b.empty())return 1;
+
+  std::vector<std::pair<double, bool>> v; //samples, true if from a
+  for(double x: a)v.push_back(std::make_pair(x, true));
+  for(double x: b)v.push_back(std::make_pair(x, false));
+  std::sort(v.begin(), v.end());
+
+  double ranksum = 0; //sum of ranks of a
+  double ties = 0; //tie correction, sum of t^3 - t over groups of t ties
+
+  for(size_t i=0; i<n;){
+    size_t j = i + 1; //one past the end of the group tied with v[i]
+    while(j < n && v[j].first == v[i].first)j++;
+
+    const double rank = (i + 1 + j)/2.0; //mean rank of group
+    const double t = (double)(j - i); //number of ties
+
+    for(size_t k=i; k<j; k++)
+      if(v[k].second)ranksum += rank;
+
+    ties += t*t*t - t;
+    i = j;
+  } //for
+
+  const double u = ranksum - na*(na + 1)/2; //U statistic for a
+  const double mean = na*nb/2; //mean of U
+  const double var = na*nb/12*((n + 1) - ties/(n*(n - 1.0))); //variance of U
+  if(var <= 0)return 1;
+
+  const double z = std::max(0.0, fabs(u - mean) - 0.5)/sqrt(var); //z-score
+  return erfc(z/sqrt(2.0));
+} //MannWhitney
+
+#pragma endregion statistics
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Take samples of a benchmark.
+///
+/// The benchmark is run once to warm up, then once to choose the number of
+/// repetitions per sample, which is enough for a sample to take at least
+/// 20ms.
+///
+/// \param result [in, out] Benchmark result, with name and elements set.
+/// \param samples Number of samples.
+/// \param f Function that runs the benchmark once.
+
+static void Sample(BenchResult& result, size_t samples,
+  const std::function<void()>& f)
+{
+  f(); //warm up
+
+  CTimer timer; //stopwatch
+  f();
+  const double t = std::max(timer.Elapsed(), 1e-7); //time for one run
+  result.reps = std::max((size_t)1, (size_t)ceil(0.02/t));
+
+  for(size_t i=0; i<samples; i++){
+    timer.Start();
+
+    for(size_t j=0; j<result.reps; j++)
+      f();
+
+    result.seconds.push_back(timer.Elapsed()/result.reps);
+  } //for
+} //Sample
+
+/// \brief Run the benchmarks and save the results.
+///
+/// The parameters are a file name, optionally followed by `-samples n`
+/// (default 15) and a job as described in ParseJob(); without a job, the
+/// illusions `output1.svg` and `output2.svg` are used. For each job there
+/// are four benchmarks, named after the job's file name: the geometry,
+/// format, and I/O phases timed by BenchPhasesCommand(), and everything
+/// that OpticalIllusion1() or OpticalIllusion2() does end to end, from
+/// describing the illusion to closing the file, except for printing a
+/// message. The results are
+/// saved as JSON to be compared later with CompareCommand().
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchJsonCommand(size_t argc, const char* const argv[]){
+  size_t samples = 15; //number of samples
+  std::vector<Job> jobs; //jobs to benchmark
+  std::string out; //results file name
+  bool ok = argc >= 1; //parameters are valid
+
+  if(ok){
+    out = argv[0];
+    argc--; argv++;
+
+    if(argc >= 2 && !strcmp(argv[0], "-samples")){
+      samples = (size_t)strtoul(argv[1], nullptr, 10);
+      argc -= 2; argv += 2;
+      ok = samples > 0;
+    } //if
+  } //if
+
+  if(ok && argc > 0){
+    jobs.push_back(Job());
+    ok = ParseJob(jobs[0], argc, argv);
+  } //if
+
+  if(!ok){
+    printf("Expected <file.json> [-samples n] [job]\n");
+    return 1;
+  } //if
+
+  if(jobs.empty())BenchJobs(jobs);
+
+  const std::string fname = TempName("bench-json"); //temporary file name
+  std::vector<BenchResult> results; //benchmark results
+
+  for(const Job& job: jobs){
+    Illusion illusion; //illusion descriptor
+    Describe(illusion, job);
+    const size_t n = ElementCount(illusion); //number of elements
+    std::vector<Placed> placed(n); //placed elements
+    PlaceElements(illusion, placed);
+
+    std::string body; //formatted style and elements
+    COutput bodyoutput(body); //output stream for body
+    FormatElements(bodyoutput, illusion, placed);
+    bodyoutput.Close();
+
+    const char* phase[] = {"geometry", "format", "io", "end-to-end"}; //names
+
+    for(size_t k=0; k<4; k++){
+      BenchResult result; //result for this phase
+      result.name = job.fname + "/" + phase[k];
+      result.elements = n;
+
+      Sample(result, samples, [&](){
+        switch(k){
+          case 0: PlaceElements(illusion, placed); break;
+
+          case 1:{
+            COutput count; //count-only output
+            FormatElements(count, illusion, placed);
+          } break;
+
+          case 2:{
+            COutput file; //output file
+
+            if(OpenSVG(file, fname, job.w, job.w)){
+              file.Write(body.data(), body.size());
+              CloseSVG(file);
+            } //if
+          } break;
+
+          case 3:{
+            Illusion fresh; //illusion descriptor
+            Describe(fresh, job);
+            COutput file; //output file
+
+            if(OpenSVG(file, fname, job.w, job.w)){
+              DrawIllusion(file, fresh);
+              CloseSVG(file);
+            } //if
+          } break;
+        } //switch
+      });
+
+      printf("%-24s %10.2f us %8.2f Melem/s\n", result.name.c_str(),
+        1e6*Median(result.seconds), n/Median(result.seconds)/1e6);
+      results.push_back(result);
+    } //for
+  } //for
+
+  remove((fname + ".svg").c_str());
+
+  if(!SaveResults(out, results)){
+    printf("Cannot write results\n");
+    return 1;
+  } //if
+
+  return 0;
+} //BenchJsonCommand
+
+/// \brief Compare two sets of benchmark results.
+///
+/// The parameters are a baseline results file and a new results file, both
+/// written by BenchJsonCommand(), optionally followed by `-threshold t`, the
+/// smallest change in median time that matters, in percent (default 5), and
+/// `-alpha a`, the significance level (default 0.01). For each benchmark the
+/// median time, the median absolute deviation, the throughput in elements
+/// per second, and the change in median time are reported, and the samples
+/// are compared with MannWhitney(). A benchmark is a regression if its
+/// median time went up by more than the threshold and the p-value is below
+/// the significance level, that is, if it got slower by enough to matter
+/// and by more than noise would explain.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 if there are no regressions, 1 if there are, or for failure.
+
+int CompareCommand(size_t argc, const char* const argv[]){
+  double threshold = 5; //smallest change that matters, in percent
+  double alpha = 0.01; //significance level
+  bool ok = argc >= 2 && argc%2 == 0; //parameters are valid
+
+  for(size_t i=2; ok && i<argc; i+=2){
+    if(!strcmp(argv[i], "-threshold"))threshold = atof(argv[i + 1]);
+    else if(!strcmp(argv[i], "-alpha"))alpha = atof(argv[i + 1]);
+    else ok = false;
+  } //for
+
+  if(!ok || threshold < 0 || alpha <= 0){
+    printf("Expected <base.json> <new.json> [-threshold percent] "
+      "[-alpha a]\n");
+    return 1;
+  } //if
+
+  std::vector<BenchResult> base, next; //baseline and new results
+
+  for(size_t i=0; i<2; i++)
+    if(!LoadResults(argv[i], i == 0? base: next)){
+      printf("Cannot read results from %s\n", argv[i]);
+      return 1;
+    } //if
+
+  size_t regressions = 0; //number of regressions
+
+  printf("%-24s %10s %8s %10s %8s %9s %9s %8s %8s\n", "benchmark", "base us",
+    "MAD", "new us", "MAD", "Melem/s", "Melem/s", "change", "p");
+
+  for(const BenchResult& b: base){
+    const BenchResult* r = nullptr; //matching new result
+
+    for(const BenchResult& x: next)
+      if(x.name == b.name)r = &x;
+
+    if(r == nullptr || r->seconds.empty() || b.seconds.empty()){
+      printf("%-24s missing\n", b.name.c_str());
+      continue;
+    } //if
+
+    const double m0 = Median(b.seconds), m1 = Median(r->seconds); //medians
+    const double change = 100*(m1/m0 - 1); //change in percent
+    const double p = MannWhitney(b.seconds, r->seconds); //p-value
+
+    const char* verdict = "same"; //what happened
+
+    if(p < alpha && change > threshold){
+      verdict = "SLOWER";
+      regressions++;
+    } //if
+
+    else if(p < alpha && change < -threshold)
+      verdict = "faster";
+
+    printf("%-24s %10.2f %8.2f %10.2f %8.2f %9.2f %9.2f %+7.1f%% %8.4f %s\n",
+      b.name.c_str(), 1e6*m0, 1e6*MedianDeviation(b.seconds), 1e6*m1,
+      1e6*MedianDeviation(r->seconds), b.elements/m0/1e6,
+      r->elements/m1/1e6, change, p, verdict);
+  } //for
+
+  for(const BenchResult& r: next){
+    bool found = false; //r is in the baseline
+
+    for(const BenchResult& b: base)
+      if(b.name == r.name)found = true;
+
+    if(!found)printf("%-24s new\n", r.name.c_str());
+  } //for
+
+  if(regressions > 0){
+    printf("%zu regression%s\n", regressions, regressions == 1? "": "s");
+    return 1;
+  } //if
+
+  printf("No regressions\n");
+  return 0;
+} //CompareCommand
+
+#pragma endregion commands
@@ -0,0 +1,59 @@
+/// \file Results.h
+
+/// \brief Interface for benchmark results and their comparison.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Results_h__
+#define __Results_h__
+
+#include <string>
+#include <vector>
+
+/// \brief Benchmark result.
+///
+/// The samples taken of one benchmark. Each sample is the mean time of a
+/// number of repetitions, chosen so that a sample is long enough to be
+/// timed accurately.
+
+struct BenchResult{
+  std::string name; ///< Benchmark name.
+  size_t elements = 0; ///< Number of elements drawn per repetition.
+  size_t reps = 0; ///< Number of repetitions per sample.
+  std::vector<double> seconds; ///< Seconds per repetition, one per sample.
+}; //BenchResult
+
+std::string WriteResults(const std::vector<BenchResult>& results);
+bool ReadResults(std::vector<BenchResult>& results, const std::string& text);
+bool SaveResults(const std::string& fname,
+  const std::vector<BenchResult>& results);
+bool LoadResults(const std::string& fname, std::vector<BenchResult>& results);
+
+double Median(std::vector<double> v);
+double MedianDeviation(const std::vector<double>& v);
+double MannWhitney(const std::vector<double>& a, const std::vector<double>& b);
+
+int BenchJsonCommand(size_t argc, const char* const argv[]);
+int CompareCommand(size_t argc, const char* const argv[]);
+
+#endif //__Results_h__
@@ -0,0 +1,508 @@
+/// \file Rings.cpp
+
+/// \brief Code for ring descriptor files.
+///
+/// A ring descriptor file is a compact JSON description of an optical
+/// illusion consisting of the image size, center, colors, and the
+/// list of ring descriptors that DescribeIllusion1() or DescribeIllusion2()
+/// compute. Its size is proportional to the number of rings rather than the
+/// number of elements. A client can expand it into the SVG element stream
+/// by passing each ring descriptor to DrawRing(), which is exactly what
+/// ExpandCommand() does. For example, the ring descriptor file for
+/// `output1.svg` is
+///
+///     {"illusion":1,"w":800,"cx":388,"cy":388,"dark":"black",
+///      "light":"white","bg":"gray","rings":[[0,100,24,0],[0,172,24,1],
+///      [0,244,24,0],[0,316,24,1]]}
+///
+/// Squares are described by `[0,r,sw,parity]` and ellipses by
+/// `[1,r,r0,r1,n,theta,dtheta,parity,flip]`. Floats are written with enough
+/// digits that they are read back bit-for-bit. Illusions drawn with
+/// fixed-point geometry (see DrawFixedRing()) also have `"fixed":1`, and
+/// illusions with the transforms on the elements (see FormatSquare()) have
+/// `"flat":1`.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Rings.h"
+#include "Json.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//////////////////////////////////////////////////////////////////////////
+// Writing.
+
+#pragma region writing
+
+/// \brief Append a formatted number to a string.
+///
+/// \param s [in, out] String.
+/// \param fmt Printf format for a single number.
+/// \param x Number.
+
+template<class T> static void Append(std::string& s, const char* fmt, T x){
+  char buffer[64]; //big enough for any number
+  snprintf(buffer, sizeof(buffer), fmt, x);
+  s += buffer;
+} //Append
+
+/// \brief Append a quoted string to a string.
+///
+/// Quotes and backslashes are escaped.
+///
+/// \param s [in, out] String.
+/// \param t String to be quoted.
+
+static void AppendQuoted(std::string& s, const std::string& t){
+  s += '"';
+
+  for(char c: t){
+    if(c == '"' || c == '\\')s += '\\';
+    s += c;
+  } //for
+
+  s += '"';
+} //AppendQuoted
+
+/// \brief Write ring descriptors.
+///
+/// \param illusion Illusion descriptor.
+/// \return Ring descriptor file contents in compact JSON.
+
+std::string WriteRings(const Illusion& illusion){
+  std::string s = "{\"illusion\":"; //result
+
+  Append(s, "%zu", illusion.kind);
+  s += ",\"w\":";     Append(s, "%zu", illusion.w);
+  s += ",\"cx\":";    Append(s, "%zu", illusion.cx);
+  s += ",\"cy\":";    Append(s, "%zu", illusion.cy);
+  s += ",\"dark\":";  AppendQuoted(s, illusion.dark);
+  s += ",\"light\":"; AppendQuoted(s, illusion.light);
+  s += ",\"bg\":";    AppendQuoted(s, illusion.bgclr);
+
+  const Geometry geometry = illusion.rings.empty()? Geometry::Float:
+    illusion.rings[0].geometry; //geometry of all rings
+
+  if(geometry == Geometry::Fixed)s += ",\"fixed\":1";
+  else if(geometry == Geometry::Huge)s += ",\"huge\":1";
+
+  if(!illusion.rings.empty() && illusion.rings[0].flat)
+    s += ",\"flat\":1";
+
+  s += ",\"rings\":[";
+  const char* radius = geometry == Geometry::Huge? "%.17g": "%.9g"; //format
+
+  for(size_t i=0; i<illusion.rings.size(); i++){
+    const Ring& ring = illusion.rings[i];
+    s += i? ",[": "[";
+
+    if(ring.shape == Shape::Square){
+      s += "0,"; Append(s, radius, ring.r);
+      s += ",";  Append(s, "%zu", ring.sw);
+    } //if
+
+    else{
+      s += "1,"; Append(s, radius, ring.r);
+      s += ",";  Append(s, "%.9g", ring.r0);
+      s += ",";  Append(s, "%.9g", ring.r1);
+      s += ",";  Append(s, "%zu", ring.n);
+      s += ",";  Append(s, "%.9g", ring.theta);
+      s += ",";  Append(s, "%.9g", ring.dtheta);
+    } //else
+
+    s += ring.parity? ",1": ",0";
+
+    if(ring.shape == Shape::Ellipse){
+      s += ","; Append(s, "%zu", ring.flip);
+    } //if
+
+    s += "]";
+  } //for
+
+  s += "]}\n";
+  return s;
+} //WriteRings
+
+#pragma endregion writing
+
+//////////////////////////////////////////////////////////////////////////
+// Reading.
+
+#pragma region reading
+
+/// \brief Read ring descriptors.
+///
+/// \param illusion [out] Illusion descriptor.
+/// \param text Ring descriptor file contents.
+/// \return true if the ring descriptors were read successfully.
+
+bool ReadRings(Illusion& illusion, const std::string& text){
+  CJsonParser parser(text.c_str());
+  illusion = Illusion();
+  Geometry geometry = Geometry::Float; //geometry of all rings
+  bool flat = false; //transforms on elements
+  parser.Expect('{');
+
+  do{ //for each key
+    const std::string key = parser.String();
+    parser.Expect(':');
+
+    if(key == "illusion")illusion.kind = parser.Unsigned();
+    else if(key == "w")illusion.w = parser.Unsigned();
+    else if(key == "cx")illusion.cx = parser.Unsigned();
+    else if(key == "cy")illusion.cy = parser.Unsigned();
+    else if(key == "dark")illusion.dark = parser.String();
+    else if(key == "light")illusion.light = parser.String();
+    else if(key == "bg")illusion.bgclr = parser.String();
+    else if(key == "fixed"){
+      if(parser.Unsigned() != 0)geometry = Geometry::Fixed;
+    } //else if
+
+    else if(key == "huge"){
+      if(parser.Unsigned() != 0)geometry = Geometry::Huge;
+    } //else if
+
+    else if(key == "flat")flat = parser.Unsigned() != 0;
+
+    else if(key == "rings"){
+      parser.Expect('[');
+
+      if(!parser.Accept(']'))do{ //for each ring
+        Ring ring;
+        parser.Expect('[');
+        ring.shape = parser.Unsigned()? Shape::Ellipse: Shape::Square;
+        parser.Expect(','); ring.r = parser.Double();
+
+        if(ring.shape == Shape::Square){
+          parser.Expect(','); ring.sw = parser.Unsigned();
+          if(ring.sw == 0)return false;
+          ring.n = SquareCount(ring.r, ring.sw);
+          ring.dtheta = 2*PI/ring.n;
+        } //if
+
+        else{
+          parser.Expect(','); ring.r0 = parser.Float();
+          parser.Expect(','); ring.r1 = parser.Float();
+          parser.Expect(','); ring.n = parser.Unsigned();
+          parser.Expect(','); ring.theta = parser.Float();
+          parser.Expect(','); ring.dtheta = parser.Float();
+        } //else
+
+        parser.Expect(','); ring.parity = parser.Unsigned() != 0;
+
+        if(ring.shape == Shape::Ellipse){
+          parser.Expect(','); ring.flip = parser.Unsigned();
+        } //if
+
+        parser.Expect(']');
+        illusion.rings.push_back(ring);
+      }while(parser.OK() && parser.Accept(','));
+
+      parser.Expect(']');
+    } //else if
+
+    else return false; //unknown key
+  }while(parser.OK() && parser.Accept(','));
+
+  parser.Expect('}');
+
+  for(Ring& ring: illusion.rings){
+    if(geometry != Geometry::Huge)ring.r = (float)ring.r; //float radii
+    ring.flat = flat;
+  } //for
+
+  SetGeometry(illusion, geometry);
+
+  return parser.OK() && parser.Done() &&
+    (illusion.kind == 1 || illusion.kind == 2);
+} //ReadRings
+
+#pragma endregion reading
+
+//////////////////////////////////////////////////////////////////////////
+// Files.
+
+#pragma region files
+
+/// \brief Read a whole file.
+///
+/// \param input File pointer, which must be open for reading.
+/// \param s [out] File contents.
+
+static void ReadAll(FILE* input, std::string& s){
+  char buffer[65536]; //read buffer
+  size_t n = 0; //number of bytes read
+  s.clear();
+
+  while((n = fread(buffer, 1, sizeof(buffer), input)) > 0)
+    s.append(buffer, n);
+} //ReadAll
+
+/// \brief Save a ring descriptor file.
+///
+/// \param fname File name without extension.
+/// \param illusion Illusion descriptor.
+/// \return true if save succeeded.
+
+bool SaveRings(const std::string& fname, const Illusion& illusion){
+  const std::string s = fname + ".json";
+  FILE* output = nullptr; //output file pointer
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&output, s.c_str(), "wt");
+#else
+  output = fopen(s.c_str(), "wt");
+#endif
+
+  if(output == nullptr)return false;
+
+  const std::string text = WriteRings(illusion);
+  const bool ok = fwrite(text.data(), 1, text.size(), output) == text.size();
+  fclose(output);
+  return ok;
+} //SaveRings
+
+/// \brief Load a ring descriptor file.
+///
+/// \param fname File name including extension.
+/// \param illusion [out] Illusion descriptor.
+/// \return true if load succeeded.
+
+bool LoadRings(const std::string& fname, Illusion& illusion){
+  FILE* input = nullptr; //input file pointer
+
+#ifdef _MSC_VER //Visual Studio
+  fopen_s(&input, fname.c_str(), "rt");
+#else
+  input = fopen(fname.c_str(), "rt");
+#endif
+
+  if(input == nullptr)return false;
+
+  std::string text; //file contents
+  ReadAll(input, text);
+  fclose(input);
+
+  return ReadRings(illusion, text);
+} //LoadRings
+
+#pragma endregion files
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Write a ring descriptor file for a job.
+///
+/// The parameters are a job as described in ParseJob(). The ring descriptors
+/// are written to a file with the job's file name and extension `.json`.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int RingsCommand(size_t argc, const char* const argv[]){
+  Job job; //job descriptor
+  Illusion illusion; //illusion descriptor
+
+  if(!ParseJob(job, argc, argv)){
+    printf("Bad job parameters\n");
+    return 1;
+  } //if
+
+  Describe(illusion, job);
+
+  if(!SaveRings(job.fname, illusion)){
+    printf("Cannot write %s.json\n", job.fname.c_str());
+    return 1;
+  } //if
+
+  printf("Ring descriptors for %zu elements in %zu rings to %s.json\n",
+    ElementCount(illusion), illusion.rings.size(), job.fname.c_str());
+
+  return 0;
+} //RingsCommand
+
+/// \brief Expand a ring descriptor file into an SVG file.
+///
+/// This is the reference expander. The parameters are the name of a ring
+/// descriptor file and a file name without extension for the SVG output.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int ExpandCommand(size_t argc, const char* const argv[]){
+  if(argc != 2){
+    printf("Expected ring descriptor file and output file name\n");
+    return 1;
+  } //if
+
+  Illusion illusion; //illusion descriptor
+
+  if(!LoadRings(argv[0], illusion)){
+    printf("Cannot read ring descriptors from %s\n", argv[0]);
+    return 1;
+  } //if
+
+  COutput output; //output stream
+
+  if(!OpenSVG(output, argv[1], illusion.w, illusion.w)){
+    printf("Cannot write %s.svg\n", argv[1]);
+    return 1;
+  } //if
+
+  printf("Expand %s to %s.svg\n", argv[0], argv[1]);
+  DrawIllusion(output, illusion);
+  CloseSVG(output);
+
+  return 0;
+} //ExpandCommand
+
+/// \brief Draw an illusion without ring descriptors.
+///
+/// Write the style and elements of a job's illusion the way
+/// OpticalIllusion1() and OpticalIllusion2() did before ring descriptors:
+/// the style tag and background written out in full, then one call to
+/// DrawCircleOfSquares() per circle, or three calls to
+/// DrawCircleOfEllipses() per triple circle, with their parameters
+/// computed here from the job rather than by DescribeIllusion1(),
+/// DescribeIllusion2(), or TripleCircle(). Float geometry only.
+///
+/// \param output Output stream.
+/// \param job Job descriptor.
+
+static void DrawOriginal(COutput& output, const Job& job){
+  const char* dark = job.dark.c_str(); //dark color
+  const char* light = job.light.c_str(); //light color
+
+  if(job.kind == 1){
+    const size_t sw = (size_t)job.p[2]; //square width
+    const size_t cx = job.w/2 - sw/2; //center x coordinate
+    const size_t cy = cx; //center y coordinate
+
+    output.Printf("<style>"); //open style tag
+    output.Printf("rect{fill:none;stroke-width:3}"); //rectangle
+    output.Printf("rect.b{x:%zu;y:%zu;stroke:%s;}", cx, cy, dark); //black rect
+    output.Printf("rect.w{x:%zu;y:%zu;stroke:%s;}", cx, cy, light); //white rect
+    output.Printf("</style>\n"); //close style tag
+
+    output.Printf("<rect width=\"%zu\" height=\"%zu\" ", job.w, job.w);
+    output.Printf("style=\"fill:%s\"/>\n", job.bgclr.c_str()); //background
+
+    for(size_t i=0; i<job.n; i++) //for each circle of squares
+      DrawCircleOfSquares(output, cx, cy, (float)job.p[0] + i*(float)job.p[1],
+        sw, i&1, nullptr, job.flat);
+  } //if
+
+  else{
+    const size_t cx = job.w/2; //center x coordinate
+    const size_t cy = cx; //center y coordinate
+
+    output.Printf("<style>"); //open style tag
+    output.Printf("ellipse{fill:none;stroke-width:3}"); //ellipse
+    output.Printf("ellipse.b{cx:%zu;cy:%zu;stroke:none;fill:%s;}",
+      cx, cy, dark); //dark ellipse
+    output.Printf("ellipse.w{cx:%zu;cy:%zu;stroke:none;fill:%s;}",
+      cx, cy, light); //light ellipse
+    output.Printf("</style>\n"); //close style tag
+
+    output.Printf("<rect width=\"%zu\" height=\"%zu\" ", job.w, job.w);
+    output.Printf("style=\"fill:%s\"/>\n", job.bgclr.c_str()); //background
+
+    for(int k=0; k<2; k++){ //for each triple circle
+      const float p[3] = {(float)job.p[0], (float)job.p[1],
+        (float)job.p[2]}; //parameters in float, as in OpticalIllusion2()
+      const float r = k? p[0] - 64: p[0]; //middle radius
+      const float r0 = k? 0.8f*p[1]: p[1]; //long radius
+      const float r1 = k? 0.8f*p[2]: p[2]; //short radius
+      const size_t n = 2*36; //ellipses and spaces
+      const float dtheta = PI/36; //angle delta to next ellipse
+      const float theta = (k? PI: -PI)/2; //angle to first ellipse
+
+      DrawCircleOfEllipses(output, cx, cy, r, r0, r1, n, theta, dtheta,
+        true, 999999, nullptr, job.flat);
+      DrawCircleOfEllipses(output, cx, cy, r - r1, r0, r1, n,
+        theta + dtheta, dtheta, true, n/2 - 1, nullptr, job.flat);
+      DrawCircleOfEllipses(output, cx, cy, r + r1, r0, r1, n,
+        theta + dtheta, dtheta, false, n/2 - 2, nullptr, job.flat);
+    } //for
+  } //else
+} //DrawOriginal
+
+/// \brief Verify that ring descriptors expand to the same element stream.
+///
+/// The parameters are a job as described in ParseJob(). The job's illusion
+/// is written to a ring descriptor string, read back, and expanded. The
+/// element stream must be identical to the one drawn by DrawOriginal()
+/// without ring descriptors. Fixed-point and huge geometry have no
+/// original drawing, so for them it is compared with the illusion drawn
+/// from the ring descriptors before they were written.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 if the element streams are identical, 1 otherwise.
+
+int VerifyCommand(size_t argc, const char* const argv[]){
+  Job job; //job descriptor
+
+  if(!ParseJob(job, argc, argv)){
+    printf("Bad job parameters\n");
+    return 1;
+  } //if
+
+  Illusion direct; //illusion descriptor for direct drawing
+  Illusion expanded; //illusion descriptor read from ring descriptors
+  Describe(direct, job);
+  const std::string text = WriteRings(direct);
+
+  if(!ReadRings(expanded, text)){
+    printf("Cannot read back ring descriptors\n");
+    return 1;
+  } //if
+
+  const bool original = job.geometry == Geometry::Float; //can draw original
+  std::string s0, s1; //element streams
+  COutput output0(s0); //original or direct element stream
+  COutput output1(s1); //expanded element stream
+
+  if(original)DrawOriginal(output0, job);
+  else DrawIllusion(output0, direct);
+
+  DrawIllusion(output1, expanded);
+  output0.Flush();
+  output1.Flush();
+
+  const bool same = s0 == s1; //element streams match
+
+  printf("%s: %zu bytes of SVG from %zu bytes of ring descriptors, %s %s\n",
+    job.fname.c_str(), s0.size(), text.size(),
+    same? "identical to": "DIFFERENT from",
+    original? "the original drawing": "the descriptors before writing");
+
+  return same? 0: 1;
+} //VerifyCommand
+
+#pragma endregion commands
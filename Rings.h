@@ -0,0 +1,42 @@
+/// \file Rings.h
+
+/// \brief Interface for ring descriptor files.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Rings_h__
+#define __Rings_h__
+
+#include "Illusion.h"
+
+std::string WriteRings(const Illusion& illusion);
+bool ReadRings(Illusion& illusion, const std::string& text);
+
+bool SaveRings(const std::string& fname, const Illusion& illusion);
+bool LoadRings(const std::string& fname, Illusion& illusion);
+
+int RingsCommand(size_t argc, const char* const argv[]);
+int ExpandCommand(size_t argc, const char* const argv[]);
+int VerifyCommand(size_t argc, const char* const argv[]);
+
+#endif //__Rings_h__
@@ -0,0 +1,506 @@
+/// \file Rotate.cpp
+
+/// \brief Code for rings drawn as rotations of one element.
+///
+/// Every element of a ring is the element at angle zero rotated about the
+/// center of the ring. Instead of a translation and a rotation for each
+/// element, a ring can be drawn as a group containing one canonical,
+/// pre-positioned element per color, defined once, and a `use` of it per
+/// element that has only a rotation. That is fewer numbers per element,
+/// and a whole ring can be animated by transforming its group.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Rotate.h"
+#include "Crop.h"
+#include "Perf.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// Drawing.
+
+#pragma region drawing
+
+/// \brief Class of an element.
+///
+/// Squares with odd index are black and squares with even index are white,
+/// as in FormatSquare(). Ellipses follow a pattern of four, black, blank,
+/// white, blank, or the other way around, as in SelectEllipseColor().
+///
+/// \param ring Ring descriptor.
+/// \param i Element index about circle.
+/// \param parity Element parity.
+/// \return `b` for black, `w` for white, or 0 for blank.
+
+static char ElementClass(const Ring& ring, size_t i, bool parity){
+  if(ring.shape == Shape::Square)
+    return (i & 1)? 'b': 'w';
+
+  const size_t j = i%4; //position in pattern of four
+
+  if((parity && j == 0) || (!parity && j == 2))return 'b';
+  if((parity && j == 2) || (!parity && j == 0))return 'w';
+
+  return 0;
+} //ElementClass
+
+/// \brief Draw a ring as rotations of one element.
+///
+/// The ring is drawn as a group with id `r` followed by the ring number.
+/// It starts with a `defs` tag holding one canonical element per color,
+/// which is the element that DrawRing() would draw at angle zero, with
+/// ids `r<k>b` and `r<k>w`. Each element is then a `use` of one of those
+/// with a rotation about the center of the ring, which for squares is
+/// half a square width below and right of the image center because of
+/// the translation in FormatSquare(). Blank ellipses are invisible and are
+/// left out. The angles are computed with PlaceElement(), so the ring can
+/// have any geometry, and are written with just enough decimal places that
+/// rounding them moves an element by no more than rounding its position to
+/// 0.1 pixels does in FormatSquare() and FormatEllipse().
+///
+/// \param output Output stream.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param ring Ring descriptor.
+/// \param k Ring number, for ids.
+/// \return Number of elements drawn.
+
+size_t DrawRotatedRing(COutput& output, size_t cx, size_t cy,
+  const Ring& ring, size_t k)
+{
+  const bool square = ring.shape == Shape::Square; //shape is square
+  const int base = square? (ring.parity? 12: -12): 90; //canonical angle
+  const double h = square? ring.sw/2.0: 0; //half square width
+  const double rho = ring.r + 2*h; //bound on distance to element center
+  const int digits = rho > 0? //decimal places in angles
+    std::max(1, (int)ceil(log10(PI*rho/18))): 1;
+
+  const size_t whole = square? ring.sw/2: 0; //whole part of half width
+  const char* frac = square && (ring.sw & 1)? ".5": ""; //fractional part
+  char center[64]; //center of rotation
+  snprintf(center, sizeof(center), "%zu%s %zu%s", cx + whole, frac,
+    cy + whole, frac);
+
+  output.Printf("<g id=\"r%zu\"><defs>\n", k); //open group and defs
+
+  for(char cls: {'b', 'w'}){ //canonical elements
+    if(square)
+      output.Printf("<rect id=\"r%zu%c\" class=\"%c\" width=\"%zu\" "
+        "height=\"%zu\" ", k, cls, cls, ring.sw, ring.sw);
+    else output.Printf("<ellipse id=\"r%zu%c\" class=\"%c\" rx=\"%0.1f\" "
+        "ry=\"%0.1f\" ", k, cls, cls, ring.r0, ring.r1);
+
+    output.Printf("transform=\"translate(%0.3f %0.3f)rotate(%d %zu %zu)\"/>\n",
+      ring.r + h, h, base, cx, cy);
+  } //for
+
+  output.Printf("</defs>\n"); //close defs
+
+  float theta = ring.theta; //angle to current element
+  bool parity = ring.parity; //parity of current element
+  size_t count = 0; //number of elements drawn
+
+  for(size_t i=0; i<ring.n; i++){
+    const char cls = ElementClass(ring, i, parity); //element class
+
+    if(cls != 0){
+      double x, y, phi; //placement
+      PlaceElement(ring, i, theta, parity, x, y, phi);
+      output.Printf("<use href=\"#r%zu%c\" transform=\"rotate(%0.*f %s)\"/>\n",
+        k, cls, digits, phi - base, center);
+      count++;
+    } //if
+
+    NextElement(ring, i, theta, parity);
+  } //for
+
+  output.Printf("</g>\n"); //close group
+  return count;
+} //DrawRotatedRing
+
+/// \brief Draw an illusion with rotated rings.
+///
+/// The equivalent of DrawIllusion() using DrawRotatedRing().
+///
+/// \param output Output stream.
+/// \param illusion Illusion descriptor.
+/// \return Number of elements drawn.
+
+size_t DrawRotatedIllusion(COutput& output, const Illusion& illusion){
+  DrawStyle(output, illusion);
+  size_t count = 0; //number of elements drawn
+
+  for(size_t k=0; k<illusion.rings.size(); k++)
+    count += DrawRotatedRing(output, illusion.cx, illusion.cy,
+      illusion.rings[k], k);
+
+  return count;
+} //DrawRotatedIllusion
+
+#pragma endregion drawing
+
+//////////////////////////////////////////////////////////////////////////
+// Checking.
+
+#pragma region checking
+
+/// \brief Element as rendered.
+///
+/// Where an element ends up after all of its transforms are applied.
+
+struct Rendered{
+  double x = 0; ///< Center x.
+  double y = 0; ///< Center y.
+  double phi = 0; ///< Orientation in degrees.
+  char cls = 0; ///< Class, `b` or `w`.
+}; //Rendered
+
+/// \brief Parse an SVG transform.
+///
+/// Parse a list of `translate(x y)` and `rotate(a x y)` transforms, as
+/// written by FormatSquare(), FormatEllipse(), and DrawRotatedRing(), into
+/// an affine matrix `(a, b, c, d, e, f)` that maps `(x, y)` to
+/// `(ax + cy + e, bx + dy + f)`.
+///
+/// \param s Transform, ending with a double quote.
+/// \param m [out] Affine matrix.
+/// \return true if the transform was parsed.
+
+static bool ParseTransform(const char* s, double m[6]){
+  const double I[6] = {1, 0, 0, 1, 0, 0}; //identity
+  std::copy(I, I + 6, m);
+
+  while(*s != '"'){
+    const bool rotate = !strncmp(s, "rotate(", 7); //rotation, not translation
+    if(!rotate && strncmp(s, "translate(", 10))return false;
+    s = strchr(s, '(') + 1;
+
+    double v[3] = {0, 0, 0}; //parameters
+
+    for(int k=0; k<(rotate? 3: 2); k++){
+      char* end = nullptr; //end of number parsed
+      v[k] = strtod(s, &end);
+      if(end == s)return false;
+      s = end;
+    } //for
+
+    if(*s++ != ')')return false;
+
+    double t[6] = {1, 0, 0, 1, v[0], v[1]}; //translation
+
+    if(rotate){ //rotation about a point
+      const double a = v[0]*PI/180; //angle in radians
+      const double c = cos(a), sn = sin(a); //cosine and sine
+      t[0] = c; t[1] = sn; t[2] = -sn; t[3] = c;
+      t[4] = v[1] - c*v[1] + sn*v[2];
+      t[5] = v[2] - sn*v[1] - c*v[2];
+    } //if
+
+    const double p[6] = { //m times t
+      m[0]*t[0] + m[2]*t[1], m[1]*t[0] + m[3]*t[1],
+      m[0]*t[2] + m[2]*t[3], m[1]*t[2] + m[3]*t[3],
+      m[0]*t[4] + m[2]*t[5] + m[4], m[1]*t[4] + m[3]*t[5] + m[5]};
+
+    std::copy(p, p + 6, m);
+  } //while
+
+  return true;
+} //ParseTransform
+
+/// \brief Apply a transform to the element under it.
+///
+/// \param m Affine matrix from ParseTransform().
+/// \param tag Start of the element's tag.
+/// \param cx Image center x, which the style puts elements at.
+/// \param cy Image center y, which the style puts elements at.
+/// \param e [out] Element as rendered, except for its class.
+
+static void Render(const double m[6], const char* tag, size_t cx, size_t cy,
+  Rendered& e)
+{
+  double x = (double)cx, y = (double)cy; //center before transform
+
+  if(!strncmp(tag, "<rect", 5)){
+    const double h = atof(strstr(tag, "width=\"") + 7)/2; //half width
+    x += h; y += h;
+  } //if
+
+  e.x = m[0]*x + m[2]*y + m[4];
+  e.y = m[1]*x + m[3]*y + m[5];
+  e.phi = atan2(m[1], m[0])*180/PI;
+} //Render
+
+/// \param tag Start of the element's tag.
+/// \return Class of the element, or 0 if it has none.
+
+static char Class(const char* tag){
+  const char* end = strchr(tag, '>'); //end of tag
+  const char* cls = strstr(tag, "class=\""); //class attribute
+  return cls != nullptr && cls < end? cls[7]: 0;
+} //Class
+
+/// \brief Find where the elements of an SVG illusion are rendered.
+///
+/// Read elements drawn by DrawIllusion() with groups, or by
+/// DrawRotatedIllusion(), and work out where each visible element ends up,
+/// in drawing order.
+///
+/// \param svg SVG text.
+/// \param cx Image center x.
+/// \param cy Image center y.
+/// \param elements [out] Visible elements as rendered.
+/// \return true if the SVG was understood.
+
+static bool RenderedElements(const std::string& svg, size_t cx, size_t cy,
+  std::vector<Rendered>& elements)
+{
+  std::map<std::string, std::string> defs; //canonical elements by id
+  const char* p = svg.c_str(); //current line
+  elements.clear();
+
+  for(; *p; p = strchr(p, '\n') + 1){
+    double m[6]; //affine matrix
+    Rendered e; //element
+
+    if(!strncmp(p, "<g transform=\"", 14)){ //grouped element
+      const char* tag = strstr(p, "\">") + 2; //element tag
+      if(!ParseTransform(p + 14, m))return false;
+      Render(m, tag, cx, cy, e);
+      e.cls = Class(tag);
+      if(e.cls != 0)elements.push_back(e);
+    } //if
+
+    else if(!strncmp(p, "<use href=\"#", 12)){ //use of a canonical element
+      const char* q = strchr(p + 12, '"'); //end of id
+      auto it = defs.find(std::string(p + 12, q)); //canonical element
+      if(it == defs.end() || strncmp(q, "\" transform=\"", 13))return false;
+      if(!ParseTransform(q + 13, m))return false;
+
+      const std::string& def = it->second; //its tag
+      double d[6]; //its transform
+      if(!ParseTransform(strstr(def.c_str(), "transform=\"") + 11, d))
+        return false;
+
+      const double md[6] = { //m times d
+        m[0]*d[0] + m[2]*d[1], m[1]*d[0] + m[3]*d[1],
+        m[0]*d[2] + m[2]*d[3], m[1]*d[2] + m[3]*d[3],
+        m[0]*d[4] + m[2]*d[5] + m[4], m[1]*d[4] + m[3]*d[5] + m[5]};
+
+      Render(md, def.c_str(), cx, cy, e);
+      e.cls = Class(def.c_str());
+      elements.push_back(e);
+    } //else if
+
+    else if(!strncmp(p, "<rect id=\"", 10) ||
+      !strncmp(p, "<ellipse id=\"", 13))
+    { //canonical element
+      const char* id = strchr(p, '"') + 1; //canonical element's id
+      defs[std::string(id, strchr(id, '"'))].assign(p, strchr(p, '\n'));
+    } //else if
+
+    if(strchr(p, '\n') == nullptr)break;
+  } //for
+
+  return true;
+} //RenderedElements
+
+/// \brief Compare two renderings.
+///
+/// \param a Elements of one rendering.
+/// \param b Elements of the other.
+/// \param dpos [out] Largest distance between element centers in pixels.
+/// \param dphi [out] Largest difference in orientation in degrees.
+/// \return true if the elements have the same number and classes.
+
+static bool CompareElements(const std::vector<Rendered>& a,
+  const std::vector<Rendered>& b, double& dpos, double& dphi)
+{
+  dpos = dphi = 0;
+  if(a.size() != b.size())return false;
+
+  for(size_t i=0; i<a.size(); i++){
+    if(a[i].cls != b[i].cls)return false;
+
+    dpos = std::max(dpos, hypot(a[i].x - b[i].x, a[i].y - b[i].y));
+    const double d = fmod(fabs(a[i].phi - b[i].phi), 360); //angle difference
+    dphi = std::max(dphi, std::min(d, 360 - d));
+  } //for
+
+  return true;
+} //CompareElements
+
+/// \param s Text.
+/// \return Number of numbers in the text, not counting digits in names.
+
+static size_t CountNumbers(const std::string& s){
+  size_t count = 0; //result
+
+  for(size_t i=0; i<s.size(); i++)
+    if(isdigit((unsigned char)s[i]) && (i == 0 ||
+      (!isalnum((unsigned char)s[i - 1]) && s[i - 1] != '.' &&
+      s[i - 1] != '#')))
+      count++;
+
+  return count;
+} //CountNumbers
+
+#pragma endregion checking
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Draw an illusion with rotated rings.
+///
+/// The parameters are a job as described in ParseJob(). The illusion is
+/// drawn with DrawRotatedIllusion().
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int RotateCommand(size_t argc, const char* const argv[]){
+  Job job; //job descriptor
+
+  if(!ParseJob(job, argc, argv)){
+    printf("Expected <job>\n");
+    return 1;
+  } //if
+
+  Illusion illusion; //illusion descriptor
+  Describe(illusion, job);
+  const std::string fname = job.fname + ".svg"; //file name
+  COutput output; //output stream
+
+  if(!output.Open(fname)){
+    printf("Cannot open %s\n", fname.c_str());
+    return 1;
+  } //if
+
+  DrawHeader(output, job.w, job.w);
+  const size_t count = DrawRotatedIllusion(output, illusion); //drawn
+  CloseSVG(output);
+
+  printf("Rotated rings to %s: %zu elements in %zu rings, %zu bytes\n",
+    fname.c_str(), count, illusion.rings.size(), output.Size());
+
+  return output.Error()? 1: 0;
+} //RotateCommand
+
+/// \brief Compare rotated rings with grouped elements.
+///
+/// The parameters are optionally `-reps n` (default 100) followed by a job
+/// as described in ParseJob(); without a job, the illusions `output1.svg`
+/// and `output2.svg` are used. For each job, the illusion is drawn with
+/// DrawIllusion() and DrawRotatedIllusion(), and the number of bytes,
+/// the number of numbers per visible element, and the time to draw are
+/// reported. Both SVGs are then read back, each element's transforms are
+/// applied, and the largest difference in where the elements end up is
+/// reported. They must have the same visible elements in the same order
+/// with the same colors.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 if the renderings match, 1 if not or for failure.
+
+int BenchRotateCommand(size_t argc, const char* const argv[]){
+  size_t reps = 100; //number of repetitions
+  std::vector<Job> jobs; //jobs to compare
+
+  if(argc >= 2 && !strcmp(argv[0], "-reps")){
+    reps = (size_t)strtoul(argv[1], nullptr, 10);
+    argc -= 2; argv += 2;
+  } //if
+
+  if(argc > 0){
+    jobs.push_back(Job());
+
+    if(!ParseJob(jobs[0], argc, argv) || reps == 0 || jobs[0].flat){
+      printf("Expected [-reps n] [job]\n");
+      return 1;
+    } //if
+  } //if
+
+  else BenchJobs(jobs);
+
+  bool ok = true; //renderings match
+
+  for(const Job& job: jobs){
+    Illusion illusion; //illusion descriptor
+    Describe(illusion, job);
+
+    std::string svg[2]; //grouped and rotated SVG
+    double t[2] = {INFINITY, INFINITY}; //fastest times
+    size_t count = 0; //number of visible elements
+
+    for(size_t rep=0; rep<reps; rep++)
+      for(int rotated=0; rotated<2; rotated++){ //grouped, then rotated
+        svg[rotated].clear();
+        CTimer timer; //stopwatch
+        COutput output(svg[rotated]); //output stream
+        DrawHeader(output, job.w, job.w);
+
+        if(rotated)count = DrawRotatedIllusion(output, illusion);
+        else DrawIllusion(output, illusion);
+
+        CloseSVG(output);
+        t[rotated] = std::min(t[rotated], timer.Elapsed());
+      } //for
+
+    printf("%s: %zu visible elements in %zu rings\n", job.fname.c_str(),
+      count, illusion.rings.size());
+    printf("  %-8s %9s %12s %9s\n", "mode", "bytes", "numbers/elt", "ms");
+
+    for(int rotated=0; rotated<2; rotated++)
+      printf("  %-8s %9zu %12.2f %9.3f\n", rotated? "rotated": "grouped",
+        svg[rotated].size(), (double)CountNumbers(svg[rotated])/count,
+        1000*t[rotated]);
+
+    std::vector<Rendered> a, b; //elements as rendered
+    double dpos = 0, dphi = 0; //largest differences
+    const bool same = RenderedElements(svg[0], illusion.cx, illusion.cy, a) &&
+      RenderedElements(svg[1], illusion.cx, illusion.cy, b) &&
+      CompareElements(a, b, dpos, dphi); //same elements and colors
+
+    if(same)printf("  same %zu elements, at most %0.3f px and %0.3f degrees "
+      "apart\n", a.size(), dpos, dphi);
+    else printf("  DIFFERENT ELEMENTS\n");
+
+    ok = ok && same && a.size() == count;
+  } //for
+
+  return ok? 0: 1;
+} //BenchRotateCommand
+
+#pragma endregion commands
@@ -0,0 +1,422 @@
+/// \file Scheduler.cpp
+
+/// \brief Code for the job scheduler CScheduler.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Scheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+//////////////////////////////////////////////////////////////////////////
+// CTask.
+
+#pragma region CTask
+
+CTask::CTask(): m_eStatus(Status::Queued){
+} //constructor
+
+/// \return Task status.
+
+Status CTask::GetStatus() const{
+  return m_eStatus;
+} //GetStatus
+
+/// \return true if the task will not be run again.
+
+bool CTask::Finished() const{
+  const Status status = m_eStatus; //current status
+  return status != Status::Queued && status != Status::Running;
+} //Finished
+
+/// \return Seconds from submission to finish, if finished.
+
+double CTask::Latency() const{
+  return m_fFinish - m_fSubmit;
+} //Latency
+
+/// \return Number of times the task was preempted.
+
+size_t CTask::Preempted() const{
+  return m_nPreempted;
+} //Preempted
+
+#pragma endregion CTask
+
+//////////////////////////////////////////////////////////////////////////
+// CScheduler.
+
+#pragma region CScheduler
+
+/// Order tasks by priority class, then deadline, then submission order.
+/// \param a A task.
+/// \param b Another task.
+/// \return true if `a` should run after `b`.
+
+bool CScheduler::Later::operator()(const Task& a, const Task& b) const{
+  if(a->m_ePriority != b->m_ePriority)
+    return a->m_ePriority > b->m_ePriority;
+
+  if(a->m_bDeadline != b->m_bDeadline)
+    return b->m_bDeadline; //tasks with deadlines first
+
+  if(a->m_bDeadline && a->m_fDeadline != b->m_fDeadline)
+    return a->m_fDeadline > b->m_fDeadline;
+
+  return a->m_nSeq > b->m_nSeq;
+} //operator()
+
+/// Start the worker threads.
+/// \param n Number of threads, or 0 for one per hardware thread.
+/// \param preempt True to let higher priority tasks preempt lower ones.
+
+CScheduler::CScheduler(size_t n, bool preempt): m_bPreempt(preempt){
+  if(n == 0)n = std::thread::hardware_concurrency();
+  if(n == 0)n = 1;
+
+  m_vRunning.resize(n);
+
+  for(size_t i=0; i<n; i++)
+    m_vThread.push_back(std::thread(&CScheduler::Run, this, i));
+} //constructor
+
+/// Cancel every task that has not finished, and stop the worker threads.
+
+CScheduler::~CScheduler(){
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_bStop = true;
+
+    for(const Task& task: m_vRunning)
+      if(task)task->m_cancel.Cancel();
+
+    while(!m_qTask.empty()){
+      Finish(m_qTask.top(), Status::Cancelled);
+      m_qTask.pop();
+    } //while
+  }
+
+  m_cvTask.notify_all();
+
+  for(std::thread& t: m_vThread)
+    t.join();
+} //destructor
+
+/// Record that a task has finished. The caller must hold the mutex.
+/// \param task Task.
+/// \param status How it finished.
+
+void CScheduler::Finish(const Task& task, Status status){
+  if(!task->Finished()){
+    task->m_eStatus = status;
+    task->m_fFinish = m_timer.Elapsed();
+    m_cvDone.notify_all();
+  } //if
+} //Finish
+
+/// Take tasks from the queue and render them until told to stop.
+/// \param slot Index of this thread.
+
+void CScheduler::Run(size_t slot){
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  for(;;){
+    m_cvTask.wait(lock, [this]{return m_bStop || !m_qTask.empty();});
+    if(m_bStop)return;
+
+    const Task task = m_qTask.top(); //next task
+    m_qTask.pop();
+    Execute(task, slot, lock);
+  } //for
+} //Run
+
+/// Render a task that has been taken from the queue, unless it has been
+/// cancelled or its deadline has passed. The caller must hold the mutex,
+/// which is released while rendering.
+/// \param task Task.
+/// \param slot Index of this thread.
+/// \param lock Lock on the mutex.
+
+void CScheduler::Execute(const Task& task, size_t slot,
+  std::unique_lock<std::mutex>& lock)
+{
+  if(task->Finished())return; //cancelled while queued
+
+  if(task->m_cancel.IsExpired()){
+    Finish(task, Status::Expired);
+    return;
+  } //if
+
+  const Task outer = m_vRunning[slot]; //task that yielded to this one
+  task->m_eStatus = Status::Running;
+  task->m_cancel.SetYield([this, task, slot]{Yield(task, slot);});
+  m_vRunning[slot] = task;
+
+  lock.unlock();
+  const bool ok = RenderJob(task->m_job, nullptr, &task->m_cancel); //done
+  lock.lock();
+
+  m_vRunning[slot] = outer;
+  task->m_cancel.SetYield(nullptr); //break the reference cycle
+
+  if(ok)Finish(task, Status::Done);
+  else if(task->m_cancel.IsCancelled())Finish(task, Status::Cancelled);
+  else if(task->m_cancel.IsExpired())Finish(task, Status::Expired);
+  else Finish(task, Status::Failed);
+} //Execute
+
+/// Called by a preempted task's cancellation flag on the thread rendering
+/// it. Render every queued task in a higher priority class than the
+/// preempted one, then return so that it can carry on.
+/// \param task Preempted task.
+/// \param slot Index of this thread.
+
+void CScheduler::Yield(const Task& task, size_t slot){
+  std::unique_lock<std::mutex> lock(m_mutex);
+  task->m_cancel.Preempt(false);
+  task->m_nPreempted++;
+
+  while(!m_bStop && !m_qTask.empty() &&
+    m_qTask.top()->m_ePriority < task->m_ePriority)
+  {
+    const Task next = m_qTask.top(); //more urgent task
+    m_qTask.pop();
+    Execute(next, slot, lock);
+  } //while
+} //Yield
+
+/// Submit a job to be rendered. If preemption is enabled and every thread
+/// is busy, the running task with the lowest priority class below that of
+/// the new task, if any, is preempted so that it yields to the new task.
+/// \param job Job descriptor.
+/// \param priority Priority class.
+/// \param deadline Seconds from now after which the job is abandoned, or 0
+/// for no deadline.
+/// \return Task, for waiting on or cancelling.
+
+Task CScheduler::Submit(const Job& job, Priority priority, double deadline){
+  Task task = std::make_shared<CTask>(); //new task
+  task->m_job = job;
+  task->m_ePriority = priority;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  task->m_fSubmit = m_timer.Elapsed();
+  task->m_nSeq = m_nSeq++;
+
+  if(deadline > 0){
+    task->m_bDeadline = true;
+    task->m_fDeadline = task->m_fSubmit + deadline;
+    task->m_cancel.SetDeadline(deadline);
+  } //if
+
+  m_qTask.push(task);
+
+  if(m_bPreempt){
+    Task victim; //task to be preempted
+    bool idle = false; //a thread is idle and will take the new task
+
+    for(const Task& t: m_vRunning){
+      if(!t)idle = true;
+
+      else if(t->m_ePriority > priority && !t->m_cancel.IsPreempted() &&
+        (!victim || t->m_ePriority > victim->m_ePriority))
+          victim = t;
+    } //for
+
+    if(victim && !idle)victim->m_cancel.Preempt();
+  } //if
+
+  lock.unlock();
+  m_cvTask.notify_one();
+  return task;
+} //Submit
+
+/// Cancel a task. A queued task is cancelled at once, and a running one
+/// at its next check.
+/// \param task Task.
+
+void CScheduler::Cancel(const Task& task){
+  std::unique_lock<std::mutex> lock(m_mutex);
+  task->m_cancel.Cancel();
+  if(task->m_eStatus == Status::Queued)Finish(task, Status::Cancelled);
+} //Cancel
+
+/// Wait for a task to finish.
+/// \param task Task.
+
+void CScheduler::Wait(const Task& task){
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cvDone.wait(lock, [&task]{return task->Finished();});
+} //Wait
+
+/// \return Number of worker threads.
+
+size_t CScheduler::Size() const{
+  return m_vThread.size();
+} //Size
+
+#pragma endregion CScheduler
+
+//////////////////////////////////////////////////////////////////////////
+// Benchmark.
+
+#pragma region benchmark
+
+/// \brief Benchmark the scheduler.
+///
+/// The parameter is a directory for the output files, optionally followed
+/// by `-threads n` to set the number of threads (by default one per
+/// hardware thread), `-previews k` to set the number of previews (default
+/// 100), and `-interval ms` to set the time between them (default 10).
+///
+/// The scheduler is kept saturated with large batch jobs while small
+/// preview jobs are submitted one at a time, and the latency of each
+/// preview from submission to its file being written is measured. This is
+/// done three times: with every job in the same class, which is first come
+/// first served; with previews in the interactive class and batch jobs in
+/// the batch class; and with preemption as well. The median, 99th
+/// percentile, and maximum preview latency are reported for each, along
+/// with the number of batch jobs finished and the number of times they
+/// yielded. The batch jobs still outstanding at the end are cancelled.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchSchedCommand(size_t argc, const char* const argv[]){
+  size_t threads = 0; //number of threads
+  size_t previews = 100; //number of previews
+  int interval = 10; //milliseconds between previews
+  bool ok = argc%2 == 1; //no errors so far
+
+  for(size_t i=1; ok && i+1<argc; i+=2){ //options
+    if(!strcmp(argv[i], "-threads"))threads = (size_t)strtoul(argv[i + 1], 0, 10);
+    else if(!strcmp(argv[i], "-previews"))previews = (size_t)strtoul(argv[i + 1], 0, 10);
+    else if(!strcmp(argv[i], "-interval"))interval = atoi(argv[i + 1]);
+    else ok = false;
+  } //for
+
+  if(!ok || previews == 0){
+    printf("Expected directory [-threads n] [-previews k] [-interval ms]\n");
+    return 1;
+  } //if
+
+  const std::string dir = argv[0]; //output directory
+
+  Job preview; //preview job
+  preview.kind = 1;
+  preview.fname = dir + "/preview";
+  preview.w = 800;
+  preview.n = 4;
+  preview.p[0] = 100; preview.p[1] = 72; preview.p[2] = 24;
+  preview.dark = "black"; preview.light = "white"; preview.bgclr = "gray";
+
+  Job batch = preview; //batch job
+  batch.w = 12000;
+  batch.n = 120;
+  batch.p[1] = 48;
+
+  /// \brief Scheduling mode.
+
+  struct Mode{
+    const char* name; ///< Name.
+    bool priority; ///< Use priority classes.
+    bool preempt; ///< Use preemption.
+  }; //Mode
+
+  const Mode modes[] = {
+    {"first come first served", false, false},
+    {"priority classes", true, false},
+    {"priority and preemption", true, true},
+  }; //modes
+
+  for(const Mode& mode: modes){
+    CScheduler scheduler(threads, mode.preempt); //scheduler
+    const size_t backlog = 2*scheduler.Size(); //batch jobs to keep queued
+    std::vector<Task> batches; //batch tasks
+    std::vector<double> latency; //preview latencies
+    size_t outstanding = 0; //number of unfinished batch tasks
+    CTimer timer; //stopwatch
+
+    for(size_t k=0; k<previews; k++){
+      for(int j=0; j<2; j++){ //top up the batch jobs before and after a pause
+        outstanding = 0;
+        for(const Task& t: batches)
+          if(!t->Finished())outstanding++;
+
+        for(; outstanding<backlog; outstanding++){
+          batch.fname = dir + "/batch" + std::to_string(batches.size()%8);
+          batches.push_back(scheduler.Submit(batch,
+            mode.priority? Priority::Batch: Priority::Normal));
+        } //for
+
+        if(j == 0)
+          std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+      } //for
+
+      const Task t = scheduler.Submit(preview,
+        mode.priority? Priority::Interactive: Priority::Normal); //preview
+      scheduler.Wait(t);
+
+      if(t->GetStatus() != Status::Done){
+        printf("Cannot write %s.svg\n", preview.fname.c_str());
+        return 1;
+      } //if
+
+      latency.push_back(t->Latency());
+    } //for
+
+    size_t done = 0; //number of batch jobs done
+    size_t preempted = 0; //number of times batch jobs yielded
+
+    for(const Task& t: batches)
+      scheduler.Cancel(t);
+
+    for(const Task& t: batches){
+      scheduler.Wait(t);
+      if(t->GetStatus() == Status::Done)done++;
+      preempted += t->Preempted();
+    } //for
+
+    const double t = timer.Elapsed(); //elapsed time
+    std::sort(latency.begin(), latency.end());
+    const size_t n = latency.size(); //number of previews
+
+    printf("%s, %zu threads, %0.3f s\n", mode.name, scheduler.Size(), t);
+    printf("  preview latency median %8.3f ms, p99 %8.3f ms, max %8.3f ms\n",
+      1000*latency[n/2], 1000*latency[std::min(n - 1, (size_t)(0.99*n))],
+      1000*latency[n - 1]);
+    printf("  %zu batch jobs done, %zu yields, %zu cancelled\n",
+      done, preempted, batches.size() - done);
+  } //for
+
+  return 0;
+} //BenchSchedCommand
+
+#pragma endregion benchmark
@@ -0,0 +1,144 @@
+/// \file Scheduler.h
+
+/// \brief Interface for the job scheduler CScheduler.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Scheduler_h__
+#define __Scheduler_h__
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "Illusion.h"
+#include "Timer.h"
+
+/// \brief Priority class, highest first.
+
+enum class Priority{
+  Interactive, ///< Someone is waiting for it, such as a preview.
+  Normal, ///< Ordinary work.
+  Batch ///< Bulk work that can wait.
+}; //Priority
+
+/// \brief Task status.
+
+enum class Status{
+  Queued, ///< Waiting to run.
+  Running, ///< Being rendered.
+  Done, ///< Rendered.
+  Failed, ///< Could not be written.
+  Cancelled, ///< Cancelled before it finished.
+  Expired ///< Deadline passed before it finished.
+}; //Status
+
+/// \brief Scheduled task.
+///
+/// A job submitted to a CScheduler, together with its priority, its
+/// cancellation flag, and what has happened to it so far.
+
+class CTask{
+  friend class CScheduler;
+
+  private:
+    Job m_job; ///< Job to be rendered.
+    Priority m_ePriority = Priority::Normal; ///< Priority class.
+    bool m_bDeadline = false; ///< Has a deadline.
+    double m_fDeadline = 0; ///< Deadline, seconds after scheduler started.
+    size_t m_nSeq = 0; ///< Submission order.
+    CCancel m_cancel; ///< Cancellation flag checked while drawing.
+    std::atomic<Status> m_eStatus; ///< Status.
+    size_t m_nPreempted = 0; ///< Number of times it yielded.
+    double m_fSubmit = 0; ///< Time submitted.
+    double m_fFinish = 0; ///< Time finished.
+
+  public:
+    CTask(); ///< Constructor.
+
+    Status GetStatus() const; ///< Get status.
+    bool Finished() const; ///< Done, failed, cancelled, or expired?
+    double Latency() const; ///< Seconds from submission to finish.
+    size_t Preempted() const; ///< Number of times it yielded.
+}; //CTask
+
+typedef std::shared_ptr<CTask> Task; ///< Shared pointer to a task.
+
+/// \brief Job scheduler.
+///
+/// A fixed set of threads that render jobs in order of priority class,
+/// then deadline, earliest first, then submission order. A job can be
+/// cancelled at any time, and a job whose deadline passes is abandoned.
+/// Rendering checks for cancellation between rings and every CCancel::CHUNK
+/// elements, so that even a job with millions of elements stops within
+/// microseconds.
+///
+/// If preemption is enabled, a job submitted when every thread is busy
+/// preempts a running job of a lower priority class. At its next check the
+/// preempted job yields, and its thread renders the queued jobs of higher
+/// priority classes before carrying on where it left off. This bounds the
+/// wait for an interactive job by the time taken to draw one chunk rather
+/// than one whole batch job, without wasting any of the batch work.
+
+class CScheduler{
+  private:
+    /// \brief Task ordering for the priority queue, lowest first.
+
+    struct Later{
+      bool operator()(const Task& a, const Task& b) const; ///< Is `a` later?
+    }; //Later
+
+    std::vector<std::thread> m_vThread; ///< Worker threads.
+    std::vector<Task> m_vRunning; ///< Task being run by each thread.
+    std::priority_queue<Task, std::vector<Task>, Later> m_qTask; ///< Queued tasks.
+    std::mutex m_mutex; ///< Guards everything above and below.
+    std::condition_variable m_cvTask; ///< Signalled when a task is queued.
+    std::condition_variable m_cvDone; ///< Signalled when a task finishes.
+    size_t m_nSeq = 0; ///< Number of tasks submitted.
+    bool m_bPreempt = true; ///< Preempt lower priority tasks.
+    bool m_bStop = false; ///< Tell the threads to exit.
+    CTimer m_timer; ///< Time since construction.
+
+    void Run(size_t slot); ///< Worker thread main loop.
+    void Execute(const Task& task, size_t slot,
+      std::unique_lock<std::mutex>& lock); ///< Render a task.
+    void Yield(const Task& task, size_t slot); ///< Render more urgent tasks.
+    void Finish(const Task& task, Status status); ///< Record a finished task.
+
+  public:
+    CScheduler(size_t n=0, bool preempt=true); ///< Constructor.
+    ~CScheduler(); ///< Destructor.
+
+    Task Submit(const Job& job, Priority priority, double deadline=0); ///< Submit a job.
+    void Cancel(const Task& task); ///< Cancel a task.
+    void Wait(const Task& task); ///< Wait for a task to finish.
+    size_t Size() const; ///< Number of threads.
+}; //CScheduler
+
+int BenchSchedCommand(size_t argc, const char* const argv[]);
+
+#endif //__Scheduler_h__
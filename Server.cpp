@@ -0,0 +1,244 @@
+/// \file Server.cpp
+
+/// \brief Code for the local HTTP server.
+///
+/// The server answers HTTP `GET` and `HEAD` requests for the illusions in a
+/// job file. The path of each illusion is its file name with extension
+/// `.svg`. Requests with a `Range` header are answered with only the bytes
+/// requested, which are drawn on demand using a byte range index so that
+/// the rest of the illusion is never drawn. The indices are built before
+/// the server starts listening, so that no request waits for one.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Server.h"
+#include "Range.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+#ifndef _MSC_VER
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifndef _MSC_VER
+
+/// \brief Parse a byte range.
+///
+/// Parse the value of an HTTP `Range` header with a single range, one of
+/// `bytes=a-b`, `bytes=a-`, or `bytes=-n`.
+///
+/// \param s Header value.
+/// \param size Size of resource in bytes.
+/// \param a [out] Offset of first byte.
+/// \param b [out] Offset of byte after last.
+/// \return true if the range is valid and satisfiable.
+
+static bool ParseRange(const char* s, size_t size, size_t& a, size_t& b){
+  if(strncmp(s, "bytes=", 6))return false;
+  s += 6;
+
+  char* end = nullptr; //end of number
+
+  if(*s == '-'){ //suffix range
+    const size_t n = (size_t)strtoull(s + 1, &end, 10);
+    if(end == s + 1 || n == 0)return false;
+    a = n < size? size - n: 0;
+    b = size;
+  } //if
+
+  else{ //first and optional last byte
+    a = (size_t)strtoull(s, &end, 10);
+    if(end == s || *end != '-')return false;
+    s = end + 1;
+    b = (size_t)strtoull(s, &end, 10) + 1;
+    if(end == s)b = size; //no last byte
+    if(b > size)b = size;
+  } //else
+
+  return a < b;
+} //ParseRange
+
+/// \brief Answer one HTTP request.
+///
+/// \param fd Socket file descriptor, which is closed on return.
+/// \param paths Map from path to job index.
+/// \param jobs Job descriptors.
+/// \param indices Byte range indices, by job index.
+
+static void Answer(int fd, const std::map<std::string, size_t>& paths,
+  const std::vector<CRangeIndex>& indices)
+{
+  char request[8192]; //request, up to the end of the headers
+  size_t len = 0; //length of request
+
+  while(len < sizeof(request) - 1){ //read request headers
+    const ssize_t n = read(fd, request + len, sizeof(request) - 1 - len);
+    if(n <= 0)break;
+    len += n;
+    request[len] = 0;
+    if(strstr(request, "\r\n\r\n") != nullptr)break;
+  } //while
+
+  request[len] = 0;
+  FILE* output = fdopen(fd, "w"); //socket as a file
+
+  if(output == nullptr){
+    close(fd);
+    return;
+  } //if
+
+  char method[16] = {0}; //request method
+  char path[1024] = {0}; //request path
+  sscanf(request, "%15s %1023s", method, path);
+
+  const bool head = !strcmp(method, "HEAD"); //no body wanted
+  const auto it = paths.find(path); //job for path
+
+  if((strcmp(method, "GET") && !head) || it == paths.end()){ //can't serve it
+    fprintf(output, "HTTP/1.1 404 Not Found\r\n"
+      "Content-Length: 0\r\nConnection: close\r\n\r\n");
+    fclose(output);
+    return;
+  } //if
+
+  const CRangeIndex& index = indices[it->second]; //byte range index
+  const size_t size = index.Size(); //SVG size
+  size_t a = 0, b = size; //range to be drawn
+
+  const char* range = nullptr; //range header value
+
+  for(char* p = strstr(request, "\r\n"); p != nullptr;
+    p = strstr(p + 2, "\r\n"))
+  {
+    if(!strncasecmp(p + 2, "Range:", 6)){
+      range = p + 8;
+      while(*range == ' ')range++;
+      break;
+    } //if
+  } //for
+
+  if(range != nullptr && !ParseRange(range, size, a, b)){ //bad range
+    fprintf(output, "HTTP/1.1 416 Range Not Satisfiable\r\n"
+      "Content-Range: bytes */%zu\r\n"
+      "Content-Length: 0\r\nConnection: close\r\n\r\n", size);
+    fclose(output);
+    return;
+  } //if
+
+  if(range != nullptr)
+    fprintf(output, "HTTP/1.1 206 Partial Content\r\n"
+      "Content-Range: bytes %zu-%zu/%zu\r\n", a, b - 1, size);
+  else fprintf(output, "HTTP/1.1 200 OK\r\n");
+
+  fprintf(output, "Content-Type: image/svg+xml\r\nAccept-Ranges: bytes\r\n"
+    "Content-Length: %zu\r\nConnection: close\r\n\r\n", b - a);
+
+  if(!head){
+    COutput body(output); //output stream for body
+    index.Draw(body, a, b);
+    body.Flush();
+  } //if
+
+  fclose(output);
+} //Answer
+
+#endif //_MSC_VER
+
+/// \brief Serve illusions over HTTP.
+///
+/// The parameters are a port number and a job file as described in
+/// LoadJobs(). The byte range index of every illusion is built first. The
+/// server listens on the loopback interface only, and answers one request
+/// at a time until it is killed.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 1 for failure, otherwise it doesn't return.
+
+int ServeCommand(size_t argc, const char* const argv[]){
+#ifdef _MSC_VER //Visual Studio
+  printf("The server is not supported under Windows\n");
+  return 1;
+#else
+  std::vector<Job> jobs; //job descriptors
+
+  if(argc != 2 || !LoadJobs(argv[1], jobs)){
+    printf("Expected port number and job file\n");
+    return 1;
+  } //if
+
+  std::map<std::string, size_t> paths; //map from path to job index
+
+  for(size_t i=0; i<jobs.size(); i++)
+    paths["/" + jobs[i].fname + ".svg"] = i;
+
+  CTimer timer; //stopwatch
+  std::vector<CRangeIndex> indices(jobs.size()); //byte range indices
+
+  for(size_t i=0; i<jobs.size(); i++){ //build indices before serving
+    Illusion illusion; //illusion descriptor
+    Describe(illusion, jobs[i]);
+    indices[i].Build(illusion);
+  } //for
+
+  printf("Built %zu byte range indices in %0.3f s\n", jobs.size(),
+    timer.Elapsed());
+
+  const int port = atoi(argv[0]); //port number
+  const int fd = socket(AF_INET, SOCK_STREAM, 0); //listening socket
+  const int one = 1; //for setting socket options
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in addr; //server address
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((unsigned short)port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if(fd < 0 || bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+    listen(fd, 64) != 0)
+  {
+    printf("Cannot listen on port %d\n", port);
+    return 1;
+  } //if
+
+  signal(SIGPIPE, SIG_IGN); //clients may hang up early
+  printf("Serving %zu illusions at http://127.0.0.1:%d/\n", jobs.size(), port);
+  fflush(stdout);
+
+  for(;;){ //answer requests
+    const int client = accept(fd, nullptr, nullptr); //client socket
+    if(client >= 0)Answer(client, paths, indices);
+  } //for
+#endif
+} //ServeCommand
@@ -0,0 +1,270 @@
+/// \file Sizes.cpp
+
+/// \brief Code for drawing an illusion at several sizes.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Sizes.h"
+#include "Perf.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// Drawing.
+
+#pragma region drawing
+
+/// Parse a comma-separated list of image sizes, such as `200,400,800`.
+/// \param s List of sizes.
+/// \param sizes [out] Sizes in the order in which they are listed.
+/// \return true if every size is a positive integer.
+
+bool ParseSizes(const char* s, std::vector<size_t>& sizes){
+  sizes.clear();
+
+  while(true){
+    char* end = nullptr; //end of number parsed
+    const size_t size = (size_t)strtoull(s, &end, 10); //one size
+
+    if(end == s || size == 0 || (*end != ',' && *end != '\0'))
+      return false;
+
+    sizes.push_back(size);
+    if(*end == '\0')return true;
+    s = end + 1;
+  } //while
+} //ParseSizes
+
+/// \param job Job descriptor.
+/// \param size Image width and height in pixels.
+/// \return Name of the SVG file for the job drawn at that size.
+
+std::string SizeName(const Job& job, size_t size){
+  return job.fname + "-" + std::to_string(size) + ".svg";
+} //SizeName
+
+/// Scale a job to a different image size by scaling the radii and the
+/// square width, which is rounded to the nearest pixel. This is what had to
+/// be done to publish an illusion at several sizes before RenderSizes().
+/// \param job Job descriptor.
+/// \param size Image width and height in pixels.
+/// \return The job scaled to that size.
+
+Job ScaledJob(const Job& job, size_t size){
+  Job scaled = job; //scaled job
+  const float s = (float)size/job.w; //scale factor
+
+  scaled.w = size;
+  scaled.fname = job.fname + "-" + std::to_string(size);
+
+  for(double& p: scaled.p)
+    p = (float)p*s;
+
+  if(job.kind == 1) //square width is an integer
+    scaled.p[2] = std::max(1.0f, floorf((float)scaled.p[2] + 0.5f));
+
+  return scaled;
+} //ScaledJob
+
+/// Draw a job at several sizes from one pass over its geometry. The body of
+/// the SVG, that is, the style and the elements, is drawn once in the
+/// job's own coordinates. Each size gets its own file, named by SizeName(),
+/// that has the job's view box but a different display width and height,
+/// so that the viewer does the scaling, followed by the same body bytes.
+/// Each file is written to a temporary file and moved into place, as in
+/// RenderJob(). The body is kept in memory while the files are written.
+/// \param job Job descriptor.
+/// \param sizes Image widths and heights in pixels.
+/// \param bytes [out] Total number of bytes written, if not `nullptr`.
+/// \return true if every file was written.
+
+bool RenderSizes(const Job& job, const std::vector<size_t>& sizes,
+  size_t* bytes)
+{
+  Illusion illusion; //illusion descriptor
+  Describe(illusion, job);
+
+  std::string body; //style and elements
+  COutput drawing(body); //output stream for body
+  DrawIllusion(drawing, illusion);
+  drawing.Close();
+
+  size_t total = 0; //total bytes written
+  bool ok = true; //every file written
+
+  for(size_t size: sizes){
+    const std::string fname = SizeName(job, size); //file name
+    const std::string temp = TempName(fname); //temporary file name
+    COutput output; //output stream
+
+    if(!output.Open(temp, true)){
+      ok = false;
+      continue;
+    } //if
+
+    DrawHeader(output, job.w, job.w, 0, 0, size, size);
+    output.Write(body.data(), body.size());
+    CloseSVG(output);
+    total += output.Size();
+
+    ok = MoveIntoPlace(temp, fname, !output.Error()) && ok;
+  } //for
+
+  if(bytes != nullptr)
+    *bytes = total;
+
+  return ok;
+} //RenderSizes
+
+#pragma endregion drawing
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Draw an illusion at several sizes.
+///
+/// The parameters are a comma-separated list of image sizes in pixels
+/// followed by a job as described in ParseJob(). The job is drawn once and
+/// written at each size by RenderSizes().
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int SizesCommand(size_t argc, const char* const argv[]){
+  std::vector<size_t> sizes; //image sizes
+  Job job; //job descriptor
+
+  if(argc < 1 || !ParseSizes(argv[0], sizes) ||
+    !ParseJob(job, argc - 1, argv + 1))
+  {
+    printf("Expected <w1,w2,...> <job>\n");
+    return 1;
+  } //if
+
+  CTimer timer; //stopwatch
+  size_t bytes = 0; //total bytes written
+
+  if(!RenderSizes(job, sizes, &bytes)){
+    printf("Cannot write %s at every size\n", job.fname.c_str());
+    return 1;
+  } //if
+
+  printf("Wrote %zu sizes of %s, %zu bytes, in %0.3f ms\n", sizes.size(),
+    job.fname.c_str(), bytes, 1000*timer.Elapsed());
+
+  return 0;
+} //SizesCommand
+
+/// \brief Time drawing an illusion at several sizes.
+///
+/// The parameters are optionally `-reps n` (default 10) and `-sizes` with a
+/// comma-separated list of sizes (default 200, 400, 800, 1600, 3200, and
+/// 8000) followed by a job as described in ParseJob(); without a job, the
+/// illusions `output1.svg` and `output2.svg` are used. For each job, the
+/// files are written once per size by rendering a scaled job with
+/// RenderJob(), then all at once by RenderSizes(), and the total time and
+/// number of bytes of each are reported. The fastest of the repetitions is
+/// used, and the files are removed afterwards.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int BenchSizesCommand(size_t argc, const char* const argv[]){
+  size_t reps = 10; //number of repetitions
+  std::vector<size_t> sizes = {200, 400, 800, 1600, 3200, 8000}; //sizes
+  std::vector<Job> jobs; //jobs to time
+  bool ok = true; //parameters are good so far
+
+  while(ok && argc >= 2 && argv[0][0] == '-'){
+    if(!strcmp(argv[0], "-reps"))
+      reps = (size_t)strtoul(argv[1], nullptr, 10);
+
+    else if(!strcmp(argv[0], "-sizes"))
+      ok = ParseSizes(argv[1], sizes);
+
+    else ok = false;
+
+    argc -= 2; argv += 2;
+  } //while
+
+  if(ok && argc > 0){
+    jobs.push_back(Job());
+    ok = ParseJob(jobs[0], argc, argv);
+  } //if
+
+  else if(ok)BenchJobs(jobs);
+
+  if(!ok || reps == 0){
+    printf("Expected [-reps n] [-sizes w1,w2,...] [job]\n");
+    return 1;
+  } //if
+
+  for(const Job& job: jobs){
+    double t0 = INFINITY, t1 = INFINITY; //fastest separate and single pass
+    size_t bytes0 = 0, bytes1 = 0; //bytes written by each
+
+    for(size_t rep=0; rep<reps && ok; rep++){
+      CTimer timer; //stopwatch
+      bytes0 = 0;
+
+      for(size_t size: sizes){
+        Digest digest; //size of file
+        ok = RenderJob(ScaledJob(job, size), &digest) && ok;
+        bytes0 += digest.size;
+      } //for
+
+      t0 = std::min(t0, timer.Elapsed());
+
+      timer.Start();
+      ok = RenderSizes(job, sizes, &bytes1) && ok;
+      t1 = std::min(t1, timer.Elapsed());
+    } //for
+
+    for(size_t size: sizes)
+      remove(SizeName(job, size).c_str());
+
+    if(!ok){
+      printf("Cannot write %s at every size\n", job.fname.c_str());
+      return 1;
+    } //if
+
+    printf("%s: %zu sizes\n", job.fname.c_str(), sizes.size());
+    printf("  separate runs %9.3f ms %10zu bytes\n", 1000*t0, bytes0);
+    printf("  one pass      %9.3f ms %10zu bytes\n", 1000*t1, bytes1);
+    printf("  %0.1fx faster\n", t0/t1);
+  } //for
+
+  return 0;
+} //BenchSizesCommand
+
+#pragma endregion commands
@@ -0,0 +1,43 @@
+/// \file Sizes.h
+
+/// \brief Interface for drawing an illusion at several sizes.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Sizes_h__
+#define __Sizes_h__
+
+#include <vector>
+
+#include "Illusion.h"
+
+bool ParseSizes(const char* s, std::vector<size_t>& sizes);
+std::string SizeName(const Job& job, size_t size);
+Job ScaledJob(const Job& job, size_t size);
+bool RenderSizes(const Job& job, const std::vector<size_t>& sizes,
+  size_t* bytes=nullptr);
+
+int SizesCommand(size_t argc, const char* const argv[]);
+int BenchSizesCommand(size_t argc, const char* const argv[]);
+
+#endif //__Sizes_h__
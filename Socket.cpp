@@ -0,0 +1,182 @@
+/// \file Socket.cpp
+
+/// \brief Code for Unix domain socket helpers.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Socket.h"
+
+#include <string.h>
+
+#ifndef _MSC_VER
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/// \brief Make a Unix domain socket address.
+///
+/// \param addr [out] Socket address.
+/// \param path Socket path.
+/// \return true if the path is short enough.
+
+static bool MakeAddress(sockaddr_un& addr, const char* path){
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if(strlen(path) >= sizeof(addr.sun_path))return false;
+  strcpy(addr.sun_path, path);
+  return true;
+} //MakeAddress
+
+/// \brief Listen on a Unix domain socket.
+///
+/// A socket already at the socket path, left behind by an earlier run, is
+/// removed first. Anything else at the path is left alone and this fails.
+///
+/// \param path Socket path.
+/// \return Listening socket file descriptor, or -1 on failure.
+
+int Listen(const char* path){
+  struct stat st; //status of whatever is at the path
+
+  if(lstat(path, &st) == 0){ //something is there
+    if(!S_ISSOCK(st.st_mode))return -1;
+    unlink(path);
+  } //if
+
+  sockaddr_un addr; //socket address
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0); //listening socket
+
+  if(fd < 0 || !MakeAddress(addr, path) ||
+    bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 64) != 0)
+  {
+    if(fd >= 0)close(fd);
+    return -1;
+  } //if
+
+  return fd;
+} //Listen
+
+/// \brief Connect to a Unix domain socket.
+///
+/// \param path Socket path.
+/// \return Socket file descriptor, or -1 on failure.
+
+int Connect(const char* path){
+  sockaddr_un addr; //socket address
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0); //socket
+
+  if(fd < 0 || !MakeAddress(addr, path) ||
+    connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+  {
+    if(fd >= 0)close(fd);
+    return -1;
+  } //if
+
+  return fd;
+} //Connect
+
+/// \brief Send a line of text.
+///
+/// This will send any string, not just a line of text.
+///
+/// \param fd Socket file descriptor.
+/// \param s Line of text, including the newline.
+/// \return true if the whole line was sent.
+
+bool SendLine(int fd, const std::string& s){
+  size_t sent = 0; //number of bytes sent
+
+  while(sent < s.size()){
+    const ssize_t n = send(fd, s.data() + sent, s.size() - sent, MSG_NOSIGNAL);
+    if(n <= 0)return false;
+    sent += n;
+  } //while
+
+  return true;
+} //SendLine
+
+/// \brief Take a line of text from a buffer.
+///
+/// \param buffer [in, out] Text received so far.
+/// \param line [out] First line of text, without the newline.
+/// \return true if there was a whole line in the buffer.
+
+bool TakeLine(std::string& buffer, std::string& line){
+  const size_t n = buffer.find('\n'); //end of first line
+  if(n == std::string::npos)return false;
+
+  line = buffer.substr(0, n);
+  buffer.erase(0, n + 1);
+  return true;
+} //TakeLine
+
+/// \brief Receive a line of text.
+///
+/// \param fd Socket file descriptor.
+/// \param buffer [in, out] Text received but not yet used.
+/// \param line [out] Line of text, without the newline.
+/// \return true if a line was received, false if the socket closed.
+
+bool ReceiveLine(int fd, std::string& buffer, std::string& line){
+  while(!TakeLine(buffer, line)){
+    char s[4096]; //received bytes
+    const ssize_t n = recv(fd, s, sizeof(s), 0);
+    if(n <= 0)return false;
+    buffer.append(s, n);
+  } //while
+
+  return true;
+} //ReceiveLine
+
+/// \brief Receive a given number of bytes.
+///
+/// \param fd Socket file descriptor.
+/// \param buffer [in, out] Bytes received but not yet used.
+/// \param n Number of bytes wanted.
+/// \param bytes [out] Bytes received.
+/// \return true if all of the bytes were received, false if the socket
+/// closed first.
+
+bool ReceiveBytes(int fd, std::string& buffer, size_t n, std::string& bytes){
+  bytes.swap(buffer);
+  buffer.clear();
+
+  if(bytes.size() > n){ //received too much
+    buffer.assign(bytes, n, std::string::npos);
+    bytes.resize(n);
+  } //if
+
+  const size_t start = bytes.size(); //number of bytes already received
+  bytes.resize(n);
+
+  for(size_t i=start; i<n;){
+    const ssize_t k = recv(fd, &bytes[i], n - i, 0);
+    if(k <= 0)return false;
+    i += k;
+  } //for
+
+  return true;
+} //ReceiveBytes
+
+#endif //_MSC_VER
@@ -0,0 +1,330 @@
+/// \file Template.cpp
+
+/// \brief Code for the element template CTemplate.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Template.h"
+#include "Illusion.h"
+#include "Perf.h"
+#include "Timer.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <random>
+
+//////////////////////////////////////////////////////////////////////////
+// Formatting.
+
+#pragma region formatting
+
+/// \brief Append an unsigned integer to a buffer.
+///
+/// Write the decimal digits of an integer, as `printf` does with `%llu`.
+/// At most 20 bytes are written.
+///
+/// \param p [in, out] Pointer to the end of the buffer.
+/// \param n Number.
+
+void AppendUnsigned(char*& p, uint64_t n){
+  char digits[20]; //digits in reverse order
+  size_t k = 0; //number of digits
+
+  do{
+    digits[k++] = (char)('0' + n%10);
+    n /= 10;
+  }while(n > 0);
+
+  while(k > 0)
+    *p++ = digits[--k];
+} //AppendUnsigned
+
+/// \brief Append a float with one decimal place to a buffer.
+///
+/// Write a float exactly as `printf` does with `%0.1f`. Ten times a float
+/// is exact in double, so rounding it to an integer with `nearbyint()`
+/// rounds the float's exact value to tenths, with halves going to even in
+/// the default rounding mode, just as `printf` does. The sign is written
+/// whenever the float is negative, even if it rounds to zero. Numbers too
+/// big for 64 bits, infinities, and NaNs are passed to `snprintf()`. At
+/// most 64 bytes are written.
+///
+/// \param p [in, out] Pointer to the end of the buffer.
+/// \param x Number.
+
+void AppendTenths(char*& p, float x){
+  const double d = 10.0*x; //tenths, exactly
+
+  if(!(fabs(d) < 1e18)){ //too big, infinite, or not a number
+    p += snprintf(p, 64, "%0.1f", x);
+    return;
+  } //if
+
+  const uint64_t t = (uint64_t)fabs(nearbyint(d)); //rounded tenths
+
+  if(signbit(x))*p++ = '-';
+  AppendUnsigned(p, t/10);
+  *p++ = '.';
+  *p++ = (char)('0' + t%10);
+} //AppendTenths
+
+#pragma endregion formatting
+
+//////////////////////////////////////////////////////////////////////////
+// CTemplate.
+
+#pragma region CTemplate
+
+/// Append text to the current fragment, formatted now with the same
+/// format string conventions as `printf`. Constant text beyond
+/// CTemplate::TEXTSIZE bytes in all is cut off, which is several times
+/// more than any element has.
+/// \param fmt Format string.
+
+void CTemplate::Constant(const char* fmt, ...){
+  va_list args; //argument list
+  va_start(args, fmt);
+  const int n = vsnprintf(m_szText + m_nText, TEXTSIZE - m_nText, fmt,
+    args); //length of text
+  va_end(args);
+
+  if(n <= 0)return; //nothing to append, or format error
+
+  m_nText = std::min(m_nText + n, TEXTSIZE - 1);
+  if(m_nFragments == 0)m_nFragments = 1;
+  m_pFragments[m_nFragments - 1].end = m_nText;
+} //Constant
+
+/// Holes after the first CTemplate::MAXFRAGMENTS - 1 are ignored, which is
+/// several times more than any element has.
+/// \param hole Kind of hole.
+
+void CTemplate::AddHole(Hole hole){
+  if(m_nFragments == 0)m_nFragments = 1;
+  if(m_nFragments == MAXFRAGMENTS)return;
+
+  m_pFragments[m_nFragments - 1].hole = hole;
+  m_pFragments[m_nFragments].end = m_nText;
+  m_pFragments[m_nFragments].hole = Hole::None;
+  m_nFragments++;
+} //AddHole
+
+/// Append a hole to be filled with a float, formatted by AppendTenths().
+
+void CTemplate::TenthsHole(){
+  AddHole(Hole::Tenths);
+} //TenthsHole
+
+/// Append a hole to be filled with a string of at most CTemplate::MAXTEXT
+/// bytes.
+
+void CTemplate::TextHole(){
+  AddHole(Hole::Text);
+} //TextHole
+
+/// Write one element by copying the constant fragments and filling the
+/// holes, in order, into a buffer on the stack, and then writing the buffer
+/// to an output stream in one piece.
+/// \param output Output stream.
+/// \param tenths Floats for the tenths holes, in order.
+/// \param text Strings for the text holes, in order.
+
+void CTemplate::Emit(COutput& output, const float tenths[],
+  const char* const text[]) const
+{
+  char buffer[BUFSIZE]; //element text
+  char* p = buffer; //end of element text
+  size_t begin = 0; //start of current fragment
+
+  for(size_t i=0; i<m_nFragments; i++){
+    const Fragment& fragment = m_pFragments[i]; //current fragment
+    memcpy(p, m_szText + begin, fragment.end - begin);
+    p += fragment.end - begin;
+    begin = fragment.end;
+
+    if(fragment.hole == Hole::Tenths)
+      AppendTenths(p, *tenths++);
+
+    else if(fragment.hole == Hole::Text){
+      const size_t n = strnlen(*text, MAXTEXT); //length of string
+      memcpy(p, *text++, n);
+      p += n;
+    } //else if
+  } //for
+
+  output.Write(buffer, p - buffer);
+} //Emit
+
+#pragma endregion CTemplate
+
+//////////////////////////////////////////////////////////////////////////
+// Commands.
+
+#pragma region commands
+
+/// \brief Time element templates against `printf`.
+///
+/// The parameters are optionally `-reps n` (default 100) followed by a job
+/// as described in ParseJob(); without a job, the illusions `output1.svg`
+/// and `output2.svg` are used. First AppendTenths() is checked against
+/// `snprintf()` on four million floats: random bit patterns, random
+/// numbers near the image, exact halves of tenths, and tiny numbers, some
+/// negative, that round to zero, and the time per number is reported for
+/// each. Then, for each job, with and without "flat", the illusion is
+/// drawn with DrawIllusion(), whose rings use templates, and one element
+/// at a time with DrawElement(), which uses `printf`. The time per element
+/// is reported for each, and the two must be identical.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 if everything matches, 1 if not or for failure.
+
+int BenchTemplateCommand(size_t argc, const char* const argv[]){
+  size_t reps = 100; //number of repetitions
+  std::vector<Job> jobs; //jobs to time
+
+  if(argc >= 2 && !strcmp(argv[0], "-reps")){
+    reps = (size_t)strtoul(argv[1], nullptr, 10);
+    argc -= 2; argv += 2;
+  } //if
+
+  if(argc > 0){
+    jobs.push_back(Job());
+
+    if(!ParseJob(jobs[0], argc, argv) || reps == 0){
+      printf("Expected [-reps n] [job]\n");
+      return 1;
+    } //if
+  } //if
+
+  else BenchJobs(jobs);
+
+  const size_t COUNT = 1 << 22; //number of floats
+  std::vector<float> v(COUNT); //floats to format
+  std::mt19937 rng(12345); //random number generator
+  std::uniform_real_distribution<float> near(-1000, 1000); //near the image
+  std::uniform_int_distribution<int> quarters(-40000, 40000); //halves
+
+  for(size_t k=0; k<COUNT; k++)
+    switch(k%4){
+      case 0: { //any bit pattern, including infinities and NaNs
+        const uint32_t bits = (uint32_t)rng(); //random bits
+        memcpy(&v[k], &bits, sizeof(bits));
+      } break;
+
+      case 1: v[k] = near(rng); break;
+      case 2: v[k] = quarters(rng)/4.0f; break; //x.25 and x.75 are halves
+      case 3: v[k] = near(rng)*1e-5f; break; //rounds to zero
+    } //switch
+
+  size_t mismatches = 0; //number of floats formatted differently
+
+  for(size_t k=0; k<COUNT; k++){
+    char a[64], b[64]; //formatted by snprintf and AppendTenths
+    snprintf(a, sizeof(a), "%0.1f", v[k]);
+    char* p = b; //end of b
+    AppendTenths(p, v[k]);
+    *p = '\0';
+
+    if(strcmp(a, b) != 0 && mismatches++ == 0)
+      printf("  %s formatted as %s\n", a, b);
+  } //for
+
+  double t[2] = {0, 0}; //time for snprintf and AppendTenths
+  size_t bytes[2] = {0, 0}; //bytes written by each, so it isn't optimized out
+
+  for(int k=0; k<2; k++){
+    CTimer timer; //stopwatch
+
+    for(float x: v){
+      char buffer[64]; //formatted number
+      char* p = buffer; //end of buffer
+      if(k == 0)p += snprintf(buffer, sizeof(buffer), "%0.1f", x);
+      else AppendTenths(p, x);
+      bytes[k] += p - buffer;
+    } //for
+
+    t[k] = timer.Elapsed();
+  } //for
+
+  printf("%%0.1f on %zu floats: %zu mismatches, snprintf %0.1f ns, "
+    "AppendTenths %0.1f ns\n", COUNT, mismatches, 1e9*t[0]/COUNT,
+    1e9*t[1]/COUNT);
+
+  bool ok = mismatches == 0 && bytes[0] == bytes[1]; //everything matches
+
+  for(Job job: jobs)
+    for(int flat=0; flat<2; flat++){
+      job.flat = flat != 0;
+      Illusion illusion; //illusion descriptor
+      Describe(illusion, job);
+      const size_t n = ElementCount(illusion); //number of elements
+
+      std::string s[2]; //drawn with printf and with templates
+      double best[2] = {INFINITY, INFINITY}; //fastest times
+
+      for(size_t rep=0; rep<reps; rep++)
+        for(int k=0; k<2; k++){ //printf, then templates
+          s[k].clear();
+          CTimer timer; //stopwatch
+          COutput output(s[k]); //output stream
+
+          if(k == 0){
+            DrawStyle(output, illusion);
+
+            for(const Ring& ring: illusion.rings){
+              float theta = ring.theta; //angle to element
+              bool parity = ring.parity; //element parity
+
+              for(size_t i=0; i<ring.n; i++){
+                DrawElement(output, illusion.cx, illusion.cy, ring, i, theta,
+                  parity);
+                NextElement(ring, i, theta, parity);
+              } //for
+            } //for
+          } //if
+
+          else DrawIllusion(output, illusion);
+
+          output.Flush();
+          best[k] = std::min(best[k], timer.Elapsed());
+        } //for
+
+      const bool same = s[0] == s[1]; //identical SVG
+      ok = ok && same;
+
+      printf("%s%s: %zu elements, printf %0.1f ns, templates %0.1f ns, "
+        "%0.1fx, %s\n", job.fname.c_str(), flat? " flat": "", n,
+        1e9*best[0]/n, 1e9*best[1]/n, best[0]/best[1],
+        same? "identical": "DIFFERENT");
+    } //for
+
+  return ok? 0: 1;
+} //BenchTemplateCommand
+
+#pragma endregion commands
@@ -0,0 +1,95 @@
+/// \file Template.h
+
+/// \brief Interface for the element template CTemplate.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Template_h__
+#define __Template_h__
+
+#include <stdint.h>
+
+#include "Output.h"
+
+/// \brief Element template.
+///
+/// Most of the text of an element is the same for every element of a ring:
+/// the tags, the attribute names, the image center, and the element's size.
+/// Only the position, the orientation, and the class change. A template
+/// holds the constant text, formatted once, as fragments separated by
+/// holes, and writes an element by copying the fragments and formatting
+/// only what goes in the holes. A tenths hole is filled with a float
+/// written exactly as `%0.1f` would, and a text hole with a string.
+///
+/// The fragments are kept in fixed arrays inside the template, so compiling
+/// one allocates nothing, and the longest element a template can write
+/// fits in the buffer on the stack that Emit() writes it into.
+
+class CTemplate{
+  public:
+    static const size_t MAXTEXT = 32; ///< Longest string in a text hole.
+
+  private:
+    static const size_t MAXTENTHS = 64; ///< Longest number in a tenths hole.
+    static const size_t TEXTSIZE = 512; ///< Most constant text, with a null.
+    static const size_t MAXFRAGMENTS = 16; ///< Most fragments.
+    static const size_t BUFSIZE =
+      TEXTSIZE + MAXFRAGMENTS*MAXTENTHS; ///< Element buffer size.
+
+    /// \brief Kind of hole.
+
+    enum class Hole{
+      None, ///< No hole, at the end.
+      Tenths, ///< Float with one decimal place.
+      Text ///< String.
+    }; //Hole
+
+    /// \brief Constant fragment and the hole after it.
+
+    struct Fragment{
+      size_t end = 0; ///< End of fragment in m_szText.
+      Hole hole = Hole::None; ///< Hole after fragment.
+    }; //Fragment
+
+    char m_szText[TEXTSIZE]; ///< Constant fragments end to end.
+    size_t m_nText = 0; ///< Length of m_szText.
+    Fragment m_pFragments[MAXFRAGMENTS]; ///< Fragments in order.
+    size_t m_nFragments = 0; ///< Number of fragments.
+
+    void AddHole(Hole hole); ///< End the current fragment with a hole.
+
+  public:
+    void Constant(const char* fmt, ...); ///< Append constant text.
+    void TenthsHole(); ///< Append a tenths hole.
+    void TextHole(); ///< Append a text hole.
+
+    void Emit(COutput& output, const float tenths[],
+      const char* const text[]) const; ///< Write an element.
+}; //CTemplate
+
+void AppendUnsigned(char*& p, uint64_t n);
+void AppendTenths(char*& p, float x);
+
+int BenchTemplateCommand(size_t argc, const char* const argv[]);
+
+#endif //__Template_h__
@@ -0,0 +1,98 @@
+/// \file ThreadPool.cpp
+
+/// \brief Code for the thread pool CThreadPool.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "ThreadPool.h"
+
+/// Start the worker threads.
+/// \param n Number of threads, or 0 for one per hardware thread.
+
+CThreadPool::CThreadPool(size_t n){
+  if(n == 0)n = std::thread::hardware_concurrency();
+  if(n == 0)n = 1;
+
+  for(size_t i=0; i<n; i++)
+    m_vThread.push_back(std::thread(&CThreadPool::Run, this));
+} //constructor
+
+/// Finish the tasks already in the queue, then stop the worker threads.
+
+CThreadPool::~CThreadPool(){
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_bStop = true;
+  }
+
+  m_cvTask.notify_all();
+
+  for(std::thread& t: m_vThread)
+    t.join();
+} //destructor
+
+/// Take tasks from the queue and run them until told to stop.
+
+void CThreadPool::Run(){
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  for(;;){
+    m_cvTask.wait(lock, [this]{return m_bStop || !m_qTask.empty();});
+    if(m_qTask.empty())return; //stopping and nothing left to do
+
+    std::function<void()> task = std::move(m_qTask.front()); //next task
+    m_qTask.pop_front();
+    m_nBusy++;
+
+    lock.unlock();
+    task();
+    lock.lock();
+
+    m_nBusy--;
+    if(m_nBusy == 0 && m_qTask.empty())m_cvIdle.notify_all();
+  } //for
+} //Run
+
+/// \param task Task to be run by one of the worker threads.
+
+void CThreadPool::Enqueue(const std::function<void()>& task){
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_qTask.push_back(task);
+  }
+
+  m_cvTask.notify_one();
+} //Enqueue
+
+/// Wait until the queue is empty and no task is being run.
+
+void CThreadPool::Wait(){
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cvIdle.wait(lock, [this]{return m_nBusy == 0 && m_qTask.empty();});
+} //Wait
+
+/// \return Number of worker threads.
+
+size_t CThreadPool::Size() const{
+  return m_vThread.size();
+} //Size
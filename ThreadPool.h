@@ -0,0 +1,66 @@
+/// \file ThreadPool.h
+
+/// \brief Interface for the thread pool CThreadPool.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __ThreadPool_h__
+#define __ThreadPool_h__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// \brief Thread pool.
+///
+/// A fixed set of worker threads that take tasks from a shared queue in
+/// the order in which they were added. The threads are started by the
+/// constructor and kept waiting for more work until the destructor, so that
+/// the cost of starting them is paid only once however many batches of
+/// tasks they are given.
+
+class CThreadPool{
+  private:
+    std::vector<std::thread> m_vThread; ///< Worker threads.
+    std::deque<std::function<void()>> m_qTask; ///< Tasks not yet started.
+    std::mutex m_mutex; ///< Guards everything below.
+    std::condition_variable m_cvTask; ///< Signalled when a task is added.
+    std::condition_variable m_cvIdle; ///< Signalled when a task finishes.
+    size_t m_nBusy = 0; ///< Number of tasks being run.
+    bool m_bStop = false; ///< Tell the threads to exit.
+
+    void Run(); ///< Worker thread main loop.
+
+  public:
+    CThreadPool(size_t n=0); ///< Constructor.
+    ~CThreadPool(); ///< Destructor.
+
+    void Enqueue(const std::function<void()>& task); ///< Add a task.
+    void Wait(); ///< Wait for all tasks to finish.
+    size_t Size() const; ///< Number of threads.
+}; //CThreadPool
+
+#endif //__ThreadPool_h__
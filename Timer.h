@@ -0,0 +1,48 @@
+/// \file Timer.h
+
+/// \brief Interface for the timer CTimer.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#ifndef __Timer_h__
+#define __Timer_h__
+
+#include <chrono>
+
+/// \brief Timer.
+///
+/// A stopwatch for measuring elapsed wall clock time in seconds, used by the
+/// benchmark commands.
+
+class CTimer{
+  private:
+    std::chrono::steady_clock::time_point m_tStart; ///< Start time.
+
+  public:
+    CTimer(); ///< Constructor.
+
+    void Start(); ///< Start or restart the timer.
+    double Elapsed() const; ///< Seconds since start.
+}; //CTimer
+
+#endif //__Timer_h__
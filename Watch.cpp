@@ -0,0 +1,220 @@
+/// \file Watch.cpp
+
+/// \brief Code for watch mode, which renders jobs as they are edited.
+
+// MIT License
+//
+// Copyright (c) 2021 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include "Watch.h"
+#include "Make.h"
+#include "Timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/// \brief Wait for a file to change.
+///
+/// Read events from an inotify descriptor watching a directory until one of
+/// them says that a file of the given name was written or moved into the
+/// directory, or until a timeout expires. Editors commonly save a file by
+/// writing a new one and renaming it over the old, which is why the
+/// directory is watched rather than the file.
+///
+/// \param fd Inotify file descriptor.
+/// \param name File name without directory.
+/// \param timeout Timeout in milliseconds, or -1 to wait forever.
+/// \return true if the file changed, false if the timeout expired.
+
+static bool WaitForChange(int fd, const std::string& name, int timeout){
+  CTimer timer; //stopwatch for timeout
+
+  for(;;){
+    int wait = timeout; //milliseconds left to wait
+
+    if(timeout >= 0){
+      wait = timeout - (int)(1000*timer.Elapsed());
+      if(wait < 0)wait = 0;
+    } //if
+
+    pollfd pfd = {fd, POLLIN, 0}; //what to poll
+    const int n = poll(&pfd, 1, wait); //number of descriptors ready
+
+    if(n <= 0)return false; //timed out or interrupted
+
+    alignas(inotify_event) char buffer[4096]; //events
+    const ssize_t len = read(fd, buffer, sizeof(buffer)); //bytes read
+    if(len <= 0)return false;
+
+    bool changed = false; //whether one of the events is ours
+
+    for(char* p=buffer; p<buffer + len;){
+      const inotify_event* event = (const inotify_event*)p; //next event
+      if(event->len > 0 && name == event->name)changed = true;
+      p += sizeof(inotify_event) + event->len;
+    } //for
+
+    if(changed)return true;
+  } //for
+} //WaitForChange
+
+/// \brief Time since a file was modified.
+///
+/// \param fname File name.
+/// \return Seconds since the file was last modified.
+
+static double Age(const std::string& fname){
+  struct stat st; //file status
+  timespec now; //current time
+  if(stat(fname.c_str(), &st) != 0)return 0;
+  clock_gettime(CLOCK_REALTIME, &now);
+
+  return (now.tv_sec - st.st_mtim.tv_sec) +
+    1e-9*(now.tv_nsec - st.st_mtim.tv_nsec);
+} //Age
+
+#endif //__linux__
+
+/// \brief Render jobs as they are edited.
+///
+/// The parameters are a job file as described in LoadJobs(), optionally
+/// followed by `-deps <file>` and `-threads <n>` as for MakeCommand(),
+/// `-debounce <ms>` to set how long the job file must be left alone before
+/// it is reloaded (default 50 ms), and `-count <k>` to stop after `k` edits
+/// instead of running until interrupted.
+///
+/// The out of date jobs are rendered first, as by MakeCommand(). After that,
+/// each time the job file is saved the jobs are loaded again and compared
+/// with the previous version using the job hashes in the dependency file,
+/// and only the new and edited jobs are rendered. The threads in the pool
+/// are kept waiting between edits. A job file that cannot be loaded, for
+/// example because it was saved half way through an edit, is reported and
+/// otherwise ignored. The time from the job file's modification time to the
+/// last output being written is reported for each edit, along with the
+/// time spent on each phase.
+///
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
+
+int WatchCommand(size_t argc, const char* const argv[]){
+#ifndef __linux__
+  printf("Watch mode is supported only under Linux\n");
+  return 1;
+#else
+  std::string depsfile = argc > 0? std::string(argv[0]) + ".deps": ""; //dependency file
+  size_t threads = 0; //number of threads
+  int debounce = 50; //debounce time in milliseconds
+  size_t count = 0; //number of edits to watch for, 0 for no limit
+  bool ok = argc > 0; //no errors so far
+
+  for(size_t i=1; ok && i<argc; i++){ //options
+    if(!strcmp(argv[i], "-deps") && i + 1 < argc)
+      depsfile = argv[++i];
+    else if(!strcmp(argv[i], "-threads") && i + 1 < argc)
+      threads = (size_t)strtoul(argv[++i], nullptr, 10);
+    else if(!strcmp(argv[i], "-debounce") && i + 1 < argc)
+      debounce = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-count") && i + 1 < argc)
+      count = (size_t)strtoul(argv[++i], nullptr, 10);
+    else ok = false;
+  } //for
+
+  if(!ok){
+    printf("Expected job file [-deps file] [-threads n] [-debounce ms] ");
+    printf("[-count k]\n");
+    return 1;
+  } //if
+
+  const std::string jobfile = argv[0]; //job file name
+  const size_t slash = jobfile.rfind('/'); //end of directory name
+  const std::string dir = slash == std::string::npos? ".":
+    slash == 0? "/": jobfile.substr(0, slash); //directory
+  const std::string name = jobfile.substr(slash + 1); //file name
+
+  const int fd = inotify_init1(IN_CLOEXEC); //inotify descriptor
+
+  if(fd < 0 || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0){
+    printf("Cannot watch %s\n", dir.c_str());
+    return 1;
+  } //if
+
+  std::vector<Job> jobs; //job descriptors
+
+  if(!LoadJobs(jobfile, jobs)){
+    printf("Cannot load jobs from %s\n", jobfile.c_str());
+    close(fd);
+    return 1;
+  } //if
+
+  CThreadPool pool(threads); //rendering threads, kept warm between edits
+  CJournal deps; //dependency file
+  MakeReport report; //what Make() did
+  deps.Load(depsfile);
+  Make(jobs, depsfile, deps, pool, true, report);
+
+  printf("%zu outputs, %zu up to date, %zu rendered on %zu threads\n",
+    report.outputs, report.outputs - report.dirty,
+    report.dirty - report.failed, pool.Size());
+  printf("Watching %s\n", jobfile.c_str());
+  fflush(stdout);
+
+  for(size_t edit=1; count == 0 || edit<=count; edit++){
+    WaitForChange(fd, name, -1);
+
+    CTimer timer; //stopwatch for each phase
+    while(WaitForChange(fd, name, debounce)); //wait for the edits to stop
+    const double tDebounce = timer.Elapsed(); //time spent debouncing
+
+    timer.Start();
+    ok = LoadJobs(jobfile, jobs);
+    const double tParse = timer.Elapsed(); //time to load jobs
+
+    if(!ok){
+      printf("Edit %zu: cannot load jobs, waiting for the next edit\n", edit);
+      fflush(stdout);
+      continue;
+    } //if
+
+    Make(jobs, depsfile, deps, pool, false, report);
+    const double tLatency = Age(jobfile); //edit to output latency
+
+    printf("Edit %zu: %zu of %zu outputs changed, %zu rendered, ",
+      edit, report.dirty, report.outputs, report.dirty - report.failed);
+    printf("edit to output %0.1f ms\n", 1000*tLatency);
+    printf("  debounce %0.1f ms, load %0.1f ms, diff %0.1f ms, ",
+      1000*tDebounce, 1000*tParse, 1000*report.tCheck);
+    printf("render %0.1f ms, save deps %0.1f ms\n",
+      1000*report.tRender, 1000*report.tSave);
+    fflush(stdout);
+  } //for
+
+  close(fd);
+  return 0;
+#endif
+} //WatchCommand
@@ -24,359 +24,278 @@
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 // IN THE SOFTWARE.
 
-#define _USE_MATH_DEFINES
-#include <math.h>
-
 #include <stdio.h>
-#include <string>
-
-const float PI = 3.14159265358979323846f; ///< Pi.
-
-//////////////////////////////////////////////////////////////////////////
-// Helper fuctions.
-
-#pragma region helpers
-
-/// \brief Open SVG file.
-///
-/// Open an SVG file for writing and print the header tag and an
-/// open `svg` tag.
-/// \param output [out] Reference to output file pointer.
-/// \param fname File name without extension.
-/// \param w Image width.
-/// \param h Image height.
-/// \return true if open succeeded.
-
-bool OpenSVG(FILE*& output, const std::string& fname, size_t w, size_t h){
-  const std::string s = fname + ".svg";
-  
-#ifdef _MSC_VER //Visual Studio 
-  fopen_s(&output, s.c_str(), "wt");
-#else
-  output = fopen(s.c_str(), "wt");
-#endif
-  
-  if(output != nullptr){ //write header to file
-    fprintf(output, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"); //xml tag
-
-    fprintf(output, "<svg width=\"%zu\" height=\"%zu\" ", w, w); //svg tag
-    fprintf(output, "viewBox=\"0 0 %zu %zu\" ", w, w);
-    fprintf(output, "xmlns=\"http://www.w3.org/2000/svg\">\n");
-    
-    fprintf(output, "<!-- Created by Ian Parberry -->\n"); //author comment
-     
-    return true; //success
-  } //if
-
-  return false; //failure
-} //OpenSVG
-
-/// \brief Close SVG file.
-///
-/// Print a close `svg` tag and close the SVG file.
-/// \param output Reference to file pointer.
-
-void CloseSVG(FILE*& output){
-  if(output != nullptr){
-    fprintf(output, "</svg>\n"); //close the svg tag
-    fclose(output);
-    output = nullptr;
-  } //if
-} //CloseSVG
-
-#pragma endregion helpers
-
-//////////////////////////////////////////////////////////////////////////
-// Optical Illusion 1 - circles of squares.
-
-#pragma region Illusion1
-
-/// \brief Draw a circle of squares to a file in SVG format.
-/// 
-/// This function outputs SVG `transform` and SVG `rect` tags to the output
-/// file, alternating between black and white. The squares are spaced apart by
-/// approximately half a square width and tilted slightly from the perpendicular
-/// to a line drawn from the center of the circle to the center of the square.
-/// The number of squares is chosen so as to fit the spacing constraint, 
-/// which need not be exact for the optical illusion to work.
-/// Used for optical illusion 1.
+#include <string.h>
+
+#include "Alloc.h"
+#include "Archive.h"
+#include "Batch.h"
+#include "Compress.h"
+#include "Coordinator.h"
+#include "Cost.h"
+#include "Crop.h"
+#include "Daemon.h"
+#include "Fixed.h"
+#include "Flat.h"
+#include "Hit.h"
+#include "Huge.h"
+#include "Illusion.h"
+#include "Journal.h"
+#include "Make.h"
+#include "Pack.h"
+#include "Perf.h"
+#include "Range.h"
+#include "Results.h"
+#include "Rings.h"
+#include "Rotate.h"
+#include "Scheduler.h"
+#include "Server.h"
+#include "Sizes.h"
+#include "Template.h"
+#include "Watch.h"
+
+/// \brief Print usage.
 ///
-/// \image html OneRingOfSquares.svg height=240
+/// Print a summary of the command line options to `stdout`.
+
+void PrintUsage(){
+  printf("Usage:\n");
+  printf("  main.exe\n");
+  printf("    Generate output1.svg, output1a.svg, output2.svg, and output2a.svg.\n");
+  printf("  main.exe render <job>\n");
+  printf("    Generate one optical illusion.\n");
+  printf("  main.exe svg <job>\n");
+  printf("    Write one optical illusion to stdout.\n");
+  printf("  main.exe rings <job>\n");
+  printf("    Write ring descriptors for one optical illusion.\n");
+  printf("  main.exe expand <file.json> <fname>\n");
+  printf("    Expand ring descriptors into an SVG file.\n");
+  printf("  main.exe verify <job>\n");
+  printf("    Check that ring descriptors expand to the same elements.\n");
+  printf("  main.exe serve <port> <jobfile>\n");
+  printf("    Serve the illusions in a job file over HTTP with byte ranges.\n");
+  printf("  main.exe bench-range <job> [length]\n");
+  printf("    Time drawing the last bytes of an illusion.\n");
+  printf("  main.exe crop <x> <y> <w> <h> <job>\n");
+  printf("    Generate the part of an illusion inside a rectangle.\n");
+  printf("  main.exe bench-crop [-reps n] [job]\n");
+  printf("    Time drawing smaller and smaller crops of an illusion.\n");
+  printf("  main.exe sizes <w1,w2,...> <job>\n");
+  printf("    Generate one optical illusion at several sizes.\n");
+  printf("  main.exe bench-sizes [-reps n] [-sizes w1,w2,...] [job]\n");
+  printf("    Time generating several sizes at once against one at a time.\n");
+  printf("  main.exe hit <x> <y> <job>\n");
+  printf("    Find the element of an illusion under a point.\n");
+  printf("  main.exe bench-hit [-queries n] [job]\n");
+  printf("    Time hit tests against looking at every element.\n");
+  printf("  main.exe batch <jobfile> [-shard k/n] [-journal file [-quick] [-sync]]\n");
+  printf("      [-threads n] [-lpt] [-split | -budget m [-queue k]]\n");
+  printf("      [-tar file [-index]] [-manifest file [-sha256]]\n");
+  printf("    Render the illusions in a job file, or one shard of them.\n");
+  printf("  main.exe make <jobfile> [-deps file] [-threads n]\n");
+  printf("    Render only the illusions in a job file that are out of date.\n");
+  printf("  main.exe watch <jobfile> [-deps file] [-threads n] [-debounce ms] [-count k]\n");
+  printf("    Render the illusions in a job file as it is edited.\n");
+  printf("  main.exe bench-journal <n> [file] [-norender]\n");
+  printf("    Time restarting a batch of n jobs from a journal.\n");
+  printf("  main.exe coordinator <jobfile> <socket> [-chunk c] [-lease s] [-spawn w]\n");
+  printf("    Hand out the jobs in a job file to workers.\n");
+  printf("  main.exe worker <socket>\n");
+  printf("    Render jobs handed out by a coordinator.\n");
+  printf("  main.exe bench-workers <jobfile> [-max w] [-chunk c]\n");
+  printf("    Measure jobs per second with 1, 2, 4, ... workers.\n");
+  printf("  main.exe daemon <socket> [-threads n] [-cache m]\n");
+  printf("    Render illusions for clients until killed.\n");
+  printf("  main.exe client <socket> render <job>\n");
+  printf("  main.exe client <socket> svg <job>\n");
+  printf("    Have a daemon run the render or svg command.\n");
+  printf("  main.exe bench-daemon <n> <job>\n");
+  printf("    Time n calls to a daemon against n cold starts.\n");
+  printf("  main.exe bench-sched <dir> [-threads n] [-previews k] [-interval ms]\n");
+  printf("    Time previews rendered while the scheduler is busy with batch jobs.\n");
+  printf("  main.exe cost <jobfile> [-check]\n");
+  printf("    Predict the size of and time to draw each illusion in a job file.\n");
+  printf("  main.exe bench-lpt <dir> [-threads n]\n");
+  printf("    Time a skewed batch in file order, longest first, and split.\n");
+  printf("  main.exe extract <file.tar> <fname>\n");
+  printf("    Write one file from an archive made by batch -tar to stdout.\n");
+  printf("  main.exe bench-archive <dir> [-jobs n] [-threads t]\n");
+  printf("    Time a batch written to one file per job and to a tar archive.\n");
+  printf("  main.exe pack <jobfile> <pack>\n");
+  printf("    Add the illusions in a job file to a deduplicating pack store.\n");
+  printf("  main.exe unpack <pack> [fname]\n");
+  printf("    Write every file in a pack store, or one to stdout.\n");
+  printf("  main.exe bench-pack <dir> [-variants n]\n");
+  printf("    Time packing and unpacking many color variants.\n");
+  printf("  main.exe train <jobfile> <dict> [-zstd] [-size bytes]\n");
+  printf("    Train a compression dictionary on the illusions in a job file.\n");
+  printf("  main.exe compress <jobfile> [-dict file] [-zstd] [-level l] [-threads n]\n");
+  printf("    Render compressed illusions.\n");
+  printf("  main.exe decompress <file> [-dict file]\n");
+  printf("    Write a compressed illusion to stdout.\n");
+  printf("  main.exe bench-compress [-variants n] [-threads t]\n");
+  printf("    Compare compression with and without dictionaries.\n");
+  printf("  main.exe bench-phases [-reps n] [job]\n");
+  printf("    Time and count events in the geometry, formatting, and I/O phases.\n");
+  printf("  main.exe bench-json <file.json> [-samples n] [job]\n");
+  printf("    Run the benchmarks and save the results as JSON.\n");
+  printf("  main.exe compare <base.json> <new.json> [-threshold percent] [-alpha a]\n");
+  printf("    Compare two sets of benchmark results and fail on a regression.\n");
+  printf("  main.exe bench-alloc [-reps n] [job | jobfile]\n");
+  printf("    Count allocations per phase (needs make TRACK_ALLOC=1).\n");
+  printf("  main.exe bench-hash [-reps n] [job]\n");
+  printf("    Measure the cost of hashing SVG as it is written.\n");
+  printf("  main.exe bench-fixed [-reps n] [job]\n");
+  printf("    Compare fixed-point geometry with float geometry.\n");
+  printf("  main.exe bench-huge [-gb g] [-keep] [fname]\n");
+  printf("    Stream a multi-gigabyte illusion in huge geometry.\n");
+  printf("  main.exe bench-flat [-reps n] [job]\n");
+  printf("    Compare elements in groups with elements without groups.\n");
+  printf("  main.exe rotate <job>\n");
+  printf("    Generate an optical illusion with each ring a rotated element.\n");
+  printf("  main.exe bench-rotate [-reps n] [job]\n");
+  printf("    Compare rotated rings with elements in groups.\n");
+  printf("  main.exe bench-template [-reps n] [job]\n");
+  printf("    Time element templates against printf.\n");
+  printf("A <job> is the illusion number followed by the parameters of\n");
+  printf("OpticalIllusion1() or OpticalIllusion2(), for example\n");
+  printf("  1 output1 800 4 100 72 24 black white gray\n");
+  printf("  2 output2 800 3 300 12 6 black white gray\n");
+  printf("optionally followed by \"fixed\" for fixed-point geometry or \"huge\"\n");
+  printf("for rings of billions of elements, and then by \"flat\" for elements\n");
+  printf("without groups.\n");
+} //PrintUsage
+
+/// \brief Generate one optical illusion.
 ///
-/// \param output File pointer.
-/// \param cx Image center x.
-/// \param cy Image center y.
-/// \param r Circle radius in pixels.
-/// \param sw Square width and height.
-/// \param parity Square initial orientation parity.
-
-void DrawCircleOfSquares(FILE* output, size_t cx, size_t cy, float r,
-  size_t sw, bool parity)
-{
-  //number of squares on circle, must be even
-  const size_t n = (size_t)ceil((2*PI*r)/(1.5f*sw)) & 0xFFFFFFFE; 
-
-  const float dtheta = 2*PI/n; //angle delta to next square
-  float theta = 0; //angle to current square
-
-  for(size_t i=0; i<n; i++){ //for each square
-    const float x = r*cosf(theta); //square center x
-    const float y = r*sinf(theta); //square center y
-    const float phi = 12*(parity? 1: -1) + 180*theta/PI; //square orientation
-
-    fprintf(output, "<g transform=\"translate(%0.1f %0.1f)", x + sw/2.0f, y + sw/2.0f); //translate
-    fprintf(output, "rotate(%0.1f %zu %zu)\">", phi, cx, cy); //rotate
-    fprintf(output, "<rect width=\"%zu\" height=\"%zu\" ", sw, sw); //rectangle
-
-    if(i&1)fprintf(output, "class=\"b\""); //black
-    else fprintf(output, "class=\"w\""); //white
-
-    fprintf(output, "/>"); //close rect tag
-    fprintf(output, "</g>\n"); //close group
-
-    theta += dtheta; //next square
-  } //for
-} //DrawCircleOfSquares
-
-/// \brief Draw the first optical illusion to a file in SVG format.
-/// 
-/// The image consists of four concentric circles of tilted squares,
-/// alternating between light and dark squares. This function outputs an SVG
-/// `style` tag (the use of which refices the SVG file size) and the 
-/// background `rectangle` tag, then calls DrawCircleOfSquares()
-/// once for each circle of squares required.
+/// The parameters are a job as described in ParseJob().
 ///
-/// \image html output1.svg height=250
-/// 
-/// \param fname File name without extension.
-/// \param w Width and height of image in pixels.
-/// \param n Number of circles.
-/// \param r0 Initial circle radius.
-/// \param dr Radius delta.
-/// \param sw Width of squares.
-/// \param dark A dark SVG color.
-/// \param light A light SVG color.
-/// \param bgclr A mid-range SVG color for the background.
-
-void OpticalIllusion1(const std::string& fname, size_t w, size_t n,
-  float r0, float dr, size_t sw, const char dark[], const char light[],
-  const char bgclr[])
-{
-  const size_t cx = w/2 - sw/2; //center x coordinate
-  const size_t cy = cx; //center y coordinate
-  FILE* output = nullptr; //output file pointer
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
 
-  if(OpenSVG(output, fname, w, w)){
-    printf("Optical illusion 1 to %s.svg\n", fname.c_str());
+int RenderCommand(size_t argc, const char* const argv[]){
+  Job job; //job descriptor
 
-    //style tag
-    fprintf(output, "<style>"); //open style tag
-    fprintf(output, "rect{fill:none;stroke-width:3}"); //rectangle
-    fprintf(output, "rect.b{x:%zu;y:%zu;stroke:%s;}", cx, cy, dark); //black rect
-    fprintf(output, "rect.w{x:%zu;y:%zu;stroke:%s;}", cx, cy, light); //white rect
-    fprintf(output, "</style>\n"); //close style tag
-    
-    //background
-    fprintf(output, "<rect width=\"%zu\" height=\"%zu\" ", w, w); //rectangle
-    fprintf(output, "style=\"fill:%s\"/>\n", bgclr); //fill
-  
-    for(size_t i=0; i<n; i++) //for each circle of squares
-      DrawCircleOfSquares(output, cx, cy, r0 + i*dr, sw, i&1); //draw it
-       
-    CloseSVG(output); //clean up and exit
+  if(!ParseJob(job, argc, argv)){
+    printf("Bad job parameters\n");
+    return 1;
   } //if
-} //OpticalIllusion1
 
-#pragma endregion Illusion1
+  if(job.geometry != Geometry::Float || job.flat) //illusion functions can't
+    return RenderJob(job)? 0: 1;
 
-//////////////////////////////////////////////////////////////////////////
-// Optical Illusion 2 - circles of circles of ellipses.
+  const char* dark = job.dark.c_str(); //dark color
+  const char* light = job.light.c_str(); //light color
+  const char* bgclr = job.bgclr.c_str(); //background color
 
-#pragma region Illusion2
+  if(job.kind == 1)
+    OpticalIllusion1(job.fname, job.w, job.n, job.p[0], job.p[1],
+      (size_t)job.p[2], dark, light, bgclr);
 
-/// \brief Select ellipse color based on index.
-/// 
-/// If parity is true, ellipse is black when i%4=0, white when ji%4==2, and 
-/// blank when i%4==1 and i%4==3. If parity is false, black and white are
-/// flipped. This function outputs the appropriate class name, `class="b"` for
-/// black and `class="w"` for white, to the output file. Used for optical
-/// illusion 2.
-/// 
-/// \param output Output file pointer.
-/// \param i Ellipse index about circle.
-/// \param parity True if first ellipse is black, false if white.
-
-void SelectEllipseColor(FILE* output, size_t i, bool parity){
-  const size_t j = i%4;
-  if((parity && j == 0) || (!parity && j == 2))
-    fprintf(output, "class=\"b\""); //black ellipse
-  else if((parity && j == 2) || (!parity && j == 0))
-    fprintf(output, "class=\"w\""); //white ellipse
-} //SelectEllipseColor
-
-/// \brief Draw circle of ellipses to a file in SVG format.
-/// 
-/// Draw a circle of elipses oriented so that the long axis of each ellipse is
-/// perpendicular to a line drawn from the center of the circles to the center
-/// of the ellipse. This function outputs SVG `transform` and SVG `ellipse` tags
-/// to the output file. Used for optical illusion 2.
-/// 
-/// \param output Output file pointer.
-/// \param cx X coordinate of center of image in pixels.
-/// \param cy Y coordinate of center of image in pixels.
-/// \param r Radius of circle.
-/// \param r0 Long radius of ellipses.
-/// \param r1 Short radius of ellipses.
-/// \param n Number of ellipses in ring.
-/// \param theta Angle to first ellipse.
-/// \param dtheta Angle delta.
-/// \param parity True if first ellipse is black, false if white.
-/// \param flip True to clip the ordering of colots of ellipses.
-
-void DrawCircleOfEllipses(FILE* output, size_t cx, size_t cy, float r,
-  float r0, float r1, size_t n, float theta, float dtheta, bool parity,
-  size_t flip=999999)
-{
-  for(size_t i=0; i<n; i++){ //for each ellipse
-    const float x = r*cosf(theta); //ellipse center x
-    const float y = r*sinf(theta); //ellipse center y
-    const float phi = 90 + 180*theta/PI; //ellipse orientation
-
-    fprintf(output, "<g transform=\"translate(%0.1f %0.1f)", x, y); //translate
-    fprintf(output, "rotate(%0.1f %zu %zu)\">", phi, cx, cy); //rotate
-    fprintf(output, "<ellipse rx=\"%0.1f\" ry=\"%0.1f\" ", r0, r1); //ellipse
-    
-    SelectEllipseColor(output, i, parity);
+  else OpticalIllusion2(job.fname, job.w, job.n, job.p[0], job.p[1],
+    job.p[2], dark, light, bgclr);
 
-    fprintf(output, "/>"); //close ellipse tag
-    fprintf(output, "</g>\n"); //close group
-
-    theta += dtheta; //next ellipse
-    if(i == flip)parity = !parity; //flip parity if we need to
-  } //for
-} //DrawCircleOfEllipses
+  return 0;
+} //RenderCommand
 
-/// \brief Draw 3 concentric circles of ellipses to a file in SVG format.
-/// 
-/// This function calls DrawCircleOfEllipses() three times, once for each
-/// circle of ellipses. The middle circle is drawn first, then
-/// the inner circle, then the outer circle. The parameters for the calls 
-/// DrawCircleOfEllipses() are chosen so as to achieve the following.
-/// 
-/// The inner circle starts with a black ellipse centered at the top and
-/// alternates with white ellipses each spaced roughly one ellipse long-axis
-/// apart for a total of 36 ellipses as shown in the next image.
-/// 
-/// \image html ring1-middle.svg height=250
-///
-/// The inner circle also has 36 ellipses, but it starts with a gap centered
-/// at the top with black ellipses to the left and right and a gap centered at
-/// the bottom with white ellipses to the left and right. Black and white
-/// alternate for the rest of the circle.
-/// 
-/// \image html ring2-inner.svg height=250
+/// \brief Write one optical illusion to `stdout`.
 ///
-/// The outer circle of a ring is similar to the inner circle
-/// but has black and white interchanged.
-/// 
-/// \image html ring3-outer.svg height=250
-/// 
-/// Used for optical illusion 2.
-/// 
-/// \param output Pointer to output file.
-/// \param cx X coordinate of center of image in pixels.
-/// \param cy Y coordinate of center of image in pixels.
-/// \param r Radius of braid.
-/// \param r0 Long radius of ellipses.
-/// \param r1 Short radius of ellipses.
-/// \param n Number of ellipses in ring.
-/// \param flip True to flip the ordering of colors of ellipses.
-
-void DrawTripleCircle(FILE* output, size_t cx, size_t cy, float r,
-  float r0, float r1, size_t n, bool flip=false)
-{
-  const float dtheta = PI/n; //angle delta to next ellipse
-  float theta = (flip? PI: -PI)/2; //angle to next ellipse
-  n *= 2; //include spaces
-
-  DrawCircleOfEllipses(output, cx, cy, r, r0, r1, n, theta, dtheta, true);  
-  DrawCircleOfEllipses(output, cx, cy, r - r1, r0, r1, n, 
-    theta + dtheta, dtheta, true, n/2 - 1);  
-  DrawCircleOfEllipses(output, cx, cy, r + r1, r0, r1, n, 
-    theta + dtheta, dtheta, false, n/2 - 2);
-} //DrawTripleCircle
-
-/// \brief Draw the second optical illusion to a file in SVG format.
-/// 
-/// The image consists of a pair of concentric rings, each of which is made
-/// up of three concentric circles of ellipses. This function outputs an SVG
-/// `style` tag (the use of which refices the SVG file size) and the 
-/// background `rectangle` tag, then calls DrawTripleCircle()
-/// twice, once for each triplet of circles.
+/// The parameters are a job as described in ParseJob(). The file name is
+/// ignored.
 ///
-/// \image html output2.svg height=250
-/// 
-/// \param fname File name without extension.
-/// \param w Width and height of image in pixels.
-/// \param n Number of ellipses in ring.
-/// \param r Radius of braid.
-/// \param r0 Long radius of ellipses.
-/// \param r1 Short radius of ellipses.
-/// \param dark A dark SVG color.
-/// \param light A light SVG color.
-/// \param bgclr A mid-range SVG color for the background.
+/// \param argc Number of parameters.
+/// \param argv Parameters.
+/// \return 0 for success, 1 for failure.
 
-void OpticalIllusion2(const std::string& fname, size_t w, size_t n,
-  float r, float r0, float r1, const char dark[], const char light[],
-  const char bgclr[])
-{
-  const size_t cx = w/2; //center x coordinate
-  const size_t cy = cx; //center y coordinate
-  FILE* output = nullptr; //output file pointer
+int SvgCommand(size_t argc, const char* const argv[]){
+  Job job; //job descriptor
 
-  if(OpenSVG(output, fname, w, w)){
-    printf("Optical illusion 2 to %s.svg\n", fname.c_str());
-
-    //style tag
-    fprintf(output, "<style>"); //open style tag
-    fprintf(output, "ellipse{fill:none;stroke-width:3}");	//ellipse
-    fprintf(output, "ellipse.b{cx:%zu;cy:%zu;stroke:none;fill:%s;}",
-      cx, cy, dark);	//dark ellipse
-    fprintf(output, "ellipse.w{cx:%zu;cy:%zu;stroke:none;fill:%s;}",
-      cx, cy, light);	//light ellipse
-    fprintf(output, "</style>\n"); //close style tag
-    
-    //background
-    fprintf(output, "<rect width=\"%zu\" height=\"%zu\" ", w, w); //rectangle
-    fprintf(output, "style=\"fill:%s\"/>\n", bgclr); //fill
-  
-    DrawTripleCircle(output, cx, cy, r, r0, r1, 36);
-    DrawTripleCircle(output, cx, cy, r - 64, 0.8f*r0, 0.8f*r1, 36, true);
-
-    CloseSVG(output); //clean up and exit
+  if(!ParseJob(job, argc, argv)){
+    printf("Bad job parameters\n");
+    return 1;
   } //if
-} //OpticalIllusion2
 
-#pragma region Illusion2
-
-//////////////////////////////////////////////////////////////////////////
+  COutput output(stdout); //output stream
+  DrawJob(output, job);
+  return 0;
+} //SvgCommand
 
 /// \brief Main.
 /// 
-/// Create two optical illusions and save them as SVG files. The actual work is
-/// done by functions OpticalIllusion1() and OpticalIllusion2(), called with
-/// various parameters.
-/// \return 0.
-
-int main(){
-  OpticalIllusion1("output1", 800, 4, 100.0f, 72.0f, 24,
-    "black", "white", "gray");
-  OpticalIllusion1("output1a", 800, 4, 100.0f, 72.0f, 24,
-    "blue", "yellow", "forestgreen");
-  OpticalIllusion2("output2", 800, 3, 300.0f, 12.0f, 6.0f,
-    "black", "white", "gray");
-  OpticalIllusion2("output2a", 800, 3, 300.0f, 12.0f, 6.0f,
-    "blue", "yellow", "forestgreen");
+/// With no command line arguments, create two optical illusions and save
+/// them as SVG files. The actual work is done by functions OpticalIllusion1()
+/// and OpticalIllusion2(), called with various parameters. Otherwise the
+/// first argument is a command, see PrintUsage().
+/// \param argc Number of command line arguments.
+/// \param argv Command line arguments.
+/// \return 0 for success, 1 for failure.
+
+int main(int argc, char* argv[]){
+  if(argc < 2){ //no command, generate the default illusions
+    OpticalIllusion1("output1", 800, 4, 100.0f, 72.0f, 24,
+      "black", "white", "gray");
+    OpticalIllusion1("output1a", 800, 4, 100.0f, 72.0f, 24,
+      "blue", "yellow", "forestgreen");
+    OpticalIllusion2("output2", 800, 3, 300.0f, 12.0f, 6.0f,
+      "black", "white", "gray");
+    OpticalIllusion2("output2a", 800, 3, 300.0f, 12.0f, 6.0f,
+      "blue", "yellow", "forestgreen");
+
+    return 0;
+  } //if
 
-  return 0;
-} //main
\ No newline at end of file
+  const char* cmd = argv[1]; //command
+  const size_t n = (size_t)argc - 2; //number of command parameters
+  const char* const* params = argv + 2; //command parameters
+
+  if(!strcmp(cmd, "render"))return RenderCommand(n, params);
+  if(!strcmp(cmd, "svg"))return SvgCommand(n, params);
+  if(!strcmp(cmd, "rings"))return RingsCommand(n, params);
+  if(!strcmp(cmd, "expand"))return ExpandCommand(n, params);
+  if(!strcmp(cmd, "verify"))return VerifyCommand(n, params);
+  if(!strcmp(cmd, "serve"))return ServeCommand(n, params);
+  if(!strcmp(cmd, "bench-range"))return BenchRangeCommand(n, params);
+  if(!strcmp(cmd, "crop"))return CropCommand(n, params);
+  if(!strcmp(cmd, "bench-crop"))return BenchCropCommand(n, params);
+  if(!strcmp(cmd, "sizes"))return SizesCommand(n, params);
+  if(!strcmp(cmd, "bench-sizes"))return BenchSizesCommand(n, params);
+  if(!strcmp(cmd, "hit"))return HitCommand(n, params);
+  if(!strcmp(cmd, "bench-hit"))return BenchHitCommand(n, params);
+  if(!strcmp(cmd, "batch"))return BatchCommand(n, params);
+  if(!strcmp(cmd, "make"))return MakeCommand(n, params);
+  if(!strcmp(cmd, "watch"))return WatchCommand(n, params);
+  if(!strcmp(cmd, "bench-journal"))return BenchJournalCommand(n, params);
+  if(!strcmp(cmd, "coordinator"))return CoordinatorCommand(n, params);
+  if(!strcmp(cmd, "worker"))return WorkerCommand(n, params);
+  if(!strcmp(cmd, "bench-workers"))return BenchWorkersCommand(n, params);
+  if(!strcmp(cmd, "daemon"))return DaemonCommand(n, params);
+  if(!strcmp(cmd, "client"))return ClientCommand(n, params);
+  if(!strcmp(cmd, "bench-daemon"))return BenchDaemonCommand(n, params);
+  if(!strcmp(cmd, "bench-sched"))return BenchSchedCommand(n, params);
+  if(!strcmp(cmd, "cost"))return CostCommand(n, params);
+  if(!strcmp(cmd, "bench-lpt"))return BenchLptCommand(n, params);
+  if(!strcmp(cmd, "extract"))return ExtractCommand(n, params);
+  if(!strcmp(cmd, "bench-archive"))return BenchArchiveCommand(n, params);
+  if(!strcmp(cmd, "pack"))return PackCommand(n, params);
+  if(!strcmp(cmd, "unpack"))return UnpackCommand(n, params);
+  if(!strcmp(cmd, "bench-pack"))return BenchPackCommand(n, params);
+  if(!strcmp(cmd, "train"))return TrainCommand(n, params);
+  if(!strcmp(cmd, "compress"))return CompressCommand(n, params);
+  if(!strcmp(cmd, "decompress"))return DecompressCommand(n, params);
+  if(!strcmp(cmd, "bench-compress"))return BenchCompressCommand(n, params);
+  if(!strcmp(cmd, "bench-phases"))return BenchPhasesCommand(n, params);
+  if(!strcmp(cmd, "bench-json"))return BenchJsonCommand(n, params);
+  if(!strcmp(cmd, "compare"))return CompareCommand(n, params);
+  if(!strcmp(cmd, "bench-alloc"))return BenchAllocCommand(n, params);
+  if(!strcmp(cmd, "bench-hash"))return BenchHashCommand(n, params);
+  if(!strcmp(cmd, "bench-fixed"))return BenchFixedCommand(n, params);
+  if(!strcmp(cmd, "bench-huge"))return BenchHugeCommand(n, params);
+  if(!strcmp(cmd, "bench-flat"))return BenchFlatCommand(n, params);
+  if(!strcmp(cmd, "rotate"))return RotateCommand(n, params);
+  if(!strcmp(cmd, "bench-rotate"))return BenchRotateCommand(n, params);
+  if(!strcmp(cmd, "bench-template"))return BenchTemplateCommand(n, params);
+
+  PrintUsage();
+  return 1;
+} //main